@@ -0,0 +1,70 @@
+// Contention of the different ways to accumulate a shared quantity from many threads.
+// usage: bench_atomic_accumulate [max_threads] [additions_per_thread]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "quantity/atomic.hpp"
+#include "quantity/predefined.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+
+namespace
+{
+    template<class F>
+    double run(unsigned threads, F&& work)
+    {
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for(unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back(work);
+        }
+        for(auto& w : workers) {
+            w.join();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void report(const char* name, unsigned threads, long additions, double seconds)
+    {
+        std::cout << "  " << name << ": " << threads * additions / seconds / 1e6 << " M adds/s\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned max_threads = argc > 1 ? unsigned(std::atoi(argv[1])) : 64;
+    long additions = argc > 2 ? std::atol(argv[2]) : 1'000'000;
+    const energy_t delta = 1.0_J;
+
+    for(unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        std::cout << threads << " threads\n";
+
+        std::mutex mutex;
+        energy_t locked{};
+        report("mutex", threads, additions, run(threads, [&] {
+            for(long i = 0; i < additions; ++i) {
+                std::lock_guard<std::mutex> lock(mutex);
+                locked += delta;
+            }
+        }));
+
+        AtomicQuantity<double, energy_t::dimension_t> atomic;
+        report("AtomicQuantity", threads, additions, run(threads, [&] {
+            for(long i = 0; i < additions; ++i) {
+                atomic.fetch_add(delta, std::memory_order_relaxed);
+            }
+        }));
+
+        ShardedAccumulator<energy_t> sharded(threads);
+        report("ShardedAccumulator", threads, additions, run(threads, [&] {
+            for(long i = 0; i < additions; ++i) {
+                sharded.add(delta);
+            }
+        }));
+    }
+}
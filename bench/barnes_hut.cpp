@@ -0,0 +1,66 @@
+// Throughput of the Barnes-Hut solver compared to the direct sum.
+// usage: bench_barnes_hut [max_bodies] [opening_angle]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "quantity/gravity.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t max_bodies = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    gravity::Options options;
+    options.opening_angle = argc > 2 ? std::atof(argv[2]) : 0.5;
+
+    std::mt19937 rng(1);
+    std::normal_distribution<double> coord(0.0, 1e9);
+    std::uniform_real_distribution<double> mass(1e20, 1e24);
+
+    for(std::size_t n = 10'000; n <= max_bodies; n *= 10) {
+        std::vector<length_vec> pos(n);
+        std::vector<mass_t> m(n);
+        for(std::size_t i = 0; i < n; ++i) {
+            pos[i] = meters(coord(rng), coord(rng), coord(rng));
+            m[i] = mass_t(mass(rng));
+        }
+        std::vector<accel_vec> acc(n);
+
+        gravity::BarnesHut tree(options);
+        auto start = std::chrono::steady_clock::now();
+        tree.build(pos, m);
+        double build = seconds_since(start);
+        start = std::chrono::steady_clock::now();
+        tree.accelerations(acc);
+        double walk = seconds_since(start);
+
+        std::cout << "N = " << n << ": build " << build << " s, traversal " << walk << " s, "
+                  << n / (build + walk) << " bodies/s";
+
+        // the direct sum is only feasible for the smallest size
+        if(n == 10'000) {
+            std::vector<accel_vec> reference(n);
+            start = std::chrono::steady_clock::now();
+            gravity::direct_sum(pos, m, reference, options);
+            double direct = seconds_since(start);
+            double max_error = 0;
+            for(std::size_t i = 0; i < n; ++i) {
+                max_error = std::max(max_error, double(length(acc[i] - reference[i]) / length(reference[i])));
+            }
+            std::cout << ", direct " << direct << " s, max rel. error " << max_error;
+        }
+        std::cout << "\n";
+    }
+}
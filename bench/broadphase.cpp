@@ -0,0 +1,69 @@
+// Candidate pairs per second of the broadphase structures.
+// usage: bench_broadphase [bodies] [steps]
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "quantity/broadphase.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+
+namespace
+{
+    template<class Phase, class Step>
+    void run(const char* name, Phase& phase, std::vector<length_vec>& pos, const std::vector<length_t>& radii,
+             int steps, Step&& step)
+    {
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<double> d(-0.05, 0.05);
+        std::vector<broadphase::Pair> pairs;
+        std::size_t total = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        phase.build(pos, radii);
+        for(int s = 0; s < steps; ++s) {
+            for(auto& p : pos) p += meters(d(rng), d(rng), d(rng));
+            step(phase);
+            pairs.clear();
+            phase.find_pairs(pairs);
+            total += pairs.size();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << total / steps << " pairs/step, " << seconds / steps * 1e3 << " ms/step, "
+                  << total / seconds << " pairs/s, " << pos.size() * steps / seconds << " bodies/s\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000;
+    int steps = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    std::mt19937 rng(1);
+    // about 1.5 neighbours per body
+    double extent = std::cbrt(double(n)) * 4;
+    std::uniform_real_distribution<double> coord(0, extent);
+    std::uniform_real_distribution<double> radius(0.2, 1.0);
+    std::vector<length_vec> pos(n);
+    std::vector<length_t> radii(n);
+    for(std::size_t i = 0; i < n; ++i) {
+        pos[i] = meters(coord(rng), coord(rng), coord(rng));
+        radii[i] = length_t(radius(rng));
+    }
+
+    auto grid_pos = pos;
+    broadphase::UniformGrid grid(0.25_m);
+    run("uniform grid", grid, grid_pos, radii, steps, [&](broadphase::UniformGrid& g) {
+        g.update(grid_pos, radii);
+    });
+
+    auto sap_pos = pos;
+    broadphase::SweepAndPrune sap;
+    run("sweep and prune", sap, sap_pos, radii, steps, [&](broadphase::SweepAndPrune& s) {
+        s.update(sap_pos, radii);
+    });
+}
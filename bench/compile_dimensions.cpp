@@ -0,0 +1,54 @@
+// Compile time stress test of the dimension arithmetic: instantiates quantity operations for
+// COUNT different dimensions, each reached along two different paths.
+// Built by `bench_compile_dimensions`; `compile_time_report` measures its compilation.
+
+#include <iostream>
+#include <utility>
+#include "quantity/quantity.hpp"
+#include "quantity/vec.hpp"
+
+#ifndef COUNT
+#define COUNT 200
+#endif
+
+using namespace quantity;
+using namespace quantity::dimensions;
+
+namespace
+{
+    template<std::size_t I>
+    using first_path = ops::mul_t<ops::pow_t<predefined::length_t, std::intmax_t(I % 7) - 3, 1>,
+                                  ops::div_t<ops::pow_t<predefined::mass_t, std::intmax_t(I % 5) - 2, 2>,
+                                             ops::pow_t<predefined::time_t, std::intmax_t(I % 11) - 5, 3>>>;
+
+    template<std::size_t I>
+    using second_path = ops::div_t<ops::mul_t<ops::pow_t<predefined::mass_t, std::intmax_t(I % 5) - 2, 2>,
+                                              ops::pow_t<predefined::length_t, std::intmax_t(I % 7) - 3, 1>>,
+                                   ops::pow_t<predefined::time_t, std::intmax_t(I % 11) - 5, 3>>;
+
+    template<std::size_t I>
+    double kernel(double x)
+    {
+        static_assert(ops::dimensions_equal<first_path<I>, second_path<I>>(), "paths lead to the same dimension");
+        Quantity<double, first_path<I>> a(x);
+        Quantity<double, first_path<I>> b(x + I);
+        auto rate = a / Quantity<double, predefined::time_t>(2.0);
+        auto square = sqrt(a * a);
+        auto v = make_vector(a, b, square) * 2.0;
+        return (rate * Quantity<double, predefined::time_t>(1.0) + length(v)).value;
+    }
+
+    template<std::size_t... I>
+    double run(std::index_sequence<I...>)
+    {
+        double total = 0;
+        int expand[] = {0, (total += kernel<I>(1.0), 0)...};
+        (void)expand;
+        return total;
+    }
+}
+
+int main()
+{
+    std::cout << run(std::make_index_sequence<COUNT>{}) << "\n";
+}
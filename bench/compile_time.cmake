@@ -0,0 +1,53 @@
+# Measures the cost of compiling bench/compile_dimensions.cpp: wall time, object size, the time
+# the compiler spends instantiating templates, the number and mean length of the symbols it
+# emits and how many of them are template instantiations.
+# usage: cmake -DCOMPILER=<c++> -DSOURCE=<file> -DINCLUDE=<dir> -DOUTPUT=<object> [-DNM=<nm>] [-DCOUNT=<n>]
+#              -P compile_time.cmake
+
+if(NOT COUNT)
+    set(COUNT 200)
+endif()
+
+string(TIMESTAMP start "%s%f")
+execute_process(COMMAND ${COMPILER} -std=c++14 -g -ftime-report -DCOUNT=${COUNT} -I${INCLUDE} -c ${SOURCE} -o ${OUTPUT}
+                RESULT_VARIABLE result ERROR_VARIABLE report)
+string(TIMESTAMP stop "%s%f")
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "compilation failed\n${report}")
+endif()
+math(EXPR milliseconds "(${stop} - ${start}) / 1000")
+file(SIZE ${OUTPUT} bytes)
+message(STATUS "dimensions: ${COUNT}, compile time: ${milliseconds} ms, object size: ${bytes} bytes")
+
+# GCC's phase table: "template instantiation : usr ( %) sys ( %) wall ( %) memory ( %)"
+if(report MATCHES "template instantiation[ ]*:[^\n]*[)][ ]+([0-9.]+)[ ]+[(][ ]*[0-9]+%[)][ ]+([0-9.]+[kMG]?)[ ]+[(]")
+    message(STATUS "template instantiation: ${CMAKE_MATCH_1} s wall, ${CMAKE_MATCH_2} memory")
+endif()
+
+if(NM)
+    execute_process(COMMAND ${NM} ${OUTPUT} OUTPUT_VARIABLE symbols)
+    string(REGEX MATCHALL "[^\n]+" lines "${symbols}")
+    set(count 0)
+    set(total 0)
+    foreach(line IN LISTS lines)
+        string(REGEX REPLACE "^.* " "" name "${line}")
+        string(LENGTH "${name}" length)
+        math(EXPR count "${count} + 1")
+        math(EXPR total "${total} + ${length}")
+    endforeach()
+    if(count GREATER 0)
+        math(EXPR mean "${total} / ${count}")
+        message(STATUS "symbols: ${count}, mean mangled length: ${mean}")
+    endif()
+
+    # instantiations that reach the object file: defined symbols with template arguments and the
+    # distinct dimension types named in them. Instantiations used only during compilation, such as
+    # the exponent arithmetic, leave no symbol; their cost is the instantiation time above.
+    execute_process(COMMAND ${NM} -C --defined-only ${OUTPUT} OUTPUT_VARIABLE demangled)
+    string(REGEX MATCHALL "[^\n]*<[^\n]*" templates "${demangled}")
+    list(LENGTH templates functions)
+    string(REGEX MATCHALL "dimensions::Dim[A-Za-z_]*<([-0-9a-z, ]|std::ratio<[-0-9a-z, ]*>)*>" dimension_types "${demangled}")
+    list(REMOVE_DUPLICATES dimension_types)
+    list(LENGTH dimension_types dimension_count)
+    message(STATUS "template instantiations: ${functions} functions, ${dimension_count} dimension types")
+endif()
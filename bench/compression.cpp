@@ -0,0 +1,79 @@
+// Compression ratio and decode speed of compressed series on a synthetic orbit, compared to
+// the size of the text written by operator<<.
+// usage: bench_compression [samples]
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include "quantity/compression.hpp"
+#include "quantity/kepler.hpp"
+#include "quantity/io.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+using stamp_t = quantity::predefined::time_t;
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+
+    // one low earth orbit, sampled once per second: sample i is the orbit advanced by i seconds.
+    const kepler::grav_param_t mu(3.986004418e14);
+    const double a = 6.9e6;
+    const double mean_motion = std::sqrt(mu.value / (a * a * a));
+    kepler::Elements elements;
+    elements.reserve(n);
+    for(std::size_t i = 0; i < n; ++i) {
+        elements.push_back(meters(a), 0.001, 0.9, 0.3, 1.2, mean_motion * double(i), stamp_t(0.0));
+    }
+    Vec3Array<length_t> positions;
+    Vec3Array<speed_t> velocities;
+    kepler::propagate(elements, stamp_t(0.0), mu, positions, velocities);
+
+    compression::Series<length_vec> series(stamp_t(1e-3), 4096);
+    auto start = std::chrono::steady_clock::now();
+    for(std::size_t i = 0; i < n; ++i) {
+        series.push_back(stamp_t(1.6e9 + double(i)), positions[i]);
+    }
+    series.flush();
+    double encode = seconds_since(start);
+
+    const double raw_bytes = double(n) * 4 * sizeof(double);
+    std::stringstream text;
+    const std::size_t text_n = std::min<std::size_t>(n, 100'000);
+    for(std::size_t i = 0; i < text_n; ++i) {
+        text << stamp_t(1.6e9 + double(i)) << " " << positions[i] << "\n";
+    }
+    const double text_bytes = double(text.str().size()) * double(n) / double(text_n);
+
+    std::cout << "samples:       " << n << " in " << series.block_count() << " blocks\n";
+    std::cout << "compressed:    " << series.compressed_bytes() / 1e6 << " MB, " << raw_bytes / series.compressed_bytes()
+              << "x smaller than binary, " << text_bytes / series.compressed_bytes() << "x smaller than text\n";
+    std::cout << "encode:        " << raw_bytes / encode / 1e9 << " GB/s\n";
+
+    std::vector<stamp_t> times;
+    Vec3Array<length_t> decoded;
+    for(unsigned threads : {1u, 0u}) {
+        start = std::chrono::steady_clock::now();
+        series.decode(times, decoded, threads);
+        double decode = seconds_since(start);
+        std::cout << "decode (" << (threads == 1 ? "1 thread" : "all threads") << "): "
+                  << raw_bytes / decode / 1e9 << " GB/s";
+        std::cout << (decoded[n / 2] == positions[n / 2] ? "\n" : " MISMATCH\n");
+    }
+
+    start = std::chrono::steady_clock::now();
+    std::size_t block = series.find_block(stamp_t(1.6e9 + double(n / 3)));
+    series.decode_block(block, times, decoded);
+    std::cout << "random access of one block: " << seconds_since(start) * 1e6 << " us\n";
+}
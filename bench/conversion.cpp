@@ -0,0 +1,59 @@
+// Converting a column between unit spellings: reading every value with its unit through
+// `operator>>` compared to a prebuilt conversion plan.
+// usage: bench_conversion [values]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "quantity/conversion.hpp"
+#include "quantity/io.hpp"
+#include "quantity/predefined.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50'000'000;
+    std::vector<double> raw(n);
+    for(std::size_t i = 0; i < n; ++i) raw[i] = 1e-3 * double(i % 100000);
+    std::vector<double> out(n);
+
+    // the per value path parses the unit every time; measured on a small part of the data
+    std::size_t m = std::min<std::size_t>(n, 20000);
+    auto start = std::chrono::steady_clock::now();
+    std::stringstream text;
+    speed_t v;
+    for(std::size_t i = 0; i < m; ++i) {
+        text.clear();
+        text.str("");
+        text << raw[i] << " km/s";
+        text >> v;
+        out[i] = v.value * 1e-6;
+    }
+    double per_value = seconds_since(start) / double(m);
+
+    start = std::chrono::steady_clock::now();
+    const auto& plan = runtime::ConversionPlan::cached("km/s", "Mm/s");
+    double build = seconds_since(start);
+
+    for(unsigned threads : {1u, 0u}) {
+        start = std::chrono::steady_clock::now();
+        plan.apply(raw, out, threads);
+        double t = seconds_since(start);
+        std::cout << (threads == 1 ? "plan, 1 thread:    " : "plan, all threads: ") << double(n) / t / 1e6
+                  << " M values/s\n";
+    }
+    std::cout << "per value parsing: " << 1e-6 / per_value << " M values/s\n"
+              << "building the plan: " << build * 1e6 << " us\n";
+}
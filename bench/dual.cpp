@@ -0,0 +1,72 @@
+// Jacobian of the point mass acceleration with respect to position by dual numbers, compared to
+// central finite differences.
+// usage: bench_dual [states]
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "quantity/dual.hpp"
+#include "quantity/predefined.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+
+namespace
+{
+    using mu_t = decltype(area_t() * accel_t());
+    const mu_t MU(3.986004418e14);
+
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template<class T>
+    auto acceleration(const Vec3<T>& r)
+    {
+        auto d = length(r);
+        return r * (-MU / (d * d * d));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+    std::vector<length_vec> states(n);
+    for(std::size_t i = 0; i < n; ++i) {
+        double phase = i * 1e-3;
+        states[i] = make_vector(meters(7e6 * std::cos(phase)), meters(7e6 * std::sin(phase)), meters(1e5));
+    }
+
+    // one pass with three derivative lanes
+    auto start = std::chrono::steady_clock::now();
+    double dual_sum = 0;
+    for(const auto& r : states) {
+        auto a = acceleration(variable<3>(r, 0));
+        for(std::size_t j = 0; j < 3; ++j) {
+            auto column = derivative<length_t>(a, j);
+            dual_sum += column.x.value + column.y.value + column.z.value;
+        }
+    }
+    double dual = seconds_since(start);
+
+    // six evaluations per state
+    start = std::chrono::steady_clock::now();
+    double fd_sum = 0;
+    const length_t h = 1.0_m;
+    for(const auto& r : states) {
+        const length_vec steps[3] = {make_vector(h, 0.0_m, 0.0_m), make_vector(0.0_m, h, 0.0_m),
+                                     make_vector(0.0_m, 0.0_m, h)};
+        for(const auto& step : steps) {
+            auto column = (acceleration(r + step) - acceleration(r - step)) / (2.0 * h);
+            fd_sum += column.x.value + column.y.value + column.z.value;
+        }
+    }
+    double fd = seconds_since(start);
+
+    std::cout << "dual numbers:        " << n / dual / 1e6 << " M Jacobians/s\n"
+              << "finite differences:  " << n / fd / 1e6 << " M Jacobians/s\n"
+              << "relative difference of the sums: " << std::abs(dual_sum - fd_sum) / std::abs(dual_sum) << "\n";
+}
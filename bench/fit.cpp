@@ -0,0 +1,132 @@
+// Fitting many short tracks: a generic dense least squares solver on plain doubles, with heap
+// allocated matrices per track, compared to the batched fits of the fit module.
+// usage: bench_fit [tracks] [samples per track]
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <vector>
+#include "quantity/fit.hpp"
+#include "quantity/predefined.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+using stamp_t = quantity::predefined::time_t;
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /// least squares solution of `a x = b` via the normal equations and Gaussian elimination.
+    std::vector<double> generic_solve(const std::vector<std::vector<double>>& a, const std::vector<double>& b)
+    {
+        const std::size_t n = a[0].size();
+        std::vector<std::vector<double>> m(n, std::vector<double>(n + 1, 0.0));
+        for(std::size_t r = 0; r < a.size(); ++r) {
+            for(std::size_t i = 0; i < n; ++i) {
+                for(std::size_t j = 0; j < n; ++j) m[i][j] += a[r][i] * a[r][j];
+                m[i][n] += a[r][i] * b[r];
+            }
+        }
+        for(std::size_t i = 0; i < n; ++i) {
+            for(std::size_t k = i + 1; k < n; ++k) {
+                const double f = m[k][i] / m[i][i];
+                for(std::size_t j = i; j <= n; ++j) m[k][j] -= f * m[i][j];
+            }
+        }
+        std::vector<double> x(n);
+        for(std::size_t i = n; i-- > 0;) {
+            double v = m[i][n];
+            for(std::size_t j = i + 1; j < n; ++j) v -= m[i][j] * x[j];
+            x[i] = v / m[i][i];
+        }
+        return x;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t tracks_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20'000;
+    const std::size_t samples = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 50;
+    std::mt19937_64 rng(3);
+    std::normal_distribution<double> noise(0.0, 5.0);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+
+    fit::Tracks<stamp_t, length_vec> tracks;
+    tracks.reserve(tracks_count, tracks_count * samples);
+    std::vector<stamp_t> times(samples);
+    std::vector<length_vec> positions(samples);
+    for(std::size_t k = 0; k < tracks_count; ++k) {
+        const length_vec r0(meters(7e6 * uniform(rng)), meters(7e6 * uniform(rng)), meters(7e6 * uniform(rng)));
+        const velocity_vec v(speed_t(7e3 * uniform(rng)), speed_t(7e3 * uniform(rng)), speed_t(7e3 * uniform(rng)));
+        const accel_t a(9.0 * uniform(rng));
+        for(std::size_t i = 0; i < samples; ++i) {
+            times[i] = stamp_t(1.7e9 + double(i));
+            const stamp_t t{double(i)};
+            positions[i] = r0 + v * t + length_vec(0.5 * a * t * t, meters(0.0), meters(0.0)) +
+                           length_vec(meters(noise(rng)), meters(noise(rng)), meters(noise(rng)));
+        }
+        tracks.add(times, positions);
+    }
+    const double fits = double(tracks_count);
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        double check = 0;
+        for(std::size_t k = 0; k < tracks_count; ++k) {
+            const std::size_t begin = tracks.begin(k), end = tracks.end(k);
+            const double t0 = tracks.x()[begin].value;
+            std::vector<std::vector<double>> a;
+            std::vector<double> bx, by, bz;
+            for(std::size_t i = begin; i < end; ++i) {
+                const double t = tracks.x()[i].value - t0;
+                a.push_back({1.0, t, t * t});
+                bx.push_back(tracks.y().x[i].value);
+                by.push_back(tracks.y().y[i].value);
+                bz.push_back(tracks.y().z[i].value);
+            }
+            check += generic_solve(a, bx)[1] + generic_solve(a, by)[1] + generic_solve(a, bz)[1];
+        }
+        std::cout << "generic quadratic fits:      " << fits / seconds_since(start) * 1e-3 << " k tracks/s (" << check
+                  << ")\n";
+    }
+
+    for(unsigned threads : {1u, 0u}) {
+        auto start = std::chrono::steady_clock::now();
+        auto results = fit::fit_polynomials<2>(tracks, threads);
+        const double s = seconds_since(start);
+        std::cout << "batched quadratic fits (" << (threads ? "1 thread" : "all threads") << "): " << fits / s * 1e-3
+                  << " k tracks/s (" << results[0].rms.value << " m rms)\n";
+    }
+
+    {
+        // a ballistic model with a drag like term, fitted to the x components only
+        fit::Tracks<stamp_t, length_t> x_tracks;
+        x_tracks.reserve(tracks_count, tracks_count * samples);
+        std::vector<length_t> xs(samples);
+        for(std::size_t k = 0; k < tracks_count; ++k) {
+            const std::size_t begin = tracks.begin(k);
+            for(std::size_t i = 0; i < samples; ++i) {
+                times[i] = stamp_t(double(i));
+                xs[i] = tracks.y().x[begin + i];
+            }
+            x_tracks.add(times, xs);
+        }
+        auto model = [](stamp_t t, auto x0, auto v, auto a) { return x0 + v * t + 0.5 * a * t * t; };
+        std::vector<std::tuple<length_t, speed_t, accel_t>> initial = {
+                std::make_tuple(meters(0.0), speed_t(0.0), accel_t(0.0))};
+        auto start = std::chrono::steady_clock::now();
+        auto results = fit::levenberg_marquardt(model, x_tracks, initial, fit::Options{}, 0);
+        const double s = seconds_since(start);
+        std::size_t iterations = 0;
+        for(const auto& r : results) iterations += r.iterations;
+        std::cout << "Levenberg-Marquardt fits:    " << fits / s * 1e-3 << " k tracks/s, "
+                  << double(iterations) / fits << " iterations per track\n";
+    }
+}
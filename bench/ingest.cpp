@@ -0,0 +1,83 @@
+// Reading "value unit" lines: std::getline and operator>> on a single thread compared to the
+// staged ingest::Pipeline, with the metrics of every stage.
+// usage: bench_ingest [lines]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include "quantity/ingest.hpp"
+#include "quantity/io.hpp"
+#include "quantity/predefined.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> value(-1e3, 1e3);
+    const char* units[] = {"m", "km", "mm", "cm"};
+
+    std::string text;
+    char line[64];
+    for(std::size_t i = 0; i < n; ++i) {
+        std::snprintf(line, sizeof line, "%.9g %s\n", value(rng), units[i % 4]);
+        text += line;
+    }
+    const double mb = double(text.size()) / 1e6;
+    std::cout << n << " lines, " << mb << " MB\n";
+
+    {
+        // the straightforward loop, with the unit lookups cached so only the text handling is compared
+        auto start = std::chrono::steady_clock::now();
+        std::istringstream input(text);
+        std::unordered_map<std::string, double> scales;
+        std::string row, unit;
+        double sum = 0, v;
+        while(std::getline(input, row)) {
+            std::istringstream fields(row);
+            fields >> v >> unit;
+            auto found = scales.find(unit);
+            if(found == scales.end()) {
+                auto dim = runtime::parse_dim(unit);
+                found = scales.emplace(unit, std::pow(10.0, double(dim.factor.num) / double(dim.factor.den))).first;
+            }
+            sum += v * found->second;
+        }
+        double s = seconds_since(start);
+        std::cout << "getline:  " << mb / s << " MB/s (" << sum << ")\n";
+    }
+
+    {
+        std::istringstream input(text);
+        ingest::Pipeline<double, length_t::dimension_t> pipeline(ingest::from_stream(input));
+        double sum = 0;
+        pipeline.run([&](Span<const length_t> batch) {
+            for(const auto& q : batch) sum += q.value;
+        });
+        const double s = std::chrono::duration<double>(pipeline.elapsed()).count();
+        std::cout << "pipeline: " << mb / s << " MB/s (" << sum << ")\n";
+        for(const auto& stage : pipeline.metrics()) {
+            std::cout << "  " << stage.name << ": " << stage.items << " items, busy "
+                      << std::chrono::duration<double>(stage.busy).count() << " s, starved "
+                      << std::chrono::duration<double>(stage.starved).count() << " s, blocked "
+                      << std::chrono::duration<double>(stage.blocked).count() << " s, max queue "
+                      << stage.max_queue_depth << "\n";
+        }
+    }
+}
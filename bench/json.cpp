@@ -0,0 +1,78 @@
+// Writing and reading records of quantities as JSON lines through a file, compared to parsing
+// the unit of every field again, as a document based reader followed by parse_dim would.
+// usage: bench_json [records] [file]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "quantity/io.hpp"
+#include "quantity/json.hpp"
+#include "quantity/predefined.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    std::string path = argc > 2 ? argv[2] : "bench_json.jsonl";
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::ofstream file(path, std::ios::binary);
+        json::Writer writer(file);
+        for(std::size_t i = 0; i < n; ++i) {
+            const double t = double(i);
+            writer.begin_object()
+                  .field("pos", kilometers(7000.0 + 0.001 * t, -0.5 * t, 12.25), "km")
+                  .field("vel", make_vector(speed_t(7500.0), speed_t(1e-3 * t), speed_t(-2.0)), "km/s")
+                  .field("mass", kilogram(500.0 + t), "t")
+                  .end_object();
+        }
+    }
+    const double write = seconds_since(start);
+    std::ifstream size_probe(path, std::ios::binary | std::ios::ate);
+    const double megabytes = double(size_probe.tellg()) / 1e6;
+
+    length_vec pos;
+    velocity_vec vel;
+    mass_t mass;
+    json::Fields fields;
+    fields.bind("pos", pos).bind("vel", vel).bind("mass", mass);
+
+    start = std::chrono::steady_clock::now();
+    std::ifstream file(path, std::ios::binary);
+    json::RecordReader records(file, fields);
+    double checksum = 0;
+    while(records.next()) checksum += pos.x.value + vel.y.value + mass.value;
+    const double read = seconds_since(start);
+
+    // parse_dim is slow, so it is timed on a part of the records
+    const std::size_t m = std::min<std::size_t>(n, 20000);
+    start = std::chrono::steady_clock::now();
+    for(std::size_t i = 0; i < m; ++i) {
+        runtime::parse_dim("km");
+        runtime::parse_dim("km/s");
+        runtime::parse_dim("t");
+    }
+    const double units = seconds_since(start);
+
+    std::cout << records.count() << " records, " << megabytes << " MB (checksum " << checksum << ")\n"
+              << "write:                  " << megabytes / write << " MB/s\n"
+              << "read:                   " << megabytes / read << " MB/s, " << double(n) / read / 1e6
+              << " M records/s\n"
+              << "parse_dim per field:    " << double(m) / units / 1e6 << " M records/s for the units alone\n";
+    std::remove(path.c_str());
+}
@@ -0,0 +1,74 @@
+// Latency seen by the logging thread: queueing a record in the asynchronous sink compared to
+// formatting the value with operator<< on the spot. Records are logged in bursts of 256, like
+// a simulation that logs once per step, which gives the writer time to keep up.
+// usage: bench_logging [records]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "quantity/io.hpp"
+#include "quantity/logging.hpp"
+#include "quantity/predefined.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+
+    void report(const char* name, std::vector<double>& ns)
+    {
+        std::sort(ns.begin(), ns.end());
+        auto at = [&](double q) { return ns[std::size_t(q * double(ns.size() - 1))]; };
+        std::cout << name << " p50 " << at(0.5) << " ns, p99 " << at(0.99) << " ns, p99.9 " << at(0.999) << " ns\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200'000;
+    std::vector<double> ns(n);
+    std::ofstream devnull("/dev/null");
+
+    // what the measurement itself costs
+    for(std::size_t i = 0; i < n; ++i) {
+        auto start = clock_type::now();
+        ns[i] = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+    }
+    report("clock only:  ", ns);
+
+    {
+        std::ostringstream text;
+        for(std::size_t i = 0; i < n; ++i) {
+            auto position = make_vector(meters(double(i)), 2.5_km, -0.5_m);
+            auto start = clock_type::now();
+            text << "position: " << position << "\n";
+            if(text.tellp() > (1 << 16)) {
+                devnull << text.str();
+                text.str("");
+            }
+            ns[i] = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+        }
+        report("operator<<:  ", ns);
+    }
+
+    {
+        logging::AsyncSink sink(devnull);
+        for(std::size_t i = 0; i < n; ++i) {
+            auto position = make_vector(meters(double(i)), 2.5_km, -0.5_m);
+            auto start = clock_type::now();
+            sink.log("position", position);
+            ns[i] = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+            if(i % 256 == 255) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        sink.flush();
+        report("AsyncSink:   ", ns);
+        std::cout << "dropped " << sink.dropped() << " of " << n << " records\n";
+    }
+}
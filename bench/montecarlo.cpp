@@ -0,0 +1,56 @@
+// Monte-Carlo propagation of the uncertainty of an orbital period, compared to a scalar loop
+// with a sequential random number generator.
+// usage: bench_montecarlo [samples]
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include "quantity/montecarlo.hpp"
+#include "quantity/predefined.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+using stamp_t = quantity::predefined::time_t;
+
+namespace
+{
+    using mu_t = decltype(area_t() * accel_t());
+
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    stamp_t period(length_t a, mu_t mu)
+    {
+        return 6.283185307179586 * sqrt(a * a * a / mu);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20'000'000;
+    auto a = montecarlo::normal(7000.0_km, 0.5_km);
+    auto mu = montecarlo::normal(mu_t(3.986004418e14), mu_t(8e5));
+
+    auto start = std::chrono::steady_clock::now();
+    std::mt19937_64 rng(1);
+    std::normal_distribution<double> da(a.mean.value, a.stddev.value);
+    std::normal_distribution<double> dmu(mu.mean.value, mu.stddev.value);
+    statistics::RunningStats<stamp_t> scalar;
+    for(std::size_t i = 0; i < n; ++i) {
+        scalar.add(period(length_t(da(rng)), mu_t(dmu(rng))));
+    }
+    double sequential = seconds_since(start);
+    std::cout << "scalar loop:    " << n / sequential / 1e6 << " M samples/s, stddev " << scalar.stddev().value << " s\n";
+
+    for(unsigned threads : {1u, 0u}) {
+        start = std::chrono::steady_clock::now();
+        auto stats = montecarlo::propagate(n, montecarlo::Options{1, threads}, period, a, mu);
+        double t = seconds_since(start);
+        std::cout << (threads == 1 ? "engine, 1 thread:   " : "engine, all threads: ") << n / t / 1e6
+                  << " M samples/s, stddev " << stats.stddev().value << " s\n";
+    }
+}
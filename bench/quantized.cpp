@@ -0,0 +1,64 @@
+// Memory footprint, error and (de)quantization speed of quantized arrays compared to plain doubles.
+// usage: bench_quantized [values]
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "quantity/quantized.hpp"
+#include "quantity/predefined.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50'000'000;
+    std::vector<length_t> data(n);
+    for(std::size_t i = 0; i < n; ++i) {
+        data[i] = meters(6.9e6 + 2e4 * std::sin(i * 1e-4) + 10.0 * std::cos(i * 0.37));
+    }
+    const double raw = double(n * sizeof(double));
+
+    for(auto encoding : {Encoding::INT16, Encoding::FLOAT16}) {
+        const char* name = encoding == Encoding::INT16 ? "int16  " : "float16";
+        auto start = std::chrono::steady_clock::now();
+        QuantizedArray<length_t> q(data, encoding);
+        double quantize = seconds_since(start);
+
+        std::vector<length_t> out(n);
+        start = std::chrono::steady_clock::now();
+        q.dequantize(out);
+        double dequantize = seconds_since(start);
+
+        // the read-mostly case: a reduction that streams through the compressed data
+        start = std::chrono::steady_clock::now();
+        std::vector<length_t> chunk(QuantizedArray<length_t>::BLOCK * 16);
+        double sum = 0;
+        for(std::size_t offset = 0; offset < n; offset += chunk.size()) {
+            Span<length_t> part(chunk.data(), std::min(chunk.size(), n - offset));
+            q.dequantize(offset, part);
+            for(const auto& v : part) sum += v.value;
+        }
+        double streamed = seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        double plain_sum = 0;
+        for(const auto& v : data) plain_sum += v.value;
+        double plain = seconds_since(start);
+
+        std::cout << name << ": " << raw / q.bytes() << "x smaller, max error " << q.max_error().value << " m, "
+                  << "quantize " << raw / quantize / 1e9 << " GB/s, dequantize " << raw / dequantize / 1e9
+                  << " GB/s, streamed sum " << streamed / plain << "x the time of summing doubles (mean error "
+                  << (sum - plain_sum) / n << " m)\n";
+    }
+}
@@ -0,0 +1,93 @@
+// Resampling irregular channels onto a common grid: a binary search per grid point compared to
+// the single forward sweep of resample::Channel, and several channels aligned in parallel.
+// usage: bench_resample [samples per channel]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "quantity/predefined.hpp"
+#include "quantity/resample.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+using namespace quantity::resample;
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5'000'000;
+    std::mt19937_64 rng(42);
+    std::exponential_distribution<double> gap(1.0);
+
+    std::vector<stamp_t> times(n);
+    std::vector<length_t> values(n);
+    double t = 0;
+    for(std::size_t i = 0; i < n; ++i) {
+        t += gap(rng);
+        times[i] = stamp_t(t);
+        values[i] = meters(std::sin(1e-3 * t));
+    }
+    const Grid grid{0.0_s, 1.0_s};
+    const std::size_t points = std::size_t(t);
+
+    // per grid point binary search
+    auto start = std::chrono::steady_clock::now();
+    std::vector<length_t> searched;
+    searched.reserve(points);
+    for(std::size_t k = grid.first_at_or_after(times.front()); k < points; ++k) {
+        const stamp_t g = grid.at(k);
+        auto hi = std::upper_bound(times.begin(), times.end(), g);
+        if(hi == times.end()) break;
+        auto i = std::size_t(hi - times.begin()) - 1;
+        double s = double((g - times[i]) / (times[i + 1] - times[i]));
+        searched.push_back(values[i] + (values[i + 1] - values[i]) * s);
+    }
+    const double search = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    Channel<length_t> channel(grid, Interpolation::LINEAR);
+    channel.push(times, values);
+    channel.finish();
+    const double sweep = seconds_since(start);
+
+    double difference = 0;
+    for(std::size_t i = 0; i < std::min(searched.size(), channel.output().size()); ++i) {
+        difference = std::max(difference, std::abs((searched[i] - channel.output()[i]).value));
+    }
+
+    // eight channels in chunks, aligned on one grid
+    using A = Aligner<length_t, length_t, length_t, length_t, length_t, length_t, length_t, length_t>;
+    std::size_t rows = 0;
+    double aligned[2];
+    for(unsigned threads : {1u, 0u}) {
+        A aligner(grid, Interpolation::CUBIC, threads);
+        start = std::chrono::steady_clock::now();
+        const std::size_t chunk = 1 << 16;
+        for(std::size_t b = 0; b < n; b += chunk) {
+            const std::size_t e = std::min(n, b + chunk);
+            Input<length_t> in{Span<const stamp_t>(times.data() + b, e - b),
+                               Span<const length_t>(values.data() + b, e - b)};
+            aligner.feed(in, in, in, in, in, in, in, in);
+            aligner.drain([&](const Block<length_t, length_t, length_t, length_t, length_t, length_t, length_t,
+                                          length_t>& block) { rows += block.size(); });
+        }
+        aligned[threads == 1 ? 0 : 1] = seconds_since(start);
+    }
+
+    std::cout << n << " samples, " << channel.output().size() << " grid points (max difference " << difference
+              << " m)\n"
+              << "binary search:          " << double(n) / search / 1e6 << " M samples/s\n"
+              << "forward sweep:          " << double(n) / sweep / 1e6 << " M samples/s\n"
+              << "8 channels, 1 thread:   " << 8.0 * double(n) / aligned[0] / 1e6 << " M samples/s\n"
+              << "8 channels, all:        " << 8.0 * double(n) / aligned[1] / 1e6 << " M samples/s\n";
+}
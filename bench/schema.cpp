@@ -0,0 +1,98 @@
+// Record I/O through a schema compared to the stream operators called field by field.
+// usage: bench_schema [records]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "quantity/io.hpp"
+#include "quantity/predefined.hpp"
+#include "quantity/schema.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+using stamp_t = quantity::predefined::time_t;
+
+namespace
+{
+    struct Body
+    {
+        stamp_t t;
+        length_vec position;
+        velocity_vec velocity;
+        mass_t mass;
+    };
+
+    constexpr auto body_schema = schema::make_schema(schema::field("t", &Body::t),
+                                                     schema::field("position", &Body::position, "km"),
+                                                     schema::field("velocity", &Body::velocity, "km/s"),
+                                                     schema::field("mass", &Body::mass));
+    using body_schema_t = std::decay_t<decltype(body_schema)>;
+
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void report(const char* what, std::size_t n, double seconds)
+    {
+        std::cout << what << ": " << double(n) / seconds * 1e-6 << " M records/s\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200'000;
+    std::vector<Body> bodies(n);
+    for(std::size_t i = 0; i < n; ++i) {
+        const double x = double(i);
+        bodies[i] = Body{stamp_t(x), length_vec(meters(7e6 + x), meters(-x), meters(0.5 * x)),
+                         velocity_vec(speed_t(7.5e3), speed_t(0.1 * x), speed_t(-3.0)), mass_t(1000 + x)};
+    }
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::ostringstream out;
+        for(const auto& b : bodies) out << b.t << ' ' << b.position << ' ' << b.velocity << ' ' << b.mass << '\n';
+        report("operator<<          ", n, seconds_since(start));
+
+        start = std::chrono::steady_clock::now();
+        std::istringstream in(out.str());
+        std::vector<Body> read(n);
+        for(auto& b : read) in >> b.t >> b.position >> b.velocity >> b.mass;
+        report("operator>>          ", n, seconds_since(start));
+    }
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::ostringstream out;
+        {
+            schema::TextWriter<body_schema_t> writer(out, body_schema);
+            writer.write(bodies);
+        }
+        report("schema text write   ", n, seconds_since(start));
+
+        start = std::chrono::steady_clock::now();
+        std::istringstream in(out.str());
+        schema::TextReader<body_schema_t> reader(in, body_schema);
+        std::vector<Body> read;
+        read.reserve(n);
+        reader.read(read, n);
+        report("schema text read    ", n, seconds_since(start));
+    }
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::ostringstream out;
+        schema::write_binary(out, body_schema, bodies);
+        report("schema binary write ", n, seconds_since(start));
+
+        start = std::chrono::steady_clock::now();
+        std::istringstream in(out.str());
+        std::vector<Body> read;
+        read.reserve(n);
+        schema::read_binary(in, body_schema, read, n);
+        report("schema binary read  ", n, seconds_since(start));
+    }
+}
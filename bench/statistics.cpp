@@ -0,0 +1,59 @@
+// One-pass running statistics compared to computing mean, variance, extrema and a
+// percentile with separate passes.
+// usage: bench_statistics [values]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "quantity/statistics.hpp"
+#include "quantity/predefined.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50'000'000;
+    std::mt19937 rng(1);
+    std::normal_distribution<double> d(7e6, 1e4);
+    std::vector<length_t> data(n);
+    for(auto& v : data) v = length_t(d(rng));
+
+    // multi pass, the way it is done by hand
+    auto start = std::chrono::steady_clock::now();
+    double sum = 0;
+    for(const auto& v : data) sum += v.value;
+    double mean = sum / n;
+    double m2 = 0;
+    for(const auto& v : data) m2 += (v.value - mean) * (v.value - mean);
+    auto minmax = std::minmax_element(data.begin(), data.end());
+    auto copy = data;
+    std::nth_element(copy.begin(), copy.begin() + n / 2, copy.end());
+    double multi = seconds_since(start);
+    std::cout << "multi pass:  " << multi << " s (mean " << mean << ", var " << m2 / n << ", min "
+              << minmax.first->value << ", median " << copy[n / 2].value << ")\n";
+
+    start = std::chrono::steady_clock::now();
+    auto stats = statistics::parallel_stats(data);
+    double one = seconds_since(start);
+    std::cout << "one pass:    " << one << " s (mean " << stats.mean().value << ", var " << stats.variance().value
+              << ", min " << stats.min().value << ") " << n * sizeof(double) / one / 1e9 << " GB/s\n";
+
+    start = std::chrono::steady_clock::now();
+    statistics::QuantileSketch<length_t> sketch(0.001);
+    sketch.add(data);
+    double sketched = seconds_since(start);
+    std::cout << "sketch:      " << sketched << " s (median " << sketch.quantile(0.5).value << ")\n";
+    std::cout << "speedup of one pass + sketch over multi pass: " << multi / (one + sketched) << "\n";
+}
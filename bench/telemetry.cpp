@@ -0,0 +1,137 @@
+// Throughput and latency of the shared memory telemetry ring buffer, compared to sending
+// the same values as text with operator<< and operator>>.
+// usage: bench_telemetry [records]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "quantity/telemetry.hpp"
+#include "quantity/io.hpp"
+#include "quantity/predefined.hpp"
+
+using namespace quantity;
+using namespace quantity::predefined;
+using namespace quantity::telemetry;
+using stamp_t = quantity::predefined::time_t;
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double now_seconds()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    Schema make_schema()
+    {
+        Schema schema;
+        schema.add<stamp_t>("stamp").add<length_vec>("position").add<velocity_vec>("velocity");
+        return schema;
+    }
+
+    void throughput(std::size_t n)
+    {
+        std::string name = "/quantity_bench_" + std::to_string(getpid());
+        Producer producer(name, make_schema(), 1 << 16);
+        auto position = producer.channel<length_vec>("position");
+        auto velocity = producer.channel<velocity_vec>("velocity");
+        Consumer consumer(name);
+
+        double checksum = 0;
+        std::thread reader([&] {
+            auto c_position = consumer.channel<length_vec>("position");
+            Sample sample;
+            std::uint64_t seen = 0;
+            while(seen + consumer.lost() < n) {
+                if(!consumer.poll(sample)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                checksum += sample[c_position].x.value;
+                ++seen;
+            }
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        for(std::size_t i = 0; i < n; ++i) {
+            producer.publish([&](WriteSample& s) {
+                s[position] = meters(make_vector(double(i), 1.0, 2.0));
+                s[velocity] = make_vector(3.0_m / 1.0_s, 4.0_m / 1.0_s, 5.0_m / 1.0_s);
+            });
+        }
+        reader.join();
+        double shm = seconds_since(start);
+        std::cout << "shared memory: " << n / shm / 1e6 << " M records/s, " << consumer.lost() << " lost ("
+                  << checksum << ")\n";
+
+        // the same records as text, on fewer records since parsing units is slow
+        const std::size_t text_n = std::min<std::size_t>(n, 10'000);
+        start = std::chrono::steady_clock::now();
+        std::stringstream stream;
+        for(std::size_t i = 0; i < text_n; ++i) {
+            stream << meters(make_vector(double(i), 1.0, 2.0)).x << " "
+                   << make_vector(3.0_m / 1.0_s, 4.0_m / 1.0_s, 5.0_m / 1.0_s).x << "\n";
+        }
+        length_t x;
+        speed_t v;
+        checksum = 0;
+        for(std::size_t i = 0; i < text_n; ++i) {
+            stream >> x >> v;
+            checksum += x.value;
+        }
+        double text = seconds_since(start);
+        std::cout << "text (one component each): " << text_n / text / 1e6 << " M records/s (" << checksum << ")\n";
+        std::cout << "speedup: " << (text / text_n) / (shm / n) << "\n";
+    }
+
+    void latency(std::size_t n)
+    {
+        std::string name = "/quantity_bench_latency_" + std::to_string(getpid());
+        Producer producer(name, make_schema(), 1024);
+        auto stamp = producer.channel<stamp_t>("stamp");
+        Consumer consumer(name);
+
+        std::vector<double> latencies;
+        latencies.reserve(n);
+        std::thread reader([&] {
+            auto c_stamp = consumer.channel<stamp_t>("stamp");
+            Sample sample;
+            while(latencies.size() + consumer.lost() < n) {
+                if(consumer.poll(sample)) {
+                    latencies.push_back(now_seconds() - sample[c_stamp].value);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        for(std::size_t i = 0; i < n; ++i) {
+            producer.publish([&](WriteSample& s) { s[stamp] = stamp_t(now_seconds()); });
+            // give the reader a chance to catch up, so that latency and not queueing is measured
+            auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(20);
+            while(std::chrono::steady_clock::now() < until) std::this_thread::yield();
+        }
+        reader.join();
+
+        std::sort(latencies.begin(), latencies.end());
+        if(latencies.empty()) return;
+        std::cout << "latency: median " << latencies[latencies.size() / 2] * 1e6 << " us, p99 "
+                  << latencies[latencies.size() * 99 / 100] * 1e6 << " us\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+    throughput(n);
+    latency(std::min<std::size_t>(n, 10'000));
+}
@@ -0,0 +1,238 @@
+#ifndef QUANTITY_ATOMIC_HPP
+#define QUANTITY_ATOMIC_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include "quantity.hpp"
+#include "threading.hpp"
+#include "vec.hpp"
+
+namespace quantity
+{
+    /*!
+     * \brief Atomic wrapper around a `Quantity<B, D>`.
+     * \details Mirrors the interface of `std::atomic`. `fetch_add` and `fetch_sub` use the
+     *          native instructions for integral `B` and a compare-exchange loop for
+     *          floating point `B`, where `std::atomic` has no arithmetic before C++20.
+     */
+    template<class B, class D>
+    class AtomicQuantity
+    {
+    public:
+        using value_type = Quantity<B, D>;
+
+        AtomicQuantity() noexcept : m_Value(B{}) { }
+        explicit AtomicQuantity(value_type value) noexcept : m_Value(value.value) { }
+
+        AtomicQuantity(const AtomicQuantity&) = delete;
+        AtomicQuantity& operator=(const AtomicQuantity&) = delete;
+
+        bool is_lock_free() const noexcept { return m_Value.is_lock_free(); }
+
+        value_type load(std::memory_order order = std::memory_order_seq_cst) const noexcept
+        {
+            return value_type(m_Value.load(order));
+        }
+
+        void store(value_type value, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            m_Value.store(value.value, order);
+        }
+
+        value_type exchange(value_type value, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            return value_type(m_Value.exchange(value.value, order));
+        }
+
+        bool compare_exchange_weak(value_type& expected, value_type desired,
+                                   std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            return m_Value.compare_exchange_weak(expected.value, desired.value, order);
+        }
+
+        bool compare_exchange_strong(value_type& expected, value_type desired,
+                                     std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            return m_Value.compare_exchange_strong(expected.value, desired.value, order);
+        }
+
+        /// atomically adds `delta` and returns the previous value.
+        value_type fetch_add(value_type delta, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            return value_type(add(delta.value, order, std::is_integral<B>{}));
+        }
+
+        /// atomically subtracts `delta` and returns the previous value.
+        value_type fetch_sub(value_type delta, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            return value_type(add(-delta.value, order, std::is_integral<B>{}));
+        }
+
+        value_type operator+=(value_type delta) noexcept { return fetch_add(delta) + delta; }
+        value_type operator-=(value_type delta) noexcept { return fetch_sub(delta) - delta; }
+
+        operator value_type() const noexcept { return load(); }
+
+    private:
+        B add(B delta, std::memory_order order, std::true_type /* integral */) noexcept
+        {
+            return m_Value.fetch_add(delta, order);
+        }
+
+        B add(B delta, std::memory_order order, std::false_type /* integral */) noexcept
+        {
+            B old = m_Value.load(std::memory_order_relaxed);
+            while(!m_Value.compare_exchange_weak(old, old + delta, order, std::memory_order_relaxed)) { }
+            return old;
+        }
+
+        std::atomic<B> m_Value;
+    };
+
+    template<class T>
+    class AtomicVec3;
+
+    /*!
+     * \brief Three atomic quantities that form a vector.
+     * \details Each component is updated atomically on its own, so concurrent `fetch_add`s
+     *          never lose contributions. A `load` that races with updates may however see
+     *          some components before and others after a concurrent update.
+     */
+    template<class B, class D>
+    class AtomicVec3<Quantity<B, D>>
+    {
+    public:
+        using value_type = Vec3<Quantity<B, D>>;
+
+        AtomicVec3() noexcept = default;
+        explicit AtomicVec3(const value_type& v) noexcept : x(v.x), y(v.y), z(v.z) { }
+
+        value_type load(std::memory_order order = std::memory_order_seq_cst) const noexcept
+        {
+            return make_vector(x.load(order), y.load(order), z.load(order));
+        }
+
+        void store(const value_type& v, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            x.store(v.x, order);
+            y.store(v.y, order);
+            z.store(v.z, order);
+        }
+
+        value_type fetch_add(const value_type& delta, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            return make_vector(x.fetch_add(delta.x, order), y.fetch_add(delta.y, order), z.fetch_add(delta.z, order));
+        }
+
+        value_type fetch_sub(const value_type& delta, std::memory_order order = std::memory_order_seq_cst) noexcept
+        {
+            return make_vector(x.fetch_sub(delta.x, order), y.fetch_sub(delta.y, order), z.fetch_sub(delta.z, order));
+        }
+
+        operator value_type() const noexcept { return load(); }
+
+        // the coordinates
+        AtomicQuantity<B, D> x;
+        AtomicQuantity<B, D> y;
+        AtomicQuantity<B, D> z;
+    };
+
+    namespace detail
+    {
+        template<class T>
+        struct atomic_of;
+
+        template<class B, class D>
+        struct atomic_of<Quantity<B, D>> { using type = AtomicQuantity<B, D>; };
+
+        template<class B, class D>
+        struct atomic_of<Vec3<Quantity<B, D>>> { using type = AtomicVec3<Quantity<B, D>>; };
+
+        /// small, dense index of the calling thread.
+        inline std::size_t thread_slot()
+        {
+            static std::atomic<std::size_t> next{0};
+            thread_local std::size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+            return slot;
+        }
+    }
+
+    /*!
+     * \brief Accumulator for a `Quantity` or `Vec3<Quantity>` that many threads add to.
+     * \details Every thread adds to its own shard, which lives on a separate cache line.
+     *          Threads thus never contend as long as there are at least as many shards as
+     *          threads; if there are more threads, shards are shared and the atomic update
+     *          keeps the result correct. `total` merges all shards when it is read.
+     */
+    template<class T>
+    class ShardedAccumulator
+    {
+        using atomic_t = typename detail::atomic_of<T>::type;
+
+        struct alignas(64) Shard
+        {
+            atomic_t value;
+        };
+
+    public:
+        using value_type = T;
+
+        /// \param shards Number of shards, 0 means one per hardware thread.
+        explicit ShardedAccumulator(std::size_t shards = 0) :
+                m_Count(shards == 0 ? threading::default_thread_count() : shards),
+                m_Storage(new unsigned char[(m_Count + 1) * sizeof(Shard)])
+        {
+            // C++14 `new` does not respect the over-alignment of Shard, so align by hand.
+            void* base = m_Storage.get();
+            std::size_t space = (m_Count + 1) * sizeof(Shard);
+            base = std::align(alignof(Shard), m_Count * sizeof(Shard), base, space);
+            m_Shards = static_cast<Shard*>(base);
+            for(std::size_t i = 0; i < m_Count; ++i) {
+                new (m_Shards + i) Shard{};
+            }
+        }
+
+        void add(const T& delta) noexcept
+        {
+            m_Shards[detail::thread_slot() % m_Count].value.fetch_add(delta, std::memory_order_relaxed);
+        }
+
+        ShardedAccumulator& operator+=(const T& delta) noexcept
+        {
+            add(delta);
+            return *this;
+        }
+
+        /// sum over all shards. Concurrent additions may or may not be included.
+        T total() const noexcept
+        {
+            T sum{};
+            for(std::size_t i = 0; i < m_Count; ++i) {
+                sum += m_Shards[i].value.load(std::memory_order_relaxed);
+            }
+            return sum;
+        }
+
+        /// sets all shards to zero. Must not race with `add`.
+        void reset() noexcept
+        {
+            for(std::size_t i = 0; i < m_Count; ++i) {
+                m_Shards[i].value.store(T{}, std::memory_order_relaxed);
+            }
+        }
+
+        std::size_t shard_count() const noexcept { return m_Count; }
+
+    private:
+        static_assert(std::is_trivially_destructible<Shard>::value, "shards are never destroyed explicitly");
+
+        std::size_t m_Count;
+        std::unique_ptr<unsigned char[]> m_Storage;
+        Shard* m_Shards;
+    };
+}
+
+#endif //QUANTITY_ATOMIC_HPP
@@ -0,0 +1,122 @@
+#ifndef QUANTITY_BROADPHASE_HPP
+#define QUANTITY_BROADPHASE_HPP
+
+#include <cstdint>
+#include <vector>
+#include "predefined.hpp"
+#include "span.hpp"
+
+namespace quantity
+{
+    namespace broadphase
+    {
+        /// A pair of body indices with `a < b`.
+        struct Pair
+        {
+            std::uint32_t a;
+            std::uint32_t b;
+        };
+
+        bool operator==(const Pair& x, const Pair& y);
+        bool operator<(const Pair& x, const Pair& y);
+
+        /// Checks whether the spheres around two bodies touch, i.e. `length(a-b) <= ra + rb`.
+        inline bool spheres_overlap(const predefined::length_vec& a, predefined::length_t ra,
+                                    const predefined::length_vec& b, predefined::length_t rb)
+        {
+            auto d = a - b;
+            auto r = ra + rb;
+            return dot(d, d) <= r * r;
+        }
+
+        /// Reference implementation that checks all pairs. Results are appended to `pairs`.
+        void brute_force(Span<const predefined::length_vec> positions, Span<const predefined::length_t> radii,
+                         std::vector<Pair>& pairs);
+
+        /*!
+         * \brief Loose uniform grid based on spatial hashing.
+         * \details Every body is stored in the grid cell that contains its center. Cells are at
+         *          least as large as the largest diameter plus twice the `margin`, so overlapping
+         *          bodies are always found in neighbouring cells. A body keeps its cell as long as
+         *          it has not moved more than `margin` outside of it, so `update` only needs to
+         *          rebuild the grid once some body has left its (loose) cell.
+         *
+         *          Cells are stored compactly by sorting bodies by the hash of their cell, so
+         *          memory use is proportional to the number of bodies, not the extent of the scene.
+         */
+        class UniformGrid
+        {
+        public:
+            /// \param margin How far a body may leave its cell before the grid is rebuilt.
+            /// \param cell_size Minimum cell size, the actual size may grow with the radii.
+            explicit UniformGrid(predefined::length_t margin = predefined::length_t{0},
+                                 predefined::length_t cell_size = predefined::length_t{0});
+
+            /// builds the grid from scratch.
+            void build(Span<const predefined::length_vec> positions, Span<const predefined::length_t> radii);
+
+            /// updates the grid for moved bodies, rebuilding only if necessary. Returns whether a rebuild happened.
+            bool update(Span<const predefined::length_vec> positions, Span<const predefined::length_t> radii);
+
+            /// appends all pairs of overlapping bodies to `pairs`.
+            void find_pairs(std::vector<Pair>& pairs) const;
+
+            predefined::length_t cell_size() const { return predefined::length_t{m_CellSize}; }
+
+        private:
+            struct Cell
+            {
+                std::int64_t i, j, k;
+            };
+
+            Cell cell_of(const predefined::length_vec& p) const;
+            std::size_t bucket_of(const Cell& c) const;
+            bool fits(const predefined::length_vec& p, const Cell& c) const;
+
+            double m_Margin;
+            double m_MinCellSize;
+            double m_CellSize = 0;
+            double m_MaxRadius = 0;
+            std::size_t m_BucketMask = 0;
+
+            std::vector<Cell> m_Cells;                  //!< assigned cell of each body
+            std::vector<std::uint32_t> m_BucketStart;   //!< CSR offsets into m_Sorted per hash bucket
+            std::vector<std::uint32_t> m_Sorted;        //!< body indices, grouped by bucket
+
+            // body data, copied so that `find_pairs` does not need the input spans
+            std::vector<double> m_X, m_Y, m_Z, m_R;
+        };
+
+        /*!
+         * \brief Sweep-and-prune along the axis with the largest spread.
+         * \details The sort order along the sweep axis is kept between calls, so for bodies
+         *          that move only a little `update` re-sorts with an insertion sort in
+         *          close to linear time.
+         */
+        class SweepAndPrune
+        {
+        public:
+            /// builds the sorted interval list from scratch.
+            void build(Span<const predefined::length_vec> positions, Span<const predefined::length_t> radii);
+
+            /// re-sorts the existing interval list for the new positions.
+            void update(Span<const predefined::length_vec> positions, Span<const predefined::length_t> radii);
+
+            /// appends all pairs of overlapping bodies to `pairs`.
+            void find_pairs(std::vector<Pair>& pairs) const;
+
+            /// index of the sweep axis, 0, 1 or 2 for x, y or z.
+            int axis() const { return m_Axis; }
+
+        private:
+            void load(Span<const predefined::length_vec> positions, Span<const predefined::length_t> radii);
+
+            int m_Axis = 0;
+            std::vector<std::uint32_t> m_Order;     //!< body indices sorted by lower bound on the sweep axis
+            std::vector<double> m_Lower, m_Upper;   //!< bounds on the sweep axis, by body
+            std::vector<double> m_X, m_Y, m_Z, m_R;
+        };
+    }
+}
+
+#endif //QUANTITY_BROADPHASE_HPP
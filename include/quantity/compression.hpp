@@ -0,0 +1,222 @@
+#ifndef QUANTITY_COMPRESSION_HPP
+#define QUANTITY_COMPRESSION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <boost/throw_exception.hpp>
+#include "predefined.hpp"
+#include "runtime.hpp"
+#include "span.hpp"
+#include "threading.hpp"
+#include "vec_array.hpp"
+
+namespace quantity
+{
+    /*!
+     * \brief Compressed storage of time series of quantities, in the style of Facebook's Gorilla.
+     * \details A series is cut into self-contained blocks. Timestamps are rounded to a fixed
+     *          resolution and stored as delta-of-delta integers, values are stored by XOR with
+     *          the previous value of the same component. Every component of a block is its own
+     *          bit stream, so a block decodes directly into structure-of-arrays buffers, and the
+     *          block header records the dimension of the values.
+     */
+    namespace compression
+    {
+        /// Contents of a block header.
+        struct BlockInfo
+        {
+            runtime::Dimension dimension;
+            std::uint32_t count;        //!< number of samples
+            std::uint32_t components;   //!< 1 for quantities, 3 for vectors
+            double resolution;          //!< time resolution in seconds
+            double first_time;          //!< in seconds
+            double last_time;           //!< in seconds
+        };
+
+        /// reads the header of an encoded block, throws std::runtime_error if it is not one.
+        BlockInfo read_block_info(Span<const unsigned char> block);
+
+        /// encodes `times` (in seconds) and the values of every component into a single block.
+        std::vector<unsigned char> encode_block(const runtime::Dimension& dimension, double resolution,
+                                                Span<const double> times,
+                                                const std::vector<Span<const double>>& components);
+
+        /// decodes a block into `times` and one buffer per component, each of `read_block_info(block).count` values.
+        void decode_block(Span<const unsigned char> block, Span<double> times,
+                          const std::vector<Span<double>>& components);
+
+        namespace detail
+        {
+            template<class T>
+            struct series_traits;
+
+            template<class D>
+            struct series_traits<Quantity<double, D>>
+            {
+                using dimension_t = D;
+                using values_type = std::vector<Quantity<double, D>>;
+                static constexpr std::size_t components = 1;
+
+                static double get(const Quantity<double, D>& v, std::size_t) { return v.value; }
+                static void resize(values_type& values, std::size_t n) { values.resize(n); }
+                static std::vector<Span<double>> spans(values_type& values, std::size_t offset, std::size_t count)
+                {
+                    return {Span<double>(reinterpret_cast<double*>(values.data()) + offset, count)};
+                }
+            };
+
+            template<class D>
+            struct series_traits<Vec3<Quantity<double, D>>>
+            {
+                using dimension_t = D;
+                using values_type = Vec3Array<Quantity<double, D>>;
+                static constexpr std::size_t components = 3;
+
+                static double get(const Vec3<Quantity<double, D>>& v, std::size_t c)
+                {
+                    return c == 0 ? v.x.value : (c == 1 ? v.y.value : v.z.value);
+                }
+                static void resize(values_type& values, std::size_t n) { values.resize(n); }
+                static std::vector<Span<double>> spans(values_type& values, std::size_t offset, std::size_t count)
+                {
+                    return {Span<double>(reinterpret_cast<double*>(values.x.data()) + offset, count),
+                            Span<double>(reinterpret_cast<double*>(values.y.data()) + offset, count),
+                            Span<double>(reinterpret_cast<double*>(values.z.data()) + offset, count)};
+                }
+            };
+        }
+
+        /*!
+         * \brief Compressed time series of `Quantity<double, D>` or `Vec3<Quantity<double, D>>`.
+         * \details Samples are appended with `push_back` and compressed whenever `block_size`
+         *          of them have been collected, or on `flush`. Blocks can be accessed and decoded
+         *          individually; `find_block` locates the block of a point in time. Vectors are
+         *          decoded into a `Vec3Array`.
+         */
+        template<class T>
+        class Series
+        {
+            using traits = detail::series_traits<T>;
+        public:
+            using value_type  = T;
+            using time_type   = predefined::time_t;
+            using values_type = typename traits::values_type;
+
+            /// timestamps are rounded to multiples of `resolution`.
+            explicit Series(time_type resolution = time_type(1e-6), std::size_t block_size = 1024) :
+                    m_Resolution(resolution.value), m_BlockSize(block_size)
+            {
+                if(!(m_Resolution > 0) || block_size == 0) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("Invalid resolution or block size"));
+                }
+            }
+
+            /// appends a sample. Timestamps have to be non-decreasing.
+            void push_back(time_type t, const T& value)
+            {
+                if(t.value < m_LastTime) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("Timestamps of a series have to be non-decreasing"));
+                }
+                m_LastTime = t.value;
+                m_PendingTimes.push_back(t.value);
+                for(std::size_t c = 0; c < traits::components; ++c) {
+                    m_Pending[c].push_back(traits::get(value, c));
+                }
+                if(m_PendingTimes.size() == m_BlockSize) flush();
+            }
+
+            /// compresses all pending samples into a block.
+            void flush()
+            {
+                if(m_PendingTimes.empty()) return;
+                std::vector<Span<const double>> components;
+                for(std::size_t c = 0; c < traits::components; ++c) components.emplace_back(m_Pending[c]);
+                add_block(encode_block(dimension(), m_Resolution, m_PendingTimes, components));
+                m_PendingTimes.clear();
+                for(auto& p : m_Pending) p.clear();
+            }
+
+            /// appends an encoded block, e.g. read from a file. Throws if dimension, components or time order differ.
+            void add_block(std::vector<unsigned char> block)
+            {
+                BlockInfo info = read_block_info(block);
+                if(!(info.dimension == dimension()) || info.components != traits::components) {
+                    BOOST_THROW_EXCEPTION(std::runtime_error("Block does not match the dimension of the series"));
+                }
+                if(!m_Info.empty() && info.first_time < m_Info.back().last_time) {
+                    BOOST_THROW_EXCEPTION(std::runtime_error("Block starts before the end of the series"));
+                }
+                m_LastTime = std::max(m_LastTime, info.last_time);
+                m_Size += info.count;
+                m_Bytes += block.size();
+                m_Info.push_back(info);
+                m_Blocks.push_back(std::move(block));
+            }
+
+            static runtime::Dimension dimension() { return runtime::to_dynamic(typename traits::dimension_t{}); }
+
+            /// number of samples in blocks, pending samples are not counted.
+            std::size_t size() const { return m_Size; }
+            std::size_t block_count() const { return m_Blocks.size(); }
+            std::size_t compressed_bytes() const { return m_Bytes; }
+
+            Span<const unsigned char> block(std::size_t i) const { return m_Blocks.at(i); }
+            const BlockInfo& block_info(std::size_t i) const { return m_Info.at(i); }
+
+            /// index of the last block that starts at or before `t`, 0 if `t` is before the first block.
+            std::size_t find_block(time_type t) const
+            {
+                auto it = std::upper_bound(m_Info.begin(), m_Info.end(), t.value,
+                                           [](double v, const BlockInfo& info) { return v < info.first_time; });
+                return it == m_Info.begin() ? 0 : std::size_t(it - m_Info.begin()) - 1;
+            }
+
+            /// decodes block `i`, replacing the contents of `times` and `values`.
+            void decode_block(std::size_t i, std::vector<time_type>& times, values_type& values) const
+            {
+                const BlockInfo& info = m_Info.at(i);
+                times.resize(info.count);
+                traits::resize(values, info.count);
+                decode_into(i, times, values, 0);
+            }
+
+            /// decodes all blocks, in parallel, replacing the contents of `times` and `values`.
+            void decode(std::vector<time_type>& times, values_type& values, unsigned threads = 0) const
+            {
+                times.resize(m_Size);
+                traits::resize(values, m_Size);
+                std::vector<std::size_t> offsets(m_Info.size() + 1, 0);
+                for(std::size_t i = 0; i < m_Info.size(); ++i) offsets[i + 1] = offsets[i] + m_Info[i].count;
+
+                threading::for_chunks(m_Blocks.size(), [&](std::size_t begin, std::size_t end) {
+                    for(std::size_t i = begin; i < end; ++i) decode_into(i, times, values, offsets[i]);
+                }, threads);
+            }
+
+        private:
+            void decode_into(std::size_t i, std::vector<time_type>& times, values_type& values,
+                             std::size_t offset) const
+            {
+                std::size_t n = m_Info[i].count;
+                Span<double> t(reinterpret_cast<double*>(times.data()) + offset, n);
+                compression::decode_block(m_Blocks[i], t, traits::spans(values, offset, n));
+            }
+
+            double m_Resolution;
+            std::size_t m_BlockSize;
+            double m_LastTime = -std::numeric_limits<double>::infinity();
+            std::vector<double> m_PendingTimes;
+            std::vector<double> m_Pending[traits::components];
+            std::vector<std::vector<unsigned char>> m_Blocks;
+            std::vector<BlockInfo> m_Info;
+            std::size_t m_Size = 0;
+            std::size_t m_Bytes = 0;
+        };
+    }
+}
+
+#endif //QUANTITY_COMPRESSION_HPP
@@ -0,0 +1,87 @@
+#ifndef QUANTITY_CONSTANTS_HPP
+#define QUANTITY_CONSTANTS_HPP
+
+#include "gravity.hpp"
+#include "kepler.hpp"
+#include "predefined.hpp"
+
+namespace quantity
+{
+    /*!
+     * \brief Physical constants and gravitational parameters as typed `constexpr` quantities.
+     * \details Everything here, and everything derived from it with the quantity arithmetic, is a
+     *          constant expression, so tables of derived values are computed by the compiler:
+     *
+     *              constexpr speed_t v = constants::escape_velocity(constants::gm::earth,
+     *                                                               constants::radius::earth);
+     */
+    namespace constants
+    {
+        using kepler::grav_param_t;
+
+        /// gravitational constant (CODATA 2018).
+        constexpr gravity::grav_const_t G = gravity::G;
+
+        /// speed of light in vacuum, exact.
+        constexpr predefined::speed_t c{299'792'458.0};
+
+        /// standard acceleration of gravity, exact.
+        constexpr predefined::accel_t g0{9.80665};
+
+        /// standard gravitational parameters GM (IAU 2015 nominal for the sun and earth, JPL DE440 otherwise).
+        namespace gm
+        {
+            constexpr grav_param_t sun{1.3271244e20};
+            constexpr grav_param_t mercury{2.2031868551e13};
+            constexpr grav_param_t venus{3.24858592e14};
+            constexpr grav_param_t earth{3.986004e14};
+            constexpr grav_param_t moon{4.9028001218467e12};
+            constexpr grav_param_t mars{4.282837362e13};
+            constexpr grav_param_t jupiter{1.266865349e17};
+            constexpr grav_param_t saturn{3.79311879e16};
+            constexpr grav_param_t uranus{5.7939399e15};
+            constexpr grav_param_t neptune{6.8365299e15};
+        }
+
+        /// mean equatorial radii (IAU 2015 nominal for the sun and earth).
+        namespace radius
+        {
+            constexpr predefined::length_t sun{6.957e8};
+            constexpr predefined::length_t mercury{2.4397e6};
+            constexpr predefined::length_t venus{6.0518e6};
+            constexpr predefined::length_t earth{6.3781e6};
+            constexpr predefined::length_t moon{1.7374e6};
+            constexpr predefined::length_t mars{3.3962e6};
+            constexpr predefined::length_t jupiter{7.1492e7};
+            constexpr predefined::length_t saturn{6.0268e7};
+            constexpr predefined::length_t uranus{2.5559e7};
+            constexpr predefined::length_t neptune{2.4764e7};
+        }
+
+        /// mass of a body with gravitational parameter `gm`.
+        constexpr predefined::mass_t mass(grav_param_t gm)
+        {
+            return gm / G;
+        }
+
+        /// speed needed to escape from distance `r` of a body with gravitational parameter `gm`.
+        constexpr predefined::speed_t escape_velocity(grav_param_t gm, predefined::length_t r)
+        {
+            return sqrt(2.0 * gm / r);
+        }
+
+        /// speed on a circular orbit of radius `r`.
+        constexpr predefined::speed_t circular_velocity(grav_param_t gm, predefined::length_t r)
+        {
+            return sqrt(gm / r);
+        }
+
+        /// gravitational acceleration at distance `r`.
+        constexpr predefined::accel_t gravitational_acceleration(grav_param_t gm, predefined::length_t r)
+        {
+            return gm / (r * r);
+        }
+    }
+}
+
+#endif //QUANTITY_CONSTANTS_HPP
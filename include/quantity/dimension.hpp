@@ -4,7 +4,10 @@
 #ifndef SPACEPHYS_DIMENSION_BASE_HPP
 #define SPACEPHYS_DIMENSION_BASE_HPP
 
+#include <cstdint>
 #include <ratio>
+#include <stdexcept>
+#include <type_traits>
 
 namespace quantity
 {
@@ -13,49 +16,121 @@ namespace quantity
         template<class T>
         struct DimBase { };
 
-        template<class LengthDim, class TimeDim, class MassDim>
-        struct Dimension_t : public DimBase<Dimension_t<LengthDim, TimeDim, MassDim>>
+        namespace encoding
+        {
+            /*!
+             * \brief Packing of the three rational exponents of a dimension into one integer.
+             * \details Each exponent takes `FIELD_BITS` bits: a signed numerator of `NUM_BITS` bits
+             *          followed by a positive denominator of `DEN_BITS` bits. Exponents are always
+             *          stored in lowest terms, so every dimension has exactly one code and equal
+             *          dimensions are the same type, no matter how they were computed.
+             */
+            constexpr unsigned NUM_BITS   = 12;
+            constexpr unsigned DEN_BITS   = 9;
+            constexpr unsigned FIELD_BITS = NUM_BITS + DEN_BITS;
+
+            constexpr std::intmax_t MAX_NUM = (std::intmax_t(1) << (NUM_BITS - 1)) - 1;
+            constexpr std::intmax_t MAX_DEN = (std::intmax_t(1) << DEN_BITS) - 1;
+
+            /// positions of the exponents in the code.
+            enum Field : unsigned { LENGTH = 0, TIME = 1, MASS = 2 };
+
+            constexpr std::intmax_t gcd(std::intmax_t a, std::intmax_t b)
+            {
+                return b == 0 ? (a < 0 ? -a : a) : gcd(b, a % b);
+            }
+
+            /// the field of the exponent num / den, which must not have a zero denominator.
+            constexpr std::uint64_t field(std::intmax_t num, std::intmax_t den)
+            {
+                return den < 0 ? field(-num, -den) :
+                       gcd(num, den) != 1 ? field(num / gcd(num, den), den / gcd(num, den)) :
+                       num > MAX_NUM || num < -MAX_NUM || den > MAX_DEN ?
+                           throw std::overflow_error("dimension exponent out of range") :
+                       (std::uint64_t(num) & ((std::uint64_t(1) << NUM_BITS) - 1)) << DEN_BITS | std::uint64_t(den);
+            }
+
+            constexpr std::intmax_t num(std::uint64_t code, Field f)
+            {
+                // sign extension of the numerator bits
+                return std::intmax_t((code >> (f * FIELD_BITS + DEN_BITS) & ((std::uint64_t(1) << NUM_BITS) - 1))
+                                     ^ (std::uint64_t(1) << (NUM_BITS - 1))) - (std::intmax_t(1) << (NUM_BITS - 1));
+            }
+
+            constexpr std::intmax_t den(std::uint64_t code, Field f)
+            {
+                return std::intmax_t(code >> (f * FIELD_BITS) & ((std::uint64_t(1) << DEN_BITS) - 1));
+            }
+
+            constexpr std::uint64_t pack(std::intmax_t ln, std::intmax_t ld, std::intmax_t tn, std::intmax_t td,
+                                         std::intmax_t mn, std::intmax_t md)
+            {
+                return field(ln, ld) << (LENGTH * FIELD_BITS) | field(tn, td) << (TIME * FIELD_BITS) |
+                       field(mn, md) << (MASS * FIELD_BITS);
+            }
+
+            /// the code of the product of two dimensions, i.e. the sum of the exponents.
+            constexpr std::uint64_t add(std::uint64_t a, std::uint64_t b, std::intmax_t sign = 1)
+            {
+                return pack(num(a, LENGTH) * den(b, LENGTH) + sign * num(b, LENGTH) * den(a, LENGTH),
+                            den(a, LENGTH) * den(b, LENGTH),
+                            num(a, TIME) * den(b, TIME) + sign * num(b, TIME) * den(a, TIME),
+                            den(a, TIME) * den(b, TIME),
+                            num(a, MASS) * den(b, MASS) + sign * num(b, MASS) * den(a, MASS),
+                            den(a, MASS) * den(b, MASS));
+            }
+
+            /// the code of a dimension raised to `p / q`.
+            constexpr std::uint64_t scale(std::uint64_t a, std::intmax_t p, std::intmax_t q)
+            {
+                return pack(num(a, LENGTH) * p, den(a, LENGTH) * q, num(a, TIME) * p, den(a, TIME) * q,
+                            num(a, MASS) * p, den(a, MASS) * q);
+            }
+        }
+
+        /*!
+         * \brief A physical dimension, identified by the packed exponents `Code`.
+         * \details Instead of this type directly, use `Dimension_t` to name a dimension and the
+         *          functions in `ops` to compute with them. The exponents are available as
+         *          `std::ratio`s for code that needs them.
+         */
+        template<std::uint64_t Code>
+        struct Dim : public DimBase<Dim<Code>>
         {
-            using length = LengthDim;
-            using time   = TimeDim;
-            using mass   = MassDim;
+            static constexpr std::uint64_t code = Code;
+            using length = std::ratio<encoding::num(Code, encoding::LENGTH), encoding::den(Code, encoding::LENGTH)>;
+            using time   = std::ratio<encoding::num(Code, encoding::TIME),   encoding::den(Code, encoding::TIME)>;
+            using mass   = std::ratio<encoding::num(Code, encoding::MASS),   encoding::den(Code, encoding::MASS)>;
         };
 
+        /// The dimension with the given exponents of length, time and mass as `std::ratio`s.
+        template<class LengthDim, class TimeDim, class MassDim>
+        using Dimension_t = Dim<encoding::pack(LengthDim::num, LengthDim::den, TimeDim::num, TimeDim::den,
+                                               MassDim::num, MassDim::den)>;
+
         namespace ops
         {
-            // calculation with dimensions
-            template<class D1, class D2, template<class, class> class OP>
-            struct OperationDim
-            {
-                using new_len  = OP<typename D1::length, typename D2::length>;
-                using new_time = OP<typename D1::time,   typename D2::time>;
-                using new_mass = OP<typename D1::mass,   typename D2::mass>;
-                using type  = Dimension_t<new_len, new_time, new_mass>;
-            };
-
             /// A dimension in which every component has value P/Q.
             template<std::intmax_t P, std::intmax_t Q>
-            using fill_t = Dimension_t<std::ratio<P, Q>, std::ratio<P, Q>, std::ratio<P, Q>>;
+            using fill_t = Dim<encoding::pack(P, Q, P, Q, P, Q)>;
 
             /// Product dimension of `A` and `B`.
             template<class A, class B>
-            using mul_t = typename OperationDim<A, B, std::ratio_add>::type;
+            using mul_t = Dim<encoding::add(A::code, B::code)>;
 
             /// Ratio dimension of `A` and `B`.
             template<class A, class B>
-            using div_t = typename OperationDim<A, B, std::ratio_subtract>::type;
+            using div_t = Dim<encoding::add(A::code, B::code, -1)>;
 
             /// power dimension `A**(P/Q)`.
             template<class A, std::intmax_t P, std::intmax_t Q>
-            using pow_t = typename OperationDim<A, fill_t<P, Q>, std::ratio_multiply>::type;
+            using pow_t = Dim<encoding::scale(A::code, P, Q)>;
 
-            /// check whether two dimensions are equal.
+            /// check whether two dimensions are equal. Dimensions are canonical, so this is `std::is_same`.
             template<class T, class U>
             constexpr bool dimensions_equal()
             {
-                return std::ratio_equal<typename T::length, typename U::length>::value &&
-                       std::ratio_equal<typename T::time, typename U::time>::value &&
-                       std::ratio_equal<typename T::mass, typename U::mass>::value;
+                return std::is_same<T, U>::value;
             }
         }
 
@@ -0,0 +1,290 @@
+#ifndef QUANTITY_DUAL_HPP
+#define QUANTITY_DUAL_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include "quantity.hpp"
+#include "vec.hpp"
+
+namespace quantity
+{
+    /*!
+     * \brief Dual number for forward mode automatic differentiation with `N` derivative lanes.
+     * \details Holds a value and its partial derivatives with respect to `N` independent inputs,
+     *          so a single evaluation of a function yields a full row of its Jacobian. All lanes
+     *          are updated together in fixed length loops, which the compiler turns into vector
+     *          instructions. Plain numbers convert implicitly to duals with zero derivatives,
+     *          which makes `Quantity<Dual<double, N>, D>` and `Vec3` of it work with the usual
+     *          operators; the derivative dimensions are tracked by `derivative`.
+     *
+     *          Comparisons only look at the value.
+     */
+    template<class T, std::size_t N>
+    struct Dual
+    {
+        static_assert(std::is_floating_point<T>::value, "dual numbers are built from floating point types");
+
+        constexpr Dual() : value(0), grad{} { }
+        constexpr Dual(const T& v) : value(v), grad{} { }
+        Dual(const T& v, const std::array<T, N>& g) : value(v), grad(g) { }
+
+        /// the input number `lane`, i.e. a value whose derivative is 1 in that lane.
+        static Dual variable(const T& v, std::size_t lane)
+        {
+            Dual d(v);
+            d.grad[lane] = T(1);
+            return d;
+        }
+
+        Dual& operator+=(const Dual& o)
+        {
+            value += o.value;
+            for(std::size_t i = 0; i < N; ++i) grad[i] += o.grad[i];
+            return *this;
+        }
+
+        Dual& operator-=(const Dual& o)
+        {
+            value -= o.value;
+            for(std::size_t i = 0; i < N; ++i) grad[i] -= o.grad[i];
+            return *this;
+        }
+
+        Dual& operator*=(const Dual& o)
+        {
+            for(std::size_t i = 0; i < N; ++i) grad[i] = grad[i] * o.value + value * o.grad[i];
+            value *= o.value;
+            return *this;
+        }
+
+        Dual& operator/=(const Dual& o)
+        {
+            const T inverse = T(1) / o.value;
+            value *= inverse;
+            for(std::size_t i = 0; i < N; ++i) grad[i] = (grad[i] - value * o.grad[i]) * inverse;
+            return *this;
+        }
+
+        Dual& operator+=(const T& s) { value += s; return *this; }
+        Dual& operator-=(const T& s) { value -= s; return *this; }
+
+        Dual& operator*=(const T& s)
+        {
+            value *= s;
+            for(std::size_t i = 0; i < N; ++i) grad[i] *= s;
+            return *this;
+        }
+
+        Dual& operator/=(const T& s) { return *this *= T(1) / s; }
+
+        T value;
+        std::array<T, N> grad;
+    };
+
+    namespace detail
+    {
+        /// applies the chain rule for a function with value `f` and derivative `df` at `x.value`.
+        template<class T, std::size_t N>
+        Dual<T, N> chain(const Dual<T, N>& x, const T& f, const T& df)
+        {
+            Dual<T, N> r(f);
+            for(std::size_t i = 0; i < N; ++i) r.grad[i] = df * x.grad[i];
+            return r;
+        }
+    }
+
+    // arithmetic
+    template<class T, std::size_t N>
+    Dual<T, N> operator-(const Dual<T, N>& a)
+    {
+        return detail::chain(a, -a.value, T(-1));
+    }
+
+#define QUANTITY_DUAL_OPERATOR(OP)                                                              \
+    template<class T, std::size_t N>                                                            \
+    Dual<T, N> operator OP(Dual<T, N> a, const Dual<T, N>& b) { return a OP##= b; }             \
+    template<class T, std::size_t N>                                                            \
+    Dual<T, N> operator OP(Dual<T, N> a, const detail::non_deduced_t<T>& b) { return a OP##= b; } \
+    template<class T, std::size_t N>                                                            \
+    Dual<T, N> operator OP(const detail::non_deduced_t<T>& a, const Dual<T, N>& b) { return Dual<T, N>(a) OP##= b; }
+
+    QUANTITY_DUAL_OPERATOR(+)
+    QUANTITY_DUAL_OPERATOR(-)
+    QUANTITY_DUAL_OPERATOR(*)
+    QUANTITY_DUAL_OPERATOR(/)
+#undef QUANTITY_DUAL_OPERATOR
+
+    // comparisons
+#define QUANTITY_DUAL_COMPARISON(OP)                                                            \
+    template<class T, std::size_t N>                                                            \
+    constexpr bool operator OP(const Dual<T, N>& a, const Dual<T, N>& b) { return a.value OP b.value; } \
+    template<class T, std::size_t N>                                                            \
+    constexpr bool operator OP(const Dual<T, N>& a, const detail::non_deduced_t<T>& b) { return a.value OP b; } \
+    template<class T, std::size_t N>                                                            \
+    constexpr bool operator OP(const detail::non_deduced_t<T>& a, const Dual<T, N>& b) { return a OP b.value; }
+
+    QUANTITY_DUAL_COMPARISON(<)
+    QUANTITY_DUAL_COMPARISON(<=)
+    QUANTITY_DUAL_COMPARISON(>)
+    QUANTITY_DUAL_COMPARISON(>=)
+    QUANTITY_DUAL_COMPARISON(==)
+    QUANTITY_DUAL_COMPARISON(!=)
+#undef QUANTITY_DUAL_COMPARISON
+
+    // math functions, picked up by `quantity::sqrt` and `quantity::abs` through argument dependent lookup
+    template<class T, std::size_t N>
+    Dual<T, N> sqrt(const Dual<T, N>& x)
+    {
+        const T r = std::sqrt(x.value);
+        return detail::chain(x, r, T(0.5) / r);
+    }
+
+    template<class T, std::size_t N>
+    Dual<T, N> abs(const Dual<T, N>& x)
+    {
+        return x.value < 0 ? -x : x;
+    }
+
+    template<class T, std::size_t N>
+    Dual<T, N> exp(const Dual<T, N>& x)
+    {
+        const T e = std::exp(x.value);
+        return detail::chain(x, e, e);
+    }
+
+    template<class T, std::size_t N>
+    Dual<T, N> log(const Dual<T, N>& x)
+    {
+        return detail::chain(x, std::log(x.value), T(1) / x.value);
+    }
+
+    template<class T, std::size_t N>
+    Dual<T, N> sin(const Dual<T, N>& x)
+    {
+        return detail::chain(x, std::sin(x.value), std::cos(x.value));
+    }
+
+    template<class T, std::size_t N>
+    Dual<T, N> cos(const Dual<T, N>& x)
+    {
+        return detail::chain(x, std::cos(x.value), -std::sin(x.value));
+    }
+
+    template<class T, std::size_t N>
+    Dual<T, N> pow(const Dual<T, N>& x, const detail::non_deduced_t<T>& p)
+    {
+        const T f = std::pow(x.value, p);
+        return detail::chain(x, f, p * std::pow(x.value, p - T(1)));
+    }
+
+    template<class T, std::size_t N>
+    Dual<T, N> atan2(const Dual<T, N>& y, const Dual<T, N>& x)
+    {
+        const T inverse = T(1) / (x.value * x.value + y.value * y.value);
+        Dual<T, N> r(std::atan2(y.value, x.value));
+        for(std::size_t i = 0; i < N; ++i) r.grad[i] = (x.value * y.grad[i] - y.value * x.grad[i]) * inverse;
+        return r;
+    }
+
+    // quantities with plain values act as constants in expressions with dual quantities
+    template<class T, std::size_t N, class U, class V>
+    Quantity<Dual<T, N>, dimensions::ops::mul_t<U, V>> operator*(const Quantity<Dual<T, N>, U>& a, const Quantity<T, V>& b)
+    {
+        return Quantity<Dual<T, N>, dimensions::ops::mul_t<U, V>>(a.value * b.value);
+    }
+
+    template<class T, std::size_t N, class U, class V>
+    Quantity<Dual<T, N>, dimensions::ops::mul_t<U, V>> operator*(const Quantity<T, U>& a, const Quantity<Dual<T, N>, V>& b)
+    {
+        return Quantity<Dual<T, N>, dimensions::ops::mul_t<U, V>>(a.value * b.value);
+    }
+
+    template<class T, std::size_t N, class U, class V>
+    Quantity<Dual<T, N>, dimensions::ops::div_t<U, V>> operator/(const Quantity<Dual<T, N>, U>& a, const Quantity<T, V>& b)
+    {
+        return Quantity<Dual<T, N>, dimensions::ops::div_t<U, V>>(a.value / b.value);
+    }
+
+    template<class T, std::size_t N, class U, class V>
+    Quantity<Dual<T, N>, dimensions::ops::div_t<U, V>> operator/(const Quantity<T, U>& a, const Quantity<Dual<T, N>, V>& b)
+    {
+        return Quantity<Dual<T, N>, dimensions::ops::div_t<U, V>>(a.value / b.value);
+    }
+
+    template<class T, std::size_t N, class U>
+    Quantity<Dual<T, N>, U> operator+(const Quantity<Dual<T, N>, U>& a, const Quantity<T, U>& b)
+    {
+        return Quantity<Dual<T, N>, U>(a.value + b.value);
+    }
+
+    template<class T, std::size_t N, class U>
+    Quantity<Dual<T, N>, U> operator+(const Quantity<T, U>& a, const Quantity<Dual<T, N>, U>& b)
+    {
+        return Quantity<Dual<T, N>, U>(a.value + b.value);
+    }
+
+    template<class T, std::size_t N, class U>
+    Quantity<Dual<T, N>, U> operator-(const Quantity<Dual<T, N>, U>& a, const Quantity<T, U>& b)
+    {
+        return Quantity<Dual<T, N>, U>(a.value - b.value);
+    }
+
+    template<class T, std::size_t N, class U>
+    Quantity<Dual<T, N>, U> operator-(const Quantity<T, U>& a, const Quantity<Dual<T, N>, U>& b)
+    {
+        return Quantity<Dual<T, N>, U>(a.value - b.value);
+    }
+
+    // quantity interface
+    /// the quantity `x` as input `lane` of a differentiation with `N` lanes.
+    template<std::size_t N, class T, class D>
+    Quantity<Dual<T, N>, D> variable(const Quantity<T, D>& x, std::size_t lane)
+    {
+        return Quantity<Dual<T, N>, D>(Dual<T, N>::variable(x.value, lane));
+    }
+
+    /// seeds the components of `x` as the inputs `first_lane` to `first_lane + 2`.
+    template<std::size_t N, class T, class D>
+    Vec3<Quantity<Dual<T, N>, D>> variable(const Vec3<Quantity<T, D>>& x, std::size_t first_lane)
+    {
+        return make_vector(variable<N>(x.x, first_lane), variable<N>(x.y, first_lane + 1),
+                           variable<N>(x.z, first_lane + 2));
+    }
+
+    /// the value of `q`, without derivatives.
+    template<class T, std::size_t N, class D>
+    Quantity<T, D> primal(const Quantity<Dual<T, N>, D>& q)
+    {
+        return Quantity<T, D>(q.value.value);
+    }
+
+    template<class T, std::size_t N, class D>
+    Vec3<Quantity<T, D>> primal(const Vec3<Quantity<Dual<T, N>, D>>& v)
+    {
+        return make_vector(primal(v.x), primal(v.y), primal(v.z));
+    }
+
+    /*!
+     * \brief Partial derivative of `q` with respect to input `lane`.
+     * \tparam Input Quantity type of the input that was seeded into `lane`, which determines the
+     *               dimension of the result, e.g. the derivative of a `length_t` with respect to a
+     *               `time_t` input is a `speed_t`.
+     */
+    template<class Input, class T, std::size_t N, class D>
+    Quantity<T, dimensions::ops::div_t<D, typename Input::dimension_t>>
+    derivative(const Quantity<Dual<T, N>, D>& q, std::size_t lane)
+    {
+        return Quantity<T, dimensions::ops::div_t<D, typename Input::dimension_t>>(q.value.grad[lane]);
+    }
+
+    template<class Input, class T, std::size_t N, class D>
+    auto derivative(const Vec3<Quantity<Dual<T, N>, D>>& v, std::size_t lane)
+    {
+        return make_vector(derivative<Input>(v.x, lane), derivative<Input>(v.y, lane),
+                           derivative<Input>(v.z, lane));
+    }
+}
+
+#endif //QUANTITY_DUAL_HPP
@@ -0,0 +1,96 @@
+#ifndef QUANTITY_EXPRESSION_HPP
+#define QUANTITY_EXPRESSION_HPP
+
+#include <string>
+#include <vector>
+#include "runtime.hpp"
+#include "span.hpp"
+
+namespace quantity
+{
+    namespace runtime
+    {
+        /// A named input of an expression together with the unit its values are given in.
+        struct Variable
+        {
+            std::string name;
+            Dimension unit;     //!< e.g. the result of `parse_dim("km/s")`
+        };
+
+        /*!
+         * \brief A formula over unit-tagged columns, compiled once and evaluated in bulk.
+         * \details The formula is parsed and its dimensions are checked a single time in
+         *          `compile`, using the units of the variables. Unit prefixes of the inputs
+         *          (and of the requested output unit) are folded into the program, which is
+         *          a small stack based bytecode with constant folding. Evaluation runs the
+         *          program over blocks of rows, every instruction being one tight loop over
+         *          contiguous buffers, and distributes the blocks over threads.
+         *
+         *          Supported syntax: numbers, variables, `+ - * /`, unary minus, parentheses,
+         *          `x^n` with an integer `n` or a rational `x^(p/q)`, and the functions
+         *          `sqrt(x)` and `abs(x)`.
+         */
+        class Expression
+        {
+        public:
+            /*!
+             * \brief Parses and type checks `formula`.
+             * \param variables Names and units of the columns, in the order they are passed to `evaluate`.
+             * \param output_unit Unit of the results. If empty, results are in SI base units.
+             * \throw std::runtime_error on syntax errors, unknown variables and dimension mismatches.
+             */
+            static Expression compile(const std::string& formula, const std::vector<Variable>& variables,
+                                      const std::string& output_unit = "");
+
+            /// dimension of the result.
+            const Dimension& dimension() const { return m_Dimension; }
+
+            /// number of bytecode instructions, after constant folding.
+            std::size_t instruction_count() const { return m_Program.size(); }
+
+            /*!
+             * \brief Evaluates the expression for every row.
+             * \param columns One column per variable of `compile`, each with `out.size()` values.
+             */
+            void evaluate(const std::vector<Span<const double>>& columns, Span<double> out,
+                          unsigned threads = 0) const;
+
+            /// evaluates the expression for a single row of values.
+            double evaluate(const std::vector<double>& row) const;
+
+            enum class OpCode
+            {
+                LOAD,       //!< push column `index`, scaled by `value`
+                CONSTANT,   //!< push `value`
+                ADD,
+                SUB,
+                MUL,
+                DIV,
+                NEG,
+                POWI,       //!< integer power `index`
+                POW,        //!< real power `value`
+                SQRT,
+                ABS,
+                SCALE       //!< multiply by `value`
+            };
+
+            struct Instruction
+            {
+                OpCode op;
+                int index;
+                double value;
+            };
+
+        private:
+            void run_block(const std::vector<Span<const double>>& columns, std::size_t begin, std::size_t count,
+                           double* stack, double* out) const;
+
+            std::vector<Instruction> m_Program;
+            std::size_t m_StackDepth = 0;
+            std::size_t m_VariableCount = 0;
+            Dimension m_Dimension;
+        };
+    }
+}
+
+#endif //QUANTITY_EXPRESSION_HPP
@@ -0,0 +1,617 @@
+#ifndef QUANTITY_FIT_HPP
+#define QUANTITY_FIT_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <boost/throw_exception.hpp>
+#include "dual.hpp"
+#include "quantity.hpp"
+#include "span.hpp"
+#include "threading.hpp"
+#include "vec.hpp"
+#include "vec_array.hpp"
+
+namespace quantity
+{
+    /*!
+     * \brief Least squares fits of many small problems at once, e.g. one per object track.
+     * \details The samples of all tracks are stored back to back in `Tracks`, in one column for
+     *          the arguments and one (or three, for vectors) for the values. Tracks are fitted
+     *          independently on parallel threads.
+     *
+     *          `fit_polynomials<N>` fits `y(x) = sum c_k (x - x0)^k` by linear least squares. The
+     *          coefficients are typed, `c_k` has the dimension `div_t<DY, pow_t<DX, k, 1>>`, so
+     *          for a position over time `c_1` is a velocity and `c_2` half an acceleration.
+     *
+     *          `levenberg_marquardt` fits a nonlinear model with parameters of any dimensions. The
+     *          model is called with the parameters as `Quantity` of `Dual` numbers, which gives
+     *          the Jacobian in the same evaluation as the residuals, and with plain quantities to
+     *          test a step:
+     *
+     *              auto model = [](time_t t, auto amplitude, auto omega, auto phase) {
+     *                  using std::cos;
+     *                  return amplitude * cos((omega * t + phase).value);
+     *              };
+     */
+    namespace fit
+    {
+        namespace detail
+        {
+            template<class T>
+            struct column { using type = std::vector<T>; };
+
+            template<class T>
+            struct column<Vec3<T>> { using type = Vec3Array<T>; };
+
+            template<class T>
+            using column_t = typename column<T>::type;
+
+            /// access to the raw components of values that are fitted, a `Quantity` or `Vec3<Quantity>`.
+            template<class T>
+            struct value_traits;
+
+            template<class B, class D>
+            struct value_traits<Quantity<B, D>>
+            {
+                using base_t = B;
+                using dimension_t = D;
+                static constexpr std::size_t components = 1;
+
+                template<class E>
+                using with_t = Quantity<B, E>;
+
+                static B get(const std::vector<Quantity<B, D>>& column, std::size_t i, std::size_t)
+                {
+                    return column[i].value;
+                }
+
+                template<class E>
+                static Quantity<B, E> make(const B* values)
+                {
+                    return Quantity<B, E>(values[0]);
+                }
+
+                /// the components of a model result, whose base type may be a `Dual`.
+                template<class T>
+                static void raw(const Quantity<T, D>& q, T* out)
+                {
+                    out[0] = q.value;
+                }
+            };
+
+            template<class B, class D>
+            struct value_traits<Vec3<Quantity<B, D>>>
+            {
+                using base_t = B;
+                using dimension_t = D;
+                static constexpr std::size_t components = 3;
+
+                template<class E>
+                using with_t = Vec3<Quantity<B, E>>;
+
+                static B get(const Vec3Array<Quantity<B, D>>& column, std::size_t i, std::size_t c)
+                {
+                    return c == 0 ? column.x[i].value : (c == 1 ? column.y[i].value : column.z[i].value);
+                }
+
+                template<class E>
+                static Vec3<Quantity<B, E>> make(const B* values)
+                {
+                    return Vec3<Quantity<B, E>>(Quantity<B, E>(values[0]), Quantity<B, E>(values[1]),
+                                                Quantity<B, E>(values[2]));
+                }
+
+                template<class T>
+                static void raw(const Vec3<Quantity<T, D>>& v, T* out)
+                {
+                    out[0] = v.x.value;
+                    out[1] = v.y.value;
+                    out[2] = v.z.value;
+                }
+            };
+
+            /// factors the symmetric positive definite `a` into `L L^T`, stored in its lower triangle.
+            /// \return false if `a` is singular to working precision.
+            template<std::size_t M, class B>
+            bool cholesky(B (&a)[M][M])
+            {
+                for(std::size_t j = 0; j < M; ++j) {
+                    const B diagonal = a[j][j];
+                    B d = diagonal;
+                    for(std::size_t k = 0; k < j; ++k) d -= a[j][k] * a[j][k];
+                    if(!(d > diagonal * std::numeric_limits<B>::epsilon() * B(M))) return false;
+                    d = std::sqrt(d);
+                    a[j][j] = d;
+                    for(std::size_t i = j + 1; i < M; ++i) {
+                        B v = a[i][j];
+                        for(std::size_t k = 0; k < j; ++k) v -= a[i][k] * a[j][k];
+                        a[i][j] = v / d;
+                    }
+                }
+                return true;
+            }
+
+            /// solves `L L^T x = b` in place, with `l` from `cholesky`.
+            template<std::size_t M, class B>
+            void cholesky_solve(const B (&l)[M][M], B (&b)[M])
+            {
+                for(std::size_t i = 0; i < M; ++i) {
+                    for(std::size_t k = 0; k < i; ++k) b[i] -= l[i][k] * b[k];
+                    b[i] /= l[i][i];
+                }
+                for(std::size_t i = M; i-- > 0;) {
+                    for(std::size_t k = i + 1; k < M; ++k) b[i] -= l[k][i] * b[k];
+                    b[i] /= l[i][i];
+                }
+            }
+        }
+
+        /// The samples of many tracks, stored column wise and back to back.
+        template<class X, class Y>
+        class Tracks
+        {
+        public:
+            using x_type = X;
+            using y_type = Y;
+
+            Tracks() : m_Offsets{0} { }
+
+            /// appends a track. \throw std::invalid_argument if `x` and `y` differ in size.
+            void add(Span<const X> x, Span<const Y> y)
+            {
+                if(x.size() != y.size()) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("A track needs the same number of x and y values"));
+                }
+                for(std::size_t i = 0; i < x.size(); ++i) {
+                    m_X.push_back(x[i]);
+                    m_Y.push_back(y[i]);
+                }
+                m_Offsets.push_back(m_X.size());
+            }
+
+            void reserve(std::size_t tracks, std::size_t samples)
+            {
+                m_Offsets.reserve(tracks + 1);
+                m_X.reserve(samples);
+                m_Y.reserve(samples);
+            }
+
+            void clear()
+            {
+                m_X.clear();
+                m_Y.resize(0);
+                m_Offsets.assign(1, 0);
+            }
+
+            /// number of tracks.
+            std::size_t size() const { return m_Offsets.size() - 1; }
+
+            /// the samples of `track` are `[begin(track), end(track))` of the columns.
+            std::size_t begin(std::size_t track) const { return m_Offsets[track]; }
+            std::size_t end(std::size_t track) const { return m_Offsets[track + 1]; }
+
+            const std::vector<X>& x() const { return m_X; }
+            const detail::column_t<Y>& y() const { return m_Y; }
+
+        private:
+            std::vector<X> m_X;
+            detail::column_t<Y> m_Y;
+            std::vector<std::size_t> m_Offsets;
+        };
+
+        /// `y(x) = sum c_k (x - origin)^k` for `k = 0 ... N`, with typed coefficients.
+        template<std::size_t N, class X, class Y>
+        class Polynomial
+        {
+            using traits = detail::value_traits<Y>;
+            using B = typename traits::base_t;
+            static constexpr std::size_t C = traits::components;
+
+        public:
+            using x_type = X;
+            using y_type = Y;
+
+            /// type of the coefficient of `(x - origin)^K`.
+            template<std::size_t K>
+            using coefficient_t = typename traits::template with_t<
+                    dimensions::ops::div_t<typename traits::dimension_t,
+                                           dimensions::ops::pow_t<typename X::dimension_t, std::intmax_t(K), 1>>>;
+
+            Polynomial() : m_Origin(), m_Coefficients{} { }
+
+            /// from raw coefficients in coherent SI units, `coefficients[k][component]`.
+            Polynomial(X origin, const B (&coefficients)[N + 1][C]) : m_Origin(origin)
+            {
+                for(std::size_t k = 0; k <= N; ++k) {
+                    for(std::size_t c = 0; c < C; ++c) m_Coefficients[k][c] = coefficients[k][c];
+                }
+            }
+
+            X origin() const { return m_Origin; }
+
+            template<std::size_t K>
+            coefficient_t<K> coefficient() const
+            {
+                static_assert(K <= N, "coefficient index exceeds the degree");
+                return traits::template make<typename detail::value_traits<coefficient_t<K>>::dimension_t>(
+                        m_Coefficients[K]);
+            }
+
+            Y operator()(X x) const
+            {
+                const B d = B(x.value - m_Origin.value);
+                B v[C];
+                for(std::size_t c = 0; c < C; ++c) v[c] = m_Coefficients[N][c];
+                for(std::size_t k = N; k-- > 0;) {
+                    for(std::size_t c = 0; c < C; ++c) v[c] = v[c] * d + m_Coefficients[k][c];
+                }
+                return traits::template make<typename traits::dimension_t>(v);
+            }
+
+        private:
+            X m_Origin;
+            B m_Coefficients[N + 1][C];
+        };
+
+        /// the result of fitting a polynomial to one track.
+        template<std::size_t N, class X, class Y>
+        struct PolynomialFit
+        {
+            Polynomial<N, X, Y> polynomial;
+
+            /// root mean square of the residuals; the length of the residual vectors for `Vec3`.
+            Quantity<typename detail::value_traits<Y>::base_t, typename detail::value_traits<Y>::dimension_t> rms;
+
+            std::size_t samples = 0;
+
+            /// false if the track has fewer than `N + 1` distinct arguments.
+            bool ok = false;
+        };
+
+        /*!
+         * \brief Fits a polynomial of degree `N` to one track.
+         * \details The arguments are shifted to the middle of their range and scaled to `[-1, 1]`
+         *          before the normal equations are built, which keeps them well conditioned, and
+         *          the origin of the result is that middle. The power sums are accumulated in four
+         *          interleaved lanes, which breaks the dependency between consecutive samples and
+         *          lets the compiler vectorize the loop.
+         */
+        template<std::size_t N, class X, class Y>
+        PolynomialFit<N, X, Y> fit_polynomial(const Tracks<X, Y>& tracks, std::size_t track)
+        {
+            using traits = detail::value_traits<Y>;
+            using B = typename traits::base_t;
+            constexpr std::size_t C = traits::components;
+            constexpr std::size_t M = N + 1;
+            constexpr std::size_t POWERS = 2 * N + 1;
+            constexpr std::size_t LANES = 4;
+
+            PolynomialFit<N, X, Y> result;
+            const std::size_t begin = tracks.begin(track);
+            const std::size_t end = tracks.end(track);
+            result.samples = end - begin;
+            if(result.samples < M) return result;
+
+            const auto& xs = tracks.x();
+            const auto& ys = tracks.y();
+            B lo = B(xs[begin].value), hi = lo;
+            for(std::size_t i = begin; i < end; ++i) {
+                lo = std::min(lo, B(xs[i].value));
+                hi = std::max(hi, B(xs[i].value));
+            }
+            const B origin = (lo + hi) / 2;
+            const B scale = hi > lo ? B(2) / (hi - lo) : B(1);
+
+            B s[POWERS][LANES] = {};
+            B t[M][C][LANES] = {};
+            auto accumulate = [&](std::size_t i, std::size_t lane) {
+                const B u = (B(xs[i].value) - origin) * scale;
+                B p[POWERS];
+                p[0] = 1;
+                for(std::size_t k = 1; k < POWERS; ++k) p[k] = p[k - 1] * u;
+                for(std::size_t k = 0; k < POWERS; ++k) s[k][lane] += p[k];
+                for(std::size_t c = 0; c < C; ++c) {
+                    const B y = traits::get(ys, i, c);
+                    for(std::size_t k = 0; k < M; ++k) t[k][c][lane] += p[k] * y;
+                }
+            };
+            std::size_t i = begin;
+            for(; i + LANES <= end; i += LANES) {
+                for(std::size_t lane = 0; lane < LANES; ++lane) accumulate(i + lane, lane);
+            }
+            for(; i < end; ++i) accumulate(i, 0);
+
+            B normal[M][M];
+            for(std::size_t j = 0; j < M; ++j) {
+                for(std::size_t k = 0; k < M; ++k) {
+                    B sum = 0;
+                    for(std::size_t lane = 0; lane < LANES; ++lane) sum += s[j + k][lane];
+                    normal[j][k] = sum;
+                }
+            }
+            if(!detail::cholesky(normal)) return result;
+
+            // coefficients in the scaled argument u
+            B a[C][M];
+            for(std::size_t c = 0; c < C; ++c) {
+                for(std::size_t k = 0; k < M; ++k) {
+                    B sum = 0;
+                    for(std::size_t lane = 0; lane < LANES; ++lane) sum += t[k][c][lane];
+                    a[c][k] = sum;
+                }
+                detail::cholesky_solve(normal, a[c]);
+            }
+
+            B squares = 0;
+            for(std::size_t j = begin; j < end; ++j) {
+                const B u = (B(xs[j].value) - origin) * scale;
+                for(std::size_t c = 0; c < C; ++c) {
+                    B v = a[c][N];
+                    for(std::size_t k = N; k-- > 0;) v = v * u + a[c][k];
+                    const B r = traits::get(ys, j, c) - v;
+                    squares += r * r;
+                }
+            }
+
+            B coefficients[M][C];
+            B power = 1;
+            for(std::size_t k = 0; k < M; ++k, power *= scale) {
+                for(std::size_t c = 0; c < C; ++c) coefficients[k][c] = a[c][k] * power;
+            }
+            result.polynomial = Polynomial<N, X, Y>(X(origin), coefficients);
+            result.rms.value = std::sqrt(squares / B(result.samples));
+            result.ok = true;
+            return result;
+        }
+
+        /// fits a polynomial of degree `N` to every track, on `threads` threads (0 for the default).
+        template<std::size_t N, class X, class Y>
+        std::vector<PolynomialFit<N, X, Y>> fit_polynomials(const Tracks<X, Y>& tracks, unsigned threads = 0)
+        {
+            std::vector<PolynomialFit<N, X, Y>> results(tracks.size());
+            threading::for_chunks(tracks.size(), [&](std::size_t begin, std::size_t end) {
+                for(std::size_t i = begin; i < end; ++i) results[i] = fit_polynomial<N>(tracks, i);
+            }, threads, 64);
+            return results;
+        }
+
+        struct Options
+        {
+            std::size_t max_iterations = 100;
+
+            /// stop once a step lowers the sum of squares by less than this fraction.
+            double tolerance = 1e-12;
+
+            /// initial damping, relative to the diagonal of `J^T J`.
+            double initial_lambda = 1e-3;
+        };
+
+        /// the result of a nonlinear fit to one track.
+        template<class Y, class... Ps>
+        struct NonlinearFit
+        {
+            std::tuple<Ps...> parameters;
+
+            /// standard errors of the parameters, from the covariance `s^2 (J^T J)^-1` at the
+            /// solution; NaN without redundant samples.
+            std::tuple<Ps...> sigma;
+
+            Quantity<typename detail::value_traits<Y>::base_t, typename detail::value_traits<Y>::dimension_t> rms;
+
+            std::size_t samples = 0;
+            std::size_t iterations = 0;
+
+            /// false if the iteration limit was reached or `J^T J` was singular.
+            bool converged = false;
+        };
+
+        namespace detail
+        {
+            template<class Model, class X, class Y, class... Ps>
+            class LevenbergMarquardt
+            {
+                using traits = value_traits<Y>;
+                static constexpr std::size_t P = sizeof...(Ps);
+                static constexpr std::size_t C = traits::components;
+                using dual_t = Dual<double, P>;
+                using result_t = NonlinearFit<Y, Ps...>;
+                static_assert(P > 0, "a model needs parameters");
+
+            public:
+                LevenbergMarquardt(const Model& model, const Tracks<X, Y>& tracks, const Options& options) :
+                        m_Model(model), m_Tracks(tracks), m_Options(options)
+                {
+                }
+
+                result_t solve(std::size_t track, const std::tuple<Ps...>& initial) const
+                {
+                    result_t result;
+                    const std::size_t begin = m_Tracks.begin(track);
+                    const std::size_t end = m_Tracks.end(track);
+                    result.samples = end - begin;
+
+                    double p[P];
+                    unpack(initial, p, std::index_sequence_for<Ps...>{});
+                    double jtj[P][P], jtr[P];
+                    double cost = linearize(begin, end, p, jtj, jtr);
+                    double lambda = m_Options.initial_lambda;
+
+                    while(result.iterations < m_Options.max_iterations && cost > 0) {
+                        ++result.iterations;
+                        double a[P][P], step[P], damping[P];
+                        for(std::size_t i = 0; i < P; ++i) {
+                            for(std::size_t j = 0; j < P; ++j) a[i][j] = jtj[i][j];
+                            damping[i] = lambda * std::max(jtj[i][i], std::numeric_limits<double>::min());
+                            a[i][i] += damping[i];
+                            step[i] = jtr[i];
+                        }
+                        if(!cholesky(a)) {
+                            lambda *= 10;
+                            continue;
+                        }
+                        cholesky_solve(a, step);
+
+                        // the reduction of the sum of squares that the linearized model predicts
+                        double predicted = 0;
+                        for(std::size_t i = 0; i < P; ++i) predicted += step[i] * (jtr[i] + damping[i] * step[i]);
+                        if(predicted <= m_Options.tolerance * cost) {
+                            result.converged = true;
+                            break;
+                        }
+
+                        double trial[P];
+                        for(std::size_t i = 0; i < P; ++i) trial[i] = p[i] + step[i];
+                        const double trial_cost = sum_of_squares(begin, end, trial);
+                        if(trial_cost < cost) {
+                            const bool small = cost - trial_cost <= m_Options.tolerance * cost;
+                            std::copy(trial, trial + P, p);
+                            cost = linearize(begin, end, p, jtj, jtr);
+                            lambda = std::max(lambda / 10, 1e-15);
+                            if(small) {
+                                result.converged = true;
+                                break;
+                            }
+                        } else if(lambda > 1e15) {
+                            // no step lowers the sum of squares any more: a minimum to working precision
+                            result.converged = true;
+                            break;
+                        } else {
+                            lambda *= 10;
+                        }
+                    }
+                    if(cost == 0) result.converged = true;
+
+                    result.parameters = pack(p, std::index_sequence_for<Ps...>{});
+                    const std::size_t residuals = result.samples * C;
+                    double sigma[P];
+                    std::fill(sigma, sigma + P, std::numeric_limits<double>::quiet_NaN());
+                    if(residuals > P && cholesky(jtj)) {
+                        const double variance = cost / double(residuals - P);
+                        for(std::size_t i = 0; i < P; ++i) {
+                            double e[P] = {};
+                            e[i] = 1;
+                            cholesky_solve(jtj, e);
+                            sigma[i] = std::sqrt(variance * e[i]);
+                        }
+                    } else if(residuals < P) {
+                        result.converged = false;
+                    }
+                    result.sigma = pack(sigma, std::index_sequence_for<Ps...>{});
+                    result.rms.value = residuals ? std::sqrt(cost / double(result.samples)) : 0;
+                    return result;
+                }
+
+            private:
+                template<std::size_t... Is>
+                static void unpack(const std::tuple<Ps...>& parameters, double* p, std::index_sequence<Is...>)
+                {
+                    int expand[] = {0, (p[Is] = double(std::get<Is>(parameters).value), 0)...};
+                    (void)expand;
+                }
+
+                template<std::size_t... Is>
+                static std::tuple<Ps...> pack(const double* p, std::index_sequence<Is...>)
+                {
+                    return std::tuple<Ps...>(Ps(typename value_traits<Ps>::base_t(p[Is]))...);
+                }
+
+                template<std::size_t... Is>
+                auto evaluate(const X& x, const double* p, std::index_sequence<Is...>) const
+                {
+                    return m_Model(x, Ps(typename value_traits<Ps>::base_t(p[Is]))...);
+                }
+
+                template<std::size_t... Is>
+                auto evaluate_dual(const X& x, const double* p, std::index_sequence<Is...>) const
+                {
+                    return m_Model(x, Quantity<dual_t, typename Ps::dimension_t>(dual_t::variable(p[Is], Is))...);
+                }
+
+                double sum_of_squares(std::size_t begin, std::size_t end, const double* p) const
+                {
+                    const auto& xs = m_Tracks.x();
+                    const auto& ys = m_Tracks.y();
+                    double cost = 0;
+                    for(std::size_t i = begin; i < end; ++i) {
+                        double f[C];
+                        traits::raw(evaluate(xs[i], p, std::index_sequence_for<Ps...>{}), f);
+                        for(std::size_t c = 0; c < C; ++c) {
+                            const double r = double(traits::get(ys, i, c)) - f[c];
+                            cost += r * r;
+                        }
+                    }
+                    return std::isfinite(cost) ? cost : std::numeric_limits<double>::infinity();
+                }
+
+                /// the sum of squares at `p`, with `J^T J` and `J^T r` of the residuals `r = y - f(x)`.
+                double linearize(std::size_t begin, std::size_t end, const double* p, double (&jtj)[P][P],
+                                 double (&jtr)[P]) const
+                {
+                    const auto& xs = m_Tracks.x();
+                    const auto& ys = m_Tracks.y();
+                    for(std::size_t i = 0; i < P; ++i) {
+                        jtr[i] = 0;
+                        for(std::size_t j = 0; j < P; ++j) jtj[i][j] = 0;
+                    }
+                    double cost = 0;
+                    for(std::size_t s = begin; s < end; ++s) {
+                        dual_t f[C];
+                        traits::raw(evaluate_dual(xs[s], p, std::index_sequence_for<Ps...>{}), f);
+                        for(std::size_t c = 0; c < C; ++c) {
+                            const double r = double(traits::get(ys, s, c)) - f[c].value;
+                            cost += r * r;
+                            const auto& g = f[c].grad;
+                            for(std::size_t i = 0; i < P; ++i) {
+                                jtr[i] += g[i] * r;
+                                for(std::size_t j = 0; j <= i; ++j) jtj[i][j] += g[i] * g[j];
+                            }
+                        }
+                    }
+                    for(std::size_t i = 0; i < P; ++i) {
+                        for(std::size_t j = i + 1; j < P; ++j) jtj[i][j] = jtj[j][i];
+                    }
+                    return cost;
+                }
+
+                const Model& m_Model;
+                const Tracks<X, Y>& m_Tracks;
+                Options m_Options;
+            };
+        }
+
+        /*!
+         * \brief Fits `y = model(x, parameters...)` to every track with the Levenberg-Marquardt method.
+         * \details `initial` holds a starting point for every track, or a single one for all of
+         *          them. The damping is scaled by the diagonal of `J^T J` (Marquardt's variant), so
+         *          parameters of very different magnitudes need no rescaling. Tracks are solved on
+         *          `threads` threads (0 for the default); `model` must be safe to call concurrently.
+         *          \throw std::invalid_argument if `initial` has the wrong size.
+         */
+        template<class Model, class X, class Y, class... Ps>
+        std::vector<NonlinearFit<Y, Ps...>> levenberg_marquardt(const Model& model, const Tracks<X, Y>& tracks,
+                                                                const std::vector<std::tuple<Ps...>>& initial,
+                                                                const Options& options = Options{},
+                                                                unsigned threads = 0)
+        {
+            if(initial.size() != 1 && initial.size() != tracks.size()) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Need one initial guess, or one for every track"));
+            }
+            std::vector<NonlinearFit<Y, Ps...>> results(tracks.size());
+            const detail::LevenbergMarquardt<Model, X, Y, Ps...> solver(model, tracks, options);
+            threading::for_chunks(tracks.size(), [&](std::size_t begin, std::size_t end) {
+                for(std::size_t i = begin; i < end; ++i) {
+                    results[i] = solver.solve(i, initial[initial.size() == 1 ? 0 : i]);
+                }
+            }, threads, 16);
+            return results;
+        }
+    }
+}
+
+#endif //QUANTITY_FIT_HPP
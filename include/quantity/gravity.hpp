@@ -0,0 +1,115 @@
+#ifndef QUANTITY_GRAVITY_HPP
+#define QUANTITY_GRAVITY_HPP
+
+#include <cstdint>
+#include <vector>
+#include "predefined.hpp"
+#include "span.hpp"
+
+namespace quantity
+{
+    namespace gravity
+    {
+        namespace pd_ = dimensions::predefined;
+
+        /// Dimension of the gravitational constant, m^3 / (kg s^2).
+        using grav_const_dim_t = dimensions::ops::div_t<dimensions::ops::mul_t<pd_::acceleration_t, pd_::area_t>,
+                                                        pd_::mass_t>;
+        using grav_const_t = Quantity<predefined::base_t, grav_const_dim_t>;
+
+        /// CODATA 2018 value of the gravitational constant.
+        constexpr grav_const_t G{6.67430e-11};
+
+        /// Parameters shared by the direct and the tree based solver.
+        struct Options
+        {
+            /// Barnes-Hut opening angle: a cell of side `s` at distance `d` is used as a
+            /// single point mass if `s / d < opening_angle`. 0 gives the exact direct sum.
+            predefined::base_t opening_angle = 0.5;
+
+            /// Plummer softening length, avoids singular forces in close encounters.
+            predefined::length_t softening{0};
+
+            /// Maximum number of bodies stored in a leaf cell.
+            std::size_t leaf_size = 8;
+
+            /// Number of threads to use, 0 means one per hardware thread.
+            unsigned threads = 0;
+
+            grav_const_t gravitational_constant = G;
+        };
+
+        /*!
+         * \brief Computes the gravitational acceleration of every body by summing over all pairs.
+         * \details This is O(N^2) and mainly meant as reference for `BarnesHut`.
+         */
+        void direct_sum(Span<const predefined::length_vec> positions, Span<const predefined::mass_t> masses,
+                        Span<predefined::accel_vec> accelerations, const Options& options = Options{});
+
+        /*!
+         * \brief Barnes-Hut octree for approximate gravitational N-body accelerations.
+         * \details The tree is meant to be rebuilt every step from the current positions.
+         *          Bodies are sorted along a Morton (Z-order) curve and copied into
+         *          structure-of-arrays storage, so spatially close bodies are close in memory.
+         *          Nodes are stored in depth-first order, where the first child of a node
+         *          directly follows it and each node knows the index of the node after its
+         *          subtree. This allows a stackless traversal that walks the node array
+         *          mostly linearly.
+         *
+         *          The eight top level subtrees are built in parallel, as are the Morton
+         *          codes and the traversal for all bodies.
+         */
+        class BarnesHut
+        {
+        public:
+            explicit BarnesHut(Options options = Options{});
+
+            /// (re)builds the tree for the given bodies.
+            void build(Span<const predefined::length_vec> positions, Span<const predefined::mass_t> masses);
+
+            /// accelerations of all bodies passed to the last `build`, in their original order.
+            void accelerations(Span<predefined::accel_vec> target) const;
+
+            /// acceleration at an arbitrary point caused by all bodies in the tree.
+            predefined::accel_vec acceleration(const predefined::length_vec& position) const;
+
+            std::size_t body_count() const { return m_Mass.size(); }
+            std::size_t node_count() const { return m_Nodes.size(); }
+            const Options& options() const { return m_Options; }
+
+        private:
+            struct Node
+            {
+                double com[3];          //!< center of mass [m]
+                double mass;            //!< total mass [kg]
+                double side;            //!< edge length of the cell [m]
+                std::uint32_t skip;     //!< index of the first node after this subtree
+                std::uint32_t begin;    //!< first body (in sorted order) of this cell
+                std::uint32_t end;      //!< one past the last body of this cell
+                bool leaf;
+            };
+
+            void build_subtree(std::vector<Node>& nodes, std::uint32_t begin, std::uint32_t end,
+                               unsigned level, double side) const;
+            void finish_node(std::vector<Node>& nodes, std::size_t index) const;
+            void accumulate(const double* p, double* acc) const;
+
+            Options m_Options;
+            std::vector<Node> m_Nodes;
+
+            // bodies in Morton order
+            std::vector<double> m_X;
+            std::vector<double> m_Y;
+            std::vector<double> m_Z;
+            std::vector<double> m_Mass;
+            std::vector<std::uint64_t> m_Codes;
+            std::vector<std::uint32_t> m_Order;  //!< original index of each sorted body
+        };
+
+        /// convenience function that builds a tree and evaluates all accelerations.
+        void barnes_hut(Span<const predefined::length_vec> positions, Span<const predefined::mass_t> masses,
+                        Span<predefined::accel_vec> accelerations, const Options& options = Options{});
+    }
+}
+
+#endif //QUANTITY_GRAVITY_HPP
@@ -0,0 +1,409 @@
+#ifndef QUANTITY_INGEST_HPP
+#define QUANTITY_INGEST_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <boost/throw_exception.hpp>
+#include "quantity.hpp"
+#include "runtime.hpp"
+#include "span.hpp"
+
+namespace quantity
+{
+    /*!
+     * \brief Staged reading of newline separated "value unit" text into batches of quantities.
+     * \details A `Pipeline` runs five stages connected by bounded queues:
+     *
+     *          - read:    blocks of bytes from the source,
+     *          - split:   cut into lines, carrying partial lines over to the next block,
+     *          - parse:   number and unit spelling of every line, each distinct spelling is
+     *                     resolved with `runtime::parse_dim` once,
+     *          - convert: dimension check and scaling into coherent SI `Quantity` values,
+     *          - deliver: the consumer callback, on the thread that called `run`.
+     *
+     *          The first four stages have a thread each. When the consumer falls behind, the queues
+     *          fill up and the stages before it wait, until finally the source is not read any
+     *          more, which for a pipe stalls the writing process. Every stage counts the items it
+     *          handled and the time it spent working, waiting for input and waiting for room in its
+     *          output queue.
+     */
+    namespace ingest
+    {
+        /// reads up to `size` bytes into `buffer`, returns 0 at the end of the input.
+        using Source = std::function<std::size_t(char* buffer, std::size_t size)>;
+
+        /// a source reading from a file descriptor, returning whatever a pipe has available.
+        Source from_fd(int fd);
+
+        /// a source reading from a stream. `std::istream::read` waits for full blocks, so use
+        /// `from_fd` for live pipes.
+        Source from_stream(std::istream& stream);
+
+        struct Options
+        {
+            /// bytes read at once.
+            std::size_t chunk_bytes = 1 << 16;
+
+            /// blocks or batches held between two stages.
+            std::size_t queue_capacity = 4;
+
+            /// throw from `run` on the first malformed line or wrong unit instead of skipping it.
+            bool strict = false;
+        };
+
+        /// A copy of the counters of one stage.
+        struct StageMetrics
+        {
+            const char* name;
+            std::uint64_t items;                //!< blocks for read, lines for split and parse, values after that
+            std::chrono::nanoseconds busy;      //!< wall clock time less the waiting, known once `run` returns
+            std::chrono::nanoseconds starved;   //!< waiting for input
+            std::chrono::nanoseconds blocked;   //!< waiting for room in the output queue
+            std::size_t queue_depth;            //!< current length of the output queue
+            std::size_t max_queue_depth;
+        };
+
+        enum Stage
+        {
+            READ,
+            SPLIT,
+            PARSE,
+            CONVERT,
+            DELIVER,
+            STAGES
+        };
+
+        namespace detail
+        {
+            struct Counters
+            {
+                std::atomic<std::uint64_t> items{0};
+                std::atomic<std::int64_t> busy_ns{0};
+                std::atomic<std::int64_t> starved_ns{0};
+                std::atomic<std::int64_t> blocked_ns{0};
+            };
+
+            /// a queue with a fixed capacity, whose `push` waits while it is full.
+            template<class T>
+            class BoundedQueue
+            {
+            public:
+                explicit BoundedQueue(std::size_t capacity) : m_Capacity(std::max<std::size_t>(capacity, 1)) { }
+
+                /// \return false if the queue was closed.
+                bool push(T item, std::atomic<std::int64_t>& blocked_ns)
+                {
+                    std::unique_lock<std::mutex> lock(m_Mutex);
+                    if(m_Items.size() >= m_Capacity && !m_Closed) {
+                        auto start = std::chrono::steady_clock::now();
+                        m_NotFull.wait(lock, [&]() { return m_Items.size() < m_Capacity || m_Closed; });
+                        blocked_ns += (std::chrono::steady_clock::now() - start).count();
+                    }
+                    if(m_Closed) return false;
+                    m_Items.push_back(std::move(item));
+                    m_MaxDepth = std::max(m_MaxDepth.load(std::memory_order_relaxed), m_Items.size());
+                    m_Depth = m_Items.size();
+                    m_NotEmpty.notify_one();
+                    return true;
+                }
+
+                /// \return false once the queue is closed and empty.
+                bool pop(T& item, std::atomic<std::int64_t>& starved_ns)
+                {
+                    std::unique_lock<std::mutex> lock(m_Mutex);
+                    if(m_Items.empty() && !m_Closed) {
+                        auto start = std::chrono::steady_clock::now();
+                        m_NotEmpty.wait(lock, [&]() { return !m_Items.empty() || m_Closed; });
+                        starved_ns += (std::chrono::steady_clock::now() - start).count();
+                    }
+                    if(m_Items.empty()) return false;
+                    item = std::move(m_Items.front());
+                    m_Items.pop_front();
+                    m_Depth = m_Items.size();
+                    m_NotFull.notify_one();
+                    return true;
+                }
+
+                /// no more items will come; waiting producers and consumers return.
+                void close()
+                {
+                    std::lock_guard<std::mutex> lock(m_Mutex);
+                    m_Closed = true;
+                    m_NotEmpty.notify_all();
+                    m_NotFull.notify_all();
+                }
+
+                /// drops everything and refuses new items, used when the pipeline stops on an error.
+                void abort()
+                {
+                    std::lock_guard<std::mutex> lock(m_Mutex);
+                    m_Closed = true;
+                    m_Items.clear();
+                    m_NotEmpty.notify_all();
+                    m_NotFull.notify_all();
+                }
+
+                std::size_t depth() const { return m_Depth.load(std::memory_order_relaxed); }
+                std::size_t max_depth() const { return m_MaxDepth.load(std::memory_order_relaxed); }
+
+            private:
+                const std::size_t m_Capacity;
+                std::mutex m_Mutex;
+                std::condition_variable m_NotEmpty;
+                std::condition_variable m_NotFull;
+                std::deque<T> m_Items;
+                bool m_Closed = false;
+                std::atomic<std::size_t> m_Depth{0};
+                std::atomic<std::size_t> m_MaxDepth{0};
+            };
+
+            /// complete lines of text, `lines` holds begin and end offsets into `text`.
+            struct Lines
+            {
+                std::string text;
+                std::vector<std::pair<std::uint32_t, std::uint32_t>> lines;
+            };
+
+            /// a unit spelling, resolved once.
+            struct Unit
+            {
+                std::string name;
+                runtime::Dimension dimension;   //!< without the prefix factor
+                double scale;                   //!< factor to coherent SI units
+                bool valid;                     //!< whether `parse_dim` accepted the spelling
+            };
+
+            /// numbers with the units they were written in.
+            struct Parsed
+            {
+                std::vector<double> values;
+                std::vector<const Unit*> units;   //!< null for lines that did not parse
+            };
+
+            /// cuts `chunk` into lines; the unfinished last line is kept in `carry`.
+            /// With `last`, `carry` is emitted as a final line.
+            void split(std::string& carry, const std::string& chunk, bool last, Lines& out);
+
+            /// the units of one `Pipeline`. Entries are never removed, so pointers stay valid.
+            class UnitTable
+            {
+            public:
+                const Unit* find(const char* first, const char* last);
+            private:
+                std::deque<Unit> m_Units;
+            };
+
+            /// parses every line of `lines` into `out`. Lines that do not parse get a null unit, or
+            /// throw `std::runtime_error` with `strict`.
+            void parse(const Lines& lines, UnitTable& units, bool strict, Parsed& out);
+
+            [[noreturn]] void wrong_unit(const Unit* unit, const runtime::Dimension& expected);
+        }
+
+        /*!
+         * \brief Reads `Quantity<B, D>` values from a `Source`, see the namespace documentation.
+         * \details Lines that do not parse, or whose unit has the wrong dimension, are skipped and
+         *          counted in `rejected`, unless `Options::strict` is set. Empty lines are ignored.
+         */
+        template<class B, class D>
+        class Pipeline
+        {
+        public:
+            using quantity_t = Quantity<B, D>;
+
+            explicit Pipeline(Source source, Options options = Options{}) :
+                    m_Source(std::move(source)), m_Options(options),
+                    m_Chunks(options.queue_capacity), m_Lines(options.queue_capacity),
+                    m_Parsed(options.queue_capacity), m_Batches(options.queue_capacity)
+            {
+            }
+
+            /// reads the whole source, calling `consumer(Span<const quantity_t>)` for every batch
+            /// on this thread. Exceptions of a stage or of the consumer stop the pipeline and are
+            /// rethrown here.
+            template<class F>
+            void run(F&& consumer)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                std::vector<std::thread> threads;
+                threads.emplace_back([this]() { stage([this]() { read_stage(); }); });
+                threads.emplace_back([this]() { stage([this]() { split_stage(); }); });
+                threads.emplace_back([this]() { stage([this]() { parse_stage(); }); });
+                threads.emplace_back([this]() { stage([this]() { convert_stage(); }); });
+
+                stage([&]() {
+                    auto& counters = m_Counters[DELIVER];
+                    std::vector<quantity_t> batch;
+                    while(m_Batches.pop(batch, counters.starved_ns)) {
+                        consumer(Span<const quantity_t>(batch.data(), batch.size()));
+                        counters.items += batch.size();
+                    }
+                });
+                for(auto& thread : threads) thread.join();
+                m_Elapsed = std::chrono::steady_clock::now() - start;
+                finish_busy();
+                if(m_Error) std::rethrow_exception(m_Error);
+            }
+
+            /// counters of all stages, indexed by `Stage`. May be called while `run` is active.
+            std::array<StageMetrics, STAGES> metrics() const
+            {
+                static const char* names[STAGES] = {"read", "split", "parse", "convert", "deliver"};
+                const std::size_t depth[STAGES] = {m_Chunks.depth(), m_Lines.depth(), m_Parsed.depth(),
+                                                   m_Batches.depth(), 0};
+                const std::size_t max_depth[STAGES] = {m_Chunks.max_depth(), m_Lines.max_depth(),
+                                                       m_Parsed.max_depth(), m_Batches.max_depth(), 0};
+                std::array<StageMetrics, STAGES> result;
+                for(std::size_t i = 0; i < STAGES; ++i) {
+                    const auto& c = m_Counters[i];
+                    result[i] = StageMetrics{names[i], c.items.load(), std::chrono::nanoseconds(c.busy_ns.load()),
+                                             std::chrono::nanoseconds(c.starved_ns.load()),
+                                             std::chrono::nanoseconds(c.blocked_ns.load()), depth[i], max_depth[i]};
+                }
+                return result;
+            }
+
+            /// wall clock time of the last `run`.
+            std::chrono::nanoseconds elapsed() const
+            {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(m_Elapsed);
+            }
+
+            /// lines that were skipped because they did not parse or had the wrong unit.
+            std::uint64_t rejected() const { return m_Rejected.load(); }
+
+        private:
+            /// runs a stage body, timing it and turning its exceptions into a stop of the pipeline.
+            template<class F>
+            void stage(F&& body)
+            {
+                try {
+                    body();
+                } catch (...) {
+                    {
+                        std::lock_guard<std::mutex> lock(m_ErrorMutex);
+                        if(!m_Error) m_Error = std::current_exception();
+                    }
+                    m_Chunks.abort();
+                    m_Lines.abort();
+                    m_Parsed.abort();
+                    m_Batches.abort();
+                }
+            }
+
+            void finish_busy()
+            {
+                // busy time is what remains of the wall clock time after waiting
+                const auto total = std::chrono::duration_cast<std::chrono::nanoseconds>(m_Elapsed).count();
+                for(auto& c : m_Counters) c.busy_ns = std::max<std::int64_t>(0, total - c.starved_ns - c.blocked_ns);
+            }
+
+            void read_stage()
+            {
+                auto& counters = m_Counters[READ];
+                while(true) {
+                    std::string chunk(m_Options.chunk_bytes, '\0');
+                    auto start = std::chrono::steady_clock::now();
+                    const std::size_t n = m_Source(&chunk[0], chunk.size());
+                    // waiting for a pipe counts as starving
+                    counters.starved_ns += (std::chrono::steady_clock::now() - start).count();
+                    if(n == 0) break;
+                    chunk.resize(n);
+                    ++counters.items;
+                    if(!m_Chunks.push(std::move(chunk), counters.blocked_ns)) return;
+                }
+                m_Chunks.close();
+            }
+
+            void split_stage()
+            {
+                auto& counters = m_Counters[SPLIT];
+                std::string carry;
+                std::string chunk;
+                while(m_Chunks.pop(chunk, counters.starved_ns)) {
+                    detail::Lines lines;
+                    detail::split(carry, chunk, false, lines);
+                    if(lines.lines.empty()) continue;
+                    counters.items += lines.lines.size();
+                    if(!m_Lines.push(std::move(lines), counters.blocked_ns)) return;
+                }
+                detail::Lines last;
+                detail::split(carry, std::string(), true, last);
+                counters.items += last.lines.size();
+                if(!last.lines.empty()) m_Lines.push(std::move(last), counters.blocked_ns);
+                m_Lines.close();
+            }
+
+            void parse_stage()
+            {
+                auto& counters = m_Counters[PARSE];
+                detail::Lines lines;
+                while(m_Lines.pop(lines, counters.starved_ns)) {
+                    detail::Parsed parsed;
+                    detail::parse(lines, m_Units, m_Options.strict, parsed);
+                    counters.items += lines.lines.size();
+                    if(!m_Parsed.push(std::move(parsed), counters.blocked_ns)) return;
+                }
+                m_Parsed.close();
+            }
+
+            void convert_stage()
+            {
+                auto& counters = m_Counters[CONVERT];
+                const runtime::Dimension target = runtime::to_dynamic(D{});
+                detail::Parsed parsed;
+                while(m_Parsed.pop(parsed, counters.starved_ns)) {
+                    std::vector<quantity_t> batch;
+                    batch.reserve(parsed.values.size());
+                    for(std::size_t i = 0; i < parsed.values.size(); ++i) {
+                        const detail::Unit* unit = parsed.units[i];
+                        if(unit && unit->valid && unit->dimension == target) {
+                            batch.push_back(quantity_t(B(parsed.values[i] * unit->scale)));
+                        } else if(m_Options.strict) {
+                            detail::wrong_unit(unit, target);
+                        } else {
+                            ++m_Rejected;
+                        }
+                    }
+                    counters.items += batch.size();
+                    if(batch.empty()) continue;
+                    if(!m_Batches.push(std::move(batch), counters.blocked_ns)) return;
+                }
+                m_Batches.close();
+            }
+
+            Source m_Source;
+            Options m_Options;
+
+            detail::BoundedQueue<std::string> m_Chunks;
+            detail::BoundedQueue<detail::Lines> m_Lines;
+            detail::BoundedQueue<detail::Parsed> m_Parsed;
+            detail::BoundedQueue<std::vector<quantity_t>> m_Batches;
+            detail::UnitTable m_Units;
+
+            std::array<detail::Counters, STAGES> m_Counters;
+            std::atomic<std::uint64_t> m_Rejected{0};
+            std::chrono::steady_clock::duration m_Elapsed{0};
+
+            std::mutex m_ErrorMutex;
+            std::exception_ptr m_Error;
+        };
+    }
+}
+
+#endif //QUANTITY_INGEST_HPP
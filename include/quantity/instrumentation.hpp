@@ -0,0 +1,161 @@
+#ifndef QUANTITY_INSTRUMENTATION_HPP
+#define QUANTITY_INSTRUMENTATION_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace quantity
+{
+    /*!
+     * \brief Counters, latency histograms and traces of the hot paths of the library.
+     * \details Code is instrumented with `QUANTITY_PROBE("name")`, which times the rest of the
+     *          enclosing scope. The macro expands to nothing unless `QUANTITY_INSTRUMENTATION` is
+     *          defined (the CMake option of the same name), so an uninstrumented build pays nothing.
+     *          The library instruments `runtime::parse_dim`, `runtime::dynamic_rescale`, the
+     *          `Dimension` output and the `Quantity` stream operators; kernels can add their own
+     *          probes in the same way.
+     *
+     *          Every probe counts calls, calls left by an exception and, in instrumented builds,
+     *          the heap allocations made while it was active, and sorts the latencies into
+     *          power of two histogram buckets. All of this uses relaxed atomics. While tracing is
+     *          switched on, every timed scope is additionally recorded as an event, which
+     *          `write_chrome_trace` exports for `chrome://tracing` or Perfetto.
+     */
+    namespace instrumentation
+    {
+        /// number of latency buckets, bucket `i` counts latencies in `[2^i, 2^(i+1))` ns.
+        constexpr std::size_t BUCKETS = 40;
+
+        /// the live counters of one probe.
+        struct Probe
+        {
+            explicit Probe(std::string n) : name(std::move(n)) { }
+
+            const std::string name;
+            std::atomic<std::uint64_t> calls{0};
+            std::atomic<std::uint64_t> exceptions{0};
+            std::atomic<std::uint64_t> allocations{0};
+            std::atomic<std::uint64_t> total_ns{0};
+            std::array<std::atomic<std::uint64_t>, BUCKETS> histogram{};
+        };
+
+        /// the probe called `name`, created on first use. Probes live until the end of the program.
+        Probe& probe(const std::string& name);
+
+        /// A copy of the counters of a probe.
+        struct ProbeStats
+        {
+            std::string name;
+            std::uint64_t calls;
+            std::uint64_t exceptions;
+            std::uint64_t allocations;
+            std::chrono::nanoseconds total;
+            std::array<std::uint64_t, BUCKETS> histogram;
+
+            /// upper bound of the latency below which a fraction `q` of the calls lies.
+            std::chrono::nanoseconds quantile(double q) const;
+        };
+
+        /// the current counters of all probes, sorted by name.
+        std::vector<ProbeStats> snapshot();
+
+        /// sets all counters to zero and discards the recorded trace.
+        void reset();
+
+        /// whether the library was built with `QUANTITY_INSTRUMENTATION`.
+        bool enabled();
+
+        /// number of heap allocations made by the calling thread, always 0 in uninstrumented builds.
+        std::uint64_t thread_allocations();
+
+        /// starts recording an event per timed scope, keeping at most `capacity` events.
+        void start_tracing(std::size_t capacity = 1 << 20);
+        void stop_tracing();
+
+        /// writes the recorded events and the probe counters as Chrome trace-event JSON.
+        void write_chrome_trace(std::ostream& out);
+
+        namespace detail
+        {
+            extern std::atomic<bool> tracing;
+
+            /// number of exceptions in flight on this thread.
+            inline int unwinding()
+            {
+#ifdef __cpp_lib_uncaught_exceptions
+                return std::uncaught_exceptions();
+#else
+                return std::uncaught_exception() ? 1 : 0;
+#endif
+            }
+
+            void record(const Probe& probe, std::chrono::steady_clock::time_point start,
+                        std::chrono::steady_clock::time_point stop);
+        }
+
+        /*!
+         * \brief Times its own lifetime and adds it to a probe.
+         * \details Usually created through `QUANTITY_PROBE`, but may be used directly where the
+         *          measurement should not depend on the build configuration.
+         */
+        class ScopeTimer
+        {
+        public:
+            explicit ScopeTimer(Probe& probe) :
+                    m_Probe(probe), m_Unwinding(detail::unwinding()),
+                    m_Allocations(thread_allocations()), m_Start(std::chrono::steady_clock::now())
+            {
+            }
+
+            ScopeTimer(const ScopeTimer&) = delete;
+            ScopeTimer& operator=(const ScopeTimer&) = delete;
+
+            ~ScopeTimer()
+            {
+                auto stop = std::chrono::steady_clock::now();
+                auto ns = std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - m_Start).count());
+                std::size_t bucket = 0;
+                while(bucket + 1 < BUCKETS && (ns >> (bucket + 1)) != 0) ++bucket;
+
+                m_Probe.calls.fetch_add(1, std::memory_order_relaxed);
+                m_Probe.total_ns.fetch_add(ns, std::memory_order_relaxed);
+                m_Probe.histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+                m_Probe.allocations.fetch_add(thread_allocations() - m_Allocations, std::memory_order_relaxed);
+                if(detail::unwinding() > m_Unwinding) {
+                    m_Probe.exceptions.fetch_add(1, std::memory_order_relaxed);
+                }
+                if(detail::tracing.load(std::memory_order_relaxed)) {
+                    detail::record(m_Probe, m_Start, stop);
+                }
+            }
+
+        private:
+            Probe& m_Probe;
+            int m_Unwinding;
+            std::uint64_t m_Allocations;
+            std::chrono::steady_clock::time_point m_Start;
+        };
+    }
+}
+
+#define QUANTITY_PROBE_CONCAT_(a, b) a##b
+#define QUANTITY_PROBE_CONCAT(a, b) QUANTITY_PROBE_CONCAT_(a, b)
+
+#ifdef QUANTITY_INSTRUMENTATION
+/// times the rest of the current scope under the probe `name`.
+#define QUANTITY_PROBE(name)                                                                            \
+    static ::quantity::instrumentation::Probe& QUANTITY_PROBE_CONCAT(quantity_probe_, __LINE__) =       \
+            ::quantity::instrumentation::probe(name);                                                   \
+    ::quantity::instrumentation::ScopeTimer QUANTITY_PROBE_CONCAT(quantity_probe_timer_, __LINE__)(     \
+            QUANTITY_PROBE_CONCAT(quantity_probe_, __LINE__))
+#else
+#define QUANTITY_PROBE(name) static_cast<void>(0)
+#endif
+
+#endif //QUANTITY_INSTRUMENTATION_HPP
@@ -5,9 +5,14 @@
 #ifndef SPACEPHYS_IO_HPP
 #define SPACEPHYS_IO_HPP
 
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <cmath>
+#include <string>
+#include <type_traits>
 #include <boost/throw_exception.hpp>
+#include "instrumentation.hpp"
 #include "quantity.hpp"
 #include "runtime.hpp"
 #include "vec.hpp"
@@ -19,19 +24,41 @@ namespace quantity
         std::ostream& operator<<(std::ostream& stream, Dimension dim);
         Dimension parse_dim(std::string unit_s);
         Dimension dynamic_rescale(long double value, Dimension dimension);
+
+        /// `10^exponent`, the factor of a unit prefix stored in `Dimension::factor`.
+        double prefix_scale(const Ratio& exponent);
+
+        /// the text `operator<<` writes for `dim`, e.g. "km/s", or `dimensionless` if that is empty.
+        std::string to_string(const Dimension& dim, const char* dimensionless = "");
+
+        /// appends the shorter of 15 or 17 significant digits of `number` that reads back exactly.
+        void append_number(std::string& out, double number);
+
+        /*!
+         * \brief Parses a vector in the shared-unit format `(1.5, -2, 3e4) km`.
+         * \details Whitespace is allowed around every token; the unit is everything up to the next
+         *          whitespace and may be missing for dimensionless vectors, in which case `unit` is
+         *          empty. Units are looked up in a small per-thread cache, so parsing many vectors in
+         *          the same few units does not allocate.
+         * \return a pointer behind the unit.
+         * \throw std::runtime_error on a syntax error or an unknown unit.
+         */
+        const char* parse_vector(const char* first, const char* last, double (&values)[3], Dimension& unit);
     }
 
     template<class B, class T>
     std::ostream& operator<<(std::ostream& stream, Quantity<B, T> value)
     {
+        QUANTITY_PROBE("operator<<(Quantity)");
         auto dyn_dim = runtime::dynamic_rescale(value.value, runtime::to_dynamic(T{}));
-        return stream << value.value / std::pow(10.0, dyn_dim.factor.num) << " " << dyn_dim;
+        return stream << value.value / runtime::prefix_scale(dyn_dim.factor) << " " << dyn_dim;
     }
 
 
     template<class B, class T>
     std::istream& operator>>(std::istream& stream, Quantity<B, T>& value)
     {
+        QUANTITY_PROBE("operator>>(Quantity)");
         std::string unit_str;
         stream >> value.value;
         stream >> unit_str;
@@ -57,6 +84,95 @@ namespace quantity
     {
         return is >> vec.x >> vec.y >> vec.z;
     }
+
+    namespace detail
+    {
+        template<class B, class D>
+        Vec3<Quantity<B, D>> to_vector(const double (&values)[3], runtime::Dimension unit)
+        {
+            const B scale = B(runtime::prefix_scale(unit.factor));
+            unit.factor = runtime::Ratio{0, 1};
+            if(!(unit == runtime::to_dynamic(D{})))
+            {
+                BOOST_THROW_EXCEPTION(std::runtime_error("Unit mismatch"));
+            }
+            return Vec3<Quantity<B, D>>(Quantity<B, D>(B(values[0]) * scale), Quantity<B, D>(B(values[1]) * scale),
+                                        Quantity<B, D>(B(values[2]) * scale));
+        }
+    }
+
+    /// parses `(x, y, z) unit` into `vec`, see `runtime::parse_vector`.
+    /// \throw std::runtime_error if the text does not parse or the unit has the wrong dimension.
+    template<class B, class D>
+    const char* parse_vector(const char* first, const char* last, Vec3<Quantity<B, D>>& vec)
+    {
+        double values[3];
+        runtime::Dimension unit;
+        const char* end = runtime::parse_vector(first, last, values, unit);
+        vec = detail::to_vector<B, D>(values, unit);
+        return end;
+    }
+
+    /// writes a vector of quantities with one unit for all components, e.g. `(1.5, -2, 0.5) km`.
+    /// The prefix is chosen for the largest component.
+    template<class B, class D>
+    std::ostream& operator<<(std::ostream& os, const Vec3<Quantity<B, D>>& vec)
+    {
+        QUANTITY_PROBE("operator<<(Vec3)");
+        using std::abs;
+        const B largest = std::max(std::max(abs(vec.x.value), abs(vec.y.value)), abs(vec.z.value));
+        auto dyn_dim = runtime::dynamic_rescale(largest, runtime::to_dynamic(D{}));
+        const B scale = B(runtime::prefix_scale(dyn_dim.factor));
+        os << "(" << vec.x.value / scale << ", " << vec.y.value / scale << ", " << vec.z.value / scale << ")";
+        if(!std::is_same<D, dimensions::dimless_t>::value) os << " " << dyn_dim;
+        return os;
+    }
+
+    /*!
+     * \brief Reads a vector of quantities.
+     * \details Accepts the format written by `operator<<`, `(1.5, -2, 3e4) km`, as well as three
+     *          separate quantities, `1.5 km -2 km 30 Mm`. Sets the failbit if the closing
+     *          parenthesis is missing; malformed numbers and wrong units throw as for single
+     *          quantities.
+     */
+    template<class B, class D>
+    std::istream& operator>>(std::istream& is, Vec3<Quantity<B, D>>& vec)
+    {
+        QUANTITY_PROBE("operator>>(Vec3)");
+        if(!(is >> std::ws)) return is;
+        if(is.peek() != '(') {
+            return is >> vec.x >> vec.y >> vec.z;
+        }
+
+        // the text is collected on the stack; numbers and unit are short
+        char buffer[256];
+        std::size_t n = 0;
+        char c = 0;
+        while(n + 1 < sizeof(buffer) && is.get(c)) {
+            buffer[n++] = c;
+            if(c == ')') break;
+        }
+        if(c != ')') {
+            is.setstate(std::ios_base::failbit);
+            return is;
+        }
+        if(!std::is_same<D, dimensions::dimless_t>::value) {
+            buffer[n++] = ' ';
+            is >> std::ws;
+            while(n < sizeof(buffer) && is.get(c)) {
+                if(std::isspace(static_cast<unsigned char>(c))) {
+                    is.unget();
+                    break;
+                }
+                buffer[n++] = c;
+            }
+            // reaching the end of the stream after the unit is fine
+            if(is.eof()) is.clear(std::ios_base::eofbit);
+        }
+
+        parse_vector(buffer, buffer + n, vec);
+        return is;
+    }
 }
 
 #endif //SPACEPHYS_IO_HPP
@@ -0,0 +1,329 @@
+#ifndef QUANTITY_JSON_HPP
+#define QUANTITY_JSON_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+#include "quantity.hpp"
+#include "runtime.hpp"
+#include "vec.hpp"
+#include "vec_array.hpp"
+
+namespace quantity
+{
+    /*!
+     * \brief Streaming JSON input and output of quantities, without building a document tree.
+     * \details A quantity is written as an object with its number, or three numbers for a vector,
+     *          and its unit:
+     *
+     *              {"pos": {"value": [1, 2, 3], "unit": "km"}, "mass": {"value": 5, "unit": "t"}}
+     *
+     *          `Reader` splits a stream into tokens with a fixed size buffer. `RecordReader` uses
+     *          it to read objects like the one above, one after the other, straight into the
+     *          quantities, vectors or columns bound in a `Fields` list. Each field remembers the
+     *          last unit spelling it has seen, so a unit string is only parsed with
+     *          `runtime::parse_dim` when it changes. Memory use does not depend on the size of the
+     *          input, which may be a top level array of records or a sequence of records (JSON
+     *          lines).
+     *
+     *          `Writer` produces the same format, buffered and with the shortest number text that
+     *          reads back to the same `double`.
+     */
+    namespace json
+    {
+        enum class Token
+        {
+            BEGIN_OBJECT,
+            END_OBJECT,
+            BEGIN_ARRAY,
+            END_ARRAY,
+            KEY,         //!< the name of an object member, see `Reader::text`
+            STRING,
+            NUMBER,
+            BOOLEAN,
+            NULL_VALUE,
+            END          //!< end of the input
+        };
+
+        /// Splits a JSON text into tokens. Syntax errors throw `std::runtime_error`.
+        class Reader
+        {
+        public:
+            explicit Reader(std::istream& source, std::size_t buffer_size = 1 << 16);
+
+            Token next();
+
+            /// the contents of the last KEY or STRING, unescaped.
+            const std::string& text() const { return m_Text; }
+
+            /// the last NUMBER; a NULL_VALUE reads as NaN.
+            double number() const { return m_Number; }
+
+            /// the last BOOLEAN.
+            bool boolean() const { return m_Boolean; }
+
+            /// number of open objects and arrays.
+            std::size_t depth() const { return m_Stack.size(); }
+
+            /// skips the value that starts with `token`, which has just been returned by `next`.
+            void skip(Token token);
+
+            /// bytes consumed so far.
+            std::uint64_t position() const { return m_Consumed + std::uint64_t(m_Pos); }
+
+        private:
+            bool fill();
+            int peek();
+            int get();
+            void skip_space();
+            void read_string();
+            void read_number();
+            void read_literal(const char* word);
+            [[noreturn]] void error(const std::string& what) const;
+
+            std::istream& m_Source;
+            std::vector<char> m_Buffer;
+            std::size_t m_Pos = 0;
+            std::size_t m_End = 0;
+            std::uint64_t m_Consumed = 0;
+
+            std::string m_Text;
+            double m_Number = 0;
+            bool m_Boolean = false;
+
+            std::vector<char> m_Stack;   // '{' or '[' for every open container
+            enum State
+            {
+                START,         //!< at the beginning of the input or of a container
+                AFTER_VALUE,
+                AFTER_COMMA,
+                AFTER_KEY
+            } m_State = START;
+        };
+
+        namespace detail
+        {
+            /// stores components, already in coherent SI units, into a bound target.
+            using StoreFn = void (*)(void* target, const double* values);
+
+            template<class B, class D>
+            void store(Quantity<B, D>* target, const double* values)
+            {
+                target->value = B(values[0]);
+            }
+
+            template<class B, class D>
+            void store(Vec3<Quantity<B, D>>* target, const double* values)
+            {
+                *target = Vec3<Quantity<B, D>>(Quantity<B, D>(B(values[0])), Quantity<B, D>(B(values[1])),
+                                               Quantity<B, D>(B(values[2])));
+            }
+
+            template<class B, class D>
+            void store(std::vector<Quantity<B, D>>* target, const double* values)
+            {
+                target->push_back(Quantity<B, D>(B(values[0])));
+            }
+
+            template<class B, class D>
+            void store(std::vector<Vec3<Quantity<B, D>>>* target, const double* values)
+            {
+                target->emplace_back(Quantity<B, D>(B(values[0])), Quantity<B, D>(B(values[1])),
+                                     Quantity<B, D>(B(values[2])));
+            }
+
+            template<class B, class D>
+            void store(Vec3Array<Quantity<B, D>>* target, const double* values)
+            {
+                target->push_back(Vec3<Quantity<B, D>>(Quantity<B, D>(B(values[0])), Quantity<B, D>(B(values[1])),
+                                                       Quantity<B, D>(B(values[2]))));
+            }
+
+            template<class T>
+            struct field_traits;
+
+            template<class B, class D>
+            struct field_traits<Quantity<B, D>> { using dimension_t = D; static constexpr std::size_t components = 1; };
+
+            template<class B, class D>
+            struct field_traits<Vec3<Quantity<B, D>>> { using dimension_t = D; static constexpr std::size_t components = 3; };
+
+            template<class B, class D>
+            struct field_traits<std::vector<Quantity<B, D>>> : field_traits<Quantity<B, D>> { };
+
+            template<class B, class D>
+            struct field_traits<std::vector<Vec3<Quantity<B, D>>>> : field_traits<Vec3<Quantity<B, D>>> { };
+
+            template<class B, class D>
+            struct field_traits<Vec3Array<Quantity<B, D>>> : field_traits<Vec3<Quantity<B, D>>> { };
+        }
+
+        /*!
+         * \brief The members of a record and where their values go.
+         * \details A field is bound to a `Quantity` or `Vec3<Quantity>`, which is overwritten by
+         *          every record, or to a `std::vector` or `Vec3Array` of them, to which every record
+         *          appends. The bound objects have to outlive the `Fields`. Every bound field must
+         *          appear in every record; other members are skipped.
+         */
+        class Fields
+        {
+        public:
+            template<class T>
+            Fields& bind(std::string name, T& target)
+            {
+                using traits = detail::field_traits<T>;
+                Field field;
+                field.name = std::move(name);
+                field.dimension = runtime::to_dynamic(typename traits::dimension_t{});
+                field.components = traits::components;
+                field.target = &target;
+                field.store = [](void* t, const double* values) { detail::store(static_cast<T*>(t), values); };
+                m_Fields.push_back(std::move(field));
+                return *this;
+            }
+
+            std::size_t size() const { return m_Fields.size(); }
+
+        private:
+            friend class RecordReader;
+
+            struct Field
+            {
+                std::string name;
+                runtime::Dimension dimension;
+                std::size_t components;
+                void* target;
+                detail::StoreFn store;
+
+                // the unit spelling seen last and its factor to coherent SI units
+                std::string unit;
+                double scale = 1.0;
+                bool unit_known = false;
+                bool seen = false;
+            };
+
+            std::vector<Field> m_Fields;
+        };
+
+        /*!
+         * \brief Reads records into the bound `Fields`.
+         * \details The value of a field is either `{"value": ..., "unit": "..."}`, with the members
+         *          in any order, or a bare number or array of numbers in coherent SI units.
+         *          \throw std::runtime_error on syntax errors, missing fields, wrong numbers of
+         *          components and units of the wrong dimension.
+         */
+        class RecordReader
+        {
+        public:
+            RecordReader(std::istream& source, Fields& fields, std::size_t buffer_size = 1 << 16);
+
+            /// reads the next record. \return false at the end of the input.
+            bool next();
+
+            /// records read so far.
+            std::size_t count() const { return m_Count; }
+
+            Reader& reader() { return m_Reader; }
+
+        private:
+            Fields::Field* find(const std::string& name);
+            void read_field(Fields::Field& field);
+            std::size_t read_numbers(Token token, double* values);
+            void resolve_unit(Fields::Field& field, const std::string& unit);
+
+            Reader m_Reader;
+            Fields& m_Fields;
+            bool m_InArray = false;
+            std::size_t m_Count = 0;
+        };
+
+        /*!
+         * \brief Writes JSON, inserting the commas and colons, into an internal buffer that is
+         *        passed on to the stream in large blocks.
+         * \details Non finite numbers, which JSON cannot represent, are written as `null`.
+         */
+        class Writer
+        {
+        public:
+            explicit Writer(std::ostream& target, std::size_t buffer_size = 1 << 16);
+            ~Writer();
+
+            Writer(const Writer&) = delete;
+            Writer& operator=(const Writer&) = delete;
+
+            Writer& begin_object();
+            Writer& end_object();
+            Writer& begin_array();
+            Writer& end_array();
+            Writer& key(const std::string& name);
+
+            Writer& value(double number);
+            Writer& value(const std::string& text);
+            Writer& value(const char* text) { return value(std::string(text)); }
+            Writer& value(bool flag);
+            Writer& null();
+
+            /// writes `{"value": x, "unit": unit}`; without a unit in coherent SI units.
+            /// \throw std::runtime_error if `unit` does not have the dimension of the quantity.
+            template<class B, class D>
+            Writer& value(const Quantity<B, D>& q, const char* unit = nullptr)
+            {
+                const double v = double(q.value);
+                return quantity_value(&v, 1, runtime::to_dynamic(D{}), unit);
+            }
+
+            template<class B, class D>
+            Writer& value(const Vec3<Quantity<B, D>>& q, const char* unit = nullptr)
+            {
+                const double v[3] = {double(q.x.value), double(q.y.value), double(q.z.value)};
+                return quantity_value(v, 3, runtime::to_dynamic(D{}), unit);
+            }
+
+            /// shorthand for `key(name).value(...)`.
+            template<class T>
+            Writer& field(const std::string& name, const T& v)
+            {
+                return key(name).value(v);
+            }
+
+            template<class T>
+            Writer& field(const std::string& name, const T& v, const char* unit)
+            {
+                return key(name).value(v, unit);
+            }
+
+            /// passes everything written so far on to the stream.
+            void flush();
+
+        private:
+            Writer& quantity_value(const double* values, std::size_t count, const runtime::Dimension& dim,
+                                   const char* unit);
+            void separate();
+            void write_number(double number);
+            void write_string(const std::string& text);
+            void maybe_flush();
+
+            struct Unit
+            {
+                bool si;   //!< the coherent SI unit, used when no unit is given
+                std::string name;
+                runtime::Dimension dimension;
+                double scale;
+            };
+            const Unit& unit_info(const runtime::Dimension& dim, const char* unit);
+
+            std::ostream& m_Target;
+            std::size_t m_BufferSize;
+            std::string m_Buffer;
+            std::vector<bool> m_First;   // for every open container, whether nothing was written yet
+            bool m_AfterKey = false;
+            bool m_WroteTopLevel = false;
+            std::vector<Unit> m_Units;
+        };
+    }
+}
+
+#endif //QUANTITY_JSON_HPP
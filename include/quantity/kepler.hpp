@@ -0,0 +1,69 @@
+#ifndef QUANTITY_KEPLER_HPP
+#define QUANTITY_KEPLER_HPP
+
+#include <vector>
+#include "predefined.hpp"
+#include "vec_array.hpp"
+
+namespace quantity
+{
+    namespace kepler
+    {
+        namespace pd_ = dimensions::predefined;
+
+        /// Dimension of a standard gravitational parameter GM, m^3 / s^2.
+        using grav_param_dim_t = dimensions::ops::mul_t<pd_::acceleration_t, pd_::area_t>;
+        using grav_param_t = Quantity<predefined::base_t, grav_param_dim_t>;
+
+        /*!
+         * \brief Classical orbital elements of many elliptic orbits, stored as structure of arrays.
+         * \details Angles are given in radians. The mean anomaly is the one at `epoch`.
+         */
+        struct Elements
+        {
+            std::vector<predefined::length_t> semi_major_axis;
+            std::vector<predefined::scalar_t> eccentricity;
+            std::vector<predefined::scalar_t> inclination;
+            std::vector<predefined::scalar_t> ascending_node;
+            std::vector<predefined::scalar_t> arg_periapsis;
+            std::vector<predefined::scalar_t> mean_anomaly;
+            std::vector<predefined::time_t> epoch;
+
+            std::size_t size() const { return semi_major_axis.size(); }
+            void resize(std::size_t count);
+            void reserve(std::size_t count);
+            void push_back(predefined::length_t a, predefined::scalar_t e, predefined::scalar_t i,
+                           predefined::scalar_t raan, predefined::scalar_t omega, predefined::scalar_t m0,
+                           predefined::time_t t0);
+        };
+
+        struct Options
+        {
+            /// Fixed number of Halley iterations. Six are enough for double precision up to e = 0.99.
+            unsigned iterations = 6;
+
+            /// Number of threads to use, 0 means one per hardware thread.
+            unsigned threads = 0;
+        };
+
+        /*!
+         * \brief Solves Kepler's equation `M = E - e sin(E)` for the eccentric anomaly `E`.
+         * \details Starts at `E = M + 0.85 e sign(sin M)` and performs a fixed number of
+         *          Halley steps. This is the scalar version of the kernel used by `propagate`.
+         */
+        double eccentric_anomaly(double mean_anomaly, double eccentricity, unsigned iterations = 6);
+
+        /*!
+         * \brief Computes position and velocity of all orbits at time `t`.
+         * \details The elements are processed in fixed-size blocks with a branch-free,
+         *          fixed iteration count solver over contiguous arrays, so the compiler can
+         *          vectorize the inner loops. Blocks are distributed over threads.
+         * \throw std::invalid_argument if any orbit is not elliptic or the arrays have different sizes.
+         */
+        void propagate(const Elements& elements, predefined::time_t t, grav_param_t mu,
+                       Vec3Array<predefined::length_t>& positions, Vec3Array<predefined::speed_t>& velocities,
+                       const Options& options = Options{});
+    }
+}
+
+#endif //QUANTITY_KEPLER_HPP
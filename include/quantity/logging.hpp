@@ -0,0 +1,177 @@
+#ifndef QUANTITY_LOGGING_HPP
+#define QUANTITY_LOGGING_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "quantity.hpp"
+#include "runtime.hpp"
+#include "vec.hpp"
+
+namespace quantity
+{
+    /*!
+     * \brief Logging of quantities without formatting them on the logging thread.
+     * \details `AsyncSink::log` only copies the raw value, the id of its static dimension and the
+     *          label pointer into a lock-free single producer queue that belongs to the calling
+     *          thread. A background thread empties the queues, chooses the SI prefixes, formats
+     *          each record exactly as the `io.hpp` stream operators would and writes the text to
+     *          the target stream in large batches.
+     *
+     *          Records of one thread keep their order; records of different threads are
+     *          interleaved in the order the background thread finds them. If a queue is full,
+     *          the record is dropped and counted, the logging thread never waits.
+     */
+    namespace logging
+    {
+        /// the id of `dim` in the process wide dimension table, registering it on first use.
+        std::uint32_t register_dimension(const runtime::Dimension& dim);
+
+        /// the dimension registered as `id`.
+        runtime::Dimension registered_dimension(std::uint32_t id);
+
+        /// the dimension id of `D`, looked up once per dimension type.
+        template<class D>
+        std::uint32_t dimension_id()
+        {
+            static const std::uint32_t id = register_dimension(runtime::to_dynamic(D{}));
+            return id;
+        }
+
+        namespace detail
+        {
+            /// one logged value, as it travels from the logging thread to the writer.
+            struct Record
+            {
+                const char* label;
+                std::uint32_t dimension;
+                std::uint32_t components;
+                double values[3];
+            };
+
+            /// ring buffer with one producing and one consuming thread.
+            class Queue
+            {
+            public:
+                explicit Queue(std::size_t capacity);
+
+                // C++14 `new` does not respect the over-alignment of the indices, so align by hand.
+                static void* operator new(std::size_t size);
+                static void operator delete(void* memory) noexcept;
+
+                bool push(const Record& record)
+                {
+                    const std::size_t tail = m_Tail.load(std::memory_order_relaxed);
+                    if(tail - m_CachedHead == m_Slots.size()) {
+                        m_CachedHead = m_Head.load(std::memory_order_acquire);
+                        if(tail - m_CachedHead == m_Slots.size()) return false;
+                    }
+                    m_Slots[tail & m_Mask] = record;
+                    m_Tail.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+
+                /// calls `f` for every waiting record and returns their number.
+                template<class F>
+                std::size_t drain(F&& f)
+                {
+                    const std::size_t head = m_Head.load(std::memory_order_relaxed);
+                    const std::size_t tail = m_Tail.load(std::memory_order_acquire);
+                    for(std::size_t i = head; i != tail; ++i) f(m_Slots[i & m_Mask]);
+                    m_Head.store(tail, std::memory_order_release);
+                    return tail - head;
+                }
+
+            private:
+                std::vector<Record> m_Slots;
+                std::size_t m_Mask;
+                // producer and consumer indices on separate cache lines
+                alignas(64) std::atomic<std::size_t> m_Tail{0};
+                std::size_t m_CachedHead = 0;
+                alignas(64) std::atomic<std::size_t> m_Head{0};
+            };
+        }
+
+        /*!
+         * \brief Writes logged quantities to a stream from a background thread.
+         * \details A record is written as `label: value` followed by a newline, where `value` is
+         *          the output of `operator<<` for the logged quantity or vector. Values are carried
+         *          as `double`. The formatting flags of `target` at construction are used.
+         */
+        class AsyncSink
+        {
+        public:
+            /// \param queue_capacity records per logging thread, rounded up to a power of two. Small
+            ///        queues stay in the cache, which keeps the latency of `log` low.
+            /// \param batch_bytes text collected before it is written to `target`.
+            explicit AsyncSink(std::ostream& target, std::size_t queue_capacity = 1 << 10,
+                               std::size_t batch_bytes = 1 << 16);
+
+            /// writes all records that are still queued.
+            ~AsyncSink();
+
+            AsyncSink(const AsyncSink&) = delete;
+            AsyncSink& operator=(const AsyncSink&) = delete;
+
+            /// queues `value`; `label` has to outlive the sink, usually it is a string literal.
+            /// \return false if the queue of this thread was full and the record was dropped.
+            template<class B, class D>
+            bool log(const char* label, const Quantity<B, D>& value)
+            {
+                return push(detail::Record{label, dimension_id<D>(), 1, {double(value.value), 0.0, 0.0}});
+            }
+
+            template<class B, class D>
+            bool log(const char* label, const Vec3<Quantity<B, D>>& value)
+            {
+                return push(detail::Record{label, dimension_id<D>(), 3,
+                                           {double(value.x.value), double(value.y.value), double(value.z.value)}});
+            }
+
+            /// blocks until everything this thread logged so far has been written to the target.
+            void flush();
+
+            /// number of records dropped because a queue was full.
+            std::uint64_t dropped() const { return m_Dropped.load(std::memory_order_relaxed); }
+
+        private:
+            bool push(const detail::Record& record)
+            {
+                if(local_queue().push(record)) return true;
+                m_Dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            detail::Queue& local_queue();
+            void run();
+
+            const std::uint64_t m_Id;
+            const std::size_t m_Capacity;
+            const std::size_t m_BatchBytes;
+            std::ostream& m_Target;
+
+            std::mutex m_QueuesMutex;
+            std::vector<std::unique_ptr<detail::Queue>> m_Queues;
+            std::unordered_map<std::thread::id, detail::Queue*> m_QueueOfThread;
+
+            std::mutex m_WakeMutex;
+            std::condition_variable m_Wake;
+            std::condition_variable m_Flushed;
+            std::uint64_t m_FlushRequested = 0;
+            std::uint64_t m_FlushDone = 0;
+            bool m_Stop = false;
+
+            std::atomic<std::uint64_t> m_Dropped{0};
+            std::thread m_Writer;
+        };
+    }
+}
+
+#endif //QUANTITY_LOGGING_HPP
@@ -0,0 +1,145 @@
+#ifndef QUANTITY_MAT_HPP
+#define QUANTITY_MAT_HPP
+
+#include <type_traits>
+#include "vec.hpp"
+
+namespace quantity {
+
+    /*! \brief Minimal class for a 3x3 matrix.
+     *  \details Like `Vec3`, this is templated so that the entries can carry units, e.g.
+     *  an inertia tensor `Mat3<Quantity<double, mass*area>>`. Multiplying a matrix of `A`
+     *  with a vector of `B` gives a vector of `A*B`.
+     */
+    template<class T>
+    struct Mat3
+    {
+        /// default constructor initializes to all zero.
+        constexpr Mat3() = default;
+
+        /// construct from three row vectors.
+        constexpr Mat3(const Vec3<T>& r0, const Vec3<T>& r1, const Vec3<T>& r2) :
+                m{{r0.x, r0.y, r0.z}, {r1.x, r1.y, r1.z}, {r2.x, r2.y, r2.z}}
+        {}
+
+        /// conversion constructor from a matrix of convertable types.
+        template<class S>
+        constexpr explicit Mat3(const Mat3<S>& o) : Mat3(Vec3<T>(o.row(0)), Vec3<T>(o.row(1)), Vec3<T>(o.row(2)))
+        {}
+
+        constexpr T& operator()(int i, int j) { return m[i][j]; }
+        constexpr const T& operator()(int i, int j) const { return m[i][j]; }
+
+        constexpr Vec3<T> row(int i) const { return Vec3<T>(m[i][0], m[i][1], m[i][2]); }
+        constexpr Vec3<T> column(int j) const { return Vec3<T>(m[0][j], m[1][j], m[2][j]); }
+
+        // the entries, row major
+        T m[3][3]{};
+    };
+
+    template<class T>
+    struct is_mat3 : std::false_type { };
+
+    template<class T>
+    struct is_mat3<Mat3<T>> : std::true_type { };
+
+    template<class T>
+    constexpr Mat3<T> make_matrix(const Vec3<T>& r0, const Vec3<T>& r1, const Vec3<T>& r2) {
+        return Mat3<T>(r0, r1, r2);
+    }
+
+    template<class T>
+    constexpr Mat3<T> diagonal_matrix(const T& a, const T& b, const T& c) {
+        return Mat3<T>(Vec3<T>(a, T{}, T{}), Vec3<T>(T{}, b, T{}), Vec3<T>(T{}, T{}, c));
+    }
+
+    template<class T = double>
+    constexpr Mat3<T> identity_matrix() {
+        return diagonal_matrix(T(1), T(1), T(1));
+    }
+
+    // operators
+    template<class T, class S>
+    constexpr auto operator+(const Mat3<T>& a, const Mat3<S>& b)
+    {
+        return make_matrix(a.row(0) + b.row(0), a.row(1) + b.row(1), a.row(2) + b.row(2));
+    }
+
+    template<class T, class S>
+    constexpr auto operator-(const Mat3<T>& a, const Mat3<S>& b)
+    {
+        return make_matrix(a.row(0) - b.row(0), a.row(1) - b.row(1), a.row(2) - b.row(2));
+    }
+
+    // Scalars only multiply from the left. A `Mat3 * S` template would also be picked up by
+    // the generic `S * Vec3` operator and make matrix-vector products ambiguous.
+    template<class S, class T, class = std::enable_if_t<!is_mat3<std::decay_t<S>>::value>>
+    constexpr auto operator*(S&& s, const Mat3<T>& a) -> decltype(make_matrix(s * a.row(0), s * a.row(1), s * a.row(2)))
+    {
+        return make_matrix(s * a.row(0), s * a.row(1), s * a.row(2));
+    }
+
+    template<class T, class S>
+    constexpr auto operator/(const Mat3<T>& a, S&& s)
+    {
+        return make_matrix(a.row(0) / s, a.row(1) / s, a.row(2) / s);
+    }
+
+    /// matrix-vector product, the entries of the result have dimension `mul_t<A, B>`.
+    template<class T, class S>
+    constexpr auto operator*(const Mat3<T>& a, const Vec3<S>& v)
+    {
+        return make_vector(a(0, 0) * v.x + a(0, 1) * v.y + a(0, 2) * v.z,
+                           a(1, 0) * v.x + a(1, 1) * v.y + a(1, 2) * v.z,
+                           a(2, 0) * v.x + a(2, 1) * v.y + a(2, 2) * v.z);
+    }
+
+    template<class T, class S>
+    constexpr auto operator*(const Mat3<T>& a, const Mat3<S>& b)
+    {
+        return make_matrix(make_vector(a(0, 0) * b(0, 0) + a(0, 1) * b(1, 0) + a(0, 2) * b(2, 0),
+                                       a(0, 0) * b(0, 1) + a(0, 1) * b(1, 1) + a(0, 2) * b(2, 1),
+                                       a(0, 0) * b(0, 2) + a(0, 1) * b(1, 2) + a(0, 2) * b(2, 2)),
+                           make_vector(a(1, 0) * b(0, 0) + a(1, 1) * b(1, 0) + a(1, 2) * b(2, 0),
+                                       a(1, 0) * b(0, 1) + a(1, 1) * b(1, 1) + a(1, 2) * b(2, 1),
+                                       a(1, 0) * b(0, 2) + a(1, 1) * b(1, 2) + a(1, 2) * b(2, 2)),
+                           make_vector(a(2, 0) * b(0, 0) + a(2, 1) * b(1, 0) + a(2, 2) * b(2, 0),
+                                       a(2, 0) * b(0, 1) + a(2, 1) * b(1, 1) + a(2, 2) * b(2, 1),
+                                       a(2, 0) * b(0, 2) + a(2, 1) * b(1, 2) + a(2, 2) * b(2, 2)));
+    }
+
+    template<class T, class S>
+    constexpr bool operator==(const Mat3<T>& a, const Mat3<S>& b)
+    {
+        return a.row(0) == b.row(0) && a.row(1) == b.row(1) && a.row(2) == b.row(2);
+    }
+
+    template<class T, class S>
+    constexpr bool operator!=(const Mat3<T>& a, const Mat3<S>& b)
+    {
+        return !(a==b);
+    }
+
+    // utility functions
+    template<class T>
+    constexpr Mat3<T> transpose(const Mat3<T>& a)
+    {
+        return make_matrix(a.column(0), a.column(1), a.column(2));
+    }
+
+    template<class T>
+    constexpr auto trace(const Mat3<T>& a)
+    {
+        return a(0, 0) + a(1, 1) + a(2, 2);
+    }
+
+    template<class T>
+    constexpr auto determinant(const Mat3<T>& a)
+    {
+        return a(0, 0) * (a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1))
+             - a(0, 1) * (a(1, 0) * a(2, 2) - a(1, 2) * a(2, 0))
+             + a(0, 2) * (a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0));
+    }
+}
+
+#endif //QUANTITY_MAT_HPP
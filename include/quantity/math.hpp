@@ -0,0 +1,93 @@
+#ifndef QUANTITY_MATH_HPP
+#define QUANTITY_MATH_HPP
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+// Whether the compiler can tell constant evaluation apart from run time evaluation. Then `math::sqrt`
+// runs its constexpr implementation during compilation and `std::sqrt` otherwise.
+#if defined(__has_builtin)
+#   if __has_builtin(__builtin_is_constant_evaluated)
+#       define QUANTITY_HAS_CONSTANT_EVALUATED 1
+#   endif
+#elif defined(_MSC_VER) && _MSC_VER >= 1925
+#   define QUANTITY_HAS_CONSTANT_EVALUATED 1
+#endif
+
+namespace quantity
+{
+    /*!
+     * \brief `constexpr` versions of the math functions that the quantity arithmetic needs.
+     * \details The functions take arithmetic types only, like their `std::` counterparts, so that
+     *          `using math::sqrt;` followed by an unqualified call still finds the overloads of
+     *          custom number types by argument dependent lookup.
+     *
+     *          At run time `sqrt` calls `std::sqrt`. Compilers that cannot detect constant
+     *          evaluation (see `QUANTITY_HAS_CONSTANT_EVALUATED`) always do so, which makes `sqrt`
+     *          unusable in constant expressions there.
+     */
+    namespace math
+    {
+        namespace detail
+        {
+            constexpr bool is_constant_evaluated()
+            {
+#ifdef QUANTITY_HAS_CONSTANT_EVALUATED
+                return __builtin_is_constant_evaluated();
+#else
+                return false;
+#endif
+            }
+
+            /// square root by Newton iteration, for finite positive `x`.
+            template<class T>
+            constexpr T newton_sqrt(T x)
+            {
+                // scale into [1, 4) by powers of four, which is exact, so that a fixed start converges quickly
+                T scale = 1;
+                while(x >= T(4)) {
+                    x /= T(4);
+                    scale *= T(2);
+                }
+                while(x < T(1)) {
+                    x *= T(4);
+                    scale /= T(2);
+                }
+
+                T y = T(1.5);
+                for(int i = 0; i < 8; ++i) {
+                    T next = T(0.5) * (y + x / y);
+                    if(next == y) break;
+                    y = next;
+                }
+                return y * scale;
+            }
+        }
+
+        /// `std::sqrt` that can be evaluated at compile time.
+        template<class T, std::enable_if_t<std::is_floating_point<T>::value, int> = 0>
+        constexpr T sqrt(T x)
+        {
+            if(!detail::is_constant_evaluated()) return std::sqrt(x);
+            if(x != x || x == T(0) || x == std::numeric_limits<T>::infinity()) return x;
+            if(x < T(0)) return std::numeric_limits<T>::quiet_NaN();
+            return detail::newton_sqrt(x);
+        }
+
+        template<class T, std::enable_if_t<std::is_integral<T>::value, int> = 0>
+        constexpr double sqrt(T x)
+        {
+            return math::sqrt(double(x));
+        }
+
+        /// `std::abs` that can be evaluated at compile time.
+        template<class T, std::enable_if_t<std::is_arithmetic<T>::value, int> = 0>
+        constexpr T abs(T x)
+        {
+            return x < T(0) ? T(-x) : (x == T(0) ? T(0) : x);
+        }
+    }
+}
+
+#endif //QUANTITY_MATH_HPP
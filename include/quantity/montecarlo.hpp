@@ -0,0 +1,298 @@
+#ifndef QUANTITY_MONTECARLO_HPP
+#define QUANTITY_MONTECARLO_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <boost/throw_exception.hpp>
+#include "quantity.hpp"
+#include "span.hpp"
+#include "statistics.hpp"
+#include "threading.hpp"
+#include "vec.hpp"
+
+namespace quantity
+{
+    /*!
+     * \brief Monte-Carlo propagation of uncertainties through computations on quantities.
+     * \details Inputs are described by distributions of `Quantity` or `Vec3<Quantity>` values.
+     *          A kernel, an ordinary function of these values, is evaluated for each sample and
+     *          the dimension-typed statistics of its results are returned.
+     *
+     *          Random numbers come from the counter-based Philox4x32-10 generator: the numbers of
+     *          sample `i` are a function of the seed, `i` and the input they belong to. Results
+     *          therefore do not depend on how the samples are split between threads, and since the
+     *          statistics of fixed batches are merged in order, they are reproducible bit for bit
+     *          for any thread count.
+     */
+    namespace montecarlo
+    {
+        namespace detail
+        {
+            inline void mulhilo(std::uint32_t a, std::uint32_t b, std::uint32_t& hi, std::uint32_t& lo)
+            {
+                std::uint64_t product = std::uint64_t(a) * b;
+                hi = std::uint32_t(product >> 32);
+                lo = std::uint32_t(product);
+            }
+        }
+
+        using Counter = std::array<std::uint32_t, 4>;
+        using Key = std::array<std::uint32_t, 2>;
+
+        /// the Philox4x32-10 bijection of Salmon et al., "Parallel random numbers: as easy as 1, 2, 3".
+        inline Counter philox(Counter c, Key k)
+        {
+            for(int round = 0; round < 10; ++round) {
+                std::uint32_t hi0, lo0, hi1, lo1;
+                detail::mulhilo(0xD2511F53u, c[0], hi0, lo0);
+                detail::mulhilo(0xCD9E8D57u, c[2], hi1, lo1);
+                c = Counter{hi1 ^ c[1] ^ k[0], lo1, hi0 ^ c[3] ^ k[1], lo0};
+                k[0] += 0x9E3779B9u;
+                k[1] += 0xBB67AE85u;
+            }
+            return c;
+        }
+
+        /// two uniform numbers in [0, 1) with 53 random bits each.
+        inline std::array<double, 2> uniform_pair(const Counter& bits)
+        {
+            const double scale = 1.0 / 9007199254740992.0;   // 2^-53
+            std::uint64_t a = (std::uint64_t(bits[0]) << 32 | bits[1]) >> 11;
+            std::uint64_t b = (std::uint64_t(bits[2]) << 32 | bits[3]) >> 11;
+            return {double(a) * scale, double(b) * scale};
+        }
+
+        /// A normal distribution of a `Quantity` or, component-wise, of a `Vec3<Quantity>`.
+        template<class T>
+        struct Normal
+        {
+            using value_type = T;
+            T mean;
+            T stddev;
+        };
+
+        /// A uniform distribution in `[low, high)`, for vectors component-wise.
+        template<class T>
+        struct Uniform
+        {
+            using value_type = T;
+            T low;
+            T high;
+        };
+
+        template<class T>
+        Normal<T> normal(const T& mean, const T& stddev)
+        {
+            return Normal<T>{mean, stddev};
+        }
+
+        template<class T>
+        Uniform<T> uniform(const T& low, const T& high)
+        {
+            return Uniform<T>{low, high};
+        }
+
+        namespace detail
+        {
+            /// two samples from the two uniform numbers `u`.
+            template<class B, class D>
+            void draw(const Normal<Quantity<B, D>>& d, const std::array<double, 2>& u, B* out)
+            {
+                // Box-Muller, 1 - u is in (0, 1]
+                const double two_pi = 6.283185307179586;
+                const double r = std::sqrt(-2.0 * std::log(1.0 - u[0]));
+                out[0] = d.mean.value + d.stddev.value * B(r * std::cos(two_pi * u[1]));
+                out[1] = d.mean.value + d.stddev.value * B(r * std::sin(two_pi * u[1]));
+            }
+
+            template<class B, class D>
+            void draw(const Uniform<Quantity<B, D>>& d, const std::array<double, 2>& u, B* out)
+            {
+                out[0] = d.low.value + (d.high.value - d.low.value) * B(u[0]);
+                out[1] = d.low.value + (d.high.value - d.low.value) * B(u[1]);
+            }
+
+            /// how samples of a distribution are stored in a batch and handed to the kernel.
+            template<class Dist, class T = typename Dist::value_type>
+            struct input_traits;
+
+            template<class Dist, class B, class D>
+            struct input_traits<Dist, Quantity<B, D>>
+            {
+                static constexpr std::size_t components = 1;
+                using base_t = B;
+
+                static const Dist& component(const Dist& d, std::size_t) { return d; }
+
+                static Quantity<B, D> load(const B* const* columns, std::size_t i)
+                {
+                    return Quantity<B, D>(columns[0][i]);
+                }
+            };
+
+            template<template<class> class Dist, class B, class D>
+            struct input_traits<Dist<Vec3<Quantity<B, D>>>, Vec3<Quantity<B, D>>>
+            {
+                static constexpr std::size_t components = 3;
+                using base_t = B;
+
+                static Dist<Quantity<B, D>> component(const Dist<Vec3<Quantity<B, D>>>& d, std::size_t c)
+                {
+                    auto pick = [c](const Vec3<Quantity<B, D>>& v) { return c == 0 ? v.x : (c == 1 ? v.y : v.z); };
+                    return Dist<Quantity<B, D>>{pick(std::get<0>(as_tuple(d))), pick(std::get<1>(as_tuple(d)))};
+                }
+
+                static Vec3<Quantity<B, D>> load(const B* const* columns, std::size_t i)
+                {
+                    return make_vector(Quantity<B, D>(columns[0][i]), Quantity<B, D>(columns[1][i]),
+                                       Quantity<B, D>(columns[2][i]));
+                }
+
+            private:
+                template<class T>
+                static std::tuple<T, T> as_tuple(const Normal<T>& d) { return std::make_tuple(d.mean, d.stddev); }
+                template<class T>
+                static std::tuple<T, T> as_tuple(const Uniform<T>& d) { return std::make_tuple(d.low, d.high); }
+            };
+        }
+
+        /// Parameters of a Monte-Carlo run.
+        struct Options
+        {
+            /// selects the random numbers; equal seeds give identical results.
+            std::uint64_t seed = 0;
+
+            /// Number of threads to use, 0 means one per hardware thread.
+            unsigned threads = 0;
+        };
+
+        /// number of samples that are generated, evaluated and summarized together. Has to be even.
+        constexpr std::size_t BATCH = 256;
+
+        namespace detail
+        {
+            template<class... Dist>
+            constexpr std::size_t sum_components()
+            {
+                std::size_t total = 0;
+                std::size_t counts[] = {0, input_traits<Dist>::components...};
+                for(std::size_t c : counts) total += c;
+                return total;
+            }
+
+            template<class Dist, class B>
+            void fill(const Dist& input, const Key& key, std::uint32_t stream, std::size_t begin, std::size_t count,
+                      B* storage, std::size_t& column)
+            {
+                using traits = input_traits<Dist>;
+                for(std::size_t c = 0; c < traits::components; ++c, ++column) {
+                    auto d = traits::component(input, c);
+                    B* out = storage + column * BATCH;
+                    // one random number block gives the values of two consecutive samples
+                    B pair[2];
+                    for(std::size_t i = 0; i < count; i += 2) {
+                        std::uint64_t index = (begin + i) / 2;
+                        Counter counter{std::uint32_t(index), std::uint32_t(index >> 32), stream, std::uint32_t(c)};
+                        draw(d, uniform_pair(philox(counter, key)), pair);
+                        out[i] = pair[0];
+                        if(i + 1 < count) out[i + 1] = pair[1];
+                    }
+                }
+            }
+
+            template<class... Dist, class F, class B, std::size_t... I>
+            auto evaluate(F& kernel, const B* const* columns, std::size_t i, std::index_sequence<I...>)
+            {
+                constexpr std::size_t widths[] = {input_traits<Dist>::components...};
+                std::size_t offsets[sizeof...(Dist) + 1] = {0};
+                for(std::size_t k = 0; k < sizeof...(Dist); ++k) offsets[k + 1] = offsets[k] + widths[k];
+                return kernel(input_traits<Dist>::load(columns + offsets[I], i)...);
+            }
+
+            /// draws and evaluates batch by batch, calling `consume(batch index, results)` for each.
+            template<class F, class C, class... Dist>
+            void run_batches(std::size_t samples, const Options& options, F& kernel, C&& consume,
+                             const Dist&... inputs)
+            {
+                using result_t = std::decay_t<decltype(kernel(std::declval<typename Dist::value_type>()...))>;
+                constexpr std::size_t columns = sum_components<Dist...>();
+                const Key key{std::uint32_t(options.seed), std::uint32_t(options.seed >> 32)};
+                const std::size_t batches = (samples + BATCH - 1) / BATCH;
+
+                threading::for_chunks(batches, [&](std::size_t first, std::size_t last) {
+                    using base_t = std::common_type_t<typename input_traits<Dist>::base_t...>;
+                    std::vector<base_t> storage(columns * BATCH);
+                    std::array<const base_t*, columns> column_ptr;
+                    for(std::size_t c = 0; c < columns; ++c) column_ptr[c] = storage.data() + c * BATCH;
+                    std::vector<result_t> results(BATCH);
+
+                    for(std::size_t b = first; b < last; ++b) {
+                        const std::size_t begin = b * BATCH;
+                        const std::size_t count = std::min(BATCH, samples - begin);
+
+                        // draw the inputs column by column
+                        std::size_t column = 0;
+                        std::uint32_t stream = 0;
+                        int expand[] = {0, (fill(inputs, key, stream++, begin, count,
+                                                 storage.data(), column), 0)...};
+                        (void)expand;
+
+                        for(std::size_t i = 0; i < count; ++i) {
+                            results[i] = evaluate<Dist...>(kernel, column_ptr.data(), i,
+                                                           std::index_sequence_for<Dist...>{});
+                        }
+                        consume(b, Span<const result_t>(results.data(), count));
+                    }
+                }, options.threads, 4);
+            }
+        }
+
+        /*!
+         * \brief Evaluates `kernel` for `samples` draws of the `inputs` and returns the statistics
+         *        of the results.
+         * \details The kernel is called with one value per input distribution, in order, and may
+         *          return a `Quantity` or a `Vec3<Quantity>`. Inputs are drawn in batches of
+         *          `BATCH` samples into one array per component before the kernel runs over them.
+         */
+        template<class F, class... Dist>
+        auto propagate(std::size_t samples, const Options& options, F kernel, const Dist&... inputs)
+        {
+            using result_t = std::decay_t<decltype(kernel(std::declval<typename Dist::value_type>()...))>;
+            using stats_t = statistics::RunningStats<result_t>;
+            if(samples == 0) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Monte-Carlo propagation needs at least one sample"));
+            }
+
+            std::vector<stats_t> partial((samples + BATCH - 1) / BATCH);
+            detail::run_batches(samples, options, kernel, [&](std::size_t b, Span<const result_t> results) {
+                partial[b].add(results);
+            }, inputs...);
+
+            // merge in batch order, so that the result does not depend on the threads
+            stats_t result;
+            for(const auto& p : partial) result.merge(p);
+            return result;
+        }
+
+        /// like `propagate`, but returns the result of every sample, e.g. to compute quantiles.
+        template<class F, class... Dist>
+        auto sample(std::size_t samples, const Options& options, F kernel, const Dist&... inputs)
+        {
+            using result_t = std::decay_t<decltype(kernel(std::declval<typename Dist::value_type>()...))>;
+            std::vector<result_t> out(samples);
+            detail::run_batches(samples, options, kernel, [&](std::size_t b, Span<const result_t> results) {
+                std::copy(results.begin(), results.end(), out.begin() + std::ptrdiff_t(b * BATCH));
+            }, inputs...);
+            return out;
+        }
+    }
+}
+
+#endif //QUANTITY_MONTECARLO_HPP
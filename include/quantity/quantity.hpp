@@ -6,10 +6,24 @@
 #define SPACEPHYS_QUANTITY_HPP
 
 #include "dimension.hpp"
+#include "math.hpp"
 #include <cmath>
 
 namespace quantity
 {
+    namespace detail
+    {
+        /// blocks template argument deduction, so that a scalar only has to convert to the value type.
+        template<class T>
+        struct non_deduced
+        {
+            using type = T;
+        };
+
+        template<class T>
+        using non_deduced_t = typename non_deduced<T>::type;
+    }
+
     /*!
      * \brief A small wrapper around a numerical type T that amends it with dimension information.
      * \tparam T Numerical type to be wrapped.
@@ -88,14 +102,14 @@ namespace quantity
     // --------------------------------------------------------------------------------
     //   scalar multiplication
     template<class T, class U>
-    constexpr Quantity<T, U>& operator*=(Quantity<T, U>& a, const T& factor)
+    constexpr Quantity<T, U>& operator*=(Quantity<T, U>& a, const detail::non_deduced_t<T>& factor)
     {
         a.value *= factor;
         return a;
     }
 
     template<class T, class U>
-    constexpr Quantity<T, U> operator*(const Quantity<T, U>& a, const T& f)
+    constexpr Quantity<T, U> operator*(const Quantity<T, U>& a, const detail::non_deduced_t<T>& f)
     {
         auto c = a;
         c *= f;
@@ -103,13 +117,13 @@ namespace quantity
     }
 
     template<class T, class U>
-    constexpr Quantity<T, U> operator/(const Quantity<T, U>& a, const T& f)
+    constexpr Quantity<T, U> operator/(const Quantity<T, U>& a, const detail::non_deduced_t<T>& f)
     {
         return a * (T(1)/f);
     }
 
     template<class T, class U>
-    constexpr Quantity<T, U> operator*(const T& f, const Quantity<T, U>& a)
+    constexpr Quantity<T, U> operator*(const detail::non_deduced_t<T>& f, const Quantity<T, U>& a)
     {
         auto c = a;
         c *= f;
@@ -119,7 +133,7 @@ namespace quantity
 
     // unit multiplication
     template<class T, class U, class V>
-    Quantity<T, dimensions::ops::mul_t<U, V>>
+    constexpr Quantity<T, dimensions::ops::mul_t<U, V>>
     operator*( const Quantity<T, U>& a, const Quantity<T, V>& b)
     {
         return Quantity<T, dimensions::ops::mul_t<U, V>> (a.value * b.value);
@@ -176,17 +190,19 @@ namespace quantity
         return !(a==b);
     }
 
-    // some math functions
+    // some math functions, found by argument dependent lookup for custom value types
     template<class U, class V>
-    auto sqrt( const Quantity<U, V>& s )
+    constexpr auto sqrt( const Quantity<U, V>& s )
     {
-        return Quantity<U, dimensions::ops::pow_t<V, 1, 2>>( std::sqrt(s.value) );
+        using math::sqrt;
+        return Quantity<U, dimensions::ops::pow_t<V, 1, 2>>( sqrt(s.value) );
     }
 
     template<class U, class V>
-    auto abs( const Quantity<U, V>& s )
+    constexpr auto abs( const Quantity<U, V>& s )
     {
-        return Quantity<U, V>( std::abs(s.value) );
+        using math::abs;
+        return Quantity<U, V>( abs(s.value) );
     }
 }
 
@@ -0,0 +1,315 @@
+#ifndef QUANTITY_QUANTIZED_HPP
+#define QUANTITY_QUANTIZED_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <boost/throw_exception.hpp>
+#include "quantity.hpp"
+#include "runtime.hpp"
+#include "span.hpp"
+#include "threading.hpp"
+
+namespace quantity
+{
+    /// Payload formats of a `QuantizedArray`.
+    enum class Encoding
+    {
+        INT16,      //!< 16 bit integers between the block minimum and maximum, constant absolute error.
+        FLOAT16     //!< IEEE half precision scaled by a power of two per block, about 3 significant digits.
+    };
+
+    namespace detail
+    {
+        inline std::uint32_t float_bits(float f)
+        {
+            std::uint32_t u;
+            std::memcpy(&u, &f, sizeof(u));
+            return u;
+        }
+
+        inline float bits_float(std::uint32_t u)
+        {
+            float f;
+            std::memcpy(&f, &u, sizeof(f));
+            return f;
+        }
+
+        /// float to half precision with round to nearest even, without branches on the normal path.
+        inline std::uint16_t float_to_half(float f)
+        {
+            const std::uint32_t f32_infinity = 255u << 23;
+            const std::uint32_t f16_max = (127u + 16u) << 23;
+            const std::uint32_t denorm_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+            std::uint32_t u = float_bits(f);
+            const std::uint32_t sign = u & 0x80000000u;
+            u ^= sign;
+
+            std::uint16_t h;
+            if(u >= f16_max) {
+                h = u > f32_infinity ? 0x7e00 : 0x7c00;
+            } else if(u < (113u << 23)) {
+                // subnormal half, let the floating point addition do the rounding
+                h = std::uint16_t(float_bits(bits_float(u) + bits_float(denorm_magic)) - denorm_magic);
+            } else {
+                std::uint32_t mantissa_odd = (u >> 13) & 1u;
+                u += (std::uint32_t(15 - 127) << 23) + 0xfffu;
+                u += mantissa_odd;
+                h = std::uint16_t(u >> 13);
+            }
+            return std::uint16_t(h | (sign >> 16));
+        }
+
+        inline float half_to_float(std::uint16_t h)
+        {
+            const std::uint32_t shifted_exponent = 0x7c00u << 13;
+            std::uint32_t u = (std::uint32_t(h) & 0x7fffu) << 13;
+            const std::uint32_t exponent = shifted_exponent & u;
+            u += (127u - 15u) << 23;
+            if(exponent == shifted_exponent) {
+                u += (128u - 16u) << 23;
+            } else if(exponent == 0) {
+                u += 1u << 23;
+                u = float_bits(bits_float(u) - bits_float(113u << 23));
+            }
+            return bits_float(u | ((std::uint32_t(h) & 0x8000u) << 16));
+        }
+    }
+
+    template<class Q>
+    class QuantizedArray;
+
+    /*!
+     * \brief Read-mostly array of quantities stored with 16 bits per value.
+     * \details Values are split into blocks of `BLOCK` elements that share an offset and a
+     *          scale, so the payload takes a quarter of the memory of `double`s. The dimension
+     *          is recorded once for the whole array as a `runtime::Dimension`. Quantization and
+     *          dequantization are plain loops over contiguous blocks that the compiler can
+     *          vectorize, spread over threads for large arrays.
+     *
+     *          `error_bound` gives the largest absolute error of any value of a block, which is
+     *          half a quantization step for `INT16` and half an ulp of the largest value for
+     *          `FLOAT16`.
+     */
+    template<class B, class D>
+    class QuantizedArray<Quantity<B, D>>
+    {
+        static_assert(std::is_floating_point<B>::value, "quantized arrays hold floating point quantities");
+    public:
+        using value_type = Quantity<B, D>;
+
+        /// number of values that share a scale.
+        static constexpr std::size_t BLOCK = 512;
+
+        explicit QuantizedArray(Encoding encoding = Encoding::INT16) : m_Encoding(encoding) { }
+
+        QuantizedArray(Span<const value_type> values, Encoding encoding = Encoding::INT16, unsigned threads = 0) :
+                m_Encoding(encoding)
+        {
+            assign(values, threads);
+        }
+
+        /// quantizes `values`, replacing the current contents. Throws std::domain_error for non-finite values.
+        void assign(Span<const value_type> values, unsigned threads = 0)
+        {
+            const std::size_t blocks = (values.size() + BLOCK - 1) / BLOCK;
+            m_Size = values.size();
+            m_Payload.resize(m_Size);
+            m_Blocks.resize(blocks);
+
+            std::atomic<bool> finite{true};
+            threading::for_chunks(blocks, [&](std::size_t first, std::size_t last) {
+                bool ok = true;
+                for(std::size_t b = first; b < last; ++b) {
+                    ok = quantize_block(values, b) && ok;
+                }
+                if(!ok) finite.store(false);
+            }, threads, MIN_CHUNK);
+
+            if(!finite.load()) {
+                clear();
+                BOOST_THROW_EXCEPTION(std::domain_error("Cannot quantize non-finite values"));
+            }
+        }
+
+        /// writes all values into `out`, which needs to have `size()` elements.
+        void dequantize(Span<value_type> out, unsigned threads = 0) const
+        {
+            if(out.size() != m_Size) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Output size does not match the quantized array"));
+            }
+            threading::for_chunks(m_Blocks.size(), [&](std::size_t first, std::size_t last) {
+                for(std::size_t b = first; b < last; ++b) {
+                    std::size_t begin = b * BLOCK;
+                    dequantize_block(b, out.subspan(begin, std::min(BLOCK, m_Size - begin)));
+                }
+            }, threads, MIN_CHUNK);
+        }
+
+        /// dequantizes the values `[offset, offset + out.size())`.
+        void dequantize(std::size_t offset, Span<value_type> out) const
+        {
+            if(offset + out.size() > m_Size) {
+                BOOST_THROW_EXCEPTION(std::out_of_range("Range exceeds the quantized array"));
+            }
+            std::size_t done = 0;
+            while(done < out.size()) {
+                std::size_t i = offset + done;
+                std::size_t b = i / BLOCK;
+                std::size_t count = std::min(out.size() - done, (b + 1) * BLOCK - i);
+                const Scale& s = m_Blocks[b];
+                for(std::size_t k = 0; k < count; ++k) {
+                    out[done + k].value = decode(s, m_Payload[i + k]);
+                }
+                done += count;
+            }
+        }
+
+        value_type operator[](std::size_t i) const
+        {
+            return value_type(decode(m_Blocks[i / BLOCK], m_Payload[i]));
+        }
+
+        std::size_t size() const { return m_Size; }
+        bool empty() const { return m_Size == 0; }
+        Encoding encoding() const { return m_Encoding; }
+        static runtime::Dimension dimension() { return runtime::to_dynamic(D{}); }
+
+        /// memory used by payload and block scales, in bytes.
+        std::size_t bytes() const
+        {
+            return m_Payload.size() * sizeof(std::uint16_t) + m_Blocks.size() * sizeof(Scale);
+        }
+
+        /// largest absolute error of the values in the block of element `i`.
+        value_type error_bound(std::size_t i) const
+        {
+            return value_type(block_error(m_Blocks.at(i / BLOCK)));
+        }
+
+        /// largest absolute error of any value.
+        value_type max_error() const
+        {
+            B e = 0;
+            for(const auto& s : m_Blocks) e = std::max(e, block_error(s));
+            return value_type(e);
+        }
+
+        void clear()
+        {
+            m_Size = 0;
+            m_Payload.clear();
+            m_Blocks.clear();
+        }
+
+    private:
+        static constexpr std::size_t MIN_CHUNK = 64;
+
+        struct Scale
+        {
+            B offset;
+            B scale;
+        };
+
+        /// error bound of a block, derived from its scale instead of being stored.
+        B block_error(const Scale& s) const
+        {
+            const B eps = 4 * std::numeric_limits<B>::epsilon();
+            if(m_Encoding == Encoding::INT16) {
+                const B magnitude = std::abs(s.offset) + s.scale * B(32767);
+                return s.scale / 2 + magnitude * eps;
+            }
+            // half an ulp of half precision in [0.5, 1) is 2^-12, plus the rounding to float on the way
+            return s.scale * (B(std::ldexp(1.0, -12) + std::ldexp(1.0, -24)) + eps);
+        }
+
+        B decode(const Scale& s, std::uint16_t q) const
+        {
+            if(m_Encoding == Encoding::INT16) {
+                return s.offset + s.scale * B(std::int16_t(q));
+            }
+            return s.scale * B(detail::half_to_float(q));
+        }
+
+        bool quantize_block(Span<const value_type> values, std::size_t b)
+        {
+            const std::size_t begin = b * BLOCK;
+            const std::size_t count = std::min(BLOCK, m_Size - begin);
+            const value_type* in = values.data() + begin;
+            std::uint16_t* out = m_Payload.data() + begin;
+
+            B lo = in[0].value;
+            B hi = in[0].value;
+            B nan_check = 0;    // becomes NaN if any value is infinite or NaN
+            for(std::size_t i = 0; i < count; ++i) {
+                lo = std::min(lo, in[i].value);
+                hi = std::max(hi, in[i].value);
+                nan_check += in[i].value * 0;
+            }
+            if(nan_check != 0 || !std::isfinite(hi - lo)) return false;
+
+            Scale& s = m_Blocks[b];
+            if(m_Encoding == Encoding::INT16) {
+                s.offset = lo / 2 + hi / 2;
+                s.scale = (hi / 2 - lo / 2) / B(32767);
+                const B inverse = s.scale > 0 ? 1 / s.scale : B(0);
+                for(std::size_t i = 0; i < count; ++i) {
+                    B t = (in[i].value - s.offset) * inverse;
+                    t = std::min(std::max(t, B(-32767)), B(32767));
+                    out[i] = std::uint16_t(std::int16_t(t + (t >= 0 ? B(0.5) : B(-0.5))));
+                }
+            } else {
+                // scale the largest magnitude into [0.5, 1), the top binade of half precision is not used
+                int exponent = 0;
+                std::frexp(std::max(std::abs(lo), std::abs(hi)), &exponent);
+                s.offset = 0;
+                s.scale = std::ldexp(B(1), exponent);
+                const B inverse = std::ldexp(B(1), -exponent);
+                for(std::size_t i = 0; i < count; ++i) {
+                    out[i] = detail::float_to_half(float(in[i].value * inverse));
+                }
+            }
+            return true;
+        }
+
+        void dequantize_block(std::size_t b, Span<value_type> out) const
+        {
+            const Scale s = m_Blocks[b];
+            const std::uint16_t* in = m_Payload.data() + b * BLOCK;
+            const std::size_t count = out.size();
+            if(m_Encoding == Encoding::INT16) {
+                for(std::size_t i = 0; i < count; ++i) {
+                    out[i].value = s.offset + s.scale * B(std::int16_t(in[i]));
+                }
+            } else {
+                for(std::size_t i = 0; i < count; ++i) {
+                    out[i].value = s.scale * B(detail::half_to_float(in[i]));
+                }
+            }
+        }
+
+        Encoding m_Encoding;
+        std::size_t m_Size = 0;
+        std::vector<std::uint16_t> m_Payload;
+        std::vector<Scale> m_Blocks;
+    };
+
+    template<class B, class D>
+    constexpr std::size_t QuantizedArray<Quantity<B, D>>::BLOCK;
+
+    /// creation function that deduces the quantity type from a contiguous container.
+    template<class C>
+    QuantizedArray<typename C::value_type> quantize(const C& values, Encoding encoding = Encoding::INT16)
+    {
+        return QuantizedArray<typename C::value_type>(values, encoding);
+    }
+}
+
+#endif //QUANTITY_QUANTIZED_HPP
@@ -0,0 +1,155 @@
+#ifndef QUANTITY_QUAT_HPP
+#define QUANTITY_QUAT_HPP
+
+#include <cmath>
+#include <type_traits>
+#include "mat.hpp"
+
+namespace quantity {
+
+    /*! \brief Minimal quaternion class `w + xi + yj + zk`.
+     *  \details Templated like `Vec3`. Rotations are described by dimensionless unit
+     *  quaternions, but products of general quaternions keep track of the dimensions
+     *  of their components.
+     */
+    template<class T>
+    struct Quat
+    {
+        /// default constructor initializes to all zero.
+        constexpr Quat() = default;
+
+        constexpr Quat(const T& w_, const T& x_, const T& y_, const T& z_) : w(w_), x(x_), y(y_), z(z_)
+        {}
+
+        /// construct from scalar and vector part.
+        constexpr Quat(const T& w_, const Vec3<T>& v) : w(w_), x(v.x), y(v.y), z(v.z)
+        {}
+
+        /// the vector (imaginary) part.
+        constexpr Vec3<T> vec() const { return Vec3<T>(x, y, z); }
+
+        // the components
+        T w{0};
+        T x{0};
+        T y{0};
+        T z{0};
+    };
+
+    template<class T>
+    struct is_quat : std::false_type { };
+
+    template<class T>
+    struct is_quat<Quat<T>> : std::true_type { };
+
+    template<class T>
+    constexpr Quat<T> make_quaternion(const T& w, const T& x, const T& y, const T& z) {
+        return Quat<T>(w, x, y, z);
+    }
+
+    template<class T = double>
+    constexpr Quat<T> identity_quaternion() {
+        return Quat<T>(T(1), T(0), T(0), T(0));
+    }
+
+    /// rotation by `angle` (in radians) around the unit vector `axis`.
+    template<class T>
+    Quat<T> axis_angle(const Vec3<T>& axis, const T& angle)
+    {
+        using std::cos;
+        using std::sin;
+        T half = angle / T(2);
+        return Quat<T>(cos(half), sin(half) * axis);
+    }
+
+    // operators
+    template<class T, class S>
+    constexpr auto operator+(const Quat<T>& a, const Quat<S>& b)
+    {
+        return make_quaternion(a.w + b.w, a.x + b.x, a.y + b.y, a.z + b.z);
+    }
+
+    template<class T, class S>
+    constexpr auto operator-(const Quat<T>& a, const Quat<S>& b)
+    {
+        return make_quaternion(a.w - b.w, a.x - b.x, a.y - b.y, a.z - b.z);
+    }
+
+    // As for `Mat3`, scalars only multiply from the left.
+    template<class S, class T, class = std::enable_if_t<!is_quat<std::decay_t<S>>::value>>
+    constexpr auto operator*(S&& s, const Quat<T>& a) -> decltype(make_quaternion(s * a.w, s * a.x, s * a.y, s * a.z))
+    {
+        return make_quaternion(s * a.w, s * a.x, s * a.y, s * a.z);
+    }
+
+    template<class T, class S>
+    constexpr auto operator/(const Quat<T>& a, S&& s)
+    {
+        return make_quaternion(a.w / s, a.x / s, a.y / s, a.z / s);
+    }
+
+    /// Hamilton product.
+    template<class T, class S>
+    constexpr auto operator*(const Quat<T>& a, const Quat<S>& b)
+    {
+        return make_quaternion(a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+                               a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                               a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                               a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w);
+    }
+
+    template<class T, class S>
+    constexpr bool operator==(const Quat<T>& a, const Quat<S>& b)
+    {
+        return a.w == b.w && a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+
+    template<class T, class S>
+    constexpr bool operator!=(const Quat<T>& a, const Quat<S>& b)
+    {
+        return !(a==b);
+    }
+
+    // utility functions
+    template<class T>
+    constexpr Quat<T> conjugate(const Quat<T>& q)
+    {
+        return Quat<T>(q.w, -q.x, -q.y, -q.z);
+    }
+
+    template<class T>
+    T norm(const Quat<T>& q)
+    {
+        using std::sqrt;
+        return sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+    }
+
+    template<class T>
+    auto normalized(const Quat<T>& q)
+    {
+        return q / norm(q);
+    }
+
+    /// rotates `v` by the unit quaternion `q`, i.e. computes `q v q*`.
+    template<class T, class S>
+    auto rotate(const Quat<T>& q, const Vec3<S>& v)
+    {
+        auto u = q.vec();
+        auto c = cross(u, v);
+        auto t = c + c;
+        return v + q.w * t + cross(u, t);
+    }
+
+    /// rotation matrix of the unit quaternion `q`.
+    template<class T>
+    constexpr Mat3<T> to_matrix(const Quat<T>& q)
+    {
+        const T one(1);
+        const T two(2);
+        return make_matrix(
+                make_vector(one - two * (q.y * q.y + q.z * q.z), two * (q.x * q.y - q.w * q.z), two * (q.x * q.z + q.w * q.y)),
+                make_vector(two * (q.x * q.y + q.w * q.z), one - two * (q.x * q.x + q.z * q.z), two * (q.y * q.z - q.w * q.x)),
+                make_vector(two * (q.x * q.z - q.w * q.y), two * (q.y * q.z + q.w * q.x), one - two * (q.x * q.x + q.y * q.y)));
+    }
+}
+
+#endif //QUANTITY_QUAT_HPP
@@ -0,0 +1,391 @@
+#ifndef QUANTITY_RESAMPLE_HPP
+#define QUANTITY_RESAMPLE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <boost/throw_exception.hpp>
+#include "predefined.hpp"
+#include "span.hpp"
+#include "threading.hpp"
+#include "vec_array.hpp"
+
+namespace quantity
+{
+    /*!
+     * \brief Resampling of irregularly sampled streams of quantities onto a common time grid.
+     * \details Every `Channel` walks through its samples once, in time order, and keeps only the
+     *          last four of them. Each grid point is interpolated as soon as the samples that
+     *          determine it have arrived, so inputs can be fed in chunks of any size and memory
+     *          stays bounded however long the streams are. An `Aligner` runs several channels,
+     *          feeding them in parallel, and hands out blocks of grid rows that every channel has
+     *          produced, with one column per channel in structure-of-arrays layout.
+     *
+     *          Grid points before the first sample of a channel are not produced, neither are
+     *          points after its last sample.
+     */
+    namespace resample
+    {
+        using stamp_t = predefined::time_t;
+
+        enum class Interpolation
+        {
+            HOLD,     //!< value of the last sample at or before the grid point
+            LINEAR,
+            CUBIC     //!< cubic Hermite spline with Catmull-Rom tangents for uneven spacing
+        };
+
+        /// the equidistant grid `start + k * step`, `k = 0, 1, ...`.
+        struct Grid
+        {
+            stamp_t start;
+            stamp_t step;
+
+            stamp_t at(std::size_t k) const { return start + step * double(k); }
+
+            /// index of the first grid point at or after `t`.
+            std::size_t first_at_or_after(stamp_t t) const
+            {
+                if(t <= start) return 0;
+                return std::size_t(std::ceil(double((t - start) / step)));
+            }
+        };
+
+        /// the column type of a block: `Vec3Array` for vectors, `std::vector` otherwise.
+        template<class T>
+        struct column
+        {
+            using type = std::vector<T>;
+        };
+
+        template<class T>
+        struct column<Vec3<T>>
+        {
+            using type = Vec3Array<T>;
+        };
+
+        template<class T>
+        using column_t = typename column<T>::type;
+
+        /*!
+         * \brief Resamples one time sorted stream of `T` (a `Quantity` or `Vec3<Quantity>`).
+         * \details `push` interpolates every grid point that the new samples determine and appends
+         *          it to `output`, whose first element belongs to the grid point `output_begin`.
+         *          Consumers remove what they have used with `consume`.
+         */
+        template<class T>
+        class Channel
+        {
+        public:
+            Channel(Grid grid, Interpolation interpolation) : m_Grid(grid), m_Interpolation(interpolation)
+            {
+                if(!(grid.step > stamp_t(0))) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("The step of a resampling grid has to be positive"));
+                }
+            }
+
+            /// adds a sample, which must not be older than the previous one.
+            void push(stamp_t t, const T& value)
+            {
+                if(m_Count > 0 && t < m_Times[m_Count - 1]) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("Samples are not sorted by time"));
+                }
+                if(m_Finished) {
+                    BOOST_THROW_EXCEPTION(std::logic_error("Sample added to a finished channel"));
+                }
+                if(m_Started == false) {
+                    m_Started = true;
+                    m_Next = m_Grid.first_at_or_after(t);
+                    m_OutputBegin = m_Next;
+                }
+
+                if(m_Count == WINDOW) {
+                    std::move(m_Times.begin() + 1, m_Times.end(), m_Times.begin());
+                    std::move(m_Values.begin() + 1, m_Values.end(), m_Values.begin());
+                    --m_Count;
+                }
+                m_Times[m_Count] = t;
+                m_Values[m_Count] = value;
+                ++m_Count;
+                ++m_Samples;
+
+                if(m_Interpolation == Interpolation::CUBIC) {
+                    // the interval before the previous sample now has both of its tangents
+                    if(m_Count >= 3) emit_interval(m_Count - 3);
+                } else if(m_Count >= 2) {
+                    emit_interval(m_Count - 2);
+                }
+            }
+
+            void push(Span<const stamp_t> times, Span<const T> values)
+            {
+                if(times.size() != values.size()) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("Times and values differ in length"));
+                }
+                for(std::size_t i = 0; i < times.size(); ++i) push(times[i], values[i]);
+            }
+
+            /// marks the end of the stream and produces the grid points up to the last sample.
+            void finish()
+            {
+                if(m_Finished) return;
+                m_Finished = true;
+                if(m_Count == 0) return;
+                if(m_Interpolation == Interpolation::CUBIC && m_Count >= 2) emit_interval(m_Count - 2);
+                // a grid point on the last sample
+                while(m_Grid.at(m_Next) <= m_Times[m_Count - 1]) {
+                    m_Output.push_back(m_Values[m_Count - 1]);
+                    ++m_Next;
+                }
+            }
+
+            bool finished() const { return m_Finished; }
+
+            /// number of samples pushed so far.
+            std::size_t samples() const { return m_Samples; }
+
+            /// grid index of the first element of `output`.
+            std::size_t output_begin() const { return m_OutputBegin; }
+
+            /// grid index after the last element of `output`.
+            std::size_t output_end() const { return m_OutputBegin + m_Output.size(); }
+
+            const std::vector<T>& output() const { return m_Output; }
+
+            /// drops the output up to, but excluding, grid index `end`.
+            void consume(std::size_t end)
+            {
+                end = std::min(std::max(end, m_OutputBegin), output_end());
+                m_Output.erase(m_Output.begin(), m_Output.begin() + std::ptrdiff_t(end - m_OutputBegin));
+                m_OutputBegin = end;
+            }
+
+        private:
+            static constexpr std::size_t WINDOW = 4;
+
+            /// produces the grid points in `[t_i, t_{i+1})`, `i` indexing the window.
+            void emit_interval(std::size_t i)
+            {
+                const stamp_t t0 = m_Times[i];
+                const stamp_t t1 = m_Times[i + 1];
+                const stamp_t dt = t1 - t0;
+                for(stamp_t g = m_Grid.at(m_Next); g < t1; g = m_Grid.at(++m_Next)) {
+                    // rounding can put the first grid point marginally before the first sample
+                    const double s = g < t0 ? 0.0 : double((g - t0) / dt);
+                    switch(m_Interpolation) {
+                        case Interpolation::HOLD:
+                            m_Output.push_back(m_Values[i]);
+                            break;
+                        case Interpolation::LINEAR:
+                            m_Output.push_back(m_Values[i] + (m_Values[i + 1] - m_Values[i]) * s);
+                            break;
+                        case Interpolation::CUBIC:
+                            m_Output.push_back(hermite(i, s));
+                            break;
+                    }
+                }
+            }
+
+            /// tangent at window sample `i`, scaled to the interval `[t_i0, t_i0+1)`.
+            T tangent(std::size_t i, std::size_t i0) const
+            {
+                const std::size_t lo = i > 0 ? i - 1 : i;
+                const std::size_t hi = i + 1 < m_Count ? i + 1 : i;
+                const stamp_t span = m_Times[hi] - m_Times[lo];
+                if(!(span > stamp_t(0))) return T{};
+                return (m_Values[hi] - m_Values[lo]) * double((m_Times[i0 + 1] - m_Times[i0]) / span);
+            }
+
+            T hermite(std::size_t i, double s) const
+            {
+                const double s2 = s * s;
+                const double s3 = s2 * s;
+                const double h00 = 2 * s3 - 3 * s2 + 1;
+                const double h10 = s3 - 2 * s2 + s;
+                const double h01 = -2 * s3 + 3 * s2;
+                const double h11 = s3 - s2;
+                return m_Values[i] * h00 + tangent(i, i) * h10 + m_Values[i + 1] * h01 + tangent(i + 1, i) * h11;
+            }
+
+            Grid m_Grid;
+            Interpolation m_Interpolation;
+
+            std::array<stamp_t, WINDOW> m_Times;
+            std::array<T, WINDOW> m_Values;
+            std::size_t m_Count = 0;
+            std::size_t m_Samples = 0;
+            bool m_Started = false;
+            bool m_Finished = false;
+
+            std::size_t m_Next = 0;    //!< the next grid point to produce
+            std::vector<T> m_Output;
+            std::size_t m_OutputBegin = 0;
+        };
+
+        /// a chunk of samples of one channel.
+        template<class T>
+        struct Input
+        {
+            Span<const stamp_t> times;
+            Span<const T> values;
+        };
+
+        /// rows `[first, first + size())` of the grid with one column per channel.
+        template<class... Ts>
+        struct Block
+        {
+            std::size_t first = 0;
+            std::vector<stamp_t> times;
+            std::tuple<column_t<Ts>...> columns;
+
+            std::size_t size() const { return times.size(); }
+
+            template<std::size_t I>
+            const auto& column() const { return std::get<I>(columns); }
+        };
+
+        /*!
+         * \brief Aligns several channels of different types on one grid.
+         * \details `feed` passes one chunk to every channel, processing the channels on parallel
+         *          threads. `drain` then hands out the grid rows that all channels have produced.
+         *          A channel that runs ahead of the others keeps its extra rows until they are
+         *          complete, so memory is bounded by the size of the chunks and by how far the
+         *          inputs are apart in time.
+         */
+        template<class... Ts>
+        class Aligner
+        {
+        public:
+            static constexpr std::size_t CHANNELS = sizeof...(Ts);
+
+            Aligner(Grid grid, Interpolation interpolation, unsigned threads = 0) :
+                    Aligner(grid, filled(interpolation), threads)
+            {
+            }
+
+            Aligner(Grid grid, const std::array<Interpolation, CHANNELS>& interpolation, unsigned threads = 0) :
+                    Aligner(grid, interpolation, threads, std::index_sequence_for<Ts...>{})
+            {
+            }
+
+            template<std::size_t I>
+            auto& channel() { return std::get<I>(m_Channels); }
+
+            /// adds one chunk of samples to every channel.
+            void feed(const Input<Ts>&... inputs)
+            {
+                feed(std::index_sequence_for<Ts...>{}, inputs...);
+            }
+
+            /// ends all channels.
+            void finish()
+            {
+                for_each_channel([](auto& channel) { channel.finish(); });
+            }
+
+            /// calls `f(const Block<Ts...>&)` with the rows that every channel has produced, then drops them.
+            /// \return the number of rows.
+            template<class F>
+            std::size_t drain(F&& f)
+            {
+                std::size_t begin = 0;
+                std::size_t end = std::size_t(-1);
+                bool all_started = true;
+                for_each_channel([&](auto& channel) {
+                    if(channel.samples() == 0) all_started = false;
+                    begin = std::max(begin, channel.output_begin());
+                    end = std::min(end, channel.output_end());
+                });
+                if(!all_started || end <= begin) {
+                    // rows that some channel will never have are of no use
+                    if(all_started) for_each_channel([&](auto& channel) { channel.consume(begin); });
+                    return 0;
+                }
+
+                m_Block.first = begin;
+                m_Block.times.resize(end - begin);
+                for(std::size_t k = begin; k < end; ++k) m_Block.times[k - begin] = m_Grid.at(k);
+                fill_columns(begin, end, std::index_sequence_for<Ts...>{});
+                f(static_cast<const Block<Ts...>&>(m_Block));
+                for_each_channel([&](auto& channel) { channel.consume(end); });
+                return end - begin;
+            }
+
+        private:
+            static std::array<Interpolation, CHANNELS> filled(Interpolation interpolation)
+            {
+                std::array<Interpolation, CHANNELS> all;
+                all.fill(interpolation);
+                return all;
+            }
+
+            template<std::size_t... Is>
+            Aligner(Grid grid, const std::array<Interpolation, CHANNELS>& interpolation, unsigned threads,
+                    std::index_sequence<Is...>) :
+                    m_Grid(grid), m_Threads(threads), m_Channels(Channel<Ts>(grid, interpolation[Is])...)
+            {
+            }
+
+            template<std::size_t... Is>
+            void feed(std::index_sequence<Is...>, const Input<Ts>&... inputs)
+            {
+                std::array<std::function<void()>, CHANNELS> tasks = {{
+                    [this, &inputs]() { std::get<Is>(m_Channels).push(inputs.times, inputs.values); }...
+                }};
+                threading::for_chunks(CHANNELS, [&](std::size_t b, std::size_t e) {
+                    for(std::size_t i = b; i < e; ++i) tasks[i]();
+                }, m_Threads);
+            }
+
+            template<class F>
+            void for_each_channel(F&& f)
+            {
+                for_each_channel(f, std::index_sequence_for<Ts...>{});
+            }
+
+            template<class F, std::size_t... Is>
+            void for_each_channel(F& f, std::index_sequence<Is...>)
+            {
+                int expand[] = {0, (f(std::get<Is>(m_Channels)), 0)...};
+                (void)expand;
+            }
+
+            template<class T>
+            static void copy_rows(const std::vector<T>& rows, std::size_t offset, std::size_t count,
+                                  std::vector<T>& column)
+            {
+                column.assign(rows.begin() + std::ptrdiff_t(offset), rows.begin() + std::ptrdiff_t(offset + count));
+            }
+
+            template<class T>
+            static void copy_rows(const std::vector<Vec3<T>>& rows, std::size_t offset, std::size_t count,
+                                  Vec3Array<T>& column)
+            {
+                column.resize(count);
+                for(std::size_t i = 0; i < count; ++i) column.set(i, rows[offset + i]);
+            }
+
+            template<std::size_t... Is>
+            void fill_columns(std::size_t begin, std::size_t end, std::index_sequence<Is...>)
+            {
+                int expand[] = {0, (copy_rows(std::get<Is>(m_Channels).output(),
+                                              begin - std::get<Is>(m_Channels).output_begin(), end - begin,
+                                              std::get<Is>(m_Block.columns)), 0)...};
+                (void)expand;
+            }
+
+            Grid m_Grid;
+            unsigned m_Threads;
+            std::tuple<Channel<Ts>...> m_Channels;
+            Block<Ts...> m_Block;
+        };
+    }
+}
+
+#endif //QUANTITY_RESAMPLE_HPP
@@ -0,0 +1,494 @@
+#ifndef QUANTITY_SCHEMA_HPP
+#define QUANTITY_SCHEMA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <boost/throw_exception.hpp>
+#include "quantity.hpp"
+#include "runtime.hpp"
+#include "io.hpp"
+#include "span.hpp"
+#include "vec.hpp"
+
+namespace quantity
+{
+    /*!
+     * \brief Compile time descriptions of records made of quantities, with binary and text I/O.
+     * \details A schema lists the members of a struct together with their names:
+     *
+     *              struct Body { time_t t; length_vec position; velocity_vec velocity; mass_t mass; };
+     *
+     *              constexpr auto body_schema = schema::make_schema(
+     *                      schema::field("t", &Body::t),
+     *                      schema::field("position", &Body::position, "km"),
+     *                      schema::field("velocity", &Body::velocity, "km/s"),
+     *                      schema::field("mass", &Body::mass));
+     *
+     *          The types of the fields are template arguments of the schema, so encoding and
+     *          decoding are unrolled at compile time into plain copies, without any dispatch per
+     *          field.
+     *
+     *          The binary layout is the concatenation of all components, each in the base type of
+     *          its quantity and the byte order of the machine, without padding; `record_bytes` is
+     *          its size. The text format has comma separated columns and a header line naming each
+     *          column with its unit, a vector field taking three columns:
+     *
+     *              t[s],position.x[km],position.y[km],position.z[km],velocity.x[km/s],...,mass[kg]
+     *
+     *          `TextReader` resolves the units of the header once, accepts the columns in any order
+     *          and ignores columns that are not in the schema.
+     */
+    namespace schema
+    {
+        namespace detail
+        {
+            template<class T>
+            struct field_traits;
+
+            template<class B, class D>
+            struct field_traits<Quantity<B, D>>
+            {
+                using base_t = B;
+                using dimension_t = D;
+                static constexpr std::size_t components = 1;
+
+                static void load(const Quantity<B, D>& q, double* values) { values[0] = double(q.value); }
+                static void store(Quantity<B, D>& q, const double* values) { q.value = B(values[0]); }
+
+                static void encode(const Quantity<B, D>& q, char* out) { std::memcpy(out, &q.value, sizeof(B)); }
+                static void decode(Quantity<B, D>& q, const char* in) { std::memcpy(&q.value, in, sizeof(B)); }
+            };
+
+            template<class B, class D>
+            struct field_traits<Vec3<Quantity<B, D>>>
+            {
+                using base_t = B;
+                using dimension_t = D;
+                static constexpr std::size_t components = 3;
+
+                static void load(const Vec3<Quantity<B, D>>& v, double* values)
+                {
+                    values[0] = double(v.x.value);
+                    values[1] = double(v.y.value);
+                    values[2] = double(v.z.value);
+                }
+
+                static void store(Vec3<Quantity<B, D>>& v, const double* values)
+                {
+                    v.x.value = B(values[0]);
+                    v.y.value = B(values[1]);
+                    v.z.value = B(values[2]);
+                }
+
+                static void encode(const Vec3<Quantity<B, D>>& v, char* out)
+                {
+                    std::memcpy(out, &v.x.value, sizeof(B));
+                    std::memcpy(out + sizeof(B), &v.y.value, sizeof(B));
+                    std::memcpy(out + 2 * sizeof(B), &v.z.value, sizeof(B));
+                }
+
+                static void decode(Vec3<Quantity<B, D>>& v, const char* in)
+                {
+                    std::memcpy(&v.x.value, in, sizeof(B));
+                    std::memcpy(&v.y.value, in + sizeof(B), sizeof(B));
+                    std::memcpy(&v.z.value, in + 2 * sizeof(B), sizeof(B));
+                }
+            };
+
+            template<class T>
+            constexpr std::size_t field_bytes()
+            {
+                return field_traits<T>::components * sizeof(typename field_traits<T>::base_t);
+            }
+
+            /// sum of the first `n` entries of `values`.
+            template<std::size_t N>
+            constexpr std::size_t prefix_sum(const std::size_t (&values)[N], std::size_t n)
+            {
+                std::size_t sum = 0;
+                for(std::size_t i = 0; i < n; ++i) sum += values[i];
+                return sum;
+            }
+
+            /// a column of the text format: a field, or one component of a vector field.
+            struct ColumnInfo
+            {
+                std::string name;               //!< e.g. "position.x"
+                runtime::Dimension dimension;
+                std::string unit;               //!< unit written by `TextWriter`
+                double scale;                   //!< factor from `unit` to coherent SI units
+                std::size_t slot;               //!< index into the components of a record
+            };
+
+            /// how to read one column of a text file.
+            struct Column
+            {
+                std::size_t slot;               //!< `npos` for columns that are not part of the schema
+                double scale;
+                static constexpr std::size_t npos = std::size_t(-1);
+            };
+
+            /// factor from `unit` to coherent SI units; the empty unit is dimensionless.
+            /// \throw std::invalid_argument if `unit` does not have the dimension `expected`.
+            double unit_scale(const std::string& unit, const runtime::Dimension& expected, const std::string& column);
+
+            /// `name[unit]` cells separated by commas.
+            std::string header(const std::vector<ColumnInfo>& columns);
+
+            /// matches the cells of a header line to `columns`.
+            /// \throw std::runtime_error if a column is missing, repeated or has a wrong unit.
+            std::vector<Column> match_header(const std::string& line, const std::vector<ColumnInfo>& columns);
+
+            /// reads the numbers of a row into their slots of `values`, scaled to coherent SI units.
+            /// \return false if the row does not have the columns of the header.
+            bool parse_row(const char* first, const char* last, const Column* columns, std::size_t count,
+                           double* values);
+        }
+
+        /// A named member of a record, with the unit used for text output (coherent SI if null).
+        template<class R, class T>
+        struct Field
+        {
+            using record_t = R;
+            using type = T;
+
+            const char* name;
+            T R::* member;
+            const char* unit;
+        };
+
+        template<class R, class T>
+        constexpr Field<R, T> field(const char* name, T R::* member, const char* unit = nullptr)
+        {
+            return Field<R, T>{name, member, unit};
+        }
+
+        template<class R, class... Ts>
+        class Schema
+        {
+            static constexpr std::size_t bytes[] = {0, detail::field_bytes<Ts>()...};
+            static constexpr std::size_t counts[] = {0, detail::field_traits<Ts>::components...};
+
+        public:
+            using record_t = R;
+
+            /// number of fields.
+            static constexpr std::size_t size = sizeof...(Ts);
+
+            /// number of scalar components of a record, i.e. columns of the text format.
+            static constexpr std::size_t components = detail::prefix_sum(counts, size + 1);
+
+            /// size of the binary representation of a record.
+            static constexpr std::size_t record_bytes = detail::prefix_sum(bytes, size + 1);
+
+            /// byte offset of field `I` in the binary representation.
+            template<std::size_t I>
+            static constexpr std::size_t offset() { return detail::prefix_sum(bytes, I + 1); }
+
+            /// index of the first component of field `I`.
+            template<std::size_t I>
+            static constexpr std::size_t slot() { return detail::prefix_sum(counts, I + 1); }
+
+            constexpr explicit Schema(Field<R, Ts>... fields) : m_Fields(fields...) { }
+
+            template<std::size_t I>
+            constexpr const auto& field() const { return std::get<I>(m_Fields); }
+
+            /// writes the `record_bytes` bytes of `record` to `out`.
+            void encode(const R& record, char* out) const
+            {
+                encode(record, out, std::index_sequence_for<Ts...>{});
+            }
+
+            void decode(const char* in, R& record) const
+            {
+                decode(in, record, std::index_sequence_for<Ts...>{});
+            }
+
+            /// encodes all `records` one after the other.
+            void encode(Span<const R> records, char* out) const
+            {
+                for(const R& record : records) {
+                    encode(record, out);
+                    out += record_bytes;
+                }
+            }
+
+            void decode(const char* in, std::size_t count, R* records) const
+            {
+                for(std::size_t i = 0; i < count; ++i, in += record_bytes) decode(in, records[i]);
+            }
+
+            /// the `components` values of `record` in coherent SI units.
+            void load(const R& record, double* values) const
+            {
+                load(record, values, std::index_sequence_for<Ts...>{});
+            }
+
+            void store(const double* values, R& record) const
+            {
+                store(values, record, std::index_sequence_for<Ts...>{});
+            }
+
+            /// the columns of the text format.
+            std::vector<detail::ColumnInfo> columns() const
+            {
+                std::vector<detail::ColumnInfo> result;
+                result.reserve(components);
+                columns(result, std::index_sequence_for<Ts...>{});
+                return result;
+            }
+
+            /// the header line of the text format, without a newline.
+            std::string header() const
+            {
+                return detail::header(columns());
+            }
+
+        private:
+            template<std::size_t... Is>
+            void encode(const R& record, char* out, std::index_sequence<Is...>) const
+            {
+                int expand[] = {0, (detail::field_traits<Ts>::encode(record.*std::get<Is>(m_Fields).member,
+                                                                     out + offset<Is>()), 0)...};
+                (void)expand;
+            }
+
+            template<std::size_t... Is>
+            void decode(const char* in, R& record, std::index_sequence<Is...>) const
+            {
+                int expand[] = {0, (detail::field_traits<Ts>::decode(record.*std::get<Is>(m_Fields).member,
+                                                                     in + offset<Is>()), 0)...};
+                (void)expand;
+            }
+
+            template<std::size_t... Is>
+            void load(const R& record, double* values, std::index_sequence<Is...>) const
+            {
+                int expand[] = {0, (detail::field_traits<Ts>::load(record.*std::get<Is>(m_Fields).member,
+                                                                   values + slot<Is>()), 0)...};
+                (void)expand;
+            }
+
+            template<std::size_t... Is>
+            void store(const double* values, R& record, std::index_sequence<Is...>) const
+            {
+                int expand[] = {0, (detail::field_traits<Ts>::store(record.*std::get<Is>(m_Fields).member,
+                                                                    values + slot<Is>()), 0)...};
+                (void)expand;
+            }
+
+            template<class T>
+            static void add_columns(std::vector<detail::ColumnInfo>& result, const Field<R, T>& f, std::size_t first)
+            {
+                using traits = detail::field_traits<T>;
+                const runtime::Dimension dim = runtime::to_dynamic(typename traits::dimension_t{});
+                const std::string unit = f.unit ? std::string(f.unit) : runtime::to_string(dim);
+                const double scale = detail::unit_scale(unit, dim, f.name);
+                static const char* suffix[] = {".x", ".y", ".z"};
+                for(std::size_t c = 0; c < traits::components; ++c) {
+                    std::string name = f.name;
+                    if(traits::components == 3) name += suffix[c];
+                    result.push_back(detail::ColumnInfo{std::move(name), dim, unit, scale, first + c});
+                }
+            }
+
+            template<std::size_t... Is>
+            void columns(std::vector<detail::ColumnInfo>& result, std::index_sequence<Is...>) const
+            {
+                int expand[] = {0, (add_columns(result, std::get<Is>(m_Fields), slot<Is>()), 0)...};
+                (void)expand;
+            }
+
+            std::tuple<Field<R, Ts>...> m_Fields;
+        };
+
+        template<class R, class... Ts>
+        constexpr std::size_t Schema<R, Ts...>::bytes[];
+
+        template<class R, class... Ts>
+        constexpr std::size_t Schema<R, Ts...>::counts[];
+
+        template<class R, class... Ts>
+        constexpr std::size_t Schema<R, Ts...>::size;
+
+        template<class R, class... Ts>
+        constexpr std::size_t Schema<R, Ts...>::components;
+
+        template<class R, class... Ts>
+        constexpr std::size_t Schema<R, Ts...>::record_bytes;
+
+        template<class R, class... Ts>
+        constexpr Schema<R, Ts...> make_schema(Field<R, Ts>... fields)
+        {
+            return Schema<R, Ts...>(fields...);
+        }
+
+        /// writes `records` in the binary layout of `schema`.
+        template<class S>
+        void write_binary(std::ostream& out, const S& schema, Span<const typename S::record_t> records)
+        {
+            constexpr std::size_t block = std::size_t(1 << 16) / S::record_bytes + 1;
+            std::vector<char> buffer(block * S::record_bytes);
+            for(std::size_t i = 0; i < records.size(); i += block) {
+                const std::size_t n = std::min(block, records.size() - i);
+                schema.encode(Span<const typename S::record_t>(records.data() + i, n), buffer.data());
+                out.write(buffer.data(), std::streamsize(n * S::record_bytes));
+            }
+        }
+
+        /// appends up to `count` records read in the binary layout of `schema` to `records`.
+        /// \return the number of records read, less than `count` only at the end of the input.
+        template<class S>
+        std::size_t read_binary(std::istream& in, const S& schema, std::vector<typename S::record_t>& records,
+                                std::size_t count)
+        {
+            constexpr std::size_t block = std::size_t(1 << 16) / S::record_bytes + 1;
+            std::vector<char> buffer(block * S::record_bytes);
+            std::size_t done = 0;
+            while(done < count) {
+                const std::size_t wanted = std::min(block, count - done);
+                in.read(buffer.data(), std::streamsize(wanted * S::record_bytes));
+                const std::size_t n = std::size_t(in.gcount()) / S::record_bytes;
+                const std::size_t first = records.size();
+                records.resize(first + n);
+                schema.decode(buffer.data(), n, records.data() + first);
+                done += n;
+                if(n < wanted) break;
+            }
+            return done;
+        }
+
+        /// Writes records as text, starting with the header line. Output is buffered.
+        template<class S>
+        class TextWriter
+        {
+        public:
+            using record_t = typename S::record_t;
+
+            /// \throw std::invalid_argument if the unit of a field does not fit its dimension.
+            explicit TextWriter(std::ostream& target, const S& schema, std::size_t buffer_size = 1 << 16) :
+                    m_Target(target), m_Schema(schema), m_BufferSize(buffer_size)
+            {
+                for(const auto& column : schema.columns()) m_Scales[column.slot] = column.scale;
+                m_Buffer.reserve(buffer_size + 512);
+                m_Buffer = schema.header();
+                m_Buffer += '\n';
+            }
+
+            TextWriter(const TextWriter&) = delete;
+            TextWriter& operator=(const TextWriter&) = delete;
+
+            ~TextWriter()
+            {
+                try { flush(); } catch (...) { }
+            }
+
+            void write(const record_t& record)
+            {
+                double values[S::components];
+                m_Schema.load(record, values);
+                for(std::size_t i = 0; i < S::components; ++i) {
+                    if(i) m_Buffer += ',';
+                    runtime::append_number(m_Buffer, values[i] / m_Scales[i]);
+                }
+                m_Buffer += '\n';
+                if(m_Buffer.size() >= m_BufferSize) flush();
+            }
+
+            void write(Span<const record_t> records)
+            {
+                for(const auto& record : records) write(record);
+            }
+
+            void flush()
+            {
+                m_Target.write(m_Buffer.data(), std::streamsize(m_Buffer.size()));
+                m_Buffer.clear();
+            }
+
+        private:
+            std::ostream& m_Target;
+            S m_Schema;
+            std::size_t m_BufferSize;
+            std::string m_Buffer;
+            double m_Scales[S::components];
+        };
+
+        /*!
+         * \brief Reads records written as text, see the namespace documentation.
+         * \details The header is read and matched by the constructor, each row is then split with
+         *          `strtod` and scaled with the factors of the header units.
+         *          \throw std::runtime_error on a bad header or a row with missing or extra numbers.
+         */
+        template<class S>
+        class TextReader
+        {
+        public:
+            using record_t = typename S::record_t;
+
+            TextReader(std::istream& source, const S& schema) : m_Source(source), m_Schema(schema)
+            {
+                if(!next_line()) BOOST_THROW_EXCEPTION(std::runtime_error("Missing header line"));
+                m_Columns = detail::match_header(m_Line, schema.columns());
+            }
+
+            /// reads the next row into `record`. \return false at the end of the input.
+            bool read(record_t& record)
+            {
+                while(next_line()) {
+                    if(m_Line.empty()) continue;
+                    double values[S::components];
+                    if(!detail::parse_row(m_Line.data(), m_Line.data() + m_Line.size(), m_Columns.data(),
+                                          m_Columns.size(), values)) {
+                        BOOST_THROW_EXCEPTION(std::runtime_error("Malformed row in line " + std::to_string(m_LineNumber)));
+                    }
+                    m_Schema.store(values, record);
+                    return true;
+                }
+                return false;
+            }
+
+            /// appends up to `count` records to `records`. \return the number of records read.
+            std::size_t read(std::vector<record_t>& records, std::size_t count)
+            {
+                std::size_t n = 0;
+                record_t record;
+                while(n < count && read(record)) {
+                    records.push_back(record);
+                    ++n;
+                }
+                return n;
+            }
+
+            /// lines read so far, including the header.
+            std::size_t line() const { return m_LineNumber; }
+
+        private:
+            bool next_line()
+            {
+                if(!std::getline(m_Source, m_Line)) return false;
+                if(!m_Line.empty() && m_Line.back() == '\r') m_Line.pop_back();
+                ++m_LineNumber;
+                return true;
+            }
+
+            std::istream& m_Source;
+            S m_Schema;
+            std::vector<detail::Column> m_Columns;
+            std::string m_Line;
+            std::size_t m_LineNumber = 0;
+        };
+    }
+}
+
+#endif //QUANTITY_SCHEMA_HPP
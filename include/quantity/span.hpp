@@ -0,0 +1,60 @@
+#ifndef QUANTITY_SPAN_HPP
+#define QUANTITY_SPAN_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace quantity
+{
+    /*!
+     * \brief Non-owning view of a contiguous sequence of `T`.
+     * \details A minimal stand-in for `std::span`, which is not available in C++14.
+     *          Any container that provides `data()` and `size()` (e.g. `std::vector`,
+     *          `std::array` or another `Span`) converts implicitly.
+     */
+    template<class T>
+    class Span
+    {
+    public:
+        using element_type = T;
+        using value_type   = std::remove_cv_t<T>;
+        using iterator     = T*;
+
+        constexpr Span() = default;
+        constexpr Span(T* data, std::size_t size) : m_Data(data), m_Size(size) { }
+
+        /// conversion from any contiguous container whose elements are compatible with `T`.
+        template<class C, class = std::enable_if_t<
+                std::is_convertible<decltype(std::declval<C&>().data()), T*>::value>>
+        constexpr Span(C& container) : m_Data(container.data()), m_Size(container.size()) { }
+
+        constexpr T* data() const { return m_Data; }
+        constexpr std::size_t size() const { return m_Size; }
+        constexpr bool empty() const { return m_Size == 0; }
+
+        constexpr T* begin() const { return m_Data; }
+        constexpr T* end() const { return m_Data + m_Size; }
+
+        constexpr T& operator[](std::size_t i) const { return m_Data[i]; }
+
+        /// view of `count` elements starting at `offset`.
+        constexpr Span subspan(std::size_t offset, std::size_t count) const
+        {
+            return Span(m_Data + offset, count);
+        }
+
+    private:
+        T* m_Data = nullptr;
+        std::size_t m_Size = 0;
+    };
+
+    /// creation function for a span over a container.
+    template<class C>
+    constexpr auto make_span(C& container)
+    {
+        return Span<std::remove_pointer_t<decltype(container.data())>>(container);
+    }
+}
+
+#endif //QUANTITY_SPAN_HPP
@@ -0,0 +1,322 @@
+#ifndef QUANTITY_STATISTICS_HPP
+#define QUANTITY_STATISTICS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <boost/throw_exception.hpp>
+#include "quantity.hpp"
+#include "span.hpp"
+#include "threading.hpp"
+#include "vec.hpp"
+
+namespace quantity
+{
+    namespace statistics
+    {
+        template<class T>
+        class RunningStats;
+
+        /*!
+         * \brief Single pass, mergeable mean, variance, minimum and maximum of a `Quantity`.
+         * \details Single values are added with Welford's update. Spans are consumed in small
+         *          blocks whose statistics are computed with branch-free loops while the block
+         *          is in cache and then merged with Chan's formula, so memory is read once.
+         *          Accumulators filled on different threads can be combined with `merge`.
+         *          The variance has the squared dimension `mul_t<D, D>`.
+         *          `mean`, `min` and `max` are meaningless while `count() == 0`.
+         */
+        template<class B, class D>
+        class RunningStats<Quantity<B, D>>
+        {
+        public:
+            using value_type    = Quantity<B, D>;
+            using variance_type = Quantity<B, dimensions::ops::mul_t<D, D>>;
+
+            void add(const value_type& x)
+            {
+                m_Count += 1;
+                B delta = x.value - m_Mean;
+                m_Mean += delta / B(m_Count);
+                m_M2 += delta * (x.value - m_Mean);
+                m_Min = std::min(m_Min, x.value);
+                m_Max = std::max(m_Max, x.value);
+            }
+
+            void add(Span<const value_type> xs)
+            {
+                add_blocks(xs.size(), [&](std::size_t i) { return xs[i].value; });
+            }
+
+            /// adds `count` values, where `get(i)` returns the raw value of the `i`th one.
+            template<class F>
+            void add_blocks(std::size_t count, F&& get)
+            {
+                constexpr std::size_t BLOCK = 256;
+                B block[BLOCK];
+                for(std::size_t begin = 0; begin < count; begin += BLOCK) {
+                    std::size_t n = std::min(BLOCK, count - begin);
+                    B sum = 0;
+                    B lo = block[0] = get(begin);
+                    B hi = lo;
+                    for(std::size_t i = 0; i < n; ++i) {
+                        B v = block[i] = get(begin + i);
+                        sum += v;
+                        lo = v < lo ? v : lo;
+                        hi = v > hi ? v : hi;
+                    }
+                    B mean = sum / B(n);
+                    B m2 = 0;
+                    for(std::size_t i = 0; i < n; ++i) {
+                        B d = block[i] - mean;
+                        m2 += d * d;
+                    }
+                    merge(n, mean, m2, lo, hi);
+                }
+            }
+
+            void merge(const RunningStats& other)
+            {
+                merge(other.m_Count, other.m_Mean, other.m_M2, other.m_Min, other.m_Max);
+            }
+
+            std::uint64_t count() const { return m_Count; }
+            value_type mean() const { return value_type(m_Mean); }
+            value_type min() const { return value_type(m_Min); }
+            value_type max() const { return value_type(m_Max); }
+
+            /// population variance.
+            variance_type variance() const
+            {
+                return variance_type(m_Count == 0 ? B(0) : m_M2 / B(m_Count));
+            }
+
+            /// unbiased sample variance.
+            variance_type sample_variance() const
+            {
+                return variance_type(m_Count < 2 ? B(0) : m_M2 / B(m_Count - 1));
+            }
+
+            /// population standard deviation.
+            value_type stddev() const
+            {
+                using std::sqrt;
+                return value_type(sqrt(variance().value));
+            }
+
+        private:
+            void merge(std::uint64_t count, B mean, B m2, B lo, B hi)
+            {
+                if(count == 0) return;
+                std::uint64_t total = m_Count + count;
+                B delta = mean - m_Mean;
+                B weight = B(count) / B(total);
+                m_Mean += delta * weight;
+                m_M2 += m2 + delta * delta * B(m_Count) * weight;
+                m_Count = total;
+                m_Min = std::min(m_Min, lo);
+                m_Max = std::max(m_Max, hi);
+            }
+
+            std::uint64_t m_Count = 0;
+            B m_Mean = 0;
+            B m_M2 = 0;
+            B m_Min = std::numeric_limits<B>::max();
+            B m_Max = std::numeric_limits<B>::lowest();
+        };
+
+        /*!
+         * \brief Component-wise running statistics of a `Vec3<Quantity>`.
+         */
+        template<class B, class D>
+        class RunningStats<Vec3<Quantity<B, D>>>
+        {
+        public:
+            using component_stats = RunningStats<Quantity<B, D>>;
+            using value_type      = Vec3<Quantity<B, D>>;
+            using variance_type   = Vec3<typename component_stats::variance_type>;
+
+            void add(const value_type& v)
+            {
+                x.add(v.x);
+                y.add(v.y);
+                z.add(v.z);
+            }
+
+            void add(Span<const value_type> vs)
+            {
+                x.add_blocks(vs.size(), [&](std::size_t i) { return vs[i].x.value; });
+                y.add_blocks(vs.size(), [&](std::size_t i) { return vs[i].y.value; });
+                z.add_blocks(vs.size(), [&](std::size_t i) { return vs[i].z.value; });
+            }
+
+            void merge(const RunningStats& other)
+            {
+                x.merge(other.x);
+                y.merge(other.y);
+                z.merge(other.z);
+            }
+
+            std::uint64_t count() const { return x.count(); }
+            value_type mean() const { return make_vector(x.mean(), y.mean(), z.mean()); }
+            value_type min() const { return make_vector(x.min(), y.min(), z.min()); }
+            value_type max() const { return make_vector(x.max(), y.max(), z.max()); }
+            variance_type variance() const { return make_vector(x.variance(), y.variance(), z.variance()); }
+            value_type stddev() const { return make_vector(x.stddev(), y.stddev(), z.stddev()); }
+
+            // the per component statistics
+            component_stats x;
+            component_stats y;
+            component_stats z;
+        };
+
+        template<class T>
+        class QuantileSketch;
+
+        /*!
+         * \brief Mergeable quantile sketch with a guaranteed relative error.
+         * \details Values are counted in logarithmically spaced buckets (as in DDSketch), so
+         *          every quantile is reported with a relative error of at most
+         *          `relative_accuracy`. Memory grows with the logarithm of the value range,
+         *          not with the number of values, and two sketches merge by adding counts.
+         */
+        template<class B, class D>
+        class QuantileSketch<Quantity<B, D>>
+        {
+        public:
+            using value_type = Quantity<B, D>;
+
+            explicit QuantileSketch(double relative_accuracy = 0.01) : m_Accuracy(relative_accuracy)
+            {
+                if(!(relative_accuracy > 0 && relative_accuracy < 1)) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("Relative accuracy has to be in (0, 1)"));
+                }
+                m_Gamma = (1 + relative_accuracy) / (1 - relative_accuracy);
+                m_LogGamma = std::log(m_Gamma);
+            }
+
+            void add(const value_type& x)
+            {
+                double v = double(x.value);
+                if(std::abs(v) < MIN_INDEXABLE) {
+                    m_Zero += 1;
+                } else if(v > 0) {
+                    m_Positive.add(index(v), 1);
+                } else {
+                    m_Negative.add(index(-v), 1);
+                }
+            }
+
+            void add(Span<const value_type> xs)
+            {
+                for(const auto& x : xs) add(x);
+            }
+
+            void merge(const QuantileSketch& other)
+            {
+                if(other.m_Accuracy != m_Accuracy) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("Cannot merge sketches of different accuracy"));
+                }
+                m_Positive.merge(other.m_Positive);
+                m_Negative.merge(other.m_Negative);
+                m_Zero += other.m_Zero;
+            }
+
+            std::uint64_t count() const { return m_Positive.total + m_Negative.total + m_Zero; }
+            double relative_accuracy() const { return m_Accuracy; }
+
+            /// value below which a fraction `q` of all values lies.
+            value_type quantile(double q) const
+            {
+                if(count() == 0 || !(q >= 0 && q <= 1)) {
+                    BOOST_THROW_EXCEPTION(std::domain_error("Quantile of empty sketch or outside [0, 1]"));
+                }
+                auto rank = std::uint64_t(q * double(count() - 1));
+
+                // negative values, from the largest magnitude downwards
+                std::uint64_t seen = 0;
+                for(std::size_t i = m_Negative.counts.size(); i-- > 0; ) {
+                    seen += m_Negative.counts[i];
+                    if(seen > rank) return value_type(B(-value(m_Negative.offset + int(i))));
+                }
+                seen += m_Zero;
+                if(seen > rank) return value_type(B(0));
+                for(std::size_t i = 0; i < m_Positive.counts.size(); ++i) {
+                    seen += m_Positive.counts[i];
+                    if(seen > rank) return value_type(B(value(m_Positive.offset + int(i))));
+                }
+                return value_type(B(value(m_Positive.offset + int(m_Positive.counts.size()) - 1)));
+            }
+
+        private:
+            static constexpr double MIN_INDEXABLE = 1e-300;
+
+            /// dense bucket counts for the indices `offset, offset + 1, ...`.
+            struct Store
+            {
+                void add(int index, std::uint64_t count)
+                {
+                    if(counts.empty()) {
+                        offset = index;
+                        counts.push_back(0);
+                    } else if(index < offset) {
+                        counts.insert(counts.begin(), std::size_t(offset - index), 0);
+                        offset = index;
+                    } else if(index >= offset + int(counts.size())) {
+                        counts.resize(std::size_t(index - offset + 1), 0);
+                    }
+                    counts[std::size_t(index - offset)] += count;
+                    total += count;
+                }
+
+                void merge(const Store& other)
+                {
+                    for(std::size_t i = 0; i < other.counts.size(); ++i) {
+                        if(other.counts[i] != 0) add(other.offset + int(i), other.counts[i]);
+                    }
+                }
+
+                int offset = 0;
+                std::vector<std::uint64_t> counts;
+                std::uint64_t total = 0;
+            };
+
+            int index(double v) const { return int(std::ceil(std::log(v) / m_LogGamma)); }
+            double value(int index) const { return 2 * std::pow(m_Gamma, index) / (m_Gamma + 1); }
+
+            double m_Accuracy;
+            double m_Gamma;
+            double m_LogGamma;
+            Store m_Positive;
+            Store m_Negative;
+            std::uint64_t m_Zero = 0;
+        };
+
+        /*!
+         * \brief Computes the running statistics of a contiguous container with several threads.
+         * \details Each thread accumulates its own chunk, the partial results are merged at the end.
+         */
+        template<class C>
+        auto parallel_stats(const C& data, unsigned threads = 0)
+        {
+            using value_t = std::remove_cv_t<std::remove_pointer_t<decltype(data.data())>>;
+            Span<const value_t> values(data.data(), data.size());
+            RunningStats<value_t> result;
+            std::mutex mutex;
+            threading::for_chunks(values.size(), [&](std::size_t begin, std::size_t end) {
+                RunningStats<value_t> local;
+                local.add(values.subspan(begin, end - begin));
+                std::lock_guard<std::mutex> lock(mutex);
+                result.merge(local);
+            }, threads, 1 << 14);
+            return result;
+        }
+    }
+}
+
+#endif //QUANTITY_STATISTICS_HPP
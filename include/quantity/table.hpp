@@ -0,0 +1,245 @@
+#ifndef QUANTITY_TABLE_HPP
+#define QUANTITY_TABLE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <boost/throw_exception.hpp>
+#include "quantity.hpp"
+#include "span.hpp"
+
+namespace quantity
+{
+    /// Interpolation schemes supported by `Table`.
+    enum class Interpolation
+    {
+        LINEAR,
+        CUBIC   //!< cubic Hermite spline, slopes from weighted three-point differences.
+    };
+
+    template<class X, class Y>
+    class Table;
+
+    /*!
+     * \brief Tabulated function `Y(X)` between two quantities, e.g. density over altitude.
+     * \details If the sample points are equally spaced, the segment of an argument is computed
+     *          directly in O(1). Otherwise it is found by a branch-free binary search, which
+     *          compiles to conditional moves. Arguments outside of the table are clamped to
+     *          its ends, i.e. the first and last value are held.
+     *
+     *          The derivative and integral of the interpolant have the dimensions
+     *          `div_t<DY, DX>` and `mul_t<DY, DX>` respectively.
+     */
+    template<class B, class DX, class DY>
+    class Table<Quantity<B, DX>, Quantity<B, DY>>
+    {
+    public:
+        using x_type          = Quantity<B, DX>;
+        using y_type          = Quantity<B, DY>;
+        using derivative_type = Quantity<B, dimensions::ops::div_t<DY, DX>>;
+        using integral_type   = Quantity<B, dimensions::ops::mul_t<DY, DX>>;
+
+        /// table from arbitrary, strictly increasing sample points.
+        Table(const std::vector<x_type>& xs, const std::vector<y_type>& ys,
+              Interpolation method = Interpolation::LINEAR) : m_Method(method)
+        {
+            if(xs.size() != ys.size()) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Table needs the same number of x and y values"));
+            }
+            m_X.reserve(xs.size());
+            m_Y.reserve(ys.size());
+            for(std::size_t i = 0; i < xs.size(); ++i) {
+                m_X.push_back(xs[i].value);
+                m_Y.push_back(ys[i].value);
+            }
+            init();
+        }
+
+        /// table with sample points `x0, x0 + dx, x0 + 2 dx, ...`.
+        static Table uniform(x_type x0, x_type dx, const std::vector<y_type>& ys,
+                             Interpolation method = Interpolation::LINEAR)
+        {
+            std::vector<x_type> xs;
+            xs.reserve(ys.size());
+            for(std::size_t i = 0; i < ys.size(); ++i) {
+                xs.push_back(x0 + dx * B(i));
+            }
+            return Table(xs, ys, method);
+        }
+
+        std::size_t size() const { return m_X.size(); }
+        bool is_uniform() const { return m_Uniform; }
+        Interpolation method() const { return m_Method; }
+        x_type x_min() const { return x_type(m_X.front()); }
+        x_type x_max() const { return x_type(m_X.back()); }
+
+        y_type operator()(x_type x) const
+        {
+            return y_type(value(x.value));
+        }
+
+        /// evaluates the table for all `xs`. The loop over the input is free of data dependent branches.
+        void evaluate(Span<const x_type> xs, Span<y_type> out) const
+        {
+            if(xs.size() != out.size()) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Mismatched input and output size"));
+            }
+            const std::size_t n = xs.size();
+            if(m_Method == Interpolation::LINEAR) {
+                for(std::size_t i = 0; i < n; ++i) out[i].value = linear(xs[i].value);
+            } else {
+                for(std::size_t i = 0; i < n; ++i) out[i].value = cubic(xs[i].value);
+            }
+        }
+
+        /// derivative of the interpolant, zero outside of the table.
+        derivative_type derivative(x_type x) const
+        {
+            B v = x.value;
+            if(v < m_X.front() || v > m_X.back()) return derivative_type(B(0));
+
+            std::size_t i = locate(v);
+            B h = m_X[i + 1] - m_X[i];
+            if(m_Method == Interpolation::LINEAR) {
+                return derivative_type((m_Y[i + 1] - m_Y[i]) / h);
+            }
+            B t = (v - m_X[i]) / h;
+            B dh00 = 6 * t * t - 6 * t;
+            B dh10 = 3 * t * t - 4 * t + 1;
+            B dh11 = 3 * t * t - 2 * t;
+            return derivative_type(dh00 * (m_Y[i] - m_Y[i + 1]) / h + dh10 * m_Slope[i] + dh11 * m_Slope[i + 1]);
+        }
+
+        /// integral of the interpolant from `a` to `b`, including the held values outside of the table.
+        integral_type integral(x_type a, x_type b) const
+        {
+            if(b < a) return -integral(b, a);
+
+            B lo = a.value;
+            B hi = b.value;
+            B x0 = m_X.front();
+            B xn = m_X.back();
+            B sum = 0;
+            if(lo < x0) sum += (std::min(hi, x0) - lo) * m_Y.front();
+            if(hi > xn) sum += (hi - std::max(lo, xn)) * m_Y.back();
+
+            lo = std::max(lo, x0);
+            hi = std::min(hi, xn);
+            if(lo < hi) {
+                for(std::size_t i = locate(lo); i + 1 < m_X.size() && m_X[i] < hi; ++i) {
+                    B s = std::max(lo, m_X[i]);
+                    B e = std::min(hi, m_X[i + 1]);
+                    // Simpson's rule is exact for the linear and cubic pieces.
+                    sum += (e - s) / 6 * (value(s) + 4 * value((s + e) / 2) + value(e));
+                }
+            }
+            return integral_type(sum);
+        }
+
+    private:
+        void init()
+        {
+            if(m_X.size() < 2) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Table needs at least two points"));
+            }
+            for(std::size_t i = 0; i + 1 < m_X.size(); ++i) {
+                if(!(m_X[i] < m_X[i + 1])) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("Table x values need to be strictly increasing"));
+                }
+            }
+
+            const std::size_t n = m_X.size();
+            m_Dx = (m_X.back() - m_X.front()) / B(n - 1);
+            m_Uniform = true;
+            for(std::size_t i = 0; i < n && m_Uniform; ++i) {
+                using std::abs;
+                m_Uniform = abs(m_X[i] - (m_X.front() + m_Dx * B(i))) <= 1e-12 * abs(m_Dx) * B(n);
+            }
+
+            m_Slope.assign(n, B(0));
+            m_Slope[0] = (m_Y[1] - m_Y[0]) / (m_X[1] - m_X[0]);
+            m_Slope[n - 1] = (m_Y[n - 1] - m_Y[n - 2]) / (m_X[n - 1] - m_X[n - 2]);
+            for(std::size_t i = 1; i + 1 < n; ++i) {
+                B hl = m_X[i] - m_X[i - 1];
+                B hr = m_X[i + 1] - m_X[i];
+                B dl = (m_Y[i] - m_Y[i - 1]) / hl;
+                B dr = (m_Y[i + 1] - m_Y[i]) / hr;
+                m_Slope[i] = (dl * hr + dr * hl) / (hl + hr);
+            }
+        }
+
+        /// index of the segment containing `x`, clamped to the valid segments.
+        std::size_t locate(B x) const
+        {
+            const std::size_t segments = m_X.size() - 1;
+            if(m_Uniform) {
+                B f = (x - m_X.front()) / m_Dx;
+                f = f < B(0) ? B(0) : f;
+                f = f > B(segments - 1) ? B(segments - 1) : f;
+                return std::size_t(f);
+            }
+
+            const B* base = m_X.data();
+            std::size_t len = segments;
+            while(len > 1) {
+                std::size_t half = len / 2;
+                base = base[half] <= x ? base + half : base;
+                len -= half;
+            }
+            return std::size_t(base - m_X.data());
+        }
+
+        B clamp(B x) const
+        {
+            x = x < m_X.front() ? m_X.front() : x;
+            return x > m_X.back() ? m_X.back() : x;
+        }
+
+        B linear(B x) const
+        {
+            x = clamp(x);
+            std::size_t i = locate(x);
+            B t = (x - m_X[i]) / (m_X[i + 1] - m_X[i]);
+            return m_Y[i] + t * (m_Y[i + 1] - m_Y[i]);
+        }
+
+        B cubic(B x) const
+        {
+            x = clamp(x);
+            std::size_t i = locate(x);
+            B h = m_X[i + 1] - m_X[i];
+            B t = (x - m_X[i]) / h;
+            B t2 = t * t;
+            B t3 = t2 * t;
+            B h00 = 2 * t3 - 3 * t2 + 1;
+            B h10 = t3 - 2 * t2 + t;
+            B h01 = -2 * t3 + 3 * t2;
+            B h11 = t3 - t2;
+            return h00 * m_Y[i] + h10 * h * m_Slope[i] + h01 * m_Y[i + 1] + h11 * h * m_Slope[i + 1];
+        }
+
+        B value(B x) const
+        {
+            return m_Method == Interpolation::LINEAR ? linear(x) : cubic(x);
+        }
+
+        Interpolation m_Method;
+        bool m_Uniform = false;
+        B m_Dx = 0;
+        std::vector<B> m_X;
+        std::vector<B> m_Y;
+        std::vector<B> m_Slope;
+    };
+
+    /// creation function that deduces the quantity types of a table.
+    template<class X, class Y>
+    Table<X, Y> make_table(const std::vector<X>& xs, const std::vector<Y>& ys,
+                           Interpolation method = Interpolation::LINEAR)
+    {
+        return Table<X, Y>(xs, ys, method);
+    }
+}
+
+#endif //QUANTITY_TABLE_HPP
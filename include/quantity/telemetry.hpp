@@ -0,0 +1,283 @@
+#ifndef QUANTITY_TELEMETRY_HPP
+#define QUANTITY_TELEMETRY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "quantity.hpp"
+#include "runtime.hpp"
+#include "vec.hpp"
+
+namespace quantity
+{
+    /*!
+     * \brief Transport of live quantities between processes through a POSIX shared memory ring buffer.
+     * \details A single `Producer` creates the segment and publishes records, any number of
+     *          `Consumer`s attach to it by name. A record holds one value per channel, stored in
+     *          its binary representation. The segment header describes every channel by name,
+     *          `runtime::Dimension`, element type and number of components, so that a consumer
+     *          checks the dimension once when it asks for a `Channel` handle and afterwards reads
+     *          the values in place, typed as `Quantity<B, D>` or `Vec3<Quantity<B, D>>`.
+     *
+     *          The producer never waits for consumers. Every slot carries a sequence number that
+     *          is odd while the slot is written (a sequence lock), so a consumer that falls more
+     *          than `capacity` records behind skips the overwritten ones and counts them as lost.
+     */
+    namespace telemetry
+    {
+        /// binary type of the components of a channel.
+        enum class ElementType : std::uint32_t
+        {
+            FLOAT32 = 1,
+            FLOAT64 = 2,
+            INT32   = 3,
+            INT64   = 4
+        };
+
+        template<class B>
+        struct element_type;
+
+        template<> struct element_type<float>        : std::integral_constant<ElementType, ElementType::FLOAT32> { };
+        template<> struct element_type<double>       : std::integral_constant<ElementType, ElementType::FLOAT64> { };
+        template<> struct element_type<std::int32_t> : std::integral_constant<ElementType, ElementType::INT32> { };
+        template<> struct element_type<std::int64_t> : std::integral_constant<ElementType, ElementType::INT64> { };
+
+        /// Description of a channel, as recorded in the segment header.
+        struct ChannelInfo
+        {
+            std::string name;
+            runtime::Dimension dimension;
+            ElementType type;
+            std::uint32_t components;   //!< 1 for a quantity, 3 for a vector
+            std::uint32_t offset;       //!< byte offset inside of a record
+        };
+
+        namespace detail
+        {
+            template<class T>
+            struct channel_traits;
+
+            template<class B, class D>
+            struct channel_traits<Quantity<B, D>>
+            {
+                using base_type = B;
+                using dimension_t = D;
+                static constexpr std::uint32_t components = 1;
+            };
+
+            template<class B, class D>
+            struct channel_traits<Vec3<Quantity<B, D>>>
+            {
+                static_assert(sizeof(Vec3<Quantity<B, D>>) == 3 * sizeof(B), "vector has to be tightly packed");
+                using base_type = B;
+                using dimension_t = D;
+                static constexpr std::uint32_t components = 3;
+            };
+
+            template<class T>
+            ChannelInfo make_info(std::string name)
+            {
+                using traits = channel_traits<T>;
+                return ChannelInfo{std::move(name), runtime::to_dynamic(typename traits::dimension_t{}),
+                                   element_type<typename traits::base_type>::value, traits::components, 0};
+            }
+
+            struct Header;
+            struct SlotHeader;
+
+            /// RAII mapping of a named POSIX shared memory object.
+            class SharedMemory
+            {
+            public:
+                SharedMemory() = default;
+                SharedMemory(SharedMemory&& other) noexcept;
+                SharedMemory& operator=(SharedMemory&& other) noexcept;
+                ~SharedMemory();
+
+                /// creates (or replaces) the object `name` with `size` bytes. It is removed again on destruction.
+                static SharedMemory create(const std::string& name, std::size_t size);
+                /// maps the existing object `name` read-only.
+                static SharedMemory open(const std::string& name);
+
+                unsigned char* data() const { return m_Data; }
+                std::size_t size() const { return m_Size; }
+
+            private:
+                void release() noexcept;
+
+                std::string m_Name;
+                unsigned char* m_Data = nullptr;
+                std::size_t m_Size = 0;
+                bool m_Owner = false;
+            };
+        }
+
+        /// Typed handle of a channel, obtained from `Producer::channel` or `Consumer::channel`.
+        template<class T>
+        class Channel
+        {
+        public:
+            Channel() = default;
+            explicit Channel(std::uint32_t offset) : m_Offset(offset) { }
+            std::uint32_t offset() const { return m_Offset; }
+
+        private:
+            std::uint32_t m_Offset = 0;
+        };
+
+        /// View of one record inside of the ring buffer. `Byte` is const for reading views.
+        template<class Byte>
+        class BasicSample
+        {
+        public:
+            BasicSample() = default;
+            BasicSample(Byte* data, std::uint64_t sequence) : m_Data(data), m_Sequence(sequence) { }
+
+            /// sequence number of the record, counting from zero.
+            std::uint64_t sequence() const { return m_Sequence; }
+
+            template<class T>
+            std::conditional_t<std::is_const<Byte>::value, const T&, T&> operator[](Channel<T> channel) const
+            {
+                using target = std::conditional_t<std::is_const<Byte>::value, const T, T>;
+                return *reinterpret_cast<target*>(m_Data + channel.offset());
+            }
+
+        private:
+            Byte* m_Data = nullptr;
+            std::uint64_t m_Sequence = 0;
+        };
+
+        using WriteSample = BasicSample<unsigned char>;
+        using Sample = BasicSample<const unsigned char>;
+
+        /// Ordered list of channels of a telemetry stream.
+        class Schema
+        {
+        public:
+            /// adds a channel for values of type `T`, a `Quantity` or a `Vec3` of quantities.
+            template<class T>
+            Schema& add(const std::string& name)
+            {
+                return add(detail::make_info<T>(name), sizeof(T), alignof(T));
+            }
+
+            const std::vector<ChannelInfo>& channels() const { return m_Channels; }
+
+            /// size of one record in bytes.
+            std::size_t record_size() const { return m_RecordSize; }
+
+        private:
+            Schema& add(ChannelInfo info, std::size_t size, std::size_t align);
+
+            std::vector<ChannelInfo> m_Channels;
+            std::size_t m_RecordSize = 0;
+        };
+
+        namespace detail
+        {
+            /// finds the channel named like `expected`, throws if its dimension, type or components differ.
+            const ChannelInfo& check_channel(const std::vector<ChannelInfo>& channels, const ChannelInfo& expected);
+        }
+
+        /// looks up channel `name` and checks that it holds values of type `T`.
+        template<class T>
+        Channel<T> find_channel(const std::vector<ChannelInfo>& channels, const std::string& name)
+        {
+            return Channel<T>(detail::check_channel(channels, detail::make_info<T>(name)).offset);
+        }
+
+        /// Writing end of a telemetry stream.
+        class Producer
+        {
+        public:
+            /*!
+             * \brief Creates the shared memory segment `name`, e.g. "/attitude".
+             * \param capacity Number of records that are kept, rounded up to a power of two.
+             */
+            Producer(const std::string& name, Schema schema, std::size_t capacity = 1024);
+
+            template<class T>
+            Channel<T> channel(const std::string& name) const
+            {
+                return find_channel<T>(m_Schema.channels(), name);
+            }
+
+            /// starts writing the next record. The previous content of the slot is not cleared.
+            WriteSample begin();
+
+            /// makes the record started by `begin` visible to consumers.
+            void commit();
+
+            /// writes a record by calling `fill(sample)` between `begin` and `commit`.
+            template<class F>
+            void publish(F&& fill)
+            {
+                WriteSample sample = begin();
+                fill(sample);
+                commit();
+            }
+
+            /// number of committed records.
+            std::uint64_t published() const { return m_Next; }
+            std::size_t capacity() const { return m_Capacity; }
+
+        private:
+            detail::SlotHeader* slot(std::uint64_t sequence) const;
+
+            detail::SharedMemory m_Memory;
+            Schema m_Schema;
+            detail::Header* m_Header = nullptr;
+            std::size_t m_Capacity = 0;
+            std::size_t m_Stride = 0;
+            std::uint64_t m_Next = 0;
+        };
+
+        /// Reading end of a telemetry stream. Starts with the first record published after attaching.
+        class Consumer
+        {
+        public:
+            explicit Consumer(const std::string& name);
+
+            const std::vector<ChannelInfo>& channels() const { return m_Channels; }
+
+            /// handle for channel `name`, throws if it does not hold values of type `T`.
+            template<class T>
+            Channel<T> channel(const std::string& name) const
+            {
+                return find_channel<T>(m_Channels, name);
+            }
+
+            /// points `sample` to the next unread record. Returns false if there is none yet.
+            bool poll(Sample& sample);
+
+            /*!
+             * \brief Checks that the record viewed by `sample` has not been overwritten.
+             * \details Values read through a sample are only guaranteed to be consistent
+             *          if this returns true after they have been read.
+             */
+            bool valid(const Sample& sample) const;
+
+            /// number of records that were overwritten before they could be read.
+            std::uint64_t lost() const { return m_Lost; }
+            std::size_t capacity() const { return m_Capacity; }
+
+        private:
+            const detail::SlotHeader* slot(std::uint64_t sequence) const;
+
+            detail::SharedMemory m_Memory;
+            std::vector<ChannelInfo> m_Channels;
+            const detail::Header* m_Header = nullptr;
+            std::size_t m_Capacity = 0;
+            std::size_t m_Stride = 0;
+            std::uint64_t m_Next = 0;
+            std::uint64_t m_Lost = 0;
+        };
+    }
+}
+
+#endif //QUANTITY_TELEMETRY_HPP
@@ -0,0 +1,72 @@
+#ifndef QUANTITY_THREADING_HPP
+#define QUANTITY_THREADING_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace quantity
+{
+    namespace threading
+    {
+        /// Number of worker threads used when the caller does not specify one.
+        inline unsigned default_thread_count()
+        {
+            unsigned n = std::thread::hardware_concurrency();
+            return n == 0 ? 1 : n;
+        }
+
+        /*!
+         * \brief Splits the index range `[0, count)` into contiguous chunks and calls
+         *        `f(begin, end)` for each of them on its own thread.
+         * \details The last chunk runs on the calling thread. Chunks are never smaller than
+         *          `min_chunk`, so small inputs do not pay for thread start-up. The first
+         *          exception thrown by any chunk is rethrown after all threads have joined.
+         * \param threads Number of threads to use, 0 selects `default_thread_count()`.
+         */
+        template<class F>
+        void for_chunks(std::size_t count, F&& f, unsigned threads = 0, std::size_t min_chunk = 1)
+        {
+            if(count == 0) return;
+            if(threads == 0) threads = default_thread_count();
+            min_chunk = std::max<std::size_t>(min_chunk, 1);
+            std::size_t max_chunks = (count + min_chunk - 1) / min_chunk;
+            std::size_t chunks = std::min<std::size_t>(threads, max_chunks);
+            if(chunks <= 1) {
+                f(std::size_t(0), count);
+                return;
+            }
+
+            std::size_t chunk_size = (count + chunks - 1) / chunks;
+            std::vector<std::exception_ptr> errors(chunks);
+            std::vector<std::thread> workers;
+            workers.reserve(chunks - 1);
+
+            auto run = [&](std::size_t chunk) {
+                std::size_t begin = chunk * chunk_size;
+                std::size_t end = std::min(count, begin + chunk_size);
+                try {
+                    if(begin < end) f(begin, end);
+                } catch (...) {
+                    errors[chunk] = std::current_exception();
+                }
+            };
+
+            for(std::size_t c = 0; c + 1 < chunks; ++c) {
+                workers.emplace_back(run, c);
+            }
+            run(chunks - 1);
+
+            for(auto& worker : workers) {
+                worker.join();
+            }
+            for(auto& error : errors) {
+                if(error) std::rethrow_exception(error);
+            }
+        }
+    }
+}
+
+#endif //QUANTITY_THREADING_HPP
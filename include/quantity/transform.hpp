@@ -0,0 +1,59 @@
+#ifndef QUANTITY_TRANSFORM_HPP
+#define QUANTITY_TRANSFORM_HPP
+
+#include <type_traits>
+#include <utility>
+#include "mat.hpp"
+#include "quat.hpp"
+#include "threading.hpp"
+#include "vec_array.hpp"
+
+namespace quantity
+{
+    /// result type of multiplying an `A` with a `B`.
+    template<class A, class B>
+    using product_t = decltype(std::declval<const A&>() * std::declval<const B&>());
+
+    /*!
+     * \brief Applies the matrix `m` to all vectors in `in` and stores the results in `out`.
+     * \details The kernel works directly on the component arrays, so the loop body is a
+     *          handful of multiply-adds over contiguous memory that the compiler vectorizes.
+     *          Large arrays are split across threads. `in` and `out` may be the same array.
+     */
+    template<class M, class V>
+    void transform(const Mat3<M>& m, const Vec3Array<V>& in, Vec3Array<product_t<M, V>>& out, unsigned threads = 0)
+    {
+        out.resize(in.size());
+        const V* ix = in.x.data();
+        const V* iy = in.y.data();
+        const V* iz = in.z.data();
+        auto* ox = out.x.data();
+        auto* oy = out.y.data();
+        auto* oz = out.z.data();
+
+        const M m00 = m(0, 0), m01 = m(0, 1), m02 = m(0, 2);
+        const M m10 = m(1, 0), m11 = m(1, 1), m12 = m(1, 2);
+        const M m20 = m(2, 0), m21 = m(2, 1), m22 = m(2, 2);
+
+        threading::for_chunks(in.size(), [&](std::size_t begin, std::size_t end) {
+            for(std::size_t i = begin; i < end; ++i) {
+                const V vx = ix[i];
+                const V vy = iy[i];
+                const V vz = iz[i];
+                ox[i] = m00 * vx + m01 * vy + m02 * vz;
+                oy[i] = m10 * vx + m11 * vy + m12 * vz;
+                oz[i] = m20 * vx + m21 * vy + m22 * vz;
+            }
+        }, threads, 1 << 16);
+    }
+
+    /// rotates all vectors in `in` by the unit quaternion `q`. `in` and `out` may be the same array.
+    template<class Q, class V>
+    void rotate(const Quat<Q>& q, const Vec3Array<V>& in, Vec3Array<product_t<Q, V>>& out, unsigned threads = 0)
+    {
+        // one matrix-vector product per vector is cheaper than two quaternion products.
+        transform(to_matrix(q), in, out, threads);
+    }
+}
+
+#endif //QUANTITY_TRANSFORM_HPP
@@ -4,6 +4,7 @@
 #include <iosfwd>
 #include <cmath>
 #include <tuple>  // for std::tie
+#include "math.hpp"
 
 namespace quantity {
 
@@ -35,7 +36,7 @@ namespace quantity {
 
         /// apply a function to all components and construct new vector.
         template<class F>
-        auto map(F&& f) const;
+        constexpr auto map(F&& f) const;
     };
 
     template<class T>
@@ -75,7 +76,7 @@ namespace quantity {
     }
 
     template<class T, class S>
-    Vec3<T>& operator+=(Vec3<T>& a, const Vec3<S>& b)
+    constexpr Vec3<T>& operator+=(Vec3<T>& a, const Vec3<S>& b)
     {
         a.x += b.x;
         a.y += b.y;
@@ -84,7 +85,7 @@ namespace quantity {
     }
 
     template<class T, class S>
-    Vec3<T>& operator-=(Vec3<T>& a, const Vec3<S>& b)
+    constexpr Vec3<T>& operator-=(Vec3<T>& a, const Vec3<S>& b)
     {
         a.x -= b.x;
         a.y -= b.y;
@@ -93,7 +94,7 @@ namespace quantity {
     }
 
     template<class T, class S>
-    Vec3<T>& operator*=(Vec3<T>& a, const S& s)
+    constexpr Vec3<T>& operator*=(Vec3<T>& a, const S& s)
     {
         a.x *= s;
         a.y *= s;
@@ -115,13 +116,13 @@ namespace quantity {
 
     // utility functions
     template<class T, class S>
-    auto dot(const Vec3<T>& a, const Vec3<S>& b)
+    constexpr auto dot(const Vec3<T>& a, const Vec3<S>& b)
     {
         return a.x * b.x + a.y * b.y + a.z * b.z;
     }
 
     template<class T, class S>
-    auto cross(const Vec3<T>& a, const Vec3<S>& b)
+    constexpr auto cross(const Vec3<T>& a, const Vec3<S>& b)
     {
         return make_vector(a.y * b.z - a.z * b.y,
                            a.z * b.x - a.x * b.z,
@@ -129,14 +130,14 @@ namespace quantity {
     }
 
     template<class T>
-    T length(const Vec3<T>& vec)
+    constexpr T length(const Vec3<T>& vec)
     {
-        using std::sqrt;
+        using math::sqrt;
         return sqrt(dot(vec, vec));
     }
 
     template<class T, class S>
-    auto parallel(const Vec3<T>& source, const Vec3<S>& reference)
+    constexpr auto parallel(const Vec3<T>& source, const Vec3<S>& reference)
     {
         auto s = dot(reference, reference);
         auto f = dot(source, reference);
@@ -150,7 +151,7 @@ namespace quantity {
     }
 
     template<class T, class S>
-    auto perpendicular(const Vec3<T>& source, const Vec3<S>& reference)
+    constexpr auto perpendicular(const Vec3<T>& source, const Vec3<S>& reference)
     {
         if(reference == Vec3<S>{0,0,0})
             return source;
@@ -160,7 +161,7 @@ namespace quantity {
 
     template<class T>
     template<class F>
-    auto Vec3<T>::map(F&& f) const
+    constexpr auto Vec3<T>::map(F&& f) const
     {
         return make_vector(f(x), f(y), f(z));
     }
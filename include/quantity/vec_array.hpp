@@ -0,0 +1,65 @@
+#ifndef QUANTITY_VEC_ARRAY_HPP
+#define QUANTITY_VEC_ARRAY_HPP
+
+#include <cstddef>
+#include <vector>
+#include "vec.hpp"
+
+namespace quantity
+{
+    /*! \brief Structure-of-arrays storage for many three dimensional vectors.
+     *  \details Each coordinate is kept in its own contiguous array, which is the layout
+     *  batched kernels want. Single vectors can be read and written as `Vec3<T>`.
+     */
+    template<class T>
+    struct Vec3Array
+    {
+        Vec3Array() = default;
+        explicit Vec3Array(std::size_t count) : x(count), y(count), z(count)
+        {}
+
+        std::size_t size() const { return x.size(); }
+        bool empty() const { return x.empty(); }
+
+        void resize(std::size_t count)
+        {
+            x.resize(count);
+            y.resize(count);
+            z.resize(count);
+        }
+
+        void reserve(std::size_t count)
+        {
+            x.reserve(count);
+            y.reserve(count);
+            z.reserve(count);
+        }
+
+        /// the vector at index `i`, assembled from the component arrays.
+        Vec3<T> operator[](std::size_t i) const
+        {
+            return make_vector(x[i], y[i], z[i]);
+        }
+
+        void set(std::size_t i, const Vec3<T>& v)
+        {
+            x[i] = v.x;
+            y[i] = v.y;
+            z[i] = v.z;
+        }
+
+        void push_back(const Vec3<T>& v)
+        {
+            x.push_back(v.x);
+            y.push_back(v.y);
+            z.push_back(v.z);
+        }
+
+        // the coordinates
+        std::vector<T> x;
+        std::vector<T> y;
+        std::vector<T> z;
+    };
+}
+
+#endif //QUANTITY_VEC_ARRAY_HPP
@@ -0,0 +1,405 @@
+#ifndef QUANTITY_VIEWS_HPP
+#define QUANTITY_VIEWS_HPP
+
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <boost/throw_exception.hpp>
+#include "io.hpp"
+#include "quantity.hpp"
+#include "vec.hpp"
+#include "vec_array.hpp"
+
+namespace quantity
+{
+    /*!
+     * \brief Lazy views over ranges of quantities.
+     * \details Views do not own or copy data. Adaptors are chained with `|`, e.g.
+     *          \code
+     *          auto fast = views::from_unit<speed_t>(raw, "km/s") | views::filter(is_fast) | views::scaled(0.5);
+     *          speed_t total = views::sum(fast);
+     *          \endcode
+     *          Nothing is computed until the view is iterated, and then every element passes
+     *          through the whole chain at once, so a chain of adaptors is a single loop without
+     *          intermediate vectors. Elements are produced by value and keep their quantity types.
+     *          A view refers to the containers it was created from, which have to outlive it.
+     */
+    namespace views
+    {
+        /// base class of all views, used to tell views from containers.
+        struct ViewBase { };
+
+        template<class T>
+        using is_view = std::is_base_of<ViewBase, std::decay_t<T>>;
+
+        /// view of an iterator range.
+        template<class It>
+        class RangeView : public ViewBase
+        {
+        public:
+            using iterator = It;
+
+            RangeView(It first, It last) : m_Begin(first), m_End(last) { }
+            It begin() const { return m_Begin; }
+            It end() const { return m_End; }
+
+        private:
+            It m_Begin;
+            It m_End;
+        };
+
+        /// a view of `range`. Views are copied, containers are referenced.
+        template<class R, std::enable_if_t<is_view<R>::value, int> = 0>
+        std::decay_t<R> all(R&& range)
+        {
+            return range;
+        }
+
+        template<class R, std::enable_if_t<!is_view<R>::value, int> = 0>
+        auto all(R&& range)
+        {
+            static_assert(std::is_lvalue_reference<R>::value, "views cannot refer to temporary containers");
+            using std::begin;
+            using std::end;
+            const auto& r = range;
+            return RangeView<decltype(begin(r))>(begin(r), end(r));
+        }
+
+        template<class R>
+        using all_t = decltype(all(std::declval<R>()));
+
+        // ------------------------------------------------------------------------------------------
+        //                                      map
+        // ------------------------------------------------------------------------------------------
+
+        /// view that applies `F` to every element of `V`.
+        template<class V, class F>
+        class MapView : public ViewBase
+        {
+            using base_iterator = typename V::iterator;
+        public:
+            class iterator
+            {
+            public:
+                using value_type        = std::decay_t<decltype(std::declval<const F&>()(*std::declval<base_iterator>()))>;
+                using reference         = value_type;
+                using pointer           = void;
+                using difference_type   = std::ptrdiff_t;
+                using iterator_category = std::input_iterator_tag;
+
+                iterator(base_iterator it, const F* f) : m_It(it), m_F(f) { }
+
+                value_type operator*() const { return (*m_F)(*m_It); }
+                iterator& operator++() { ++m_It; return *this; }
+                iterator operator++(int) { iterator old = *this; ++m_It; return old; }
+                bool operator==(const iterator& o) const { return m_It == o.m_It; }
+                bool operator!=(const iterator& o) const { return m_It != o.m_It; }
+
+            private:
+                base_iterator m_It;
+                const F* m_F;
+            };
+
+            MapView(V base, F f) : m_Base(std::move(base)), m_F(std::move(f)) { }
+
+            iterator begin() const { return iterator(m_Base.begin(), &m_F); }
+            iterator end() const { return iterator(m_Base.end(), &m_F); }
+
+        private:
+            V m_Base;
+            F m_F;
+        };
+
+        template<class F>
+        struct MapAdaptor
+        {
+            F f;
+        };
+
+        /// adaptor that applies `f` to every element, like `Vec3::map` does for the components of a vector.
+        template<class F>
+        MapAdaptor<std::decay_t<F>> map(F&& f)
+        {
+            return {std::forward<F>(f)};
+        }
+
+        template<class R, class F>
+        MapView<all_t<R>, F> operator|(R&& range, MapAdaptor<F> adaptor)
+        {
+            return MapView<all_t<R>, F>(all(std::forward<R>(range)), std::move(adaptor.f));
+        }
+
+        // ------------------------------------------------------------------------------------------
+        //                                      filter
+        // ------------------------------------------------------------------------------------------
+
+        /// view of the elements of `V` for which `P` is true.
+        template<class V, class P>
+        class FilterView : public ViewBase
+        {
+            using base_iterator = typename V::iterator;
+        public:
+            class iterator
+            {
+            public:
+                using value_type        = typename std::iterator_traits<base_iterator>::value_type;
+                using reference         = decltype(*std::declval<base_iterator>());
+                using pointer           = void;
+                using difference_type   = std::ptrdiff_t;
+                using iterator_category = std::input_iterator_tag;
+
+                iterator(base_iterator it, base_iterator last, const P* p) : m_It(it), m_End(last), m_P(p)
+                {
+                    skip();
+                }
+
+                reference operator*() const { return *m_It; }
+                iterator& operator++() { ++m_It; skip(); return *this; }
+                iterator operator++(int) { iterator old = *this; ++*this; return old; }
+                bool operator==(const iterator& o) const { return m_It == o.m_It; }
+                bool operator!=(const iterator& o) const { return m_It != o.m_It; }
+
+            private:
+                void skip()
+                {
+                    while(m_It != m_End && !(*m_P)(*m_It)) ++m_It;
+                }
+
+                base_iterator m_It;
+                base_iterator m_End;
+                const P* m_P;
+            };
+
+            FilterView(V base, P p) : m_Base(std::move(base)), m_P(std::move(p)) { }
+
+            iterator begin() const { return iterator(m_Base.begin(), m_Base.end(), &m_P); }
+            iterator end() const { return iterator(m_Base.end(), m_Base.end(), &m_P); }
+
+        private:
+            V m_Base;
+            P m_P;
+        };
+
+        template<class P>
+        struct FilterAdaptor
+        {
+            P p;
+        };
+
+        /// adaptor that keeps the elements for which `p` returns true.
+        template<class P>
+        FilterAdaptor<std::decay_t<P>> filter(P&& p)
+        {
+            return {std::forward<P>(p)};
+        }
+
+        template<class R, class P>
+        FilterView<all_t<R>, P> operator|(R&& range, FilterAdaptor<P> adaptor)
+        {
+            return FilterView<all_t<R>, P>(all(std::forward<R>(range)), std::move(adaptor.p));
+        }
+
+        // ------------------------------------------------------------------------------------------
+        //                                      zip
+        // ------------------------------------------------------------------------------------------
+
+        /// view of tuples of the elements of several views. Ends with the shortest of them.
+        template<class... V>
+        class ZipView : public ViewBase
+        {
+            using base_iterators = std::tuple<typename V::iterator...>;
+            using indices = std::index_sequence_for<V...>;
+        public:
+            class iterator
+            {
+            public:
+                using value_type        = std::tuple<std::decay_t<decltype(*std::declval<typename V::iterator>())>...>;
+                using reference         = value_type;
+                using pointer           = void;
+                using difference_type   = std::ptrdiff_t;
+                using iterator_category = std::input_iterator_tag;
+
+                explicit iterator(base_iterators its) : m_Its(std::move(its)) { }
+
+                value_type operator*() const { return dereference(indices{}); }
+                iterator& operator++() { increment(indices{}); return *this; }
+                iterator operator++(int) { iterator old = *this; increment(indices{}); return old; }
+                /// iterators are equal as soon as any of the underlying iterators are.
+                bool operator==(const iterator& o) const { return any_equal(o, indices{}); }
+                bool operator!=(const iterator& o) const { return !any_equal(o, indices{}); }
+
+            private:
+                template<std::size_t... I>
+                value_type dereference(std::index_sequence<I...>) const
+                {
+                    return value_type(*std::get<I>(m_Its)...);
+                }
+
+                template<std::size_t... I>
+                void increment(std::index_sequence<I...>)
+                {
+                    int expand[] = {0, (++std::get<I>(m_Its), 0)...};
+                    (void)expand;
+                }
+
+                template<std::size_t... I>
+                bool any_equal(const iterator& o, std::index_sequence<I...>) const
+                {
+                    bool equal = false;
+                    int expand[] = {0, (equal = equal || std::get<I>(m_Its) == std::get<I>(o.m_Its), 0)...};
+                    (void)expand;
+                    return equal;
+                }
+
+                base_iterators m_Its;
+            };
+
+            explicit ZipView(V... bases) : m_Bases(std::move(bases)...) { }
+
+            iterator begin() const { return make_begin(indices{}); }
+            iterator end() const { return make_end(indices{}); }
+
+        private:
+            template<std::size_t... I>
+            iterator make_begin(std::index_sequence<I...>) const
+            {
+                return iterator(base_iterators(std::get<I>(m_Bases).begin()...));
+            }
+
+            template<std::size_t... I>
+            iterator make_end(std::index_sequence<I...>) const
+            {
+                return iterator(base_iterators(std::get<I>(m_Bases).end()...));
+            }
+
+            std::tuple<V...> m_Bases;
+        };
+
+        /// zips the ranges into a view of `std::tuple`s.
+        template<class... R>
+        ZipView<all_t<R>...> zip(R&&... ranges)
+        {
+            return ZipView<all_t<R>...>(all(std::forward<R>(ranges))...);
+        }
+
+        // ------------------------------------------------------------------------------------------
+        //                              quantity specific adaptors
+        // ------------------------------------------------------------------------------------------
+
+        namespace detail
+        {
+            template<class Q>
+            struct FromRaw
+            {
+                double factor;
+                Q operator()(double raw) const { return Q(raw * factor); }
+            };
+
+            struct Scale
+            {
+                double factor;
+                template<class T>
+                T operator()(const T& v) const { return factor * v; }
+            };
+
+            template<int C>
+            struct Component
+            {
+                template<class T>
+                T operator()(const Vec3<T>& v) const { return C == 0 ? v.x : (C == 1 ? v.y : v.z); }
+            };
+
+            struct MakeVector
+            {
+                template<class T>
+                Vec3<T> operator()(const std::tuple<T, T, T>& t) const
+                {
+                    return make_vector(std::get<0>(t), std::get<1>(t), std::get<2>(t));
+                }
+            };
+        }
+
+        /*!
+         * \brief View of raw numbers, given in `unit`, as SI quantities `Q`.
+         * \details The unit is parsed and checked against the dimension of `Q` once, here; the
+         *          conversion factor is then applied to each element while the view is consumed.
+         * \throw std::runtime_error if `unit` does not have the dimension of `Q`.
+         */
+        template<class Q, class R>
+        MapView<all_t<R>, detail::FromRaw<Q>> from_unit(R&& raw, const std::string& unit)
+        {
+            runtime::Dimension parsed = runtime::parse_dim(unit);
+            double factor = runtime::prefix_scale(parsed.factor);
+            parsed.factor = runtime::Ratio{0, 1};
+            if(!(parsed == runtime::to_dynamic(typename Q::dimension_t{}))) {
+                BOOST_THROW_EXCEPTION(std::runtime_error("Unit " + unit + " does not match the dimension of the view"));
+            }
+            return MapView<all_t<R>, detail::FromRaw<Q>>(all(std::forward<R>(raw)), detail::FromRaw<Q>{factor});
+        }
+
+        /// adaptor that multiplies every element by a dimensionless `factor`.
+        inline MapAdaptor<detail::Scale> scaled(double factor)
+        {
+            return {detail::Scale{factor}};
+        }
+
+        /// adaptors that project a range of `Vec3`s onto one of their components.
+        inline MapAdaptor<detail::Component<0>> x() { return {}; }
+        inline MapAdaptor<detail::Component<1>> y() { return {}; }
+        inline MapAdaptor<detail::Component<2>> z() { return {}; }
+
+        /// view of the components of a `Vec3Array` assembled into `Vec3`s.
+        template<class T>
+        auto vectors(const Vec3Array<T>& array)
+        {
+            return zip(array.x, array.y, array.z) | map(detail::MakeVector{});
+        }
+
+        // ------------------------------------------------------------------------------------------
+        //                                      consumers
+        // ------------------------------------------------------------------------------------------
+
+        /// folds the view with `op`, starting at `init`.
+        template<class R, class T, class Op>
+        T reduce(const R& range, T init, Op op)
+        {
+            for(auto&& v : range) init = op(std::move(init), v);
+            return init;
+        }
+
+        /// sum of all elements, zero for an empty view.
+        template<class R>
+        auto sum(const R& range)
+        {
+            using value_type = std::decay_t<decltype(*std::begin(range))>;
+            value_type total{};
+            for(auto&& v : range) total += v;
+            return total;
+        }
+
+        /// number of elements.
+        template<class R>
+        std::size_t count(const R& range)
+        {
+            std::size_t n = 0;
+            for(auto it = std::begin(range); it != std::end(range); ++it) ++n;
+            return n;
+        }
+
+        /// materializes the view.
+        template<class R>
+        auto to_vector(const R& range)
+        {
+            std::vector<std::decay_t<decltype(*std::begin(range))>> result;
+            for(auto&& v : range) result.push_back(v);
+            return result;
+        }
+    }
+}
+
+#endif //QUANTITY_VIEWS_HPP
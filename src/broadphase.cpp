@@ -0,0 +1,285 @@
+#include "quantity/broadphase.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <boost/throw_exception.hpp>
+
+namespace quantity
+{
+    namespace broadphase
+    {
+        namespace
+        {
+            void check_sizes(std::size_t positions, std::size_t radii)
+            {
+                if(positions != radii) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("Mismatched number of positions and radii"));
+                }
+            }
+
+            void copy_bodies(Span<const predefined::length_vec> positions, Span<const predefined::length_t> radii,
+                             std::vector<double>& x, std::vector<double>& y, std::vector<double>& z,
+                             std::vector<double>& r)
+            {
+                check_sizes(positions.size(), radii.size());
+                std::size_t n = positions.size();
+                x.resize(n);
+                y.resize(n);
+                z.resize(n);
+                r.resize(n);
+                for(std::size_t i = 0; i < n; ++i) {
+                    x[i] = positions[i].x.value;
+                    y[i] = positions[i].y.value;
+                    z[i] = positions[i].z.value;
+                    r[i] = radii[i].value;
+                }
+            }
+
+            bool overlap(const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z,
+                         const std::vector<double>& r, std::uint32_t a, std::uint32_t b)
+            {
+                double dx = x[a] - x[b];
+                double dy = y[a] - y[b];
+                double dz = z[a] - z[b];
+                double rr = r[a] + r[b];
+                return dx * dx + dy * dy + dz * dz <= rr * rr;
+            }
+
+            Pair make_pair(std::uint32_t a, std::uint32_t b)
+            {
+                return a < b ? Pair{a, b} : Pair{b, a};
+            }
+        }
+
+        bool operator==(const Pair& x, const Pair& y)
+        {
+            return x.a == y.a && x.b == y.b;
+        }
+
+        bool operator<(const Pair& x, const Pair& y)
+        {
+            return std::tie(x.a, x.b) < std::tie(y.a, y.b);
+        }
+
+        void brute_force(Span<const predefined::length_vec> positions, Span<const predefined::length_t> radii,
+                         std::vector<Pair>& pairs)
+        {
+            check_sizes(positions.size(), radii.size());
+            for(std::size_t i = 0; i < positions.size(); ++i) {
+                for(std::size_t j = i + 1; j < positions.size(); ++j) {
+                    if(spheres_overlap(positions[i], radii[i], positions[j], radii[j])) {
+                        pairs.push_back(Pair{std::uint32_t(i), std::uint32_t(j)});
+                    }
+                }
+            }
+        }
+
+        // -------------------------------------------------------------------------------------------------
+        //  uniform grid
+
+        UniformGrid::UniformGrid(predefined::length_t margin, predefined::length_t cell_size) :
+            m_Margin(margin.value), m_MinCellSize(cell_size.value)
+        {
+            if(m_Margin < 0 || m_MinCellSize < 0) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Grid margin and cell size must not be negative"));
+            }
+        }
+
+        UniformGrid::Cell UniformGrid::cell_of(const predefined::length_vec& p) const
+        {
+            return Cell{std::int64_t(std::floor(p.x.value / m_CellSize)),
+                        std::int64_t(std::floor(p.y.value / m_CellSize)),
+                        std::int64_t(std::floor(p.z.value / m_CellSize))};
+        }
+
+        std::size_t UniformGrid::bucket_of(const Cell& c) const
+        {
+            auto h = std::uint64_t(c.i) * 73856093u ^ std::uint64_t(c.j) * 19349663u ^ std::uint64_t(c.k) * 83492791u;
+            return std::size_t(h ^ (h >> 29)) & m_BucketMask;
+        }
+
+        bool UniformGrid::fits(const predefined::length_vec& p, const Cell& c) const
+        {
+            auto inside = [&](double v, std::int64_t i) {
+                return v >= i * m_CellSize - m_Margin && v <= (i + 1) * m_CellSize + m_Margin;
+            };
+            return inside(p.x.value, c.i) && inside(p.y.value, c.j) && inside(p.z.value, c.k);
+        }
+
+        void UniformGrid::build(Span<const predefined::length_vec> positions, Span<const predefined::length_t> radii)
+        {
+            copy_bodies(positions, radii, m_X, m_Y, m_Z, m_R);
+            const std::size_t n = positions.size();
+            if(n >= std::numeric_limits<std::uint32_t>::max()) {
+                BOOST_THROW_EXCEPTION(std::length_error("Too many bodies for uniform grid"));
+            }
+
+            m_MaxRadius = n == 0 ? 0 : *std::max_element(m_R.begin(), m_R.end());
+            // the small excess makes sure that exactly touching bodies are still in neighbouring cells.
+            m_CellSize = std::max(m_MinCellSize, (2 * m_MaxRadius + 2 * m_Margin) * (1 + 1e-9));
+            if(m_CellSize <= 0) {
+                // point-like bodies without margin: any cell size works, only coincident points overlap.
+                m_CellSize = 1;
+            }
+
+            std::size_t buckets = 1;
+            while(buckets < 2 * n) buckets *= 2;
+            m_BucketMask = buckets - 1;
+
+            // counting sort of the bodies by bucket
+            m_Cells.resize(n);
+            std::vector<std::uint32_t> bucket(n);
+            m_BucketStart.assign(buckets + 1, 0);
+            for(std::size_t i = 0; i < n; ++i) {
+                m_Cells[i] = cell_of(positions[i]);
+                bucket[i] = std::uint32_t(bucket_of(m_Cells[i]));
+                m_BucketStart[bucket[i] + 1] += 1;
+            }
+            std::partial_sum(m_BucketStart.begin(), m_BucketStart.end(), m_BucketStart.begin());
+
+            m_Sorted.resize(n);
+            std::vector<std::uint32_t> fill(m_BucketStart.begin(), m_BucketStart.end() - 1);
+            for(std::size_t i = 0; i < n; ++i) {
+                m_Sorted[fill[bucket[i]]++] = std::uint32_t(i);
+            }
+        }
+
+        bool UniformGrid::update(Span<const predefined::length_vec> positions, Span<const predefined::length_t> radii)
+        {
+            check_sizes(positions.size(), radii.size());
+            if(positions.size() != m_Cells.size()) {
+                build(positions, radii);
+                return true;
+            }
+
+            double max_radius = 0;
+            bool valid = true;
+            for(std::size_t i = 0; i < positions.size() && valid; ++i) {
+                max_radius = std::max(max_radius, radii[i].value);
+                valid = fits(positions[i], m_Cells[i]);
+            }
+            if(!valid || 2 * max_radius + 2 * m_Margin > m_CellSize) {
+                build(positions, radii);
+                return true;
+            }
+
+            copy_bodies(positions, radii, m_X, m_Y, m_Z, m_R);
+            m_MaxRadius = max_radius;
+            return false;
+        }
+
+        void UniformGrid::find_pairs(std::vector<Pair>& pairs) const
+        {
+            for(std::uint32_t i : m_Sorted) {
+                const Cell& home = m_Cells[i];
+                for(std::int64_t di = -1; di <= 1; ++di)
+                for(std::int64_t dj = -1; dj <= 1; ++dj)
+                for(std::int64_t dk = -1; dk <= 1; ++dk) {
+                    Cell c{home.i + di, home.j + dj, home.k + dk};
+                    std::size_t b = bucket_of(c);
+                    for(std::uint32_t s = m_BucketStart[b]; s < m_BucketStart[b + 1]; ++s) {
+                        std::uint32_t j = m_Sorted[s];
+                        // several cells may share a bucket, so check the actual cell as well.
+                        if(j <= i) continue;
+                        const Cell& other = m_Cells[j];
+                        if(other.i != c.i || other.j != c.j || other.k != c.k) continue;
+                        if(overlap(m_X, m_Y, m_Z, m_R, i, j)) {
+                            pairs.push_back(Pair{i, j});
+                        }
+                    }
+                }
+            }
+        }
+
+        // -------------------------------------------------------------------------------------------------
+        //  sweep and prune
+
+        void SweepAndPrune::load(Span<const predefined::length_vec> positions, Span<const predefined::length_t> radii)
+        {
+            copy_bodies(positions, radii, m_X, m_Y, m_Z, m_R);
+            const std::vector<double>& axis = m_Axis == 0 ? m_X : (m_Axis == 1 ? m_Y : m_Z);
+            m_Lower.resize(axis.size());
+            m_Upper.resize(axis.size());
+            for(std::size_t i = 0; i < axis.size(); ++i) {
+                m_Lower[i] = axis[i] - m_R[i];
+                m_Upper[i] = axis[i] + m_R[i];
+            }
+        }
+
+        void SweepAndPrune::build(Span<const predefined::length_vec> positions, Span<const predefined::length_t> radii)
+        {
+            check_sizes(positions.size(), radii.size());
+            if(positions.size() >= std::numeric_limits<std::uint32_t>::max()) {
+                BOOST_THROW_EXCEPTION(std::length_error("Too many bodies for sweep and prune"));
+            }
+
+            // sweep along the axis with the largest variance, this prunes the most pairs.
+            double sum[3] = {0, 0, 0};
+            double sum_sq[3] = {0, 0, 0};
+            for(const auto& p : positions) {
+                const double c[3] = {p.x.value, p.y.value, p.z.value};
+                for(int k = 0; k < 3; ++k) {
+                    sum[k] += c[k];
+                    sum_sq[k] += c[k] * c[k];
+                }
+            }
+            double best = -1;
+            for(int k = 0; k < 3; ++k) {
+                double n = positions.empty() ? 1.0 : double(positions.size());
+                double variance = sum_sq[k] / n - (sum[k] / n) * (sum[k] / n);
+                if(variance > best) {
+                    best = variance;
+                    m_Axis = k;
+                }
+            }
+
+            load(positions, radii);
+            m_Order.resize(positions.size());
+            std::iota(m_Order.begin(), m_Order.end(), 0u);
+            std::sort(m_Order.begin(), m_Order.end(), [&](std::uint32_t a, std::uint32_t b) {
+                return m_Lower[a] < m_Lower[b];
+            });
+        }
+
+        void SweepAndPrune::update(Span<const predefined::length_vec> positions, Span<const predefined::length_t> radii)
+        {
+            check_sizes(positions.size(), radii.size());
+            if(positions.size() != m_Order.size()) {
+                build(positions, radii);
+                return;
+            }
+
+            load(positions, radii);
+            // insertion sort, linear for an almost sorted order
+            for(std::size_t i = 1; i < m_Order.size(); ++i) {
+                std::uint32_t body = m_Order[i];
+                double key = m_Lower[body];
+                std::size_t j = i;
+                while(j > 0 && m_Lower[m_Order[j - 1]] > key) {
+                    m_Order[j] = m_Order[j - 1];
+                    --j;
+                }
+                m_Order[j] = body;
+            }
+        }
+
+        void SweepAndPrune::find_pairs(std::vector<Pair>& pairs) const
+        {
+            const std::size_t n = m_Order.size();
+            for(std::size_t oi = 0; oi < n; ++oi) {
+                std::uint32_t i = m_Order[oi];
+                double upper = m_Upper[i];
+                for(std::size_t oj = oi + 1; oj < n && m_Lower[m_Order[oj]] <= upper; ++oj) {
+                    std::uint32_t j = m_Order[oj];
+                    if(overlap(m_X, m_Y, m_Z, m_R, i, j)) {
+                        pairs.push_back(make_pair(i, j));
+                    }
+                }
+            }
+        }
+    }
+}
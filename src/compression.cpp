@@ -0,0 +1,374 @@
+#include "quantity/compression.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace quantity
+{
+    namespace compression
+    {
+        namespace
+        {
+            constexpr std::uint32_t MAGIC = 0x31424751;     // "QGB1"
+            constexpr std::size_t MAX_COMPONENTS = 3;
+            /// zero bytes after the last stream, so that the reader can always load eight bytes.
+            constexpr std::size_t PADDING = 8;
+
+            struct RawHeader
+            {
+                std::uint32_t magic;
+                std::uint32_t count;
+                std::uint32_t components;
+                std::uint32_t reserved;
+                std::int64_t dimension[8];      //!< length, mass, time and factor as numerator, denominator
+                double resolution;
+                double first_time;
+                double last_time;
+                std::uint32_t stream_bytes[1 + MAX_COMPONENTS];     //!< time stream, then one per component
+            };
+
+            int leading_zeros(std::uint64_t x)
+            {
+#if defined(__GNUC__)
+                return __builtin_clzll(x);
+#else
+                int n = 0;
+                for(std::uint64_t bit = std::uint64_t(1) << 63; !(x & bit); bit >>= 1) ++n;
+                return n;
+#endif
+            }
+
+            int trailing_zeros(std::uint64_t x)
+            {
+#if defined(__GNUC__)
+                return __builtin_ctzll(x);
+#else
+                int n = 0;
+                for(; !(x & 1); x >>= 1) ++n;
+                return n;
+#endif
+            }
+
+            std::uint64_t to_bits(double v)
+            {
+                std::uint64_t bits;
+                std::memcpy(&bits, &v, sizeof(bits));
+                return bits;
+            }
+
+            double from_bits(std::uint64_t bits)
+            {
+                double v;
+                std::memcpy(&v, &bits, sizeof(v));
+                return v;
+            }
+
+            std::uint64_t load_big_endian(const unsigned char* p)
+            {
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+                std::uint64_t word;
+                std::memcpy(&word, p, sizeof(word));
+                return __builtin_bswap64(word);
+#else
+                std::uint64_t word = 0;
+                for(int i = 0; i < 8; ++i) word = (word << 8) | p[i];
+                return word;
+#endif
+            }
+
+            /// appends bits, most significant first, to a byte buffer.
+            class BitWriter
+            {
+            public:
+                explicit BitWriter(std::vector<unsigned char>& out) : m_Out(out) { }
+
+                void write(std::uint64_t bits, unsigned n)
+                {
+                    if(n > 32) {
+                        write(bits >> 32, n - 32);
+                        n = 32;
+                    }
+                    if(n == 0) return;
+                    m_Buffer = (m_Buffer << n) | (bits & ((std::uint64_t(1) << n) - 1));
+                    m_Used += n;
+                    while(m_Used >= 8) {
+                        m_Used -= 8;
+                        m_Out.push_back((unsigned char)(m_Buffer >> m_Used));
+                    }
+                }
+
+                /// writes out the last partial byte.
+                void finish()
+                {
+                    if(m_Used > 0) {
+                        m_Out.push_back((unsigned char)(m_Buffer << (8 - m_Used)));
+                        m_Used = 0;
+                    }
+                }
+
+            private:
+                std::vector<unsigned char>& m_Out;
+                std::uint64_t m_Buffer = 0;
+                unsigned m_Used = 0;
+            };
+
+            /// reads bits written by `BitWriter` from a stream of `size` bytes. Relies on `PADDING`
+            /// bytes after the end of the data, throws std::runtime_error past the end of the stream.
+            class BitReader
+            {
+            public:
+                BitReader(const unsigned char* data, std::size_t size) : m_Data(data), m_End(size * 8) { }
+
+                /// reads `n <= 32` bits.
+                std::uint64_t read(unsigned n)
+                {
+                    if(n == 0) return 0;
+                    if(m_Position + n > m_End) {
+                        BOOST_THROW_EXCEPTION(std::runtime_error("Compressed stream is truncated"));
+                    }
+                    std::uint64_t word = load_big_endian(m_Data + (m_Position >> 3)) << (m_Position & 7);
+                    m_Position += n;
+                    return word >> (64 - n);
+                }
+
+                std::uint64_t read64()
+                {
+                    std::uint64_t high = read(32);
+                    return (high << 32) | read(32);
+                }
+
+                std::uint64_t read_long(unsigned n)
+                {
+                    if(n <= 32) return read(n);
+                    std::uint64_t high = read(n - 32);
+                    return (high << 32) | read(32);
+                }
+
+                bool bit() { return read(1) != 0; }
+
+            private:
+                const unsigned char* m_Data;
+                const std::size_t m_End;
+                std::size_t m_Position = 0;
+            };
+
+            std::int64_t sign_extend(std::uint64_t bits, unsigned n)
+            {
+                std::uint64_t sign = std::uint64_t(1) << (n - 1);
+                return std::int64_t((bits ^ sign) - sign);
+            }
+
+            /// delta-of-delta encoding of the timestamps, as ticks of the resolution.
+            void encode_times(BitWriter& out, const std::vector<std::int64_t>& ticks)
+            {
+                out.write(std::uint64_t(ticks[0]), 64);
+                std::int64_t previous_delta = 0;
+                for(std::size_t i = 1; i < ticks.size(); ++i) {
+                    std::int64_t delta = ticks[i] - ticks[i - 1];
+                    std::int64_t dod = delta - previous_delta;
+                    previous_delta = delta;
+                    if(dod == 0) {
+                        out.write(0, 1);
+                    } else if(dod >= -63 && dod <= 64) {
+                        out.write(0b10, 2);
+                        out.write(std::uint64_t(dod), 7);
+                    } else if(dod >= -255 && dod <= 256) {
+                        out.write(0b110, 3);
+                        out.write(std::uint64_t(dod), 9);
+                    } else if(dod >= -2047 && dod <= 2048) {
+                        out.write(0b1110, 4);
+                        out.write(std::uint64_t(dod), 12);
+                    } else {
+                        out.write(0b1111, 4);
+                        out.write(std::uint64_t(dod), 64);
+                    }
+                }
+            }
+
+            void decode_times(BitReader& in, Span<double> times, double resolution)
+            {
+                std::int64_t tick = std::int64_t(in.read64());
+                std::int64_t delta = 0;
+                times[0] = double(tick) * resolution;
+                for(std::size_t i = 1; i < times.size(); ++i) {
+                    if(in.bit()) {
+                        unsigned width;
+                        if(!in.bit()) width = 7;
+                        else if(!in.bit()) width = 9;
+                        else if(!in.bit()) width = 12;
+                        else width = 64;
+                        std::int64_t dod = sign_extend(in.read_long(width), width);
+                        // the encoder stores 64 as the 7 bit pattern of -64, and so on
+                        if(width != 64 && dod == -(std::int64_t(1) << (width - 1))) dod = -dod;
+                        delta += dod;
+                    }
+                    tick += delta;
+                    times[i] = double(tick) * resolution;
+                }
+            }
+
+            /// XOR encoding of floating point values.
+            void encode_values(BitWriter& out, Span<const double> values)
+            {
+                std::uint64_t previous = to_bits(values[0]);
+                out.write(previous, 64);
+                int window_leading = -1;
+                int window_trailing = 0;
+                for(std::size_t i = 1; i < values.size(); ++i) {
+                    std::uint64_t bits = to_bits(values[i]);
+                    std::uint64_t x = bits ^ previous;
+                    previous = bits;
+                    if(x == 0) {
+                        out.write(0, 1);
+                        continue;
+                    }
+                    int leading = std::min(leading_zeros(x), 63);
+                    int trailing = trailing_zeros(x);
+                    if(window_leading >= 0 && leading >= window_leading && trailing >= window_trailing) {
+                        // the meaningful bits fit into the previous window
+                        out.write(0b10, 2);
+                        out.write(x >> window_trailing, unsigned(64 - window_leading - window_trailing));
+                    } else {
+                        int meaningful = 64 - leading - trailing;
+                        out.write(0b11, 2);
+                        out.write(std::uint64_t(leading), 6);
+                        out.write(std::uint64_t(meaningful - 1), 6);
+                        out.write(x >> trailing, unsigned(meaningful));
+                        window_leading = leading;
+                        window_trailing = trailing;
+                    }
+                }
+            }
+
+            void decode_values(BitReader& in, Span<double> values)
+            {
+                std::uint64_t previous = in.read64();
+                values[0] = from_bits(previous);
+                unsigned window_leading = 0;
+                unsigned window_trailing = 0;
+                for(std::size_t i = 1; i < values.size(); ++i) {
+                    if(in.bit()) {
+                        if(in.bit()) {
+                            window_leading = unsigned(in.read(6));
+                            unsigned meaningful = unsigned(in.read(6)) + 1;
+                            if(window_leading + meaningful > 64) {
+                                BOOST_THROW_EXCEPTION(std::runtime_error("Invalid compressed value window"));
+                            }
+                            window_trailing = 64 - window_leading - meaningful;
+                        }
+                        previous ^= in.read_long(64 - window_leading - window_trailing) << window_trailing;
+                    }
+                    values[i] = from_bits(previous);
+                }
+            }
+
+            RawHeader load_header(Span<const unsigned char> block)
+            {
+                RawHeader header;
+                if(block.size() < sizeof(header) + PADDING) {
+                    BOOST_THROW_EXCEPTION(std::runtime_error("Compressed block is too short"));
+                }
+                std::memcpy(&header, block.data(), sizeof(header));
+                if(header.magic != MAGIC || header.components == 0 || header.components > MAX_COMPONENTS ||
+                   header.count == 0) {
+                    BOOST_THROW_EXCEPTION(std::runtime_error("Invalid compressed block header"));
+                }
+                // every stream holds a 64 bit first sample and at least one bit per further sample
+                const std::uint64_t minimum_bits = 64 + std::uint64_t(header.count) - 1;
+                std::size_t total = sizeof(header) + PADDING;
+                bool truncated = false;
+                for(std::uint32_t s = 0; s <= header.components; ++s) {
+                    total += header.stream_bytes[s];
+                    truncated = truncated || std::uint64_t(header.stream_bytes[s]) * 8 < minimum_bits;
+                }
+                if(truncated || total != block.size()) {
+                    BOOST_THROW_EXCEPTION(std::runtime_error("Compressed block has an invalid size"));
+                }
+                return header;
+            }
+        }
+
+        BlockInfo read_block_info(Span<const unsigned char> block)
+        {
+            RawHeader header = load_header(block);
+            const std::int64_t* d = header.dimension;
+            return BlockInfo{runtime::Dimension{{d[0], d[1]}, {d[2], d[3]}, {d[4], d[5]}, {d[6], d[7]}},
+                             header.count, header.components, header.resolution, header.first_time,
+                             header.last_time};
+        }
+
+        std::vector<unsigned char> encode_block(const runtime::Dimension& dimension, double resolution,
+                                                Span<const double> times,
+                                                const std::vector<Span<const double>>& components)
+        {
+            if(times.empty() || components.empty() || components.size() > MAX_COMPONENTS || !(resolution > 0)) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Cannot encode an empty block"));
+            }
+            for(const auto& c : components) {
+                if(c.size() != times.size()) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("Components and times differ in size"));
+                }
+            }
+
+            std::vector<std::int64_t> ticks(times.size());
+            for(std::size_t i = 0; i < times.size(); ++i) ticks[i] = std::llround(times[i] / resolution);
+
+            RawHeader header;
+            std::memset(&header, 0, sizeof(header));
+            header.magic = MAGIC;
+            header.count = std::uint32_t(times.size());
+            header.components = std::uint32_t(components.size());
+            const runtime::Ratio* ratios[4] = {&dimension.length, &dimension.mass, &dimension.time, &dimension.factor};
+            for(int r = 0; r < 4; ++r) {
+                header.dimension[2 * r] = ratios[r]->num;
+                header.dimension[2 * r + 1] = ratios[r]->den;
+            }
+            header.resolution = resolution;
+            header.first_time = double(ticks.front()) * resolution;
+            header.last_time = double(ticks.back()) * resolution;
+
+            std::vector<unsigned char> block(sizeof(header));
+            std::size_t start = block.size();
+            {
+                BitWriter writer(block);
+                encode_times(writer, ticks);
+                writer.finish();
+            }
+            header.stream_bytes[0] = std::uint32_t(block.size() - start);
+            for(std::size_t c = 0; c < components.size(); ++c) {
+                start = block.size();
+                BitWriter writer(block);
+                encode_values(writer, components[c]);
+                writer.finish();
+                header.stream_bytes[c + 1] = std::uint32_t(block.size() - start);
+            }
+            block.resize(block.size() + PADDING, 0);
+            std::memcpy(block.data(), &header, sizeof(header));
+            return block;
+        }
+
+        void decode_block(Span<const unsigned char> block, Span<double> times,
+                          const std::vector<Span<double>>& components)
+        {
+            RawHeader header = load_header(block);
+            if(times.size() != header.count || components.size() != header.components) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Output buffers do not match the block"));
+            }
+
+            const unsigned char* stream = block.data() + sizeof(header);
+            BitReader time_reader(stream, header.stream_bytes[0]);
+            decode_times(time_reader, times, header.resolution);
+            stream += header.stream_bytes[0];
+
+            for(std::size_t c = 0; c < components.size(); ++c) {
+                if(components[c].size() != header.count) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("Output buffers do not match the block"));
+                }
+                BitReader reader(stream, header.stream_bytes[c + 1]);
+                decode_values(reader, components[c]);
+                stream += header.stream_bytes[c + 1];
+            }
+        }
+    }
+}
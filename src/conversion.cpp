@@ -0,0 +1,53 @@
+#include "quantity/conversion.hpp"
+#include "quantity/io.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace quantity
+{
+    namespace runtime
+    {
+        ConversionPlan::ConversionPlan(const std::string& from, const std::string& to) : m_From(from), m_To(to)
+        {
+            Dimension source = parse_dim(from);
+            Dimension target = parse_dim(to);
+            m_SourceFactor = source.factor;
+            m_TargetFactor = target.factor;
+            source.factor = Ratio{0, 1};
+            target.factor = Ratio{0, 1};
+            if(!(source == target)) {
+                BOOST_THROW_EXCEPTION(std::runtime_error("Cannot convert " + from + " to " + to +
+                                                         ", the dimensions differ"));
+            }
+            m_Dimension = source;
+            // one multiplication for both prefixes
+            m_Factor = prefix_scale(Ratio{m_SourceFactor.num * m_TargetFactor.den - m_TargetFactor.num * m_SourceFactor.den,
+                                          m_SourceFactor.den * m_TargetFactor.den});
+        }
+
+        const ConversionPlan& ConversionPlan::cached(const std::string& from, const std::string& to)
+        {
+            static std::mutex mutex;
+            static std::map<std::pair<std::string, std::string>, std::unique_ptr<ConversionPlan>> plans;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            auto& plan = plans[std::make_pair(from, to)];
+            if(!plan) plan.reset(new ConversionPlan(from, to));
+            return *plan;
+        }
+
+        void ConversionPlan::check_quantity(const Dimension& quantity_dim, const Ratio& unit_factor,
+                                            const std::string& unit) const
+        {
+            if(!(quantity_dim == m_Dimension)) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Quantity does not have the dimension of " + unit));
+            }
+            if(unit_factor.num != 0) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Quantities need a coherent SI unit instead of " + unit));
+            }
+        }
+    }
+}
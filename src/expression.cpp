@@ -0,0 +1,471 @@
+#include "quantity/expression.hpp"
+#include "quantity/io.hpp"
+#include "quantity/threading.hpp"
+#include "runtime_utils.hpp"
+#include "runtime_ratio.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <boost/throw_exception.hpp>
+
+namespace quantity
+{
+    namespace runtime
+    {
+        namespace
+        {
+            using OpCode = Expression::OpCode;
+            using Instruction = Expression::Instruction;
+
+            /// number of rows that are processed by one pass over the program.
+            constexpr std::size_t BLOCK = 256;
+
+            bool same_dimension(const Dimension& a, const Dimension& b)
+            {
+                return a.length == b.length && a.mass == b.mass && a.time == b.time;
+            }
+
+            struct Node
+            {
+                OpCode op;
+                int index = 0;
+                double value = 0;
+                Dimension dim{};
+                std::unique_ptr<Node> lhs;
+                std::unique_ptr<Node> rhs;
+
+                bool is_constant() const { return op == OpCode::CONSTANT; }
+            };
+
+            using NodePtr = std::unique_ptr<Node>;
+
+            NodePtr make_constant(double value)
+            {
+                NodePtr node(new Node{OpCode::CONSTANT});
+                node->value = value;
+                return node;
+            }
+
+            double apply(OpCode op, double a, double b, int index, double value)
+            {
+                switch(op) {
+                    case OpCode::ADD:   return a + b;
+                    case OpCode::SUB:   return a - b;
+                    case OpCode::MUL:   return a * b;
+                    case OpCode::DIV:   return a / b;
+                    case OpCode::NEG:   return -a;
+                    case OpCode::POWI:  return std::pow(a, index);
+                    case OpCode::POW:   return std::pow(a, value);
+                    case OpCode::SQRT:  return std::sqrt(a);
+                    case OpCode::ABS:   return std::abs(a);
+                    case OpCode::SCALE: return a * value;
+                    default:            return a;
+                }
+            }
+
+            /// replaces operations whose operands are all constant by their result.
+            NodePtr fold(NodePtr node)
+            {
+                if(node->lhs) node->lhs = fold(std::move(node->lhs));
+                if(node->rhs) node->rhs = fold(std::move(node->rhs));
+                if(!node->lhs || !node->lhs->is_constant()) return node;
+                if(node->rhs && !node->rhs->is_constant()) return node;
+
+                double b = node->rhs ? node->rhs->value : 0.0;
+                NodePtr result = make_constant(apply(node->op, node->lhs->value, b, node->index, node->value));
+                result->dim = node->dim;
+                return result;
+            }
+
+            /*!
+             * \brief Recursive descent parser that checks dimensions while it builds the syntax tree.
+             * \details Grammar:
+             *          sum     := product (('+' | '-') product)*
+             *          product := unary (('*' | '/') unary)*
+             *          unary   := '-' unary | power
+             *          power   := primary ('^' exponent)?
+             *          primary := number | name | name '(' sum ')' | '(' sum ')'
+             */
+            class Parser
+            {
+            public:
+                Parser(const std::string& text, const std::vector<Variable>& variables) :
+                        m_Text(text), m_Variables(variables)
+                {
+                }
+
+                NodePtr parse()
+                {
+                    NodePtr result = sum();
+                    skip_space();
+                    if(m_Pos != m_Text.size()) {
+                        fail("Unexpected '" + std::string(1, m_Text[m_Pos]) + "'");
+                    }
+                    return result;
+                }
+
+            private:
+                [[noreturn]] void fail(const std::string& message) const
+                {
+                    BOOST_THROW_EXCEPTION(std::runtime_error(message + " at position " + std::to_string(m_Pos) +
+                                                             " of expression '" + m_Text + "'"));
+                }
+
+                void skip_space()
+                {
+                    while(m_Pos < m_Text.size() && std::isspace(static_cast<unsigned char>(m_Text[m_Pos]))) ++m_Pos;
+                }
+
+                bool accept(char c)
+                {
+                    skip_space();
+                    if(m_Pos < m_Text.size() && m_Text[m_Pos] == c) {
+                        ++m_Pos;
+                        return true;
+                    }
+                    return false;
+                }
+
+                void expect(char c)
+                {
+                    if(!accept(c)) fail(std::string("Expected '") + c + "'");
+                }
+
+                NodePtr binary(OpCode op, NodePtr lhs, NodePtr rhs)
+                {
+                    NodePtr node(new Node{op});
+                    node->dim = lhs->dim;
+                    switch(op) {
+                        case OpCode::ADD:
+                        case OpCode::SUB:
+                            if(!same_dimension(lhs->dim, rhs->dim)) {
+                                fail("Cannot add or subtract " + to_string(lhs->dim, "1") + " and " + to_string(rhs->dim, "1"));
+                            }
+                            break;
+                        case OpCode::MUL:
+                            node->dim += rhs->dim;
+                            break;
+                        default:
+                            node->dim -= rhs->dim;
+                            break;
+                    }
+                    node->lhs = std::move(lhs);
+                    node->rhs = std::move(rhs);
+                    return node;
+                }
+
+                NodePtr unary_node(OpCode op, NodePtr operand)
+                {
+                    NodePtr node(new Node{op});
+                    node->dim = operand->dim;
+                    node->lhs = std::move(operand);
+                    return node;
+                }
+
+                NodePtr sum()
+                {
+                    NodePtr node = product();
+                    while(true) {
+                        if(accept('+')) node = binary(OpCode::ADD, std::move(node), product());
+                        else if(accept('-')) node = binary(OpCode::SUB, std::move(node), product());
+                        else return node;
+                    }
+                }
+
+                NodePtr product()
+                {
+                    NodePtr node = unary();
+                    while(true) {
+                        if(accept('*')) node = binary(OpCode::MUL, std::move(node), unary());
+                        else if(accept('/')) node = binary(OpCode::DIV, std::move(node), unary());
+                        else return node;
+                    }
+                }
+
+                NodePtr unary()
+                {
+                    if(accept('-')) return unary_node(OpCode::NEG, unary());
+                    return power();
+                }
+
+                NodePtr power()
+                {
+                    NodePtr base = primary();
+                    if(!accept('^')) return base;
+
+                    Ratio exponent;
+                    if(accept('(')) {
+                        exponent = Ratio(signed_integer());
+                        if(accept('/')) {
+                            const long divisor = signed_integer();
+                            if(divisor == 0) fail("Zero denominator in exponent");
+                            exponent = exponent / Ratio(divisor);
+                        }
+                        expect(')');
+                    } else {
+                        exponent = Ratio(signed_integer());
+                    }
+
+                    NodePtr node = unary_node(exponent.den == 1 ? OpCode::POWI : OpCode::POW, std::move(base));
+                    node->index = int(exponent.num);
+                    node->value = double(exponent.num) / double(exponent.den);
+                    node->dim *= exponent;
+                    return node;
+                }
+
+                long signed_integer()
+                {
+                    bool negative = accept('-');
+                    skip_space();
+                    std::size_t start = m_Pos;
+                    while(m_Pos < m_Text.size() && std::isdigit(static_cast<unsigned char>(m_Text[m_Pos]))) ++m_Pos;
+                    if(start == m_Pos) fail("Expected an integer exponent");
+                    long value = std::stol(m_Text.substr(start, m_Pos - start));
+                    return negative ? -value : value;
+                }
+
+                NodePtr primary()
+                {
+                    if(accept('(')) {
+                        NodePtr node = sum();
+                        expect(')');
+                        return node;
+                    }
+
+                    skip_space();
+                    if(m_Pos == m_Text.size()) fail("Unexpected end");
+
+                    char c = m_Text[m_Pos];
+                    if(std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+                        const char* begin = m_Text.c_str() + m_Pos;
+                        char* end = nullptr;
+                        double value = std::strtod(begin, &end);
+                        m_Pos += std::size_t(end - begin);
+                        return make_constant(value);
+                    }
+
+                    if(!std::isalpha(static_cast<unsigned char>(c)) && c != '_') {
+                        fail("Unexpected '" + std::string(1, c) + "'");
+                    }
+                    std::size_t start = m_Pos;
+                    while(m_Pos < m_Text.size() &&
+                          (std::isalnum(static_cast<unsigned char>(m_Text[m_Pos])) || m_Text[m_Pos] == '_')) {
+                        ++m_Pos;
+                    }
+                    std::string name = m_Text.substr(start, m_Pos - start);
+
+                    if(accept('(')) {
+                        NodePtr argument = sum();
+                        expect(')');
+                        if(name == "abs") return unary_node(OpCode::ABS, std::move(argument));
+                        if(name == "sqrt") {
+                            NodePtr node = unary_node(OpCode::SQRT, std::move(argument));
+                            node->dim *= Ratio{1, 2};
+                            return node;
+                        }
+                        fail("Unknown function '" + name + "'");
+                    }
+
+                    for(std::size_t i = 0; i < m_Variables.size(); ++i) {
+                        if(m_Variables[i].name == name) {
+                            NodePtr node(new Node{OpCode::LOAD});
+                            node->index = int(i);
+                            // values are converted to SI units while they are loaded.
+                            node->value = prefix_scale(m_Variables[i].unit.factor);
+                            node->dim = m_Variables[i].unit;
+                            node->dim.factor = Ratio{0, 1};
+                            return node;
+                        }
+                    }
+                    fail("Unknown variable '" + name + "'");
+                }
+
+                const std::string& m_Text;
+                const std::vector<Variable>& m_Variables;
+                std::size_t m_Pos = 0;
+            };
+
+            /// emits the program in postfix order, returns the stack depth needed to evaluate `node`.
+            std::size_t emit(const Node& node, std::vector<Instruction>& program)
+            {
+                // multiplication and division by a constant become a single scaling of the other operand.
+                if(node.op == OpCode::MUL && (node.lhs->is_constant() || node.rhs->is_constant())) {
+                    const Node& constant = node.lhs->is_constant() ? *node.lhs : *node.rhs;
+                    const Node& other = node.lhs->is_constant() ? *node.rhs : *node.lhs;
+                    std::size_t depth = emit(other, program);
+                    program.push_back(Instruction{OpCode::SCALE, 0, constant.value});
+                    return depth;
+                }
+                if(node.op == OpCode::DIV && node.rhs->is_constant()) {
+                    std::size_t depth = emit(*node.lhs, program);
+                    program.push_back(Instruction{OpCode::SCALE, 0, 1.0 / node.rhs->value});
+                    return depth;
+                }
+
+                std::size_t depth = 1;
+                if(node.lhs) depth = emit(*node.lhs, program);
+                if(node.rhs) depth = std::max(depth, 1 + emit(*node.rhs, program));
+
+                program.push_back(Instruction{node.op, node.index, node.value});
+                return depth;
+            }
+        }
+
+        Expression Expression::compile(const std::string& formula, const std::vector<Variable>& variables,
+                                       const std::string& output_unit)
+        {
+            NodePtr root = Parser(formula, variables).parse();
+
+            Expression result;
+            result.m_Dimension = root->dim;
+            result.m_VariableCount = variables.size();
+
+            if(!output_unit.empty()) {
+                Dimension unit = parse_dim(output_unit);
+                if(!same_dimension(unit, root->dim)) {
+                    BOOST_THROW_EXCEPTION(std::runtime_error("Expression '" + formula + "' has dimension " +
+                                                             to_string(root->dim, "1") + ", which cannot be expressed in " +
+                                                             output_unit));
+                }
+                double scale = 1.0 / prefix_scale(unit.factor);
+                if(scale != 1.0) {
+                    NodePtr node(new Node{OpCode::SCALE});
+                    node->value = scale;
+                    node->dim = root->dim;
+                    node->lhs = std::move(root);
+                    root = std::move(node);
+                }
+                result.m_Dimension = unit;
+            }
+
+            root = fold(std::move(root));
+            result.m_StackDepth = emit(*root, result.m_Program);
+            return result;
+        }
+
+        void Expression::run_block(const std::vector<Span<const double>>& columns, std::size_t begin,
+                                   std::size_t count, double* stack, double* out) const
+        {
+            // `depth` values are on the stack, the topmost starts at `stack + (depth - 1) * BLOCK`
+            std::size_t depth = 0;
+            for(const Instruction& ins : m_Program) {
+                switch(ins.op) {
+                    case OpCode::LOAD: {
+                        double* top = stack + depth++ * BLOCK;
+                        const double* src = columns[ins.index].data() + begin;
+                        const double s = ins.value;
+                        for(std::size_t i = 0; i < count; ++i) top[i] = src[i] * s;
+                        break;
+                    }
+                    case OpCode::CONSTANT: {
+                        double* top = stack + depth++ * BLOCK;
+                        const double v = ins.value;
+                        for(std::size_t i = 0; i < count; ++i) top[i] = v;
+                        break;
+                    }
+                    case OpCode::ADD: {
+                        double* a = stack + (--depth - 1) * BLOCK;
+                        const double* b = a + BLOCK;
+                        for(std::size_t i = 0; i < count; ++i) a[i] += b[i];
+                        break;
+                    }
+                    case OpCode::SUB: {
+                        double* a = stack + (--depth - 1) * BLOCK;
+                        const double* b = a + BLOCK;
+                        for(std::size_t i = 0; i < count; ++i) a[i] -= b[i];
+                        break;
+                    }
+                    case OpCode::MUL: {
+                        double* a = stack + (--depth - 1) * BLOCK;
+                        const double* b = a + BLOCK;
+                        for(std::size_t i = 0; i < count; ++i) a[i] *= b[i];
+                        break;
+                    }
+                    case OpCode::DIV: {
+                        double* a = stack + (--depth - 1) * BLOCK;
+                        const double* b = a + BLOCK;
+                        for(std::size_t i = 0; i < count; ++i) a[i] /= b[i];
+                        break;
+                    }
+                    case OpCode::NEG: {
+                        double* top = stack + (depth - 1) * BLOCK;
+                        for(std::size_t i = 0; i < count; ++i) top[i] = -top[i];
+                        break;
+                    }
+                    case OpCode::POWI: {
+                        double* top = stack + (depth - 1) * BLOCK;
+                        const int n = ins.index < 0 ? -ins.index : ins.index;
+                        for(std::size_t i = 0; i < count; ++i) {
+                            double x = top[i];
+                            double r = 1.0;
+                            for(int k = 0; k < n; ++k) r *= x;
+                            top[i] = ins.index < 0 ? 1.0 / r : r;
+                        }
+                        break;
+                    }
+                    case OpCode::POW: {
+                        double* top = stack + (depth - 1) * BLOCK;
+                        for(std::size_t i = 0; i < count; ++i) top[i] = std::pow(top[i], ins.value);
+                        break;
+                    }
+                    case OpCode::SQRT: {
+                        double* top = stack + (depth - 1) * BLOCK;
+                        for(std::size_t i = 0; i < count; ++i) top[i] = std::sqrt(top[i]);
+                        break;
+                    }
+                    case OpCode::ABS: {
+                        double* top = stack + (depth - 1) * BLOCK;
+                        for(std::size_t i = 0; i < count; ++i) top[i] = std::abs(top[i]);
+                        break;
+                    }
+                    case OpCode::SCALE: {
+                        double* top = stack + (depth - 1) * BLOCK;
+                        const double s = ins.value;
+                        for(std::size_t i = 0; i < count; ++i) top[i] *= s;
+                        break;
+                    }
+                }
+            }
+            for(std::size_t i = 0; i < count; ++i) out[i] = stack[i];
+        }
+
+        void Expression::evaluate(const std::vector<Span<const double>>& columns, Span<double> out,
+                                  unsigned threads) const
+        {
+            if(columns.size() != m_VariableCount) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Expected " + std::to_string(m_VariableCount) +
+                                                            " columns, got " + std::to_string(columns.size())));
+            }
+            for(const auto& column : columns) {
+                if(column.size() != out.size()) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("Column size does not match the output size"));
+                }
+            }
+
+            const std::size_t blocks = (out.size() + BLOCK - 1) / BLOCK;
+            threading::for_chunks(blocks, [&](std::size_t first, std::size_t last) {
+                std::vector<double> stack(m_StackDepth * BLOCK);
+                for(std::size_t b = first; b < last; ++b) {
+                    std::size_t begin = b * BLOCK;
+                    std::size_t count = std::min(BLOCK, out.size() - begin);
+                    run_block(columns, begin, count, stack.data(), out.data() + begin);
+                }
+            }, threads, 64);
+        }
+
+        double Expression::evaluate(const std::vector<double>& row) const
+        {
+            std::vector<Span<const double>> columns;
+            columns.reserve(row.size());
+            for(const double& value : row) columns.emplace_back(&value, 1);
+
+            double result = 0;
+            evaluate(columns, Span<double>(&result, 1), 1);
+            return result;
+        }
+    }
+}
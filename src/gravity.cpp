@@ -0,0 +1,312 @@
+#include "quantity/gravity.hpp"
+#include "quantity/threading.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <boost/throw_exception.hpp>
+
+namespace quantity
+{
+    namespace gravity
+    {
+        namespace
+        {
+            constexpr unsigned MORTON_BITS = 21;
+
+            /// spreads the lower 21 bits of `a` so that there are two zero bits between each of them.
+            std::uint64_t split_by_3(std::uint32_t a)
+            {
+                std::uint64_t x = a & 0x1fffff;
+                x = (x | x << 32) & 0x1f00000000ffffull;
+                x = (x | x << 16) & 0x1f0000ff0000ffull;
+                x = (x | x << 8)  & 0x100f00f00f00f00full;
+                x = (x | x << 4)  & 0x10c30c30c30c30c3ull;
+                x = (x | x << 2)  & 0x1249249249249249ull;
+                return x;
+            }
+
+            /// octant of a Morton code at the given subdivision level.
+            unsigned octant(std::uint64_t code, unsigned level)
+            {
+                return unsigned(code >> (3 * (MORTON_BITS - 1 - level))) & 7u;
+            }
+
+            void check_sizes(std::size_t positions, std::size_t masses, std::size_t target)
+            {
+                if(positions != masses || positions != target) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("Mismatched number of positions, masses and "
+                                                                "accelerations"));
+                }
+            }
+
+            predefined::accel_vec to_accel(const double* acc)
+            {
+                return make_vector(predefined::accel_t(acc[0]), predefined::accel_t(acc[1]),
+                                   predefined::accel_t(acc[2]));
+            }
+        }
+
+        void direct_sum(Span<const predefined::length_vec> positions, Span<const predefined::mass_t> masses,
+                        Span<predefined::accel_vec> accelerations, const Options& options)
+        {
+            check_sizes(positions.size(), masses.size(), accelerations.size());
+            double g = options.gravitational_constant.value;
+            double eps2 = options.softening.value * options.softening.value;
+            threading::for_chunks(positions.size(), [&](std::size_t begin, std::size_t end) {
+                for(std::size_t i = begin; i < end; ++i) {
+                    double acc[3] = {0, 0, 0};
+                    const auto& p = positions[i];
+                    for(std::size_t j = 0; j < positions.size(); ++j) {
+                        double dx = positions[j].x.value - p.x.value;
+                        double dy = positions[j].y.value - p.y.value;
+                        double dz = positions[j].z.value - p.z.value;
+                        double r2 = dx * dx + dy * dy + dz * dz + eps2;
+                        if(r2 == 0) continue;
+                        double f = masses[j].value / (r2 * std::sqrt(r2));
+                        acc[0] += f * dx;
+                        acc[1] += f * dy;
+                        acc[2] += f * dz;
+                    }
+                    for(double& a : acc) a *= g;
+                    accelerations[i] = to_accel(acc);
+                }
+            }, options.threads, 64);
+        }
+
+        BarnesHut::BarnesHut(Options options) : m_Options(options)
+        {
+            if(m_Options.leaf_size == 0) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Barnes-Hut leaf size must be positive"));
+            }
+            if(!(m_Options.opening_angle >= 0)) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Barnes-Hut opening angle must not be negative"));
+            }
+        }
+
+        void BarnesHut::build(Span<const predefined::length_vec> positions, Span<const predefined::mass_t> masses)
+        {
+            check_sizes(positions.size(), masses.size(), positions.size());
+            if(positions.size() >= std::numeric_limits<std::uint32_t>::max()) {
+                BOOST_THROW_EXCEPTION(std::length_error("Too many bodies for Barnes-Hut tree"));
+            }
+
+            const std::size_t n = positions.size();
+            m_Nodes.clear();
+            m_X.resize(n);
+            m_Y.resize(n);
+            m_Z.resize(n);
+            m_Mass.resize(n);
+            m_Codes.resize(n);
+            m_Order.resize(n);
+            if(n == 0) return;
+
+            // bounding cube
+            double lo[3] = {positions[0].x.value, positions[0].y.value, positions[0].z.value};
+            double hi[3] = {lo[0], lo[1], lo[2]};
+            for(const auto& p : positions) {
+                const double c[3] = {p.x.value, p.y.value, p.z.value};
+                for(int k = 0; k < 3; ++k) {
+                    lo[k] = std::min(lo[k], c[k]);
+                    hi[k] = std::max(hi[k], c[k]);
+                }
+            }
+            double side = std::max({hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]});
+            // grow the cube slightly so that the maximum coordinate still maps inside the grid
+            side = side > 0 ? side * (1 + 1e-9) : 1.0;
+
+            // Morton codes
+            std::vector<std::pair<std::uint64_t, std::uint32_t>> keys(n);
+            const double scale = double(1u << MORTON_BITS) / side;
+            const std::uint32_t max_cell = (1u << MORTON_BITS) - 1;
+            threading::for_chunks(n, [&](std::size_t begin, std::size_t end) {
+                for(std::size_t i = begin; i < end; ++i) {
+                    const double c[3] = {positions[i].x.value, positions[i].y.value, positions[i].z.value};
+                    std::uint64_t code = 0;
+                    for(int k = 0; k < 3; ++k) {
+                        auto cell = std::uint32_t(std::min(double(max_cell), (c[k] - lo[k]) * scale));
+                        code |= split_by_3(cell) << k;
+                    }
+                    keys[i] = {code, std::uint32_t(i)};
+                }
+            }, m_Options.threads, 4096);
+            std::sort(keys.begin(), keys.end());
+
+            threading::for_chunks(n, [&](std::size_t begin, std::size_t end) {
+                for(std::size_t i = begin; i < end; ++i) {
+                    auto src = keys[i].second;
+                    m_Codes[i] = keys[i].first;
+                    m_Order[i] = src;
+                    m_X[i] = positions[src].x.value;
+                    m_Y[i] = positions[src].y.value;
+                    m_Z[i] = positions[src].z.value;
+                    m_Mass[i] = masses[src].value;
+                }
+            }, m_Options.threads, 4096);
+
+            // root node
+            m_Nodes.push_back(Node{{lo[0], lo[1], lo[2]}, 0, side, 0, 0, std::uint32_t(n), true});
+            if(n <= m_Options.leaf_size) {
+                finish_node(m_Nodes, 0);
+                return;
+            }
+            m_Nodes[0].leaf = false;
+
+            // split the root into its octants and build each of them independently
+            std::uint32_t bounds[9];
+            bounds[0] = 0;
+            for(unsigned o = 0; o < 8; ++o) {
+                auto first = m_Codes.begin() + bounds[o];
+                auto split = std::partition_point(first, m_Codes.end(), [&](std::uint64_t c) {
+                    return octant(c, 0) <= o;
+                });
+                bounds[o + 1] = std::uint32_t(split - m_Codes.begin());
+            }
+
+            std::vector<std::vector<Node>> subtrees(8);
+            threading::for_chunks(8, [&](std::size_t begin, std::size_t end) {
+                for(std::size_t o = begin; o < end; ++o) {
+                    if(bounds[o] != bounds[o + 1]) {
+                        build_subtree(subtrees[o], bounds[o], bounds[o + 1], 1, side / 2);
+                    }
+                }
+            }, m_Options.threads);
+
+            // concatenate the subtrees, they are self-contained up to the offset of their skip indices.
+            for(auto& subtree : subtrees) {
+                auto offset = std::uint32_t(m_Nodes.size());
+                for(auto& node : subtree) {
+                    node.skip += offset;
+                    m_Nodes.push_back(node);
+                }
+            }
+            finish_node(m_Nodes, 0);
+        }
+
+        void BarnesHut::build_subtree(std::vector<Node>& nodes, std::uint32_t begin, std::uint32_t end,
+                                      unsigned level, double side) const
+        {
+            std::size_t index = nodes.size();
+            nodes.push_back(Node{{0, 0, 0}, 0, side, 0, begin, end, true});
+
+            if(end - begin > m_Options.leaf_size && level < MORTON_BITS) {
+                nodes[index].leaf = false;
+                std::uint32_t child_begin = begin;
+                while(child_begin < end) {
+                    unsigned oct = octant(m_Codes[child_begin], level);
+                    auto split = std::partition_point(m_Codes.begin() + child_begin, m_Codes.begin() + end,
+                                                      [&](std::uint64_t c) { return octant(c, level) <= oct; });
+                    auto child_end = std::uint32_t(split - m_Codes.begin());
+                    build_subtree(nodes, child_begin, child_end, level + 1, side / 2);
+                    child_begin = child_end;
+                }
+            }
+
+            // `nodes` may have been reallocated by the recursive calls.
+            finish_node(nodes, index);
+        }
+
+        void BarnesHut::finish_node(std::vector<Node>& nodes, std::size_t index) const
+        {
+            Node& node = nodes[index];
+            node.skip = std::uint32_t(nodes.size());
+
+            double mass = 0;
+            double com[3] = {0, 0, 0};
+            if(node.leaf) {
+                for(std::uint32_t b = node.begin; b < node.end; ++b) {
+                    mass += m_Mass[b];
+                    com[0] += m_Mass[b] * m_X[b];
+                    com[1] += m_Mass[b] * m_Y[b];
+                    com[2] += m_Mass[b] * m_Z[b];
+                }
+            } else {
+                for(std::size_t c = index + 1; c < node.skip; c = nodes[c].skip) {
+                    mass += nodes[c].mass;
+                    for(int k = 0; k < 3; ++k) com[k] += nodes[c].mass * nodes[c].com[k];
+                }
+            }
+
+            node.mass = mass;
+            for(int k = 0; k < 3; ++k) {
+                // massless cells keep their corner as reference point; they contribute nothing anyway.
+                node.com[k] = mass != 0 ? com[k] / mass : node.com[k];
+            }
+        }
+
+        void BarnesHut::accumulate(const double* p, double* acc) const
+        {
+            const double theta2 = m_Options.opening_angle * m_Options.opening_angle;
+            const double eps2 = m_Options.softening.value * m_Options.softening.value;
+            const std::size_t count = m_Nodes.size();
+
+            std::size_t i = 0;
+            while(i < count) {
+                const Node& node = m_Nodes[i];
+                double dx = node.com[0] - p[0];
+                double dy = node.com[1] - p[1];
+                double dz = node.com[2] - p[2];
+                double d2 = dx * dx + dy * dy + dz * dz;
+
+                if(node.leaf) {
+                    for(std::uint32_t b = node.begin; b < node.end; ++b) {
+                        double bx = m_X[b] - p[0];
+                        double by = m_Y[b] - p[1];
+                        double bz = m_Z[b] - p[2];
+                        double r2 = bx * bx + by * by + bz * bz + eps2;
+                        // also skips the body itself
+                        if(r2 == 0) continue;
+                        double f = m_Mass[b] / (r2 * std::sqrt(r2));
+                        acc[0] += f * bx;
+                        acc[1] += f * by;
+                        acc[2] += f * bz;
+                    }
+                    i = node.skip;
+                } else if(node.side * node.side < theta2 * d2) {
+                    double r2 = d2 + eps2;
+                    double f = node.mass / (r2 * std::sqrt(r2));
+                    acc[0] += f * dx;
+                    acc[1] += f * dy;
+                    acc[2] += f * dz;
+                    i = node.skip;
+                } else {
+                    i += 1;
+                }
+            }
+        }
+
+        void BarnesHut::accelerations(Span<predefined::accel_vec> target) const
+        {
+            check_sizes(m_Mass.size(), m_Mass.size(), target.size());
+            const double g = m_Options.gravitational_constant.value;
+            // iterate in Morton order, so that consecutive bodies traverse similar parts of the tree.
+            threading::for_chunks(m_Mass.size(), [&](std::size_t begin, std::size_t end) {
+                for(std::size_t i = begin; i < end; ++i) {
+                    const double p[3] = {m_X[i], m_Y[i], m_Z[i]};
+                    double acc[3] = {0, 0, 0};
+                    accumulate(p, acc);
+                    for(double& a : acc) a *= g;
+                    target[m_Order[i]] = to_accel(acc);
+                }
+            }, m_Options.threads, 64);
+        }
+
+        predefined::accel_vec BarnesHut::acceleration(const predefined::length_vec& position) const
+        {
+            const double p[3] = {position.x.value, position.y.value, position.z.value};
+            double acc[3] = {0, 0, 0};
+            accumulate(p, acc);
+            for(double& a : acc) a *= m_Options.gravitational_constant.value;
+            return to_accel(acc);
+        }
+
+        void barnes_hut(Span<const predefined::length_vec> positions, Span<const predefined::mass_t> masses,
+                        Span<predefined::accel_vec> accelerations, const Options& options)
+        {
+            BarnesHut tree(options);
+            tree.build(positions, masses);
+            tree.accelerations(accelerations);
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#include "quantity/ingest.hpp"
+#include "quantity/io.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <system_error>
+#include <unistd.h>
+
+namespace quantity
+{
+    namespace ingest
+    {
+        namespace
+        {
+            bool is_space(char c)
+            {
+                return c == ' ' || c == '\t' || c == '\r';
+            }
+        }
+
+        Source from_fd(int fd)
+        {
+            return [fd](char* buffer, std::size_t size) -> std::size_t {
+                while(true) {
+                    const ssize_t n = ::read(fd, buffer, size);
+                    if(n >= 0) return std::size_t(n);
+                    if(errno != EINTR) BOOST_THROW_EXCEPTION(std::system_error(errno, std::generic_category(), "read"));
+                }
+            };
+        }
+
+        Source from_stream(std::istream& stream)
+        {
+            return [&stream](char* buffer, std::size_t size) -> std::size_t {
+                stream.read(buffer, std::streamsize(size));
+                if(stream.bad()) BOOST_THROW_EXCEPTION(std::runtime_error("Reading the input stream failed"));
+                return std::size_t(stream.gcount());
+            };
+        }
+
+        namespace detail
+        {
+            void split(std::string& carry, const std::string& chunk, bool last, Lines& out)
+            {
+                const std::size_t end = last ? chunk.size() : chunk.rfind('\n') + 1;   // 0 without a newline
+                out.text.clear();
+                out.lines.clear();
+                if(end == 0 && !last) {
+                    carry += chunk;
+                    return;
+                }
+                out.text.reserve(carry.size() + end);
+                out.text.swap(carry);
+                out.text.append(chunk, 0, end);
+                carry.assign(chunk, end, std::string::npos);
+
+                const char* text = out.text.data();
+                const std::size_t size = out.text.size();
+                std::size_t begin = 0;
+                while(begin < size) {
+                    const void* newline = std::memchr(text + begin, '\n', size - begin);
+                    std::size_t stop = newline ? std::size_t(static_cast<const char*>(newline) - text) : size;
+                    std::size_t next = stop + 1;
+                    while(begin < stop && is_space(text[begin])) ++begin;
+                    while(stop > begin && is_space(text[stop - 1])) --stop;
+                    if(stop > begin) out.lines.emplace_back(std::uint32_t(begin), std::uint32_t(stop));
+                    begin = next;
+                }
+            }
+
+            const Unit* UnitTable::find(const char* first, const char* last)
+            {
+                const std::size_t length = std::size_t(last - first);
+                for(const Unit& unit : m_Units) {
+                    if(unit.name.size() == length && std::memcmp(unit.name.data(), first, length) == 0) return &unit;
+                }
+
+                Unit unit;
+                unit.name.assign(first, last);
+                unit.valid = true;
+                try {
+                    unit.dimension = unit.name.empty() ? runtime::Dimension{} : runtime::parse_dim(unit.name);
+                } catch (const std::exception&) {
+                    unit.valid = false;
+                }
+                unit.scale = runtime::prefix_scale(unit.dimension.factor);
+                unit.dimension.factor = runtime::Ratio{0, 1};
+                m_Units.push_back(std::move(unit));
+                return &m_Units.back();
+            }
+
+            void parse(const Lines& lines, UnitTable& units, bool strict, Parsed& out)
+            {
+                out.values.resize(lines.lines.size());
+                out.units.resize(lines.lines.size());
+                const char* text = lines.text.c_str();
+                for(std::size_t i = 0; i < lines.lines.size(); ++i) {
+                    // lines start and end without blanks and are followed by a newline or the end of the text
+                    const char* first = text + lines.lines[i].first;
+                    const char* last = text + lines.lines[i].second;
+                    char* end;
+                    const double value = std::strtod(first, &end);
+                    const char* unit = end;
+                    while(unit < last && is_space(*unit)) ++unit;
+                    const char* unit_end = unit;
+                    while(unit_end < last && !is_space(*unit_end)) ++unit_end;
+
+                    const bool ok = end != first && end <= last && unit_end == last && (unit == end) == (unit == last);
+                    if(ok) {
+                        out.values[i] = value;
+                        out.units[i] = units.find(unit, unit_end);
+                    } else if(strict) {
+                        BOOST_THROW_EXCEPTION(std::runtime_error("Cannot read a quantity from \"" +
+                                                                 std::string(first, last) + "\""));
+                    } else {
+                        out.values[i] = 0;
+                        out.units[i] = nullptr;
+                    }
+                }
+            }
+
+            void wrong_unit(const Unit* unit, const runtime::Dimension& expected)
+            {
+                const std::string name = unit ? unit->name : std::string();
+                if(unit && !unit->valid) BOOST_THROW_EXCEPTION(std::runtime_error("Unknown unit " + name));
+                BOOST_THROW_EXCEPTION(std::runtime_error("Unit \"" + name + "\" does not have the dimension " +
+                                                         runtime::to_string(expected)));
+            }
+        }
+    }
+}
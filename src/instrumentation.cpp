@@ -0,0 +1,251 @@
+#include "quantity/instrumentation.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+
+namespace quantity
+{
+    namespace instrumentation
+    {
+        namespace
+        {
+            thread_local std::uint64_t t_allocations = 0;
+
+            struct Event
+            {
+                const Probe* probe;
+                std::uint32_t thread;
+                std::int64_t start_ns;
+                std::int64_t duration_ns;
+            };
+
+            struct Registry
+            {
+                std::mutex mutex;
+                std::map<std::string, std::unique_ptr<Probe>> probes;
+
+                std::mutex trace_mutex;
+                std::vector<Event> events;
+                std::size_t capacity = 0;
+                std::uint64_t dropped = 0;
+            };
+
+            /// never destroyed, so that probes stay valid during static destruction.
+            Registry& registry()
+            {
+                static Registry* r = new Registry;
+                return *r;
+            }
+
+            std::chrono::steady_clock::time_point epoch()
+            {
+                static const auto start = std::chrono::steady_clock::now();
+                return start;
+            }
+
+            std::uint32_t thread_index()
+            {
+                static std::atomic<std::uint32_t> next{0};
+                thread_local std::uint32_t index = next.fetch_add(1);
+                return index;
+            }
+
+            void write_string(std::ostream& out, const std::string& s)
+            {
+                out << '"';
+                for(char c : s) {
+                    if(c == '"' || c == '\\') out << '\\';
+                    out << c;
+                }
+                out << '"';
+            }
+        }
+
+        std::atomic<bool> detail::tracing{false};
+
+        Probe& probe(const std::string& name)
+        {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            auto& slot = r.probes[name];
+            if(!slot) slot.reset(new Probe(name));
+            return *slot;
+        }
+
+        std::chrono::nanoseconds ProbeStats::quantile(double q) const
+        {
+            auto rank = std::uint64_t(std::max(0.0, std::min(q, 1.0)) * double(calls));
+            std::uint64_t seen = 0;
+            for(std::size_t b = 0; b < BUCKETS; ++b) {
+                seen += histogram[b];
+                if(seen > rank || (seen == calls && seen > 0)) return std::chrono::nanoseconds(std::int64_t(2) << b);
+            }
+            return std::chrono::nanoseconds(0);
+        }
+
+        std::vector<ProbeStats> snapshot()
+        {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            std::vector<ProbeStats> result;
+            result.reserve(r.probes.size());
+            for(const auto& entry : r.probes) {
+                const Probe& p = *entry.second;
+                ProbeStats stats{p.name, p.calls.load(std::memory_order_relaxed),
+                                 p.exceptions.load(std::memory_order_relaxed),
+                                 p.allocations.load(std::memory_order_relaxed),
+                                 std::chrono::nanoseconds(p.total_ns.load(std::memory_order_relaxed)), {}};
+                for(std::size_t b = 0; b < BUCKETS; ++b) {
+                    stats.histogram[b] = p.histogram[b].load(std::memory_order_relaxed);
+                }
+                result.push_back(std::move(stats));
+            }
+            return result;
+        }
+
+        void reset()
+        {
+            Registry& r = registry();
+            {
+                std::lock_guard<std::mutex> lock(r.mutex);
+                for(auto& entry : r.probes) {
+                    Probe& p = *entry.second;
+                    p.calls.store(0);
+                    p.exceptions.store(0);
+                    p.allocations.store(0);
+                    p.total_ns.store(0);
+                    for(auto& bucket : p.histogram) bucket.store(0);
+                }
+            }
+            std::lock_guard<std::mutex> lock(r.trace_mutex);
+            r.events.clear();
+            r.dropped = 0;
+        }
+
+        bool enabled()
+        {
+#ifdef QUANTITY_INSTRUMENTATION
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        std::uint64_t thread_allocations()
+        {
+            return t_allocations;
+        }
+
+        void start_tracing(std::size_t capacity)
+        {
+            Registry& r = registry();
+            epoch();
+            std::lock_guard<std::mutex> lock(r.trace_mutex);
+            r.capacity = capacity;
+            r.events.reserve(std::min<std::size_t>(capacity, 1 << 16));
+            detail::tracing.store(true);
+        }
+
+        void stop_tracing()
+        {
+            detail::tracing.store(false);
+        }
+
+        void detail::record(const Probe& probe, std::chrono::steady_clock::time_point start,
+                            std::chrono::steady_clock::time_point stop)
+        {
+            using std::chrono::duration_cast;
+            using std::chrono::nanoseconds;
+            Event event{&probe, thread_index(), duration_cast<nanoseconds>(start - epoch()).count(),
+                        duration_cast<nanoseconds>(stop - start).count()};
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.trace_mutex);
+            if(r.events.size() < r.capacity) {
+                r.events.push_back(event);
+            } else {
+                r.dropped += 1;
+            }
+        }
+
+        void write_chrome_trace(std::ostream& out)
+        {
+            Registry& r = registry();
+            std::vector<Event> events;
+            std::uint64_t dropped;
+            {
+                std::lock_guard<std::mutex> lock(r.trace_mutex);
+                events = r.events;
+                dropped = r.dropped;
+            }
+            std::int64_t end = 0;
+            for(const auto& e : events) end = std::max(end, e.start_ns + e.duration_ns);
+
+            // timestamps are in microseconds
+            out << "{\"traceEvents\":[";
+            bool first = true;
+            for(const auto& e : events) {
+                out << (first ? "\n" : ",\n") << "{\"name\":";
+                write_string(out, e.probe->name);
+                out << ",\"cat\":\"quantity\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread
+                    << ",\"ts\":" << double(e.start_ns) * 1e-3 << ",\"dur\":" << double(e.duration_ns) * 1e-3 << "}";
+                first = false;
+            }
+            // the counters at the end of the trace
+            for(const auto& stats : snapshot()) {
+                out << (first ? "\n" : ",\n") << "{\"name\":";
+                write_string(out, stats.name);
+                out << ",\"cat\":\"quantity\",\"ph\":\"C\",\"pid\":1,\"ts\":" << double(end) * 1e-3
+                    << ",\"args\":{\"calls\":" << stats.calls << ",\"exceptions\":" << stats.exceptions
+                    << ",\"allocations\":" << stats.allocations << "}}";
+                first = false;
+            }
+            out << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+        }
+    }
+}
+
+#ifdef QUANTITY_INSTRUMENTATION
+// Counting replacements of the global allocation functions. They are part of the library, so
+// they count the allocations of the whole program.
+void* operator new(std::size_t size)
+{
+    ++quantity::instrumentation::t_allocations;
+    if(size == 0) size = 1;
+    for(;;) {
+        if(void* p = std::malloc(size)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if(!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+#endif
@@ -1,9 +1,16 @@
 #include <regex>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <sstream>
 
 #include <boost/throw_exception.hpp>
 #include "runtime_utils.hpp"
 #include "runtime_ratio.hpp"
+#include "quantity/instrumentation.hpp"
 #include "quantity/io.hpp"
 #include "quantity/predefined.hpp"
 
@@ -123,6 +130,7 @@ namespace quantity
     {
         Dimension parse_dim(std::string unit_s)
         {
+            QUANTITY_PROBE("runtime::parse_dim");
             Dimension u{};
             int mode = +1;
             do {
@@ -142,8 +150,9 @@ namespace quantity
 
         namespace
         {
-            const char* si_prefix(std::intmax_t exp) {
-                static std::map<std::intmax_t, const char*> m = {
+            /// the symbol of the SI prefix for `10^exp`, null if there is none.
+            const char* find_si_prefix(std::intmax_t exp) {
+                static const std::map<std::intmax_t, const char*> m = {
                         {12, "T"},
                         {9, "G"},
                         {6, "M"},
@@ -157,16 +166,22 @@ namespace quantity
                         {-9, "n"},
                         {-12, "p"}
                 };
-                try {
-                    return m.at(exp);
-                } catch (std::out_of_range& oor)
-                {
+                auto it = m.find(exp);
+                return it == m.end() ? nullptr : it->second;
+            }
+
+            const char* si_prefix(std::intmax_t exp) {
+                const char* symbol = find_si_prefix(exp);
+                if(!symbol) {
                     BOOST_THROW_EXCEPTION(std::out_of_range(
                                                   "Could not find SI prefix for exponent " + std::to_string(exp)));
                 }
+                return symbol;
             }
 
-            void print_single_dimension(std::ostream& target, char unit, const Ratio& exponent, Ratio& factor)
+            // `target` may be null to only work out which part of `factor` fits into the prefixes. Then
+            // false means that the factor needs a prefix that does not exist.
+            bool print_single_dimension(std::ostream* target, char unit, const Ratio& exponent, Ratio& factor)
             {
                 if (exponent.num != 0) {
                     Ratio prefix = factor / exponent;
@@ -179,7 +194,9 @@ namespace quantity
 
                     if(prefix.num % prefix.den == 0 && (prefix.num / prefix.den) % 3 == 0)
                     {
-                        target << si_prefix(prefix.num / prefix.den);
+                        if(!target && !find_si_prefix(prefix.num / prefix.den)) return false;
+                        const char* symbol = si_prefix(prefix.num / prefix.den);
+                        if(target) *target << symbol;
                         //std::cout << "prefix " << factor << " " << prefix << " " << exponent << "\n";
                         factor = factor - prefix * exponent;
                         //std::cout << "updated " << factor << "\n";
@@ -189,19 +206,24 @@ namespace quantity
                         }
                     }
 
-                    target << unit;
+                    if(!target) return true;
+                    *target << unit;
 
                     if (!(exponent == Ratio(1))) {
-                        target << "^" << exponent;
+                        *target << "^" << exponent;
                     }
                 }
+                return true;
             }
 
-            void print(std::ostream& target, Dimension dim, Ratio factor)
+            Ratio print(std::ostream* target, Dimension dim, Ratio factor)
             {
-                print_single_dimension(target, 'g', dim.mass, factor);
-                print_single_dimension(target, 's', dim.time, factor);  // seconds before meters to circumvent milli seconds vs meter seconds
-                print_single_dimension(target, 'm', dim.length, factor);
+                // seconds before meters to circumvent milli seconds vs meter seconds
+                if(print_single_dimension(target, 'g', dim.mass, factor) &&
+                   print_single_dimension(target, 's', dim.time, factor)) {
+                    print_single_dimension(target, 'm', dim.length, factor);
+                }
+                return factor;
             }
 
             void split_ratio(const Ratio& r, Ratio& num, Ratio& den)
@@ -218,69 +240,203 @@ namespace quantity
                 split_ratio(dim.length, num.length, den.length);
                 split_ratio(dim.mass, num.mass, den.mass);
             }
+
+            /// writes `dim` to `stream`, if given, and returns the part of the factor that no prefix could express.
+            Ratio write_dimension(std::ostream* stream, Dimension dim)
+            {
+                // OK, first figure out the total prefix factor
+                auto factor = dim.factor + Ratio(3)*dim.mass;
+
+                if(contains(dim, WATT_DIM))
+                {
+                    factor = factor - Ratio(3);
+                    if(!print_single_dimension(stream, 'W', {1, 1}, factor)) return factor;
+                    dim -= WATT_DIM;
+                }
+                else if(contains(dim, JOULE_DIM))
+                {
+                    factor = factor - Ratio(3);
+                    if(!print_single_dimension(stream, 'J', {1, 1}, factor)) return factor;
+                    dim -= JOULE_DIM;
+                }
+                else if(contains(dim, NEWTON_DIM))
+                {
+                    factor = factor - Ratio(3);
+                    if(!print_single_dimension(stream, 'N', {1, 1}, factor)) return factor;
+                    dim -= NEWTON_DIM;
+                }
+
+                Dimension num_d;
+                Dimension den_d;
+                split_dim(dim, num_d, den_d);
+                if(num_d == Dimension{{0,1}, {0, 1}, {0,1}}) {
+                    num_d = dim;
+                    den_d = Dimension{{0,1}, {0, 1}, {0,1}};
+                }
+
+                Ratio rest = print(stream, num_d, factor);
+                if(den_d.mass.num != 0 || den_d.time.num != 0 || den_d.length.num != 0) {
+                    if(stream) *stream << "/";
+                    print(stream, den_d, Ratio(0));
+                }
+                return rest;
+            }
+
+            /// whether `operator<<` can write the factor of `dim` as prefixes.
+            bool representable(const Dimension& dim)
+            {
+                return write_dimension(nullptr, dim).num == 0;
+            }
         }
 
         std::ostream& operator<<(std::ostream& stream, Dimension dim)
         {
-            // OK, first figure out the total prefix factor
-            auto factor = dim.factor + Ratio(3)*dim.mass;
+            QUANTITY_PROBE("runtime::operator<<(Dimension)");
+            write_dimension(&stream, dim);
+            return stream;
+        }
 
-            if(contains(dim, WATT_DIM))
+        double prefix_scale(const Ratio& exponent)
+        {
+            return std::pow(10.0, double(exponent.num) / double(exponent.den));
+        }
+
+        std::string to_string(const Dimension& dim, const char* dimensionless)
+        {
+            std::ostringstream out;
+            write_dimension(&out, dim);
+            std::string text = out.str();
+            return text.empty() ? std::string(dimensionless) : text;
+        }
+
+        void append_number(std::string& out, double number)
+        {
+            char text[32];
+            int n = std::snprintf(text, sizeof(text), "%.15g", number);
+            if(std::strtod(text, nullptr) != number) n = std::snprintf(text, sizeof(text), "%.17g", number);
+            out.append(text, std::size_t(n));
+        }
+
+        namespace
+        {
+            const char* skip_space(const char* first, const char* last)
             {
-                factor = factor - Ratio(3);
-                print_single_dimension(stream, 'W', {1, 1}, factor);
-                dim -= WATT_DIM;
+                while(first != last && std::isspace(static_cast<unsigned char>(*first))) ++first;
+                return first;
             }
-            else if(contains(dim, JOULE_DIM))
+
+            [[noreturn]] void vector_syntax_error(const char* first, const char* last, const char* expected)
             {
-                factor = factor - Ratio(3);
-                print_single_dimension(stream, 'J', {1, 1}, factor);
-                dim -= JOULE_DIM;
+                BOOST_THROW_EXCEPTION(std::runtime_error(std::string("Invalid vector, expected ") + expected +
+                                                         " at '" + std::string(first, last) + "'"));
             }
-            else if(contains(dim, NEWTON_DIM))
+
+            // strtod needs a terminated string, so the number is copied to the stack first
+            const char* parse_number(const char* first, const char* last, double& value)
             {
-                factor = factor - Ratio(3);
-                print_single_dimension(stream, 'N', {1, 1}, factor);
-                dim -= NEWTON_DIM;
+                char buffer[64];
+                std::size_t n = 0;
+                const char* end = first;
+                while(end != last && n + 1 < sizeof(buffer) && (std::isalnum(static_cast<unsigned char>(*end)) ||
+                                                                 *end == '.' || *end == '+' || *end == '-')) {
+                    buffer[n++] = *end++;
+                }
+                buffer[n] = '\0';
+                char* used = nullptr;
+                value = std::strtod(buffer, &used);
+                if(n == 0 || used != buffer + n) vector_syntax_error(first, last, "a number");
+                return end;
             }
 
-            Dimension num_d;
-            Dimension den_d;
-            split_dim(dim, num_d, den_d);
-            if(num_d == Dimension{{0,1}, {0, 1}, {0,1}}) {
-                num_d = dim;
-                den_d = Dimension{{0,1}, {0, 1}, {0,1}};
+            // units seen recently by this thread, so that a column of vectors in the same unit
+            // parses the unit once and does not allocate afterwards.
+            struct UnitCache
+            {
+                static constexpr std::size_t SLOTS = 8;
+                static constexpr std::size_t MAX_LENGTH = 24;
+
+                struct Entry
+                {
+                    char name[MAX_LENGTH];
+                    std::size_t length = 0;
+                    Dimension dimension;
+                };
+
+                Entry entries[SLOTS];
+                std::size_t next = 0;
+
+                Dimension lookup(const char* first, const char* last)
+                {
+                    std::size_t length = std::size_t(last - first);
+                    if(length > MAX_LENGTH) return parse_dim(std::string(first, last));
+                    for(const auto& entry : entries) {
+                        if(entry.length == length && std::memcmp(entry.name, first, length) == 0) {
+                            return entry.dimension;
+                        }
+                    }
+                    Entry& entry = entries[next];
+                    entry.dimension = parse_dim(std::string(first, last));
+                    std::memcpy(entry.name, first, length);
+                    entry.length = length;
+                    next = (next + 1) % SLOTS;
+                    return entry.dimension;
+                }
+            };
+        }
+
+        const char* parse_vector(const char* first, const char* last, double (&values)[3], Dimension& unit)
+        {
+            QUANTITY_PROBE("runtime::parse_vector");
+            const char* pos = skip_space(first, last);
+            if(pos == last || *pos != '(') vector_syntax_error(pos, last, "'('");
+            ++pos;
+            for(int i = 0; i < 3; ++i) {
+                pos = parse_number(skip_space(pos, last), last, values[i]);
+                pos = skip_space(pos, last);
+                const char separator = i < 2 ? ',' : ')';
+                if(pos == last || *pos != separator) vector_syntax_error(pos, last, i < 2 ? "','" : "')'");
+                ++pos;
             }
 
-            print(stream, num_d, factor);
-            if(den_d.mass.num != 0 || den_d.time.num != 0 || den_d.length.num != 0) {
-                stream << "/";
-                print(stream, den_d, Ratio(0));
+            pos = skip_space(pos, last);
+            const char* unit_end = pos;
+            while(unit_end != last && !std::isspace(static_cast<unsigned char>(*unit_end))) ++unit_end;
+            if(unit_end == pos) {
+                unit = Dimension{};
+                return pos;
             }
-            return stream;
+            thread_local UnitCache cache;
+            unit = cache.lookup(pos, unit_end);
+            return unit_end;
         }
 
         Dimension dynamic_rescale(long double value, Dimension dimension)
         {
+            QUANTITY_PROBE("runtime::dynamic_rescale");
             value = std::abs(value);
 
             // no prefixes for 0, this would cause an endless loop below
             if(value == 0) return dimension;
 
+            // step in thousands towards [1, 1000), but only stop at factors that the unit can show as a
+            // prefix; km*m cannot be written as a prefixed m^2, so that stays 4000 m^2.
+            Dimension best = dimension;
             while(value < 1.0) {
                 value *= 1e+3;
                 dimension.factor = dimension.factor - Ratio{3, 1};
+                if(representable(dimension)) best = dimension;
             }
 
             // no inceasing prefix for time-only dimension.
-            if(dimension.mass.num == 0 && dimension.length.num == 0) return dimension;
+            if(dimension.mass.num == 0 && dimension.length.num == 0) return best;
 
             while(value > 1e3) {
                 value *= 1e-3;
                 dimension.factor = dimension.factor + Ratio{3, 1};
+                if(representable(dimension)) best = dimension;
             }
 
-            return dimension;
+            return best;
         }
     }
 }
@@ -0,0 +1,584 @@
+#include "quantity/json.hpp"
+#include "quantity/io.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <boost/throw_exception.hpp>
+
+namespace quantity
+{
+    namespace json
+    {
+        namespace
+        {
+            bool is_space(int c)
+            {
+                return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+            }
+
+            void append_utf8(std::string& out, std::uint32_t code)
+            {
+                if(code < 0x80) {
+                    out += char(code);
+                } else if(code < 0x800) {
+                    out += char(0xC0 | (code >> 6));
+                    out += char(0x80 | (code & 0x3F));
+                } else if(code < 0x10000) {
+                    out += char(0xE0 | (code >> 12));
+                    out += char(0x80 | ((code >> 6) & 0x3F));
+                    out += char(0x80 | (code & 0x3F));
+                } else {
+                    out += char(0xF0 | (code >> 18));
+                    out += char(0x80 | ((code >> 12) & 0x3F));
+                    out += char(0x80 | ((code >> 6) & 0x3F));
+                    out += char(0x80 | (code & 0x3F));
+                }
+            }
+
+            // a unit string as it appears in JSON; the empty string is dimensionless
+            runtime::Dimension parse_unit(const std::string& unit)
+            {
+                return unit.empty() ? runtime::Dimension{} : runtime::parse_dim(unit);
+            }
+        }
+
+        // ------------------------------------------------------------------------------------
+        //  Reader
+
+        Reader::Reader(std::istream& source, std::size_t buffer_size) : m_Source(source), m_Buffer(buffer_size)
+        {
+        }
+
+        bool Reader::fill()
+        {
+            m_Consumed += m_End;
+            m_Pos = 0;
+            m_Source.read(m_Buffer.data(), std::streamsize(m_Buffer.size()));
+            m_End = std::size_t(m_Source.gcount());
+            return m_End != 0;
+        }
+
+        int Reader::peek()
+        {
+            if(m_Pos == m_End && !fill()) return -1;
+            return static_cast<unsigned char>(m_Buffer[m_Pos]);
+        }
+
+        int Reader::get()
+        {
+            int c = peek();
+            if(c >= 0) ++m_Pos;
+            return c;
+        }
+
+        void Reader::skip_space()
+        {
+            while(true) {
+                while(m_Pos != m_End && is_space(m_Buffer[m_Pos])) ++m_Pos;
+                if(m_Pos != m_End || !fill()) return;
+            }
+        }
+
+        void Reader::error(const std::string& what) const
+        {
+            BOOST_THROW_EXCEPTION(std::runtime_error("JSON syntax error at byte " + std::to_string(position()) +
+                                                     ": " + what));
+        }
+
+        Token Reader::next()
+        {
+            skip_space();
+            int c = peek();
+            if(c < 0) {
+                if(!m_Stack.empty()) error("unexpected end of input");
+                return Token::END;
+            }
+
+            if(c == '}' || c == ']') {
+                const char open = c == '}' ? '{' : '[';
+                if(m_Stack.empty() || m_Stack.back() != open) error(std::string("unexpected '") + char(c) + "'");
+                if(m_State == AFTER_COMMA || m_State == AFTER_KEY) error("expected a value");
+                ++m_Pos;
+                m_Stack.pop_back();
+                m_State = AFTER_VALUE;
+                return c == '}' ? Token::END_OBJECT : Token::END_ARRAY;
+            }
+
+            // values at the top level need no commas, as in JSON lines
+            if(m_State == AFTER_VALUE && !m_Stack.empty()) {
+                if(c != ',') error("expected ','");
+                ++m_Pos;
+                skip_space();
+                c = peek();
+                m_State = AFTER_COMMA;
+            }
+
+            if(!m_Stack.empty() && m_Stack.back() == '{' && m_State != AFTER_KEY) {
+                if(c != '"') error("expected a member name");
+                ++m_Pos;
+                read_string();
+                skip_space();
+                if(get() != ':') error("expected ':'");
+                m_State = AFTER_KEY;
+                return Token::KEY;
+            }
+
+            m_State = AFTER_VALUE;
+            switch(c) {
+                case '{':
+                    ++m_Pos;
+                    m_Stack.push_back('{');
+                    m_State = START;
+                    return Token::BEGIN_OBJECT;
+                case '[':
+                    ++m_Pos;
+                    m_Stack.push_back('[');
+                    m_State = START;
+                    return Token::BEGIN_ARRAY;
+                case '"':
+                    ++m_Pos;
+                    read_string();
+                    return Token::STRING;
+                case 't':
+                    read_literal("true");
+                    m_Boolean = true;
+                    return Token::BOOLEAN;
+                case 'f':
+                    read_literal("false");
+                    m_Boolean = false;
+                    return Token::BOOLEAN;
+                case 'n':
+                    read_literal("null");
+                    m_Number = std::numeric_limits<double>::quiet_NaN();
+                    return Token::NULL_VALUE;
+                default:
+                    if(c == '-' || (c >= '0' && c <= '9')) {
+                        read_number();
+                        return Token::NUMBER;
+                    }
+                    error(c < 0 ? std::string("unexpected end of input") : std::string("unexpected '") + char(c) + "'");
+            }
+        }
+
+        void Reader::read_string()
+        {
+            m_Text.clear();
+            while(true) {
+                // copy runs without escapes in one go
+                std::size_t start = m_Pos;
+                while(m_Pos != m_End && m_Buffer[m_Pos] != '"' && m_Buffer[m_Pos] != '\\') ++m_Pos;
+                m_Text.append(m_Buffer.data() + start, m_Pos - start);
+
+                int c = get();
+                if(c < 0) error("unterminated string");
+                if(c == '"') return;
+                if(c != '\\') {
+                    // the run above ended at the end of the buffer
+                    m_Text += char(c);
+                    continue;
+                }
+
+                c = get();
+                switch(c) {
+                    case '"': m_Text += '"'; break;
+                    case '\\': m_Text += '\\'; break;
+                    case '/': m_Text += '/'; break;
+                    case 'b': m_Text += '\b'; break;
+                    case 'f': m_Text += '\f'; break;
+                    case 'n': m_Text += '\n'; break;
+                    case 'r': m_Text += '\r'; break;
+                    case 't': m_Text += '\t'; break;
+                    case 'u': {
+                        auto hex4 = [this]() {
+                            std::uint32_t code = 0;
+                            for(int i = 0; i < 4; ++i) {
+                                int h = get();
+                                code <<= 4;
+                                if(h >= '0' && h <= '9') code |= std::uint32_t(h - '0');
+                                else if(h >= 'a' && h <= 'f') code |= std::uint32_t(h - 'a' + 10);
+                                else if(h >= 'A' && h <= 'F') code |= std::uint32_t(h - 'A' + 10);
+                                else error("invalid \\u escape");
+                            }
+                            return code;
+                        };
+                        std::uint32_t code = hex4();
+                        if(code >= 0xD800 && code < 0xDC00) {
+                            // surrogate pair
+                            if(get() != '\\' || get() != 'u') error("unpaired surrogate");
+                            std::uint32_t low = hex4();
+                            if(low < 0xDC00 || low >= 0xE000) error("unpaired surrogate");
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        append_utf8(m_Text, code);
+                        break;
+                    }
+                    default:
+                        error("invalid escape");
+                }
+            }
+        }
+
+        void Reader::read_number()
+        {
+            // strtod needs a terminated string; numbers are short, so they are copied to the stack
+            char text[64];
+            std::size_t n = 0;
+            while(true) {
+                int c = peek();
+                if(!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) break;
+                if(n + 1 == sizeof(text)) error("number too long");
+                text[n++] = char(c);
+                ++m_Pos;
+            }
+            text[n] = '\0';
+            char* end = nullptr;
+            m_Number = std::strtod(text, &end);
+            if(end != text + n) error(std::string("invalid number '") + text + "'");
+        }
+
+        void Reader::read_literal(const char* word)
+        {
+            for(const char* p = word; *p; ++p) {
+                if(get() != *p) error(std::string("expected '") + word + "'");
+            }
+        }
+
+        void Reader::skip(Token token)
+        {
+            if(token != Token::BEGIN_OBJECT && token != Token::BEGIN_ARRAY) return;
+            const std::size_t depth = m_Stack.size();
+            while(m_Stack.size() >= depth) {
+                if(next() == Token::END) error("unexpected end of input");
+            }
+        }
+
+        // ------------------------------------------------------------------------------------
+        //  RecordReader
+
+        RecordReader::RecordReader(std::istream& source, Fields& fields, std::size_t buffer_size) :
+                m_Reader(source, buffer_size), m_Fields(fields)
+        {
+        }
+
+        Fields::Field* RecordReader::find(const std::string& name)
+        {
+            for(auto& field : m_Fields.m_Fields) {
+                if(field.name == name) return &field;
+            }
+            return nullptr;
+        }
+
+        bool RecordReader::next()
+        {
+            Token token = m_Reader.next();
+            if(token == Token::BEGIN_ARRAY && !m_InArray && m_Reader.depth() == 1) {
+                m_InArray = true;
+                token = m_Reader.next();
+            }
+            if(token == Token::END_ARRAY && m_InArray && m_Reader.depth() == 0) {
+                m_InArray = false;
+                return next();
+            }
+            if(token == Token::END) return false;
+            if(token != Token::BEGIN_OBJECT) {
+                BOOST_THROW_EXCEPTION(std::runtime_error("Expected a record object at byte " +
+                                                         std::to_string(m_Reader.position())));
+            }
+
+            for(auto& field : m_Fields.m_Fields) field.seen = false;
+            while((token = m_Reader.next()) == Token::KEY) {
+                Fields::Field* field = find(m_Reader.text());
+                if(!field) {
+                    m_Reader.skip(m_Reader.next());
+                    continue;
+                }
+                if(field->seen) BOOST_THROW_EXCEPTION(std::runtime_error("Field " + field->name + " appears twice"));
+                read_field(*field);
+                field->seen = true;
+            }
+
+            for(auto& field : m_Fields.m_Fields) {
+                if(!field.seen) {
+                    BOOST_THROW_EXCEPTION(std::runtime_error("Record " + std::to_string(m_Count) +
+                                                             " lacks the field " + field.name));
+                }
+            }
+            ++m_Count;
+            return true;
+        }
+
+        std::size_t RecordReader::read_numbers(Token token, double* values)
+        {
+            if(token == Token::NUMBER || token == Token::NULL_VALUE) {
+                values[0] = m_Reader.number();
+                return 1;
+            }
+            if(token != Token::BEGIN_ARRAY) {
+                BOOST_THROW_EXCEPTION(std::runtime_error("Expected a number or an array of numbers at byte " +
+                                                         std::to_string(m_Reader.position())));
+            }
+            std::size_t count = 0;
+            while((token = m_Reader.next()) != Token::END_ARRAY) {
+                if(token != Token::NUMBER && token != Token::NULL_VALUE) {
+                    BOOST_THROW_EXCEPTION(std::runtime_error("Expected a number at byte " +
+                                                             std::to_string(m_Reader.position())));
+                }
+                if(count == 3) BOOST_THROW_EXCEPTION(std::runtime_error("More than three components"));
+                values[count++] = m_Reader.number();
+            }
+            return count;
+        }
+
+        void RecordReader::resolve_unit(Fields::Field& field, const std::string& unit)
+        {
+            if(field.unit_known && field.unit == unit) return;
+            runtime::Dimension dim = parse_unit(unit);
+            const double scale = runtime::prefix_scale(dim.factor);
+            dim.factor = runtime::Ratio{0, 1};
+            if(!(dim == field.dimension)) {
+                BOOST_THROW_EXCEPTION(std::runtime_error("Unit " + unit + " of field " + field.name +
+                                                         " does not have the dimension " +
+                                                         runtime::to_string(field.dimension)));
+            }
+            field.unit = unit;
+            field.scale = scale;
+            field.unit_known = true;
+        }
+
+        void RecordReader::read_field(Fields::Field& field)
+        {
+            double values[3];
+            std::size_t count = 0;
+            double scale = 1.0;
+
+            Token token = m_Reader.next();
+            if(token == Token::BEGIN_OBJECT) {
+                bool has_value = false;
+                bool has_unit = false;
+                while((token = m_Reader.next()) == Token::KEY) {
+                    if(m_Reader.text() == "value") {
+                        count = read_numbers(m_Reader.next(), values);
+                        has_value = true;
+                    } else if(m_Reader.text() == "unit") {
+                        if(m_Reader.next() != Token::STRING) {
+                            BOOST_THROW_EXCEPTION(std::runtime_error("The unit of " + field.name + " is not a string"));
+                        }
+                        resolve_unit(field, m_Reader.text());
+                        has_unit = true;
+                    } else {
+                        m_Reader.skip(m_Reader.next());
+                    }
+                }
+                if(!has_value) BOOST_THROW_EXCEPTION(std::runtime_error("Field " + field.name + " has no value"));
+                if(has_unit) {
+                    scale = field.scale;
+                } else {
+                    resolve_unit(field, "");
+                }
+            } else {
+                // a bare number in coherent SI units
+                count = read_numbers(token, values);
+            }
+
+            if(count != field.components) {
+                BOOST_THROW_EXCEPTION(std::runtime_error("Field " + field.name + " needs " +
+                                                         std::to_string(field.components) + " components"));
+            }
+            for(std::size_t i = 0; i < count; ++i) values[i] *= scale;
+            field.store(field.target, values);
+        }
+
+        // ------------------------------------------------------------------------------------
+        //  Writer
+
+        Writer::Writer(std::ostream& target, std::size_t buffer_size) : m_Target(target), m_BufferSize(buffer_size)
+        {
+            m_Buffer.reserve(buffer_size + 256);
+        }
+
+        Writer::~Writer()
+        {
+            flush();
+        }
+
+        void Writer::flush()
+        {
+            m_Target.write(m_Buffer.data(), std::streamsize(m_Buffer.size()));
+            m_Buffer.clear();
+        }
+
+        void Writer::maybe_flush()
+        {
+            if(m_Buffer.size() >= m_BufferSize) flush();
+        }
+
+        void Writer::separate()
+        {
+            if(m_AfterKey) {
+                m_AfterKey = false;
+                return;
+            }
+            if(m_First.empty()) {
+                // top level values go on separate lines
+                if(m_WroteTopLevel) m_Buffer += '\n';
+                m_WroteTopLevel = true;
+                return;
+            }
+            if(!m_First.back()) m_Buffer += ',';
+            m_First.back() = false;
+        }
+
+        Writer& Writer::begin_object()
+        {
+            separate();
+            m_Buffer += '{';
+            m_First.push_back(true);
+            return *this;
+        }
+
+        Writer& Writer::end_object()
+        {
+            m_Buffer += '}';
+            m_First.pop_back();
+            maybe_flush();
+            return *this;
+        }
+
+        Writer& Writer::begin_array()
+        {
+            separate();
+            m_Buffer += '[';
+            m_First.push_back(true);
+            return *this;
+        }
+
+        Writer& Writer::end_array()
+        {
+            m_Buffer += ']';
+            m_First.pop_back();
+            maybe_flush();
+            return *this;
+        }
+
+        Writer& Writer::key(const std::string& name)
+        {
+            separate();
+            write_string(name);
+            m_Buffer += ':';
+            m_AfterKey = true;
+            return *this;
+        }
+
+        Writer& Writer::value(double number)
+        {
+            separate();
+            write_number(number);
+            return *this;
+        }
+
+        Writer& Writer::value(const std::string& text)
+        {
+            separate();
+            write_string(text);
+            return *this;
+        }
+
+        Writer& Writer::value(bool flag)
+        {
+            separate();
+            m_Buffer += flag ? "true" : "false";
+            return *this;
+        }
+
+        Writer& Writer::null()
+        {
+            separate();
+            m_Buffer += "null";
+            return *this;
+        }
+
+        void Writer::write_number(double number)
+        {
+            if(!std::isfinite(number)) {
+                m_Buffer += "null";
+                return;
+            }
+            runtime::append_number(m_Buffer, number);
+        }
+
+        void Writer::write_string(const std::string& text)
+        {
+            m_Buffer += '"';
+            for(char c : text) {
+                switch(c) {
+                    case '"': m_Buffer += "\\\""; break;
+                    case '\\': m_Buffer += "\\\\"; break;
+                    case '\n': m_Buffer += "\\n"; break;
+                    case '\r': m_Buffer += "\\r"; break;
+                    case '\t': m_Buffer += "\\t"; break;
+                    default:
+                        if(static_cast<unsigned char>(c) < 0x20) {
+                            char escape[8];
+                            std::snprintf(escape, sizeof(escape), "\\u%04x", unsigned(c));
+                            m_Buffer += escape;
+                        } else {
+                            m_Buffer += c;
+                        }
+                }
+            }
+            m_Buffer += '"';
+        }
+
+        const Writer::Unit& Writer::unit_info(const runtime::Dimension& dim, const char* unit)
+        {
+            for(const auto& known : m_Units) {
+                if(!(known.dimension == dim)) continue;
+                if(unit ? !known.si && known.name == unit : known.si) return known;
+            }
+
+            Unit info;
+            info.dimension = dim;
+            info.si = unit == nullptr;
+            if(unit) {
+                runtime::Dimension parsed = parse_unit(unit);
+                info.scale = runtime::prefix_scale(parsed.factor);
+                parsed.factor = runtime::Ratio{0, 1};
+                if(!(parsed == dim)) {
+                    BOOST_THROW_EXCEPTION(std::runtime_error(std::string("Unit ") + unit +
+                                                             " does not have the dimension " +
+                                                             runtime::to_string(dim)));
+                }
+                info.name = unit;
+            } else {
+                info.name = runtime::to_string(dim);
+                info.scale = 1.0;
+            }
+            m_Units.push_back(std::move(info));
+            return m_Units.back();
+        }
+
+        Writer& Writer::quantity_value(const double* values, std::size_t count, const runtime::Dimension& dim,
+                                       const char* unit)
+        {
+            const Unit& info = unit_info(dim, unit);
+            begin_object();
+            key("value");
+            if(count == 1) {
+                value(values[0] / info.scale);
+            } else {
+                begin_array();
+                for(std::size_t i = 0; i < count; ++i) value(values[i] / info.scale);
+                end_array();
+            }
+            key("unit");
+            value(info.name);
+            return end_object();
+        }
+    }
+}
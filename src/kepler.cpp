@@ -0,0 +1,187 @@
+#include "quantity/kepler.hpp"
+#include "quantity/threading.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <boost/throw_exception.hpp>
+
+namespace quantity
+{
+    namespace kepler
+    {
+        namespace
+        {
+            constexpr double PI = 3.14159265358979323846;
+            constexpr double TWO_PI = 2 * PI;
+
+            /// number of orbits that are processed together by the kernel.
+            constexpr std::size_t BLOCK = 64;
+
+            double wrap_angle(double m)
+            {
+                return m - TWO_PI * std::floor(m / TWO_PI + 0.5);
+            }
+
+            double initial_guess(double m, double e)
+            {
+                // m is in [-pi, pi], so the sign of sin(m) is the sign of m.
+                return m + 0.85 * e * std::copysign(1.0, m);
+            }
+
+            double halley_step(double E, double e, double m)
+            {
+                double s = std::sin(E);
+                double c = std::cos(E);
+                double f = E - e * s - m;
+                double fp = 1 - e * c;
+                double fpp = e * s;
+                return E - f / (fp - 0.5 * f * fpp / fp);
+            }
+
+            void check(const Elements& el)
+            {
+                const std::size_t n = el.size();
+                if(el.eccentricity.size() != n || el.inclination.size() != n || el.ascending_node.size() != n ||
+                   el.arg_periapsis.size() != n || el.mean_anomaly.size() != n || el.epoch.size() != n) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("Orbital element arrays have different sizes"));
+                }
+                for(std::size_t i = 0; i < n; ++i) {
+                    double e = el.eccentricity[i];
+                    if(!(e >= 0 && e < 1) || !(el.semi_major_axis[i].value > 0)) {
+                        BOOST_THROW_EXCEPTION(std::invalid_argument("Orbit " + std::to_string(i) + " is not elliptic"));
+                    }
+                }
+            }
+
+            struct Output
+            {
+                Vec3Array<predefined::length_t>& pos;
+                Vec3Array<predefined::speed_t>& vel;
+            };
+
+            void propagate_block(const Elements& el, std::size_t begin, std::size_t count, double t, double mu,
+                                 unsigned iterations, Output& out)
+            {
+                double a[BLOCK], e[BLOCK], m[BLOCK], E[BLOCK];
+                for(std::size_t k = 0; k < count; ++k) {
+                    std::size_t i = begin + k;
+                    a[k] = el.semi_major_axis[i].value;
+                    e[k] = el.eccentricity[i].value;
+                    double n = std::sqrt(mu / (a[k] * a[k] * a[k]));
+                    m[k] = wrap_angle(el.mean_anomaly[i].value + n * (t - el.epoch[i].value));
+                    E[k] = initial_guess(m[k], e[k]);
+                }
+
+                for(unsigned it = 0; it < iterations; ++it) {
+                    for(std::size_t k = 0; k < count; ++k) {
+                        E[k] = halley_step(E[k], e[k], m[k]);
+                    }
+                }
+
+                for(std::size_t k = 0; k < count; ++k) {
+                    std::size_t i = begin + k;
+                    double sE = std::sin(E[k]);
+                    double cE = std::cos(E[k]);
+                    double b = std::sqrt(1 - e[k] * e[k]);
+                    double r = a[k] * (1 - e[k] * cE);
+
+                    // position and velocity in the perifocal frame
+                    double xp = a[k] * (cE - e[k]);
+                    double yp = a[k] * b * sE;
+                    double v = std::sqrt(mu * a[k]) / r;
+                    double vxp = -v * sE;
+                    double vyp = v * b * cE;
+
+                    double cO = std::cos(el.ascending_node[i].value);
+                    double sO = std::sin(el.ascending_node[i].value);
+                    double cw = std::cos(el.arg_periapsis[i].value);
+                    double sw = std::sin(el.arg_periapsis[i].value);
+                    double ci = std::cos(el.inclination[i].value);
+                    double si = std::sin(el.inclination[i].value);
+
+                    // perifocal unit vectors P (towards periapsis) and Q
+                    double px = cO * cw - sO * sw * ci;
+                    double py = sO * cw + cO * sw * ci;
+                    double pz = sw * si;
+                    double qx = -cO * sw - sO * cw * ci;
+                    double qy = -sO * sw + cO * cw * ci;
+                    double qz = cw * si;
+
+                    out.pos.x[i].value = xp * px + yp * qx;
+                    out.pos.y[i].value = xp * py + yp * qy;
+                    out.pos.z[i].value = xp * pz + yp * qz;
+                    out.vel.x[i].value = vxp * px + vyp * qx;
+                    out.vel.y[i].value = vxp * py + vyp * qy;
+                    out.vel.z[i].value = vxp * pz + vyp * qz;
+                }
+            }
+        }
+
+        void Elements::resize(std::size_t count)
+        {
+            semi_major_axis.resize(count);
+            eccentricity.resize(count);
+            inclination.resize(count);
+            ascending_node.resize(count);
+            arg_periapsis.resize(count);
+            mean_anomaly.resize(count);
+            epoch.resize(count);
+        }
+
+        void Elements::reserve(std::size_t count)
+        {
+            semi_major_axis.reserve(count);
+            eccentricity.reserve(count);
+            inclination.reserve(count);
+            ascending_node.reserve(count);
+            arg_periapsis.reserve(count);
+            mean_anomaly.reserve(count);
+            epoch.reserve(count);
+        }
+
+        void Elements::push_back(predefined::length_t a, predefined::scalar_t e, predefined::scalar_t i,
+                                 predefined::scalar_t raan, predefined::scalar_t omega, predefined::scalar_t m0,
+                                 predefined::time_t t0)
+        {
+            semi_major_axis.push_back(a);
+            eccentricity.push_back(e);
+            inclination.push_back(i);
+            ascending_node.push_back(raan);
+            arg_periapsis.push_back(omega);
+            mean_anomaly.push_back(m0);
+            epoch.push_back(t0);
+        }
+
+        double eccentric_anomaly(double mean_anomaly, double eccentricity, unsigned iterations)
+        {
+            double m = wrap_angle(mean_anomaly);
+            double E = initial_guess(m, eccentricity);
+            for(unsigned it = 0; it < iterations; ++it) {
+                E = halley_step(E, eccentricity, m);
+            }
+            return E;
+        }
+
+        void propagate(const Elements& elements, predefined::time_t t, grav_param_t mu,
+                       Vec3Array<predefined::length_t>& positions, Vec3Array<predefined::speed_t>& velocities,
+                       const Options& options)
+        {
+            check(elements);
+            const std::size_t n = elements.size();
+            positions.resize(n);
+            velocities.resize(n);
+
+            Output out{positions, velocities};
+            const std::size_t blocks = (n + BLOCK - 1) / BLOCK;
+            threading::for_chunks(blocks, [&](std::size_t first, std::size_t last) {
+                for(std::size_t b = first; b < last; ++b) {
+                    std::size_t begin = b * BLOCK;
+                    std::size_t count = std::min(BLOCK, n - begin);
+                    propagate_block(elements, begin, count, t.value, mu.value, options.iterations, out);
+                }
+            }, options.threads, 16);
+        }
+    }
+}
@@ -0,0 +1,201 @@
+#include "quantity/logging.hpp"
+#include "quantity/io.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <sstream>
+
+namespace quantity
+{
+    namespace logging
+    {
+        namespace
+        {
+            std::mutex& table_mutex()
+            {
+                static std::mutex mutex;
+                return mutex;
+            }
+
+            std::vector<runtime::Dimension>& table()
+            {
+                static std::vector<runtime::Dimension> dimensions;
+                return dimensions;
+            }
+
+            std::uint64_t next_sink_id()
+            {
+                static std::atomic<std::uint64_t> counter{0};
+                return ++counter;
+            }
+
+            // the same text as `operator<<` for `Quantity` and `Vec3<Quantity>`
+            void format(std::ostream& out, const detail::Record& record, const runtime::Dimension& dim)
+            {
+                if(record.label) out << record.label << ": ";
+                if(record.components == 1) {
+                    auto dyn_dim = runtime::dynamic_rescale(record.values[0], dim);
+                    out << record.values[0] / runtime::prefix_scale(dyn_dim.factor) << " " << dyn_dim;
+                } else {
+                    const double largest = std::max(std::max(std::abs(record.values[0]), std::abs(record.values[1])),
+                                                    std::abs(record.values[2]));
+                    auto dyn_dim = runtime::dynamic_rescale(largest, dim);
+                    const double scale = runtime::prefix_scale(dyn_dim.factor);
+                    out << "(" << record.values[0] / scale << ", " << record.values[1] / scale << ", "
+                        << record.values[2] / scale << ")";
+                    if(!(dim == runtime::Dimension{})) out << " " << dyn_dim;
+                }
+                out << '\n';
+            }
+        }
+
+        std::uint32_t register_dimension(const runtime::Dimension& dim)
+        {
+            std::lock_guard<std::mutex> lock(table_mutex());
+            auto& dimensions = table();
+            auto found = std::find(dimensions.begin(), dimensions.end(), dim);
+            if(found != dimensions.end()) return std::uint32_t(found - dimensions.begin());
+            dimensions.push_back(dim);
+            return std::uint32_t(dimensions.size() - 1);
+        }
+
+        runtime::Dimension registered_dimension(std::uint32_t id)
+        {
+            std::lock_guard<std::mutex> lock(table_mutex());
+            return table().at(id);
+        }
+
+        namespace detail
+        {
+            Queue::Queue(std::size_t capacity)
+            {
+                std::size_t size = 2;
+                while(size < capacity) size *= 2;
+                m_Slots.resize(size);
+                m_Mask = size - 1;
+            }
+
+            void* Queue::operator new(std::size_t size)
+            {
+                // room to align, and for the address of the allocation just before the object
+                std::size_t space = size + alignof(Queue) + sizeof(void*);
+                void* raw = ::operator new(space);
+                void* base = static_cast<char*>(raw) + sizeof(void*);
+                space -= sizeof(void*);
+                base = std::align(alignof(Queue), size, base, space);
+                static_cast<void**>(base)[-1] = raw;
+                return base;
+            }
+
+            void Queue::operator delete(void* memory) noexcept
+            {
+                if(memory) ::operator delete(static_cast<void**>(memory)[-1]);
+            }
+        }
+
+        AsyncSink::AsyncSink(std::ostream& target, std::size_t queue_capacity, std::size_t batch_bytes) :
+                m_Id(next_sink_id()), m_Capacity(queue_capacity), m_BatchBytes(batch_bytes), m_Target(target)
+        {
+            m_Writer = std::thread([this]() { run(); });
+        }
+
+        AsyncSink::~AsyncSink()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_WakeMutex);
+                m_Stop = true;
+            }
+            m_Wake.notify_one();
+            m_Writer.join();
+        }
+
+        void AsyncSink::flush()
+        {
+            std::unique_lock<std::mutex> lock(m_WakeMutex);
+            const std::uint64_t ticket = ++m_FlushRequested;
+            m_Wake.notify_one();
+            m_Flushed.wait(lock, [&]() { return m_FlushDone >= ticket; });
+        }
+
+        detail::Queue& AsyncSink::local_queue()
+        {
+            // the queue of the sink this thread used last; sinks are told apart by id, not by
+            // address, because a new sink may be created where an old one was.
+            struct Cached
+            {
+                std::uint64_t sink = 0;
+                detail::Queue* queue = nullptr;
+            };
+            thread_local Cached cached;
+            if(cached.sink == m_Id) return *cached.queue;
+
+            std::lock_guard<std::mutex> lock(m_QueuesMutex);
+            detail::Queue*& queue = m_QueueOfThread[std::this_thread::get_id()];
+            if(!queue) {
+                m_Queues.emplace_back(new detail::Queue(m_Capacity));
+                queue = m_Queues.back().get();
+            }
+            cached = Cached{m_Id, queue};
+            return *queue;
+        }
+
+        void AsyncSink::run()
+        {
+            std::ostringstream batch;
+            batch.copyfmt(m_Target);
+            std::vector<detail::Queue*> queues;
+            std::vector<runtime::Dimension> dimensions;
+
+            auto write_record = [&](const detail::Record& record) {
+                while(record.dimension >= dimensions.size()) {
+                    dimensions.push_back(registered_dimension(std::uint32_t(dimensions.size())));
+                }
+                format(batch, record, dimensions[record.dimension]);
+            };
+
+            while(true) {
+                std::uint64_t flush_ticket;
+                bool stop;
+                {
+                    std::lock_guard<std::mutex> lock(m_WakeMutex);
+                    flush_ticket = m_FlushRequested;
+                    stop = m_Stop;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(m_QueuesMutex);
+                    queues.clear();
+                    for(const auto& queue : m_Queues) queues.push_back(queue.get());
+                }
+
+                std::size_t records = 0;
+                for(auto* queue : queues) records += queue->drain(write_record);
+
+                const auto pending = std::size_t(batch.tellp());
+                if(pending >= m_BatchBytes || (records == 0 && pending > 0)) {
+                    m_Target << batch.str();
+                    batch.str("");
+                }
+                if(records != 0) continue;
+
+                // all queues were empty after the ticket and the stop flag were read, so everything
+                // logged before them has been written.
+                std::unique_lock<std::mutex> lock(m_WakeMutex);
+                if(flush_ticket > m_FlushDone) {
+                    m_Target.flush();
+                    m_FlushDone = flush_ticket;
+                    m_Flushed.notify_all();
+                }
+                if(stop) {
+                    m_Target.flush();
+                    return;
+                }
+                // logging threads do not notify, so the queues are polled
+                if(m_FlushRequested == flush_ticket && !m_Stop) {
+                    m_Wake.wait_for(lock, std::chrono::milliseconds(1));
+                }
+            }
+        }
+    }
+}
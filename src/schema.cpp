@@ -0,0 +1,114 @@
+#include "quantity/schema.hpp"
+#include "quantity/io.hpp"
+
+#include <cstdlib>
+#include <sstream>
+
+namespace quantity
+{
+    namespace schema
+    {
+        namespace detail
+        {
+            namespace
+            {
+                const char* skip_space(const char* p, const char* last)
+                {
+                    while(p < last && (*p == ' ' || *p == '\t')) ++p;
+                    return p;
+                }
+
+                std::string trim(const std::string& text)
+                {
+                    const std::size_t first = text.find_first_not_of(" \t");
+                    if(first == std::string::npos) return std::string();
+                    return text.substr(first, text.find_last_not_of(" \t") - first + 1);
+                }
+            }
+
+            constexpr std::size_t Column::npos;
+
+            double unit_scale(const std::string& unit, const runtime::Dimension& expected, const std::string& column)
+            {
+                runtime::Dimension dim = unit.empty() ? runtime::Dimension{} : runtime::parse_dim(unit);
+                const double scale = runtime::prefix_scale(dim.factor);
+                dim.factor = runtime::Ratio{0, 1};
+                if(!(dim == expected)) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("Unit \"" + unit + "\" of " + column +
+                                                                " does not have the dimension " +
+                                                                runtime::to_string(expected)));
+                }
+                return scale;
+            }
+
+            std::string header(const std::vector<ColumnInfo>& columns)
+            {
+                std::string result;
+                for(const auto& column : columns) {
+                    if(!result.empty()) result += ',';
+                    result += column.name;
+                    if(!column.unit.empty()) result += '[' + column.unit + ']';
+                }
+                return result;
+            }
+
+            std::vector<Column> match_header(const std::string& line, const std::vector<ColumnInfo>& columns)
+            {
+                std::vector<Column> result;
+                std::vector<bool> found(columns.size(), false);
+                std::istringstream cells(line);
+                std::string cell;
+                while(std::getline(cells, cell, ',')) {
+                    cell = trim(cell);
+                    std::string name = cell, unit;
+                    const std::size_t open = cell.find('[');
+                    if(open != std::string::npos) {
+                        if(cell.back() != ']') BOOST_THROW_EXCEPTION(std::runtime_error("Malformed header cell " + cell));
+                        name = trim(cell.substr(0, open));
+                        unit = trim(cell.substr(open + 1, cell.size() - open - 2));
+                    }
+
+                    Column column{Column::npos, 1.0};
+                    for(std::size_t i = 0; i < columns.size(); ++i) {
+                        if(columns[i].name != name) continue;
+                        if(found[i]) BOOST_THROW_EXCEPTION(std::runtime_error("Repeated column " + name));
+                        found[i] = true;
+                        try {
+                            column = Column{columns[i].slot, unit_scale(unit, columns[i].dimension, name)};
+                        } catch (const std::invalid_argument& e) {
+                            BOOST_THROW_EXCEPTION(std::runtime_error(e.what()));
+                        }
+                        break;
+                    }
+                    result.push_back(column);
+                }
+                for(std::size_t i = 0; i < columns.size(); ++i) {
+                    if(!found[i]) BOOST_THROW_EXCEPTION(std::runtime_error("Missing column " + columns[i].name));
+                }
+                return result;
+            }
+
+            bool parse_row(const char* first, const char* last, const Column* columns, std::size_t count,
+                           double* values)
+            {
+                const char* p = first;
+                for(std::size_t i = 0; i < count; ++i) {
+                    if(i) {
+                        if(p == last || *p != ',') return false;
+                        ++p;
+                    }
+                    if(columns[i].slot == Column::npos) {
+                        while(p < last && *p != ',') ++p;
+                        continue;
+                    }
+                    char* end;
+                    const double value = std::strtod(p, &end);
+                    if(end == p || end > last) return false;
+                    values[columns[i].slot] = value * columns[i].scale;
+                    p = skip_space(end, last);
+                }
+                return p == last;
+            }
+        }
+    }
+}
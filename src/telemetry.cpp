@@ -0,0 +1,317 @@
+#include "quantity/telemetry.hpp"
+#include "quantity/io.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <system_error>
+#include <utility>
+#include <boost/throw_exception.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace quantity
+{
+    namespace telemetry
+    {
+        namespace detail
+        {
+            constexpr std::uint64_t MAGIC = 0x314c455459544e51;     // "QNTYTEL1"
+            constexpr std::uint32_t VERSION = 1;
+            constexpr std::size_t MAX_CHANNELS = 64;
+            constexpr std::size_t NAME_LENGTH = 48;
+            constexpr std::size_t CACHE_LINE = 64;
+
+            static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared memory needs lock free 64 bit atomics");
+
+            struct ChannelRecord
+            {
+                char name[NAME_LENGTH];
+                std::int64_t ratios[8];     //!< length, mass, time and factor as numerator, denominator
+                std::uint32_t type;
+                std::uint32_t components;
+                std::uint32_t offset;
+                std::uint32_t reserved;
+            };
+
+            /// layout of the start of the segment. Written once by the producer, before `magic`.
+            struct Header
+            {
+                std::atomic<std::uint64_t> magic;
+                std::uint32_t version;
+                std::uint32_t channel_count;
+                std::uint64_t capacity;
+                std::uint64_t stride;
+                std::uint64_t record_size;
+                ChannelRecord channels[MAX_CHANNELS];
+                alignas(CACHE_LINE) std::atomic<std::uint64_t> head;   //!< number of committed records
+            };
+
+            /// start of every slot, followed by the record.
+            struct SlotHeader
+            {
+                /// `2 n + 1` while record `n` is written, `2 n + 2` once it is complete.
+                std::atomic<std::uint64_t> sequence;
+            };
+
+            constexpr std::size_t round_up(std::size_t value, std::size_t multiple)
+            {
+                return (value + multiple - 1) / multiple * multiple;
+            }
+
+            constexpr std::size_t SLOTS_OFFSET = round_up(sizeof(Header), CACHE_LINE);
+            constexpr std::size_t PAYLOAD_OFFSET = sizeof(SlotHeader);
+
+            [[noreturn]] void throw_errno(const std::string& what)
+            {
+                BOOST_THROW_EXCEPTION(std::system_error(errno, std::generic_category(), what));
+            }
+
+            SharedMemory::SharedMemory(SharedMemory&& other) noexcept
+            {
+                *this = std::move(other);
+            }
+
+            SharedMemory& SharedMemory::operator=(SharedMemory&& other) noexcept
+            {
+                if(this != &other) {
+                    release();
+                    m_Name = std::move(other.m_Name);
+                    m_Data = other.m_Data;
+                    m_Size = other.m_Size;
+                    m_Owner = other.m_Owner;
+                    other.m_Data = nullptr;
+                    other.m_Size = 0;
+                    other.m_Owner = false;
+                }
+                return *this;
+            }
+
+            SharedMemory::~SharedMemory()
+            {
+                release();
+            }
+
+            void SharedMemory::release() noexcept
+            {
+                if(m_Data) {
+                    munmap(m_Data, m_Size);
+                    m_Data = nullptr;
+                }
+                if(m_Owner) {
+                    shm_unlink(m_Name.c_str());
+                    m_Owner = false;
+                }
+            }
+
+            SharedMemory SharedMemory::create(const std::string& name, std::size_t size)
+            {
+                int fd = shm_open(name.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0600);
+                if(fd < 0) throw_errno("Could not create shared memory " + name);
+                if(ftruncate(fd, off_t(size)) != 0) {
+                    int error = errno;
+                    close(fd);
+                    shm_unlink(name.c_str());
+                    errno = error;
+                    throw_errno("Could not resize shared memory " + name);
+                }
+                void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                close(fd);
+                if(data == MAP_FAILED) {
+                    shm_unlink(name.c_str());
+                    throw_errno("Could not map shared memory " + name);
+                }
+
+                SharedMemory memory;
+                memory.m_Name = name;
+                memory.m_Data = static_cast<unsigned char*>(data);
+                memory.m_Size = size;
+                memory.m_Owner = true;
+                return memory;
+            }
+
+            SharedMemory SharedMemory::open(const std::string& name)
+            {
+                int fd = shm_open(name.c_str(), O_RDONLY, 0);
+                if(fd < 0) throw_errno("Could not open shared memory " + name);
+                struct stat info;
+                if(fstat(fd, &info) != 0) {
+                    close(fd);
+                    throw_errno("Could not query shared memory " + name);
+                }
+                void* data = mmap(nullptr, std::size_t(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+                close(fd);
+                if(data == MAP_FAILED) throw_errno("Could not map shared memory " + name);
+
+                SharedMemory memory;
+                memory.m_Name = name;
+                memory.m_Data = static_cast<unsigned char*>(data);
+                memory.m_Size = std::size_t(info.st_size);
+                return memory;
+            }
+
+            const ChannelInfo& check_channel(const std::vector<ChannelInfo>& channels, const ChannelInfo& expected)
+            {
+                auto found = std::find_if(channels.begin(), channels.end(),
+                                          [&](const ChannelInfo& c) { return c.name == expected.name; });
+                if(found == channels.end()) {
+                    BOOST_THROW_EXCEPTION(std::runtime_error("No telemetry channel named '" + expected.name + "'"));
+                }
+                if(!(found->dimension == expected.dimension)) {
+                    BOOST_THROW_EXCEPTION(std::runtime_error("Telemetry channel '" + expected.name + "' has unit " +
+                                                             runtime::to_string(found->dimension, "1") + ", requested " +
+                                                             runtime::to_string(expected.dimension, "1")));
+                }
+                if(found->type != expected.type || found->components != expected.components) {
+                    BOOST_THROW_EXCEPTION(std::runtime_error("Telemetry channel '" + expected.name +
+                                                             "' has a different element type"));
+                }
+                return *found;
+            }
+        }
+
+        using detail::Header;
+        using detail::SlotHeader;
+
+        Schema& Schema::add(ChannelInfo info, std::size_t size, std::size_t align)
+        {
+            if(info.name.empty() || info.name.size() >= detail::NAME_LENGTH) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Invalid telemetry channel name '" + info.name + "'"));
+            }
+            for(const auto& c : m_Channels) {
+                if(c.name == info.name) {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument("Duplicate telemetry channel '" + info.name + "'"));
+                }
+            }
+            if(m_Channels.size() == detail::MAX_CHANNELS) {
+                BOOST_THROW_EXCEPTION(std::invalid_argument("Too many telemetry channels"));
+            }
+            info.offset = std::uint32_t(detail::round_up(m_RecordSize, align));
+            m_RecordSize = info.offset + size;
+            m_Channels.push_back(std::move(info));
+            return *this;
+        }
+
+        Producer::Producer(const std::string& name, Schema schema, std::size_t capacity) :
+                m_Schema(std::move(schema))
+        {
+            m_Capacity = 2;
+            while(m_Capacity < capacity) m_Capacity *= 2;
+            m_Stride = detail::round_up(detail::PAYLOAD_OFFSET + m_Schema.record_size(), detail::CACHE_LINE);
+            m_Memory = detail::SharedMemory::create(name, detail::SLOTS_OFFSET + m_Capacity * m_Stride);
+
+            m_Header = new(m_Memory.data()) Header;
+            m_Header->version = detail::VERSION;
+            m_Header->channel_count = std::uint32_t(m_Schema.channels().size());
+            m_Header->capacity = m_Capacity;
+            m_Header->stride = m_Stride;
+            m_Header->record_size = m_Schema.record_size();
+            for(std::size_t i = 0; i < m_Schema.channels().size(); ++i) {
+                const ChannelInfo& info = m_Schema.channels()[i];
+                detail::ChannelRecord& record = m_Header->channels[i];
+                std::memset(&record, 0, sizeof(record));
+                std::strncpy(record.name, info.name.c_str(), detail::NAME_LENGTH - 1);
+                const runtime::Ratio* ratios[4] = {&info.dimension.length, &info.dimension.mass,
+                                                   &info.dimension.time, &info.dimension.factor};
+                for(int r = 0; r < 4; ++r) {
+                    record.ratios[2 * r] = ratios[r]->num;
+                    record.ratios[2 * r + 1] = ratios[r]->den;
+                }
+                record.type = std::uint32_t(info.type);
+                record.components = info.components;
+                record.offset = info.offset;
+            }
+            m_Header->head.store(0, std::memory_order_relaxed);
+            for(std::size_t i = 0; i < m_Capacity; ++i) {
+                new(m_Memory.data() + detail::SLOTS_OFFSET + i * m_Stride) SlotHeader{{0}};
+            }
+            m_Header->magic.store(detail::MAGIC, std::memory_order_release);
+        }
+
+        SlotHeader* Producer::slot(std::uint64_t sequence) const
+        {
+            std::size_t index = std::size_t(sequence & (m_Capacity - 1));
+            return reinterpret_cast<SlotHeader*>(m_Memory.data() + detail::SLOTS_OFFSET + index * m_Stride);
+        }
+
+        WriteSample Producer::begin()
+        {
+            SlotHeader* s = slot(m_Next);
+            s->sequence.store(2 * m_Next + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            return WriteSample(reinterpret_cast<unsigned char*>(s) + detail::PAYLOAD_OFFSET, m_Next);
+        }
+
+        void Producer::commit()
+        {
+            slot(m_Next)->sequence.store(2 * m_Next + 2, std::memory_order_release);
+            ++m_Next;
+            m_Header->head.store(m_Next, std::memory_order_release);
+        }
+
+        Consumer::Consumer(const std::string& name) : m_Memory(detail::SharedMemory::open(name))
+        {
+            if(m_Memory.size() < detail::SLOTS_OFFSET) {
+                BOOST_THROW_EXCEPTION(std::runtime_error("Shared memory " + name + " is not a telemetry stream"));
+            }
+            m_Header = reinterpret_cast<const Header*>(m_Memory.data());
+            if(m_Header->magic.load(std::memory_order_acquire) != detail::MAGIC ||
+               m_Header->version != detail::VERSION) {
+                BOOST_THROW_EXCEPTION(std::runtime_error("Shared memory " + name + " is not a telemetry stream"));
+            }
+            m_Capacity = std::size_t(m_Header->capacity);
+            m_Stride = std::size_t(m_Header->stride);
+            if(m_Memory.size() < detail::SLOTS_OFFSET + m_Capacity * m_Stride ||
+               m_Header->channel_count > detail::MAX_CHANNELS) {
+                BOOST_THROW_EXCEPTION(std::runtime_error("Telemetry stream " + name + " is corrupted"));
+            }
+
+            for(std::size_t i = 0; i < m_Header->channel_count; ++i) {
+                const detail::ChannelRecord& record = m_Header->channels[i];
+                const std::int64_t* r = record.ratios;
+                runtime::Dimension dim{{r[0], r[1]}, {r[2], r[3]}, {r[4], r[5]}, {r[6], r[7]}};
+                m_Channels.push_back(ChannelInfo{std::string(record.name, strnlen(record.name, detail::NAME_LENGTH)),
+                                                 dim, ElementType(record.type), record.components, record.offset});
+            }
+            m_Next = m_Header->head.load(std::memory_order_acquire);
+        }
+
+        const SlotHeader* Consumer::slot(std::uint64_t sequence) const
+        {
+            std::size_t index = std::size_t(sequence & (m_Capacity - 1));
+            return reinterpret_cast<const SlotHeader*>(m_Memory.data() + detail::SLOTS_OFFSET + index * m_Stride);
+        }
+
+        bool Consumer::poll(Sample& sample)
+        {
+            std::uint64_t head = m_Header->head.load(std::memory_order_acquire);
+            while(m_Next < head) {
+                if(head - m_Next > m_Capacity) {
+                    m_Lost += head - m_Capacity - m_Next;
+                    m_Next = head - m_Capacity;
+                }
+                const SlotHeader* s = slot(m_Next);
+                if(s->sequence.load(std::memory_order_acquire) == 2 * m_Next + 2) {
+                    sample = Sample(reinterpret_cast<const unsigned char*>(s) + detail::PAYLOAD_OFFSET, m_Next);
+                    ++m_Next;
+                    return true;
+                }
+                // the slot is already reused by a later record.
+                ++m_Lost;
+                ++m_Next;
+                head = m_Header->head.load(std::memory_order_acquire);
+            }
+            return false;
+        }
+
+        bool Consumer::valid(const Sample& sample) const
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return slot(sample.sequence())->sequence.load(std::memory_order_relaxed) == 2 * sample.sequence() + 2;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#include <boost/test/unit_test.hpp>
+
+#include <thread>
+#include <vector>
+#include "quantity/atomic.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(atomic_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    namespace pd = quantity::dimensions::predefined;
+
+    template<class F>
+    void run_threads(int count, F&& f)
+    {
+        std::vector<std::thread> threads;
+        for(int t = 0; t < count; ++t) {
+            threads.emplace_back(f);
+        }
+        for(auto& t : threads) {
+            t.join();
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(atomic_quantity)
+    {
+        AtomicQuantity<double, pd::energy_t> e(5.0_J);
+        BOOST_CHECK(e.load() == 5.0_J);
+        BOOST_CHECK(e.fetch_add(2.0_J) == 5.0_J);
+        BOOST_CHECK(e.fetch_sub(1.0_J) == 7.0_J);
+        BOOST_CHECK((e += 4.0_J) == 10.0_J);
+        BOOST_CHECK(e.exchange(1.0_J) == 10.0_J);
+
+        energy_t expected = 1.0_J;
+        BOOST_CHECK(e.compare_exchange_strong(expected, 3.0_J));
+        BOOST_CHECK(!e.compare_exchange_strong(expected, 4.0_J));
+        BOOST_CHECK(expected == 3.0_J);
+        BOOST_CHECK(energy_t(e) == 3.0_J);
+
+        AtomicQuantity<long, pd::mass_t> counter;
+        counter.fetch_add(Quantity<long, pd::mass_t>(3));
+        BOOST_CHECK_EQUAL(counter.load().value, 3);
+    }
+
+    BOOST_AUTO_TEST_CASE(concurrent_fetch_add)
+    {
+        AtomicQuantity<double, pd::impulse_t> total;
+        AtomicVec3<force_t> force;
+        run_threads(8, [&] {
+            for(int i = 0; i < 10000; ++i) {
+                total.fetch_add(impulse_t(1.0));
+                force.fetch_add(make_vector(1.0_N, 2.0_N, -1.0_N));
+            }
+        });
+        BOOST_CHECK_EQUAL(total.load().value, 80000.0);
+        BOOST_CHECK(force.load() == make_vector(80000.0_N, 160000.0_N, -80000.0_N));
+    }
+
+    BOOST_AUTO_TEST_CASE(sharded_accumulator)
+    {
+        ShardedAccumulator<energy_t> energy(4);
+        ShardedAccumulator<force_vec> force;
+        BOOST_CHECK_EQUAL(energy.shard_count(), 4u);
+
+        // more threads than shards still gives the right result
+        run_threads(6, [&] {
+            for(int i = 0; i < 10000; ++i) {
+                energy += 0.5_J;
+                force.add(make_vector(1.0_N, 0.0_N, 2.0_N));
+            }
+        });
+        BOOST_CHECK(energy.total() == 30000.0_J);
+        BOOST_CHECK(force.total() == make_vector(60000.0_N, 0.0_N, 120000.0_N));
+
+        energy.reset();
+        BOOST_CHECK(energy.total() == 0.0_J);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
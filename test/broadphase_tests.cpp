@@ -0,0 +1,127 @@
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "quantity/broadphase.hpp"
+
+BOOST_AUTO_TEST_SUITE(broadphase_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    using broadphase::Pair;
+
+    struct Scene
+    {
+        explicit Scene(std::size_t n)
+        {
+            std::mt19937 rng(7);
+            std::uniform_real_distribution<double> coord(-100.0, 100.0);
+            std::uniform_real_distribution<double> radius(0.1, 3.0);
+            for(std::size_t i = 0; i < n; ++i) {
+                positions.push_back(meters(coord(rng), coord(rng), coord(rng)));
+                radii.emplace_back(radius(rng));
+            }
+        }
+
+        void jitter(double amount)
+        {
+            std::mt19937 rng(11);
+            std::uniform_real_distribution<double> d(-amount, amount);
+            for(auto& p : positions) {
+                p += meters(d(rng), d(rng), d(rng));
+            }
+        }
+
+        std::vector<Pair> reference() const
+        {
+            std::vector<Pair> pairs;
+            broadphase::brute_force(positions, radii, pairs);
+            return pairs;
+        }
+
+        std::vector<length_vec> positions;
+        std::vector<length_t> radii;
+    };
+
+    template<class Broadphase>
+    std::vector<Pair> sorted_pairs(const Broadphase& phase)
+    {
+        std::vector<Pair> pairs;
+        phase.find_pairs(pairs);
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+    void check_pairs(const std::vector<Pair>& found, const std::vector<Pair>& expected)
+    {
+        BOOST_REQUIRE_EQUAL(found.size(), expected.size());
+        BOOST_CHECK(std::equal(found.begin(), found.end(), expected.begin()));
+    }
+
+    BOOST_AUTO_TEST_CASE(touching_spheres)
+    {
+        std::vector<length_vec> pos = {meters(0, 0, 0), meters(3, 0, 0), meters(10, 0, 0)};
+        std::vector<length_t> radii = {1.0_m, 2.0_m, 1.0_m};
+
+        broadphase::UniformGrid grid;
+        grid.build(pos, radii);
+        check_pairs(sorted_pairs(grid), {Pair{0, 1}});
+
+        broadphase::SweepAndPrune sap;
+        sap.build(pos, radii);
+        check_pairs(sorted_pairs(sap), {Pair{0, 1}});
+    }
+
+    BOOST_AUTO_TEST_CASE(grid_matches_brute_force)
+    {
+        Scene scene(2000);
+        auto expected = scene.reference();
+        BOOST_CHECK(!expected.empty());
+
+        broadphase::UniformGrid grid(0.5_m);
+        grid.build(scene.positions, scene.radii);
+        check_pairs(sorted_pairs(grid), expected);
+    }
+
+    BOOST_AUTO_TEST_CASE(grid_incremental_update)
+    {
+        Scene scene(2000);
+        broadphase::UniformGrid grid(0.5_m);
+        grid.build(scene.positions, scene.radii);
+
+        // small motion stays within the loose cells
+        scene.jitter(0.1);
+        BOOST_CHECK(!grid.update(scene.positions, scene.radii));
+        check_pairs(sorted_pairs(grid), scene.reference());
+
+        // large motion forces a rebuild
+        scene.jitter(5.0);
+        BOOST_CHECK(grid.update(scene.positions, scene.radii));
+        check_pairs(sorted_pairs(grid), scene.reference());
+    }
+
+    BOOST_AUTO_TEST_CASE(sweep_and_prune)
+    {
+        Scene scene(2000);
+        broadphase::SweepAndPrune sap;
+        sap.build(scene.positions, scene.radii);
+        check_pairs(sorted_pairs(sap), scene.reference());
+
+        for(int step = 0; step < 3; ++step) {
+            scene.jitter(1.0);
+            sap.update(scene.positions, scene.radii);
+            check_pairs(sorted_pairs(sap), scene.reference());
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(size_mismatch)
+    {
+        std::vector<length_vec> pos(3);
+        std::vector<length_t> radii(2);
+        broadphase::UniformGrid grid;
+        BOOST_CHECK_THROW(grid.build(pos, radii), std::invalid_argument);
+        broadphase::SweepAndPrune sap;
+        BOOST_CHECK_THROW(sap.build(pos, radii), std::invalid_argument);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,136 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "quantity/compression.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(compression_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    using compression::Series;
+    using quantity::predefined::time_t;
+
+    BOOST_AUTO_TEST_CASE(scalar_round_trip)
+    {
+        Series<length_t> series(1e-3_s, 100);
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<double> jitter(-1.0, 1.0);
+        std::vector<double> t, h;
+        double now = 1000.0;
+        for(int i = 0; i < 1050; ++i) {
+            // mostly regular sampling with occasional gaps of all sizes
+            now += i % 97 == 0 ? 3.7 : (i % 13 == 0 ? 0.011 : 0.010);
+            now = std::round(now * 1e3) / 1e3;
+            t.push_back(now);
+            h.push_back(i % 5 == 0 ? h.empty() ? 0.0 : h.back() : 7e6 + 1e3 * std::sin(i * 0.01) + jitter(rng));
+            series.push_back(time_t(now), meters(h.back()));
+        }
+        BOOST_CHECK_EQUAL(series.block_count(), 10u);
+        BOOST_CHECK_EQUAL(series.size(), 1000u);
+        series.flush();
+        BOOST_CHECK_EQUAL(series.block_count(), 11u);
+        BOOST_CHECK_EQUAL(series.size(), t.size());
+        BOOST_CHECK_LT(series.compressed_bytes(), t.size() * 16);
+
+        std::vector<time_t> times;
+        std::vector<length_t> values;
+        series.decode(times, values, 3);
+        BOOST_REQUIRE_EQUAL(times.size(), t.size());
+        for(std::size_t i = 0; i < t.size(); ++i) {
+            BOOST_CHECK_CLOSE(times[i].value, t[i], 1e-12);
+            BOOST_CHECK_EQUAL(values[i].value, h[i]);
+        }
+
+        // random access
+        std::size_t b = series.find_block(time_t(t[555]));
+        BOOST_CHECK_EQUAL(b, 5u);
+        series.decode_block(b, times, values);
+        BOOST_CHECK_EQUAL(times.size(), 100u);
+        BOOST_CHECK_EQUAL(values[55].value, h[555]);
+        BOOST_CHECK_EQUAL(series.find_block(time_t(0.0)), 0u);
+        BOOST_CHECK_EQUAL(series.find_block(time_t(1e9)), 10u);
+    }
+
+    BOOST_AUTO_TEST_CASE(vector_round_trip)
+    {
+        Series<velocity_vec> series(1.0_s);
+        std::vector<velocity_vec> v;
+        for(int i = 0; i < 300; ++i) {
+            v.push_back(make_vector(7.5_kps * std::cos(i * 0.1), 7.5_kps * std::sin(i * 0.1), 0.0_kps));
+            series.push_back(time_t(10.0 * i), v.back());
+        }
+        series.flush();
+
+        std::vector<time_t> times;
+        Vec3Array<speed_t> values;
+        series.decode(times, values);
+        BOOST_REQUIRE_EQUAL(values.size(), v.size());
+        for(std::size_t i = 0; i < v.size(); ++i) {
+            BOOST_CHECK(values[i] == v[i]);
+            BOOST_CHECK_EQUAL(times[i].value, 10.0 * i);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(block_header)
+    {
+        Series<force_t> series;
+        series.push_back(1.0_s, 2.0_N);
+        series.push_back(2.0_s, 3.0_N);
+        series.flush();
+
+        std::vector<unsigned char> bytes(series.block(0).begin(), series.block(0).end());
+        auto info = compression::read_block_info(bytes);
+        BOOST_CHECK(info.dimension == runtime::to_dynamic(dimensions::predefined::force_t{}));
+        BOOST_CHECK_EQUAL(info.count, 2u);
+        BOOST_CHECK_EQUAL(info.last_time, 2.0);
+
+        // blocks only go into series of the same dimension, in time order
+        Series<energy_t> energy;
+        BOOST_CHECK_THROW(energy.add_block(bytes), std::runtime_error);
+        Series<force_t> copy;
+        copy.add_block(bytes);
+        BOOST_CHECK_THROW(copy.add_block(bytes), std::runtime_error);
+        BOOST_CHECK_THROW(copy.push_back(0.5_s, 1.0_N), std::invalid_argument);
+
+        bytes[0] ^= 1;
+        BOOST_CHECK_THROW(compression::read_block_info(bytes), std::runtime_error);
+    }
+
+    BOOST_AUTO_TEST_CASE(corrupted_blocks)
+    {
+        Series<length_t> series(1e-3_s, 100);
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<double> step(0.001, 0.5);
+        double now = 0.0;
+        for(int i = 0; i < 100; ++i) {
+            now += step(rng);
+            series.push_back(time_t(now), meters(step(rng)));
+        }
+
+        // more samples in the header than in the streams
+        std::vector<unsigned char> bytes(series.block(0).begin(), series.block(0).end());
+        std::uint32_t count = 150;
+        std::memcpy(bytes.data() + sizeof(std::uint32_t), &count, sizeof(count));
+        Series<length_t> truncated;
+        truncated.add_block(bytes);
+        std::vector<time_t> times;
+        std::vector<length_t> values;
+        BOOST_CHECK_THROW(truncated.decode_block(0, times, values), std::runtime_error);
+
+        // a value window with more leading and meaningful bits than a double has
+        const std::vector<double> t{0.0, 1.0};
+        const std::vector<double> v{1.0, 2.0};
+        bytes = compression::encode_block(runtime::Dimension{}, 1.0, t, {Span<const double>(v)});
+        // 120 bytes header, 10 bytes times, then the first value and the window of the second
+        BOOST_REQUIRE_EQUAL(bytes.size(), 150u);
+        bytes[138] = 0xFF;
+        bytes[139] |= 0xFC;
+        std::vector<double> decoded_t(2), decoded_v(2);
+        BOOST_CHECK_THROW(compression::decode_block(bytes, decoded_t, {Span<double>(decoded_v)}), std::runtime_error);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
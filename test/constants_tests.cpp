@@ -0,0 +1,63 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include "quantity/constants.hpp"
+#include "quantity/math.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(constants_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+
+    // the arithmetic surface in constant expressions
+    constexpr length_vec a = meters(3.0, 0.0, 4.0);
+    constexpr length_vec b = meters(0.0, 2.0, 0.0);
+    static_assert(length(a) == 5.0_m, "constexpr length");
+    static_assert(dot(a, b) == 0.0_m * 0.0_m, "constexpr dot");
+    static_assert(cross(a, b) == make_vector(-8.0_m * 1.0_m, 0.0_m * 1.0_m, 6.0_m * 1.0_m), "constexpr cross");
+    static_assert(abs(-2.0_kg) == 2.0_kg, "constexpr abs");
+    static_assert(sqrt(16.0_m * 1.0_m) == 4.0_m, "constexpr sqrt");
+
+    constexpr length_vec moved()
+    {
+        length_vec v = a;
+        v += b;
+        v -= meters(1.0, 1.0, 1.0);
+        v *= 2.0;
+        return v;
+    }
+    static_assert(moved() == meters(4.0, 2.0, 6.0), "constexpr compound assignment");
+
+    // derived tables are computed by the compiler
+    constexpr speed_t earth_escape = constants::escape_velocity(constants::gm::earth, constants::radius::earth);
+    constexpr speed_t leo = constants::circular_velocity(constants::gm::earth, constants::radius::earth + 400.0_km);
+    constexpr speed_t table[] = {leo, earth_escape};
+    static_assert(table[1] > 11.1_kps && table[1] < 11.2_kps, "escape velocity of the earth");
+
+    BOOST_AUTO_TEST_CASE(constexpr_sqrt)
+    {
+        // the compile time square root agrees with std::sqrt to the last bit or so
+        constexpr double values[] = {0.0, 1e-300, 2e-10, 0.5, 2.0, 3.0, 10.0, 12345.678, 1e20, 1.7e308};
+        constexpr double roots[] = {math::sqrt(values[0]), math::sqrt(values[1]), math::sqrt(values[2]),
+                                    math::sqrt(values[3]), math::sqrt(values[4]), math::sqrt(values[5]),
+                                    math::sqrt(values[6]), math::sqrt(values[7]), math::sqrt(values[8]),
+                                    math::sqrt(values[9])};
+        for(std::size_t i = 0; i < 10; ++i) {
+            BOOST_CHECK_LE(std::abs(roots[i] - std::sqrt(values[i])), 2e-16 * std::sqrt(values[i]));
+        }
+        BOOST_CHECK(std::isnan(math::sqrt(-1.0)));
+        BOOST_CHECK_EQUAL(math::sqrt(16), 4.0);
+        BOOST_CHECK_EQUAL(math::abs(-0.0), 0.0);
+        BOOST_CHECK(!std::signbit(math::abs(-0.0)));
+    }
+
+    BOOST_AUTO_TEST_CASE(derived_values)
+    {
+        BOOST_CHECK_CLOSE(earth_escape.value, 11180.0, 0.1);
+        BOOST_CHECK_CLOSE(leo.value, 7669.0, 0.1);
+        BOOST_CHECK_CLOSE(constants::mass(constants::gm::earth).value, 5.972e24, 0.1);
+        BOOST_CHECK_CLOSE(constants::gravitational_acceleration(constants::gm::earth, constants::radius::earth).value,
+                          constants::g0.value, 0.5);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
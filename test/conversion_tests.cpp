@@ -0,0 +1,67 @@
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include "quantity/conversion.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(conversion_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    using runtime::ConversionPlan;
+
+    BOOST_AUTO_TEST_CASE(factors)
+    {
+        BOOST_CHECK_CLOSE(ConversionPlan("km/s", "m/s").factor(), 1e3, 1e-12);
+        BOOST_CHECK_CLOSE(ConversionPlan("MJ", "kJ").factor(), 1e3, 1e-12);
+        BOOST_CHECK_CLOSE(ConversionPlan("mm^2", "m^2").factor(), 1e-6, 1e-12);
+        BOOST_CHECK_CLOSE(ConversionPlan("J", "kgm^2/s^2").factor(), 1.0, 1e-12);
+        BOOST_CHECK_CLOSE(ConversionPlan("t", "g").factor(), 1e6, 1e-12);
+        BOOST_CHECK_CLOSE(ConversionPlan("kN", "Mgm/s^2").factor(), 1.0, 1e-12);
+
+        ConversionPlan plan("km/s", "mm/ms");
+        BOOST_CHECK(plan.dimension() == runtime::to_dynamic(dimensions::predefined::velocity_t{}));
+        BOOST_CHECK_CLOSE(plan(2.0), 2000.0, 1e-12);
+
+        BOOST_CHECK_THROW(ConversionPlan("km", "s"), std::runtime_error);
+        BOOST_CHECK_THROW(ConversionPlan("km", "furlong"), std::runtime_error);
+    }
+
+    BOOST_AUTO_TEST_CASE(spans)
+    {
+        const ConversionPlan& plan = ConversionPlan::cached("MW", "kW");
+        BOOST_CHECK_EQUAL(&plan, &ConversionPlan::cached("MW", "kW"));
+        BOOST_CHECK_NE(&plan, &ConversionPlan::cached("kW", "MW"));
+
+        std::vector<double> in(100000);
+        for(std::size_t i = 0; i < in.size(); ++i) in[i] = 0.5 * double(i);
+        std::vector<double> out(in.size());
+        plan.apply(in, out, 4);
+        for(std::size_t i = 0; i < in.size(); i += 997) BOOST_CHECK_CLOSE(out[i], 500.0 * double(i), 1e-12);
+
+        plan.apply(in);
+        BOOST_CHECK_EQUAL(in[7], out[7]);
+
+        std::vector<double> short_out(10);
+        BOOST_CHECK_THROW(plan.apply(in, short_out), std::invalid_argument);
+    }
+
+    BOOST_AUTO_TEST_CASE(quantities)
+    {
+        std::vector<double> raw = {1.0, 2.5, -4.0};
+        std::vector<speed_t> speeds(raw.size());
+        ConversionPlan::cached("km/s", "m/s").apply(raw, Span<speed_t>(speeds));
+        BOOST_CHECK(speeds[1] == 2.5_kps);
+
+        std::vector<double> back(raw.size());
+        ConversionPlan::cached("m/s", "km/ms").apply(Span<const speed_t>(speeds), back);
+        BOOST_CHECK_CLOSE(back[2], -4e-3, 1e-12);
+
+        std::vector<length_t> lengths(raw.size());
+        // neither a coherent target unit nor the right dimension
+        BOOST_CHECK_THROW(ConversionPlan::cached("m", "km").apply(raw, Span<length_t>(lengths)),
+                          std::invalid_argument);
+        BOOST_CHECK_THROW(ConversionPlan::cached("km/s", "m/s").apply(raw, Span<length_t>(lengths)),
+                          std::invalid_argument);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,86 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <type_traits>
+#include "quantity/dual.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(dual_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    using quantity::predefined::time_t;
+
+    using dual_t = Dual<double, 3>;
+
+    BOOST_AUTO_TEST_CASE(scalar_rules)
+    {
+        dual_t x = dual_t::variable(2.0, 0);
+        dual_t y = dual_t::variable(3.0, 1);
+
+        dual_t f = x * y + 2.0 * x - y / x;
+        BOOST_CHECK_CLOSE(f.value, 6.0 + 4.0 - 1.5, 1e-12);
+        BOOST_CHECK_CLOSE(f.grad[0], 3.0 + 2.0 + 3.0 / 4.0, 1e-12);
+        BOOST_CHECK_CLOSE(f.grad[1], 2.0 - 0.5, 1e-12);
+        BOOST_CHECK_EQUAL(f.grad[2], 0.0);
+
+        dual_t g = sqrt(x) * exp(y) + sin(x) * log(y) + pow(x, 3.0);
+        BOOST_CHECK_CLOSE(g.grad[0], 0.5 / std::sqrt(2.0) * std::exp(3.0) + std::cos(2.0) * std::log(3.0) + 12.0,
+                          1e-10);
+        BOOST_CHECK_CLOSE(g.grad[1], std::sqrt(2.0) * std::exp(3.0) + std::sin(2.0) / 3.0, 1e-10);
+
+        dual_t angle = atan2(y, x);
+        BOOST_CHECK_CLOSE(angle.grad[0], -3.0 / 13.0, 1e-10);
+        BOOST_CHECK_CLOSE(angle.grad[1], 2.0 / 13.0, 1e-10);
+
+        BOOST_CHECK_CLOSE(abs(-x).grad[0], 1.0, 1e-12);
+        BOOST_CHECK(x < y);
+        BOOST_CHECK(x == 2.0);
+    }
+
+    BOOST_AUTO_TEST_CASE(quantity_derivatives)
+    {
+        // distance fallen after t, differentiated by the time and the initial speed
+        auto t = variable<2>(time_t(3.0), 0);
+        auto v0 = variable<2>(speed_t(5.0), 1);
+        const accel_t g(9.81);
+        auto distance = v0 * t + 0.5 * (g * t) * t;
+
+        BOOST_CHECK_CLOSE(primal(distance).value, 15.0 + 0.5 * 9.81 * 9.0, 1e-12);
+
+        auto by_time = derivative<time_t>(distance, 0);
+        auto by_speed = derivative<speed_t>(distance, 1);
+        static_assert(std::is_same<decltype(by_time), speed_t>::value, "d length / d time is a speed");
+        static_assert(std::is_same<decltype(by_speed), time_t>::value, "d length / d speed is a time");
+        BOOST_CHECK_CLOSE(by_time.value, 5.0 + 9.81 * 3.0, 1e-12);
+        BOOST_CHECK_CLOSE(by_speed.value, 3.0, 1e-12);
+    }
+
+    BOOST_AUTO_TEST_CASE(vector_jacobian)
+    {
+        // point mass acceleration a = -mu r / |r|^3, differentiated by all components of r at once
+        using mu_t = decltype(area_t() * accel_t());
+        const mu_t mu(3.986e14);
+        const length_vec r0 = make_vector(7.0e6_m, 1.0e6_m, -2.0e6_m);
+
+        auto r = variable<3>(r0, 0);
+        auto d = length(r);
+        auto a = r * (-mu / (d * d * d));
+
+        const double l = length(r0).value;
+        for(std::size_t j = 0; j < 3; ++j) {
+            auto column = derivative<length_t>(a, j);
+            static_assert(std::is_same<decltype(column.x), decltype(accel_t() / length_t())>::value,
+                          "Jacobian entries are acceleration per length");
+            const double rj = (j == 0 ? r0.x : (j == 1 ? r0.y : r0.z)).value;
+            const double expected[3] = {
+                    -mu.value * ((j == 0) / std::pow(l, 3) - 3 * r0.x.value * rj / std::pow(l, 5)),
+                    -mu.value * ((j == 1) / std::pow(l, 3) - 3 * r0.y.value * rj / std::pow(l, 5)),
+                    -mu.value * ((j == 2) / std::pow(l, 3) - 3 * r0.z.value * rj / std::pow(l, 5))};
+            BOOST_CHECK_CLOSE(column.x.value, expected[0], 1e-9);
+            BOOST_CHECK_CLOSE(column.y.value, expected[1], 1e-9);
+            BOOST_CHECK_CLOSE(column.z.value, expected[2], 1e-9);
+        }
+        BOOST_CHECK_CLOSE(primal(a).x.value, -mu.value * r0.x.value / std::pow(l, 3), 1e-12);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
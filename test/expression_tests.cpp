@@ -0,0 +1,81 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <vector>
+#include "quantity/expression.hpp"
+#include "quantity/io.hpp"
+#include "runtime_utils.hpp"
+
+BOOST_AUTO_TEST_SUITE(expression_tests)
+    using namespace quantity;
+    using runtime::Expression;
+    using runtime::parse_dim;
+
+    BOOST_AUTO_TEST_CASE(kinetic_power)
+    {
+        auto expr = Expression::compile("0.5*m*v^2/t",
+                                        {{"m", parse_dim("kg")}, {"v", parse_dim("km/s")}, {"t", parse_dim("s")}});
+        BOOST_CHECK(expr.dimension() == runtime::WATT_DIM);
+
+        std::vector<double> m, v, t;
+        for(int i = 0; i < 1000; ++i) {
+            m.push_back(1.0 + i);
+            v.push_back(0.001 * i);
+            t.push_back(2.0);
+        }
+        std::vector<double> out(m.size());
+        expr.evaluate({m, v, t}, out, 4);
+        for(std::size_t i = 0; i < out.size(); ++i) {
+            double speed = v[i] * 1e3;
+            BOOST_CHECK_CLOSE(out[i], 0.5 * m[i] * speed * speed / t[i], 1e-12);
+        }
+
+        // the same, but in kilowatts
+        auto kw = Expression::compile("0.5*m*v^2/t",
+                                      {{"m", parse_dim("kg")}, {"v", parse_dim("km/s")}, {"t", parse_dim("s")}}, "kW");
+        BOOST_CHECK_CLOSE(kw.evaluate({4.0, 1.0, 2.0}), 1000.0, 1e-12);
+    }
+
+    BOOST_AUTO_TEST_CASE(operators_and_functions)
+    {
+        std::vector<runtime::Variable> vars = {{"x", parse_dim("m")}, {"y", parse_dim("m")}, {"a", parse_dim("m^2")}};
+        auto check = [&](const char* formula, double expected) {
+            BOOST_CHECK_CLOSE(Expression::compile(formula, vars).evaluate({3.0, -4.0, 16.0}), expected, 1e-12);
+        };
+        check("x + y", -1.0);
+        check("x - y*2", 11.0);
+        check("-x^2", -9.0);
+        check("sqrt(x^2 + y^2)", 5.0);
+        check("abs(y) / x", 4.0 / 3.0);
+        check("a^(1/2) + x", 7.0);
+        check("x^-1 * y", -4.0 / 3.0);
+        check("(x + y * 1e1 * 2) / (2 * 4)", -77.0 / 8.0);
+        check("sqrt(a) * 2 / 4", 2.0);
+
+        // constant parts are folded into a single instruction
+        BOOST_CHECK_EQUAL(Expression::compile("2 * 3 * x", vars).instruction_count(), 2u);
+        BOOST_CHECK_EQUAL(Expression::compile("-(1 + 2)", vars).instruction_count(), 1u);
+    }
+
+    BOOST_AUTO_TEST_CASE(dimension_errors)
+    {
+        std::vector<runtime::Variable> vars = {{"x", parse_dim("m")}, {"t", parse_dim("s")}};
+        BOOST_CHECK_THROW(Expression::compile("x + t", vars), std::runtime_error);
+        BOOST_CHECK_THROW(Expression::compile("x + 1", vars), std::runtime_error);
+        BOOST_CHECK_THROW(Expression::compile("x / t", vars, "N"), std::runtime_error);
+        BOOST_CHECK_THROW(Expression::compile("x * z", vars), std::runtime_error);
+        BOOST_CHECK_THROW(Expression::compile("x * (t", vars), std::runtime_error);
+        BOOST_CHECK_THROW(Expression::compile("log(x)", vars), std::runtime_error);
+        BOOST_CHECK_THROW(Expression::compile("x^y", vars), std::runtime_error);
+        BOOST_CHECK_THROW(Expression::compile("x^(1/0)", vars), std::runtime_error);
+        BOOST_CHECK_THROW(Expression::compile("x^(2/-0)", vars), std::runtime_error);
+
+        auto expr = Expression::compile("x / t", vars, "km/s");
+        BOOST_CHECK_CLOSE(expr.evaluate({3000.0, 2.0}), 1.5, 1e-12);
+        std::vector<double> out(2);
+        std::vector<double> column(3);
+        BOOST_CHECK_THROW(expr.evaluate({column}, out), std::invalid_argument);
+        BOOST_CHECK_THROW(expr.evaluate({column, column}, out), std::invalid_argument);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,158 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "quantity/fit.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(fit_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    using namespace quantity::fit;
+    using quantity::predefined::time_t;
+    using frequency_t = inverse_t<time_t>;
+
+    static_assert(std::is_same<Polynomial<2, time_t, length_t>::coefficient_t<0>, length_t>::value, "position");
+    static_assert(std::is_same<Polynomial<2, time_t, length_t>::coefficient_t<1>, speed_t>::value, "velocity");
+    static_assert(std::is_same<Polynomial<2, time_t, length_t>::coefficient_t<2>, accel_t>::value, "acceleration");
+    static_assert(std::is_same<Polynomial<1, time_t, length_vec>::coefficient_t<1>, velocity_vec>::value, "vectors");
+
+    BOOST_AUTO_TEST_CASE(polynomial_exact)
+    {
+        // a parabola sampled around a large epoch, which needs the shifted and scaled basis
+        const double epoch = 1.7e9;
+        std::vector<time_t> times;
+        std::vector<length_t> positions;
+        for(int i = 0; i < 25; ++i) {
+            const double t = 3.0 * i;
+            times.push_back(time_t(epoch + t));
+            positions.push_back(meters(7e6 + 120.0 * t - 0.5 * 9.81 * t * t));
+        }
+        Tracks<time_t, length_t> tracks;
+        tracks.add(times, positions);
+        auto fits = fit_polynomials<2>(tracks, 1);
+        BOOST_REQUIRE(fits[0].ok);
+        const auto& p = fits[0].polynomial;
+        BOOST_CHECK_EQUAL(fits[0].samples, 25u);
+        BOOST_CHECK_EQUAL(p.origin().value, epoch + 36.0);
+        BOOST_CHECK_CLOSE(p.coefficient<2>().value, -0.5 * 9.81, 1e-8);
+        BOOST_CHECK_CLOSE(p.coefficient<1>().value, 120.0 - 9.81 * 36.0, 1e-8);
+        BOOST_CHECK_CLOSE(p(time_t(epoch + 10.0)).value, 7e6 + 1200.0 - 0.5 * 9.81 * 100.0, 1e-10);
+        BOOST_CHECK_SMALL(fits[0].rms.value, 1e-6);
+    }
+
+    BOOST_AUTO_TEST_CASE(polynomial_tracks)
+    {
+        std::mt19937_64 rng(5);
+        std::normal_distribution<double> noise(0.0, 1.0);
+        Tracks<time_t, length_vec> tracks;
+        std::vector<velocity_vec> velocities;
+        for(int k = 0; k < 500; ++k) {
+            const velocity_vec v(speed_t(k), speed_t(-2.0 * k), speed_t(100.0));
+            velocities.push_back(v);
+            std::vector<time_t> times;
+            std::vector<length_vec> positions;
+            for(int i = 0; i < 40 + k % 7; ++i) {
+                const time_t t(0.5 * i + 0.01 * k);
+                const length_vec noisy(meters(noise(rng)), meters(noise(rng)), meters(noise(rng)));
+                positions.push_back(length_vec(meters(1e3 * k), meters(0.0), meters(-5e3)) + v * t + noisy);
+                times.push_back(t);
+            }
+            tracks.add(times, positions);
+        }
+        // too few samples, and all at the same time
+        const std::vector<time_t> one{time_t(1.0)}, same(5, time_t(1.0));
+        const std::vector<length_vec> origin(5, length_vec());
+        tracks.add(Span<const time_t>(one.data(), 1), Span<const length_vec>(origin.data(), 1));
+        tracks.add(same, origin);
+
+        auto fits = fit_polynomials<1>(tracks);
+        auto serial = fit_polynomials<1>(tracks, 1);
+        BOOST_REQUIRE_EQUAL(fits.size(), 502u);
+        for(int k = 0; k < 500; ++k) {
+            BOOST_REQUIRE(fits[k].ok);
+            const velocity_vec v = fits[k].polynomial.coefficient<1>();
+            BOOST_CHECK_SMALL(length(v - velocities[k]).value, 0.5);
+            BOOST_CHECK_CLOSE(fits[k].rms.value, std::sqrt(3.0), 40.0);
+            BOOST_CHECK_EQUAL(fits[k].polynomial.coefficient<0>().x.value, serial[k].polynomial.coefficient<0>().x.value);
+        }
+        BOOST_CHECK(!fits[500].ok);
+        BOOST_CHECK(!fits[501].ok);
+    }
+
+    BOOST_AUTO_TEST_CASE(nonlinear_scalar)
+    {
+        auto model = [](time_t t, auto amplitude, auto omega, auto phase) {
+            using std::cos;
+            return amplitude * cos((omega * t + phase).value);
+        };
+
+        Tracks<time_t, length_t> tracks;
+        std::vector<std::tuple<length_t, frequency_t, scalar_t>> truth;
+        for(int k = 0; k < 50; ++k) {
+            truth.emplace_back(meters(1e4 + 100.0 * k), frequency_t(0.1 + 0.001 * k), scalar_t(0.3));
+            std::vector<time_t> times;
+            std::vector<length_t> values;
+            for(int i = 0; i < 60; ++i) {
+                times.push_back(time_t(0.5 * i));
+                values.push_back(model(times.back(), std::get<0>(truth[k]), std::get<1>(truth[k]), std::get<2>(truth[k])));
+            }
+            tracks.add(times, values);
+        }
+
+        std::vector<std::tuple<length_t, frequency_t, scalar_t>> initial = {
+                std::make_tuple(meters(9e3), frequency_t(0.11), scalar_t(0.0))};
+        auto fits = levenberg_marquardt(model, tracks, initial);
+        BOOST_REQUIRE_EQUAL(fits.size(), 50u);
+        for(int k = 0; k < 50; ++k) {
+            BOOST_CHECK(fits[k].converged);
+            const length_t amplitude = std::get<0>(fits[k].parameters);
+            const frequency_t omega = std::get<1>(fits[k].parameters);
+            BOOST_CHECK_CLOSE(amplitude.value, std::get<0>(truth[k]).value, 1e-6);
+            BOOST_CHECK_CLOSE(omega.value, std::get<1>(truth[k]).value, 1e-6);
+            BOOST_CHECK_CLOSE(std::get<2>(fits[k].parameters).value, 0.3, 1e-6);
+            BOOST_CHECK_SMALL(fits[k].rms.value, 1e-5);
+            BOOST_CHECK_SMALL(std::get<1>(fits[k].sigma).value, 1e-9);
+        }
+
+        std::vector<std::tuple<length_t, frequency_t, scalar_t>> wrong(3, initial[0]);
+        BOOST_CHECK_THROW(levenberg_marquardt(model, tracks, wrong), std::invalid_argument);
+    }
+
+    BOOST_AUTO_TEST_CASE(nonlinear_vector)
+    {
+        // a circular orbit in the xy plane at height h, with noisy positions
+        auto model = [](time_t t, auto radius, auto omega, auto height) {
+            using std::cos;
+            using std::sin;
+            const auto angle = (omega * t).value;
+            return make_vector(radius * cos(angle), radius * sin(angle), height);
+        };
+        std::mt19937_64 rng(11);
+        std::normal_distribution<double> noise(0.0, 10.0);
+        std::vector<time_t> times;
+        std::vector<length_vec> positions;
+        for(int i = 0; i < 200; ++i) {
+            times.push_back(time_t(10.0 * i));
+            const length_vec exact = model(times.back(), meters(7e6), frequency_t(1.1e-3), meters(2e3));
+            positions.push_back(exact + length_vec(meters(noise(rng)), meters(noise(rng)), meters(noise(rng))));
+        }
+        Tracks<time_t, length_vec> tracks;
+        tracks.add(times, positions);
+        std::vector<std::tuple<length_t, frequency_t, length_t>> initial = {
+                std::make_tuple(meters(6.9e6), frequency_t(1.09e-3), meters(0.0))};
+        auto fits = levenberg_marquardt(model, tracks, initial);
+        BOOST_REQUIRE(fits[0].converged);
+        const length_t radius = std::get<0>(fits[0].parameters);
+        const length_t radius_sigma = std::get<0>(fits[0].sigma);
+        BOOST_CHECK_SMALL(radius.value - 7e6, 4 * radius_sigma.value);
+        BOOST_CHECK_SMALL(std::get<2>(fits[0].parameters).value - 2e3, 4 * std::get<2>(fits[0].sigma).value);
+        BOOST_CHECK_CLOSE(radius_sigma.value, 10.0 / std::sqrt(200.0), 30.0);
+        // three components of standard deviation 10
+        BOOST_CHECK_CLOSE(fits[0].rms.value, 10.0 * std::sqrt(3.0), 15.0);
+    }
+BOOST_AUTO_TEST_SUITE_END()
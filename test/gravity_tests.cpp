@@ -0,0 +1,114 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include "quantity/gravity.hpp"
+
+BOOST_AUTO_TEST_SUITE(gravity_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+
+    void random_bodies(std::size_t n, std::vector<length_vec>& pos, std::vector<mass_t>& mass)
+    {
+        std::mt19937 rng(42);
+        std::normal_distribution<double> coord(0.0, 1e6);
+        std::uniform_real_distribution<double> m(1e20, 1e22);
+        pos.clear();
+        mass.clear();
+        for(std::size_t i = 0; i < n; ++i) {
+            pos.push_back(meters(coord(rng), coord(rng), coord(rng)));
+            mass.emplace_back(m(rng));
+        }
+    }
+
+    double relative_error(const accel_vec& a, const accel_vec& reference)
+    {
+        return length(a - reference) / length(reference);
+    }
+
+    BOOST_AUTO_TEST_CASE(two_bodies)
+    {
+        std::vector<length_vec> pos = {meters(0, 0, 0), meters(10, 0, 0)};
+        std::vector<mass_t> mass = {1000.0_kg, 2000.0_kg};
+        std::vector<accel_vec> acc(2);
+        gravity::barnes_hut(pos, mass, acc);
+
+        BOOST_CHECK_CLOSE(acc[0].x.value, gravity::G.value * 2000 / 100, 1e-10);
+        BOOST_CHECK_CLOSE(acc[1].x.value, -gravity::G.value * 1000 / 100, 1e-10);
+        BOOST_CHECK_EQUAL(acc[0].y.value, 0.0);
+    }
+
+    BOOST_AUTO_TEST_CASE(zero_opening_angle_is_exact)
+    {
+        std::vector<length_vec> pos;
+        std::vector<mass_t> mass;
+        random_bodies(500, pos, mass);
+
+        gravity::Options options;
+        options.opening_angle = 0;
+        std::vector<accel_vec> direct(pos.size());
+        std::vector<accel_vec> tree(pos.size());
+        gravity::direct_sum(pos, mass, direct, options);
+        gravity::barnes_hut(pos, mass, tree, options);
+
+        for(std::size_t i = 0; i < pos.size(); ++i) {
+            BOOST_CHECK_SMALL(relative_error(tree[i], direct[i]), 1e-10);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(approximation_error)
+    {
+        std::vector<length_vec> pos;
+        std::vector<mass_t> mass;
+        random_bodies(2000, pos, mass);
+
+        gravity::Options options;
+        options.opening_angle = 0.5;
+        std::vector<accel_vec> direct(pos.size());
+        std::vector<accel_vec> tree(pos.size());
+        gravity::direct_sum(pos, mass, direct, options);
+
+        gravity::BarnesHut solver(options);
+        solver.build(pos, mass);
+        solver.accelerations(tree);
+        BOOST_CHECK_EQUAL(solver.body_count(), pos.size());
+        BOOST_CHECK_GT(solver.node_count(), 1u);
+
+        double sum_sq = 0;
+        for(std::size_t i = 0; i < pos.size(); ++i) {
+            double e = relative_error(tree[i], direct[i]);
+            sum_sq += e * e;
+        }
+        BOOST_CHECK_LT(std::sqrt(sum_sq / pos.size()), 1e-2);
+
+        // evaluation at an arbitrary point uses the same tree
+        auto far = meters(1e9, 0, 0);
+        gravity::Options exact = options;
+        exact.opening_angle = 0;
+        gravity::BarnesHut reference(exact);
+        reference.build(pos, mass);
+        BOOST_CHECK_SMALL(relative_error(solver.acceleration(far), reference.acceleration(far)), 1e-4);
+    }
+
+    BOOST_AUTO_TEST_CASE(softening)
+    {
+        std::vector<length_vec> pos = {meters(0, 0, 0), meters(3, 0, 0)};
+        std::vector<mass_t> mass = {1.0_kg, 1.0_kg};
+        std::vector<accel_vec> acc(2);
+        gravity::Options options;
+        options.softening = 4.0_m;
+        gravity::barnes_hut(pos, mass, acc, options);
+        BOOST_CHECK_CLOSE(acc[0].x.value, gravity::G.value * 3 / 125, 1e-10);
+    }
+
+    BOOST_AUTO_TEST_CASE(size_mismatch)
+    {
+        std::vector<length_vec> pos(3);
+        std::vector<mass_t> mass(2);
+        std::vector<accel_vec> acc(3);
+        BOOST_CHECK_THROW(gravity::barnes_hut(pos, mass, acc), std::invalid_argument);
+        BOOST_CHECK_THROW(gravity::direct_sum(pos, mass, acc), std::invalid_argument);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,125 @@
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "quantity/ingest.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(ingest_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    using namespace quantity::ingest;
+
+    /// a source handing out `text` in pieces of at most `piece` bytes.
+    Source pieces(const std::string& text, std::size_t piece)
+    {
+        auto pos = std::make_shared<std::size_t>(0);
+        return [text, piece, pos](char* buffer, std::size_t size) {
+            const std::size_t n = std::min({size, piece, text.size() - *pos});
+            std::memcpy(buffer, text.data() + *pos, n);
+            *pos += n;
+            return n;
+        };
+    }
+
+    std::vector<length_t> collect(Pipeline<double, length_t::dimension_t>& pipeline)
+    {
+        std::vector<length_t> result;
+        pipeline.run([&](Span<const length_t> batch) { result.insert(result.end(), batch.begin(), batch.end()); });
+        return result;
+    }
+
+    BOOST_AUTO_TEST_CASE(lines_and_units)
+    {
+        std::istringstream input("1 m\n2.5 km\r\n\n  3e-3 mm  \n4");
+        Pipeline<double, length_t::dimension_t> pipeline(from_stream(input), Options{});
+        auto values = collect(pipeline);
+        BOOST_REQUIRE_EQUAL(values.size(), 3u);
+        BOOST_CHECK_EQUAL(values[0].value, 1.0);
+        BOOST_CHECK_CLOSE(values[1].value, 2500.0, 1e-12);
+        BOOST_CHECK_CLOSE(values[2].value, 3e-6, 1e-12);
+        // the last line has no unit and so the wrong dimension
+        BOOST_CHECK_EQUAL(pipeline.rejected(), 1u);
+    }
+
+    BOOST_AUTO_TEST_CASE(lines_across_blocks)
+    {
+        std::string text;
+        for(int i = 0; i < 1000; ++i) text += std::to_string(i) + (i % 2 ? " km\n" : " m\n");
+        Options options;
+        options.chunk_bytes = 7;
+        options.queue_capacity = 1;
+        Pipeline<double, length_t::dimension_t> pipeline(pieces(text, 5), options);
+        auto values = collect(pipeline);
+        BOOST_REQUIRE_EQUAL(values.size(), 1000u);
+        for(int i = 0; i < 1000; ++i) BOOST_CHECK_EQUAL(values[i].value, i % 2 ? 1000.0 * i : double(i));
+
+        auto metrics = pipeline.metrics();
+        BOOST_CHECK_EQUAL(metrics[SPLIT].items, 1000u);
+        BOOST_CHECK_EQUAL(metrics[PARSE].items, 1000u);
+        BOOST_CHECK_EQUAL(metrics[DELIVER].items, 1000u);
+        BOOST_CHECK_EQUAL(std::string(metrics[CONVERT].name), "convert");
+        BOOST_CHECK_LE(metrics[READ].max_queue_depth, 1u);
+    }
+
+    BOOST_AUTO_TEST_CASE(malformed_lines)
+    {
+        const std::string text = "1 m\nabc\n2 s\n3 m m\n4 xyz\n5 m\n";
+        {
+            Pipeline<double, length_t::dimension_t> pipeline(pieces(text, 1 << 10), Options{});
+            auto values = collect(pipeline);
+            BOOST_REQUIRE_EQUAL(values.size(), 2u);
+            BOOST_CHECK_EQUAL(values[1].value, 5.0);
+            BOOST_CHECK_EQUAL(pipeline.rejected(), 4u);
+        }
+
+        Options strict;
+        strict.strict = true;
+        Pipeline<double, length_t::dimension_t> bad_line(pieces("1 m\nabc\n", 1 << 10), strict);
+        BOOST_CHECK_THROW(collect(bad_line), std::runtime_error);
+        Pipeline<double, length_t::dimension_t> bad_unit(pieces("1 m\n2 s\n", 1 << 10), strict);
+        BOOST_CHECK_THROW(collect(bad_unit), std::runtime_error);
+    }
+
+    BOOST_AUTO_TEST_CASE(backpressure)
+    {
+        std::string text;
+        for(int i = 0; i < 20000; ++i) text += "1 km\n";
+        Options options;
+        options.chunk_bytes = 64;
+        options.queue_capacity = 2;
+        Pipeline<float, length_t::dimension_t> pipeline(pieces(text, 64), options);
+        std::size_t count = 0;
+        bool first = true;
+        pipeline.run([&](Span<const Quantity<float, length_t::dimension_t>> batch) {
+            if(first) {
+                // a stalled consumer lets every queue fill up to its capacity, but not beyond
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                first = false;
+            }
+            count += batch.size();
+        });
+        BOOST_CHECK_EQUAL(count, 20000u);
+        for(const auto& stage : pipeline.metrics()) BOOST_CHECK_LE(stage.max_queue_depth, 2u);
+        BOOST_CHECK_EQUAL(pipeline.metrics()[READ].max_queue_depth, 2u);
+        BOOST_CHECK_GT(pipeline.metrics()[READ].blocked.count(), 0);
+    }
+
+    BOOST_AUTO_TEST_CASE(consumer_exception)
+    {
+        std::string text;
+        for(int i = 0; i < 10000; ++i) text += "1 m\n";
+        Options options;
+        options.chunk_bytes = 32;
+        Pipeline<double, length_t::dimension_t> pipeline(pieces(text, 32), options);
+        BOOST_CHECK_THROW(pipeline.run([](Span<const length_t>) { throw std::logic_error("stop"); }),
+                          std::logic_error);
+    }
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,118 @@
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "quantity/instrumentation.hpp"
+#include "quantity/io.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(instrumentation_tests)
+    using namespace quantity;
+    using namespace quantity::instrumentation;
+
+    ProbeStats find(const std::string& name)
+    {
+        for(const auto& stats : snapshot()) {
+            if(stats.name == name) return stats;
+        }
+        return ProbeStats{name, 0, 0, 0, std::chrono::nanoseconds(0), {}};
+    }
+
+    std::size_t occurrences(const std::string& text, const std::string& pattern)
+    {
+        std::size_t n = 0;
+        for(auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) ++n;
+        return n;
+    }
+
+    BOOST_AUTO_TEST_CASE(scope_timer)
+    {
+        reset();
+        Probe& p = probe("test::kernel");
+        BOOST_CHECK_EQUAL(&p, &probe("test::kernel"));
+
+        for(int i = 0; i < 10; ++i) {
+            ScopeTimer timer(p);
+        }
+        try {
+            ScopeTimer timer(p);
+            throw std::runtime_error("failure");
+        } catch (std::runtime_error&) {
+            // a timer that is created during unwinding does not count as an exception
+            ScopeTimer timer(p);
+        }
+
+        ProbeStats stats = find("test::kernel");
+        BOOST_CHECK_EQUAL(stats.calls, 12u);
+        BOOST_CHECK_EQUAL(stats.exceptions, 1u);
+        std::uint64_t histogram_total = 0;
+        for(auto count : stats.histogram) histogram_total += count;
+        BOOST_CHECK_EQUAL(histogram_total, 12u);
+        BOOST_CHECK(stats.quantile(0.5) <= stats.quantile(1.0));
+        BOOST_CHECK(stats.quantile(1.0) > std::chrono::nanoseconds(0));
+
+        reset();
+        BOOST_CHECK_EQUAL(find("test::kernel").calls, 0u);
+    }
+
+    BOOST_AUTO_TEST_CASE(chrome_trace)
+    {
+        reset();
+        Probe& p = probe("test::\"quoted\"");
+        {
+            ScopeTimer untraced(p);
+        }
+        start_tracing(3);
+        for(int i = 0; i < 5; ++i) {
+            ScopeTimer timer(p);
+        }
+        stop_tracing();
+
+        std::ostringstream out;
+        write_chrome_trace(out);
+        std::string json = out.str();
+        BOOST_CHECK_EQUAL(json.find("{\"traceEvents\":["), 0u);
+        BOOST_CHECK_EQUAL(occurrences(json, "\"ph\":\"X\""), 3u);
+        BOOST_CHECK_NE(json.find("\"name\":\"test::\\\"quoted\\\"\",\"cat\":\"quantity\",\"ph\":\"C\""), std::string::npos);
+        BOOST_CHECK_NE(json.find("\"calls\":6"), std::string::npos);
+        BOOST_CHECK_NE(json.find("\"dropped_events\":2"), std::string::npos);
+        reset();
+    }
+
+    BOOST_AUTO_TEST_CASE(library_probes)
+    {
+        reset();
+        runtime::parse_dim("km/s");
+        BOOST_CHECK_THROW(runtime::parse_dim("furlong"), std::runtime_error);
+        std::ostringstream out;
+        out << predefined::meters(4.0);
+
+        ProbeStats parse = find("runtime::parse_dim");
+        if(enabled()) {
+            BOOST_CHECK_EQUAL(parse.calls, 2u);
+            BOOST_CHECK_EQUAL(parse.exceptions, 1u);
+            BOOST_CHECK_GT(parse.allocations, 0u);
+            BOOST_CHECK_EQUAL(find("operator<<(Quantity)").calls, 1u);
+            BOOST_CHECK_EQUAL(find("runtime::dynamic_rescale").calls, 1u);
+        } else {
+            // compiled out
+            BOOST_CHECK_EQUAL(parse.calls, 0u);
+            BOOST_CHECK_EQUAL(thread_allocations(), 0u);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(vector_parsing_allocations)
+    {
+        const std::string text = "(1.5, -2, 3e4) km";
+        predefined::length_vec vec;
+        // the first call parses the unit and fills the cache
+        parse_vector(text.data(), text.data() + text.size(), vec);
+
+        std::uint64_t before = thread_allocations();
+        for(int i = 0; i < 100; ++i) parse_vector(text.data(), text.data() + text.size(), vec);
+        BOOST_CHECK_EQUAL(thread_allocations(), before);
+        BOOST_CHECK(vec.z == predefined::kilometers(3e4));
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
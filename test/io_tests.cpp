@@ -151,6 +151,10 @@ BOOST_AUTO_TEST_SUITE(io_tests)
         // and handle quadratic stuff correctly.
         check_stream_out(2.0_km * 2.0_km, "4 km^2");
         check_stream_out(2.0_km * 2.0_m, "4000 m^2");
+
+        // beyond the largest and smallest prefix
+        check_stream_out(predefined::meters(1e20), "1e+08 Tm");
+        check_stream_out(predefined::meters(1e-20), "1e-08 pm");
     }
 
     BOOST_AUTO_TEST_CASE(quantity_output_compound)
@@ -177,7 +181,13 @@ BOOST_AUTO_TEST_SUITE(io_tests)
     BOOST_AUTO_TEST_CASE(vector_output)
     {
         check_stream_out(quantity::Vec3<int>{1, 2, 3}, "(1, 2, 3)");
-        check_stream_out(quantity::make_vector(2.1_m, -2.5_m, 1.8_m), "(2.1 m, -2.5 m, 1.8 m)");
+        check_stream_out(quantity::make_vector(2.1_m, -2.5_m, 1.8_m), "(2.1, -2.5, 1.8) m");
+
+        // one prefix for all components, chosen by the largest one
+        check_stream_out(quantity::make_vector(1.5_km, -2.0_km, 0.5_km), "(1.5, -2, 0.5) km");
+        check_stream_out(quantity::make_vector(1.5_km, 20.0_m, 0.0_m), "(1.5, 0.02, 0) km");
+        check_stream_out(quantity::make_vector(0.0_m, 0.0_m, 0.0_m), "(0, 0, 0) m");
+        check_stream_out(quantity::make_vector(3.0_N, 0.5_N, 1.0_N), "(3, 0.5, 1) N");
     }
 
     BOOST_AUTO_TEST_CASE(vector_input)
@@ -185,7 +195,43 @@ BOOST_AUTO_TEST_SUITE(io_tests)
         check_stream_in("1 2 3", quantity::Vec3<int>{1, 2, 3});
         check_stream_in("2.1 m -2.5 m 1.8 m", quantity::make_vector(2.1_m, -2.5_m, 1.8_m));
 
-        //! \todo allow comma separated values; allow parenthesis
+        check_stream_in("(2.1, -2.5, 1.8) m", quantity::make_vector(2.1_m, -2.5_m, 1.8_m));
+        check_stream_in("  ( 1.5,-2 , 3e4 )   km", quantity::make_vector(1.5_km, -2.0_km, 30000.0_km));
+        check_stream_in("(12, 0, -1) kgm/s^2", quantity::make_vector(12.0_N, 0.0_N, -1.0_N));
+    }
+
+    BOOST_AUTO_TEST_CASE(vector_round_trip)
+    {
+        auto original = quantity::make_vector(1234.5_m, -0.25_m, 7.0_km);
+        std::stringstream text;
+        text << original << " " << original;
+        length_vec first;
+        length_vec second;
+        text >> first >> second;
+        BOOST_CHECK(!text.fail());
+        BOOST_CHECK_CLOSE(first.x.value, 1234.5, 1e-12);
+        BOOST_CHECK_CLOSE(second.z.value, 7000.0, 1e-12);
+
+        // several vectors in one buffer
+        const std::string column = "(1, 2, 3) km (4, 5, 6) km";
+        const char* pos = column.data();
+        pos = quantity::parse_vector(pos, column.data() + column.size(), first);
+        pos = quantity::parse_vector(pos, column.data() + column.size(), second);
+        BOOST_CHECK(first.y == 2.0_km);
+        BOOST_CHECK(second.x == 4.0_km);
+        BOOST_CHECK_EQUAL(pos, column.data() + column.size());
+    }
+
+    BOOST_AUTO_TEST_CASE(vector_input_checking)
+    {
+        length_vec vec;
+        BOOST_CHECK_THROW(check_stream_in("(1, 2, 3) s", vec), std::runtime_error);
+        BOOST_CHECK_THROW(check_stream_in("(1, 2 3) m", vec), std::runtime_error);
+        BOOST_CHECK_THROW(check_stream_in("(1, two, 3) m", vec), std::runtime_error);
+
+        std::stringstream unterminated("(1, 2, 3 m");
+        unterminated >> vec;
+        BOOST_CHECK(unterminated.fail());
     }
 
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
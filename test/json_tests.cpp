@@ -0,0 +1,111 @@
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include "quantity/json.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(json_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    using json::Token;
+
+    BOOST_AUTO_TEST_CASE(tokens)
+    {
+        // a buffer of four bytes makes tokens cross buffer boundaries
+        std::istringstream text(R"( {"a": [1, -2.5e3, true, null], "b\"ä😀": {}, "c": "x\ny"} [] )");
+        json::Reader reader(text, 4);
+
+        std::vector<Token> expected = {Token::BEGIN_OBJECT, Token::KEY, Token::BEGIN_ARRAY, Token::NUMBER,
+                                       Token::NUMBER, Token::BOOLEAN, Token::NULL_VALUE, Token::END_ARRAY,
+                                       Token::KEY, Token::BEGIN_OBJECT, Token::END_OBJECT, Token::KEY,
+                                       Token::STRING, Token::END_OBJECT, Token::BEGIN_ARRAY, Token::END_ARRAY,
+                                       Token::END};
+        std::vector<std::string> texts;
+        std::vector<double> numbers;
+        for(Token e : expected) {
+            Token t = reader.next();
+            BOOST_REQUIRE(t == e);
+            if(t == Token::KEY || t == Token::STRING) texts.push_back(reader.text());
+            if(t == Token::NUMBER) numbers.push_back(reader.number());
+        }
+        BOOST_CHECK_EQUAL(texts.size(), 4u);
+        BOOST_CHECK_EQUAL(texts[1], "b\"\xc3\xa4\xf0\x9f\x98\x80");
+        BOOST_CHECK_EQUAL(texts[3], "x\ny");
+        BOOST_CHECK_EQUAL(numbers[1], -2500.0);
+
+        for(const char* bad : {"{\"a\" 1}", "[1 2]", "[1,]", "{\"a\":}", "[1", "{1: 2}", "[tru]", "\"abc"}) {
+            std::istringstream in(bad);
+            json::Reader r(in);
+            BOOST_CHECK_THROW(while(r.next() != Token::END) { }, std::runtime_error);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(records)
+    {
+        std::istringstream text(R"([
+            {"id": 7, "pos": {"value": [1, 2, 3], "unit": "km"}, "mass": {"unit": "t", "value": 5}},
+            {"pos": {"value": [4000, 0, -1], "unit": "m", "frame": "eci"}, "mass": 12.5, "extra": [{"x": 1}]}
+        ])");
+
+        length_vec pos;
+        std::vector<mass_t> masses;
+        json::Fields fields;
+        fields.bind("pos", pos).bind("mass", masses);
+        json::RecordReader records(text, fields, 16);
+
+        BOOST_REQUIRE(records.next());
+        BOOST_CHECK(pos == kilometers(1.0, 2.0, 3.0));
+        BOOST_REQUIRE(records.next());
+        BOOST_CHECK(pos == meters(4000.0, 0.0, -1.0));
+        BOOST_CHECK(!records.next());
+        BOOST_CHECK_EQUAL(records.count(), 2u);
+        BOOST_REQUIRE_EQUAL(masses.size(), 2u);
+        BOOST_CHECK(masses[0] == 5.0_t);
+        BOOST_CHECK(masses[1] == 12.5_kg);
+
+        auto fails = [&](const std::string& input) {
+            std::istringstream in(input);
+            json::RecordReader r(in, fields);
+            BOOST_CHECK_THROW(while(r.next()) { }, std::runtime_error);
+        };
+        fails(R"({"pos": {"value": [1, 2, 3], "unit": "s"}, "mass": 1})");
+        fails(R"({"pos": {"value": [1, 2], "unit": "m"}, "mass": 1})");
+        fails(R"({"pos": {"value": [1, 2, 3], "unit": "m"}})");
+        fails(R"({"pos": [1, 2, 3], "mass": 1, "mass": 2})");
+    }
+
+    BOOST_AUTO_TEST_CASE(round_trip)
+    {
+        std::ostringstream out;
+        {
+            json::Writer writer(out);
+            for(int i = 0; i < 3; ++i) {
+                writer.begin_object()
+                      .field("pos", kilometers(0.1 * i, 2.0, -3.0), "km")
+                      .field("vel", make_vector(speed_t(1.0 / 3.0), speed_t(0.0), speed_t(-7.25)))
+                      .field("name", std::string("sat \"") + char('a' + i) + "\"")
+                      .end_object();
+            }
+            BOOST_CHECK_THROW(writer.value(1.0_kg, "km"), std::runtime_error);
+        }
+        const std::string text = out.str();
+        BOOST_CHECK_EQUAL(text.substr(0, text.find('\n')),
+                          R"({"pos":{"value":[0,2,-3],"unit":"km"},"vel":{"value":[0.33333333333333331,0,-7.25],)"
+                          R"("unit":"m/s"},"name":"sat \"a\""})");
+
+        // JSON lines with Vec3Array columns
+        Vec3Array<length_t> positions;
+        std::vector<velocity_vec> velocities;
+        json::Fields fields;
+        fields.bind("pos", positions).bind("vel", velocities);
+        std::istringstream in(text);
+        json::RecordReader records(in, fields);
+        while(records.next()) { }
+        BOOST_REQUIRE_EQUAL(positions.size(), 3u);
+        BOOST_CHECK_EQUAL(positions.x[2].value, 0.2 * 1000.0);
+        BOOST_CHECK_EQUAL(velocities[1].x.value, 1.0 / 3.0);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
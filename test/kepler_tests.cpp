@@ -0,0 +1,124 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <random>
+#include "quantity/kepler.hpp"
+
+BOOST_AUTO_TEST_SUITE(kepler_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+
+    const kepler::grav_param_t MU_EARTH{3.986004418e14};
+    const double PI = 3.14159265358979323846;
+
+    BOOST_AUTO_TEST_CASE(eccentric_anomaly)
+    {
+        for(double e : {0.0, 0.1, 0.5, 0.9, 0.99}) {
+            for(double m = -3.0; m < 10.0; m += 0.37) {
+                double E = kepler::eccentric_anomaly(m, e);
+                double residual = std::remainder(E - e * std::sin(E) - m, 2 * PI);
+                BOOST_CHECK_SMALL(residual, 1e-12);
+            }
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(circular_orbit)
+    {
+        kepler::Elements el;
+        el.push_back(7000.0_km, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0_s);
+        // a quarter period later, the satellite is on the y axis.
+        double n = std::sqrt(MU_EARTH.value / std::pow(7e6, 3));
+        auto t = predefined::time_t(PI / 2 / n);
+
+        Vec3Array<length_t> pos;
+        Vec3Array<speed_t> vel;
+        kepler::propagate(el, t, MU_EARTH, pos, vel);
+
+        BOOST_CHECK_SMALL(pos.x[0].value, 1e-6);
+        BOOST_CHECK_CLOSE(pos.y[0].value, 7e6, 1e-9);
+        BOOST_CHECK_CLOSE(vel.x[0].value, -std::sqrt(MU_EARTH.value / 7e6), 1e-9);
+        BOOST_CHECK_SMALL(vel.z[0].value, 1e-9);
+    }
+
+    BOOST_AUTO_TEST_CASE(conserved_quantities)
+    {
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<double> a(6800e3, 42000e3);
+        std::uniform_real_distribution<double> e(0.0, 0.95);
+        std::uniform_real_distribution<double> angle(0.0, 2 * PI);
+
+        kepler::Elements el;
+        for(int i = 0; i < 1000; ++i) {
+            el.push_back(length_t(a(rng)), e(rng), angle(rng) / 2, angle(rng), angle(rng), angle(rng),
+                         predefined::time_t(angle(rng) * 100));
+        }
+
+        Vec3Array<length_t> pos;
+        Vec3Array<speed_t> vel;
+        kepler::Options options;
+        options.threads = 3;
+        kepler::propagate(el, 86400.0_s, MU_EARTH, pos, vel, options);
+        BOOST_REQUIRE_EQUAL(pos.size(), el.size());
+
+        for(std::size_t i = 0; i < el.size(); ++i) {
+            auto r = pos[i];
+            auto v = vel[i];
+            // vis-viva equation
+            auto v2 = dot(v, v);
+            auto expected = MU_EARTH * (scalar_t(2.0) / length(r) - scalar_t(1.0) / el.semi_major_axis[i]);
+            BOOST_CHECK_CLOSE(v2.value, expected.value, 1e-8);
+
+            // specific angular momentum
+            double h = length(cross(r, v)).value;
+            double ecc = el.eccentricity[i];
+            double expected_h = std::sqrt(MU_EARTH.value * el.semi_major_axis[i].value * (1 - ecc * ecc));
+            BOOST_CHECK_CLOSE(h, expected_h, 1e-8);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(batched_kepler_equation)
+    {
+        const double a = 26600e3;
+        const double eccentricities[] = {0.1, 0.5, 0.9, 0.99};
+        kepler::Elements el;
+        for(double e : eccentricities) {
+            for(double m0 = -3.0; m0 < 10.0; m0 += 0.37) {
+                el.push_back(length_t(a), e, 0.3, 1.0, 2.0, m0, 0.0_s);
+            }
+        }
+
+        Vec3Array<length_t> pos;
+        Vec3Array<speed_t> vel;
+        const auto t = 5000.0_s;
+        kepler::propagate(el, t, MU_EARTH, pos, vel);
+
+        const double n = std::sqrt(MU_EARTH.value / (a * a * a));
+        for(std::size_t i = 0; i < el.size(); ++i) {
+            // recover E from r = a (1 - e cos E) and r.v = sqrt(mu a) e sin E
+            double e = el.eccentricity[i];
+            double r = length(pos[i]).value;
+            double rv = dot(pos[i], vel[i]).value;
+            double E = std::atan2(rv / std::sqrt(MU_EARTH.value * a), 1 - r / a);
+            double m = el.mean_anomaly[i] + n * t.value;
+
+            BOOST_CHECK_SMALL(std::remainder(E - e * std::sin(E) - m, 2 * PI), 1e-10);
+            BOOST_CHECK_SMALL(std::remainder(E - kepler::eccentric_anomaly(m, e), 2 * PI), 1e-10);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(invalid_elements)
+    {
+        Vec3Array<length_t> pos;
+        Vec3Array<speed_t> vel;
+
+        kepler::Elements hyperbolic;
+        hyperbolic.push_back(7000.0_km, 1.2, 0.0, 0.0, 0.0, 0.0, 0.0_s);
+        BOOST_CHECK_THROW(kepler::propagate(hyperbolic, 0.0_s, MU_EARTH, pos, vel), std::invalid_argument);
+
+        kepler::Elements ragged;
+        ragged.push_back(7000.0_km, 0.1, 0.0, 0.0, 0.0, 0.0, 0.0_s);
+        ragged.epoch.clear();
+        BOOST_CHECK_THROW(kepler::propagate(ragged, 0.0_s, MU_EARTH, pos, vel), std::invalid_argument);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "quantity/io.hpp"
+#include "quantity/logging.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(logging_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    using logging::AsyncSink;
+
+    template<class T>
+    std::string formatted(const char* label, const T& value)
+    {
+        std::ostringstream out;
+        out << label << ": " << value << "\n";
+        return out.str();
+    }
+
+    BOOST_AUTO_TEST_CASE(same_text_as_operator)
+    {
+        std::ostringstream expected;
+        std::ostringstream out;
+        {
+            AsyncSink sink(out);
+            auto log = [&](const char* label, const auto& value) {
+                BOOST_CHECK(sink.log(label, value));
+                expected << formatted(label, value);
+            };
+            log("distance", 7.5_km);
+            log("mass", 12.6_g);
+            log("area", 2.0_km * 2.0_m);
+            log("power", -4.9_kW);
+            log("duration", 0.1_s);
+            log("ratio", scalar_t(0.5));
+            log("position", make_vector(1.5_km, 20.0_m, 0.0_m));
+            log("force", make_vector(3.0_N, 0.5_N, 1.0_N));
+
+            sink.flush();
+            BOOST_CHECK_EQUAL(out.str(), expected.str());
+            log("late", 1.0_m);
+        }
+        // the destructor writes the rest
+        BOOST_CHECK_EQUAL(out.str(), expected.str());
+        BOOST_CHECK_EQUAL(logging::dimension_id<dimensions::predefined::length_t>(),
+                          logging::register_dimension(runtime::to_dynamic(dimensions::predefined::length_t{})));
+    }
+
+    BOOST_AUTO_TEST_CASE(threads_and_full_queues)
+    {
+        constexpr int THREADS = 4;
+        constexpr int RECORDS = 20000;
+        static const char* labels[THREADS] = {"a", "b", "c", "d"};
+
+        std::ostringstream out;
+        std::uint64_t dropped;
+        {
+            // small queues, so that some records are dropped
+            AsyncSink sink(out, 64, 1 << 10);
+            std::vector<std::thread> threads;
+            for(int t = 0; t < THREADS; ++t) {
+                threads.emplace_back([&sink, t]() {
+                    for(int i = 0; i < RECORDS; ++i) sink.log(labels[t], meters(double(i)));
+                });
+            }
+            for(auto& thread : threads) thread.join();
+            sink.flush();
+            dropped = sink.dropped();
+        }
+
+        // every record is either written or dropped, and each thread's records stay in order
+        std::istringstream lines(out.str());
+        std::string label;
+        double value;
+        std::string unit;
+        std::vector<double> last(THREADS, -1.0);
+        std::uint64_t written = 0;
+        while(lines >> label >> value >> unit) {
+            int t = label[0] - 'a';
+            double meters = unit == "km" ? 1000.0 * value : value;
+            BOOST_REQUIRE(t >= 0 && t < THREADS);
+            BOOST_CHECK_GT(meters, last[t]);
+            last[t] = meters;
+            ++written;
+        }
+        BOOST_CHECK_EQUAL(written + dropped, std::uint64_t(THREADS * RECORDS));
+    }
+
+    BOOST_AUTO_TEST_CASE(queue_alignment)
+    {
+        // the producer and consumer indices rely on the queue starting at a cache line
+        std::vector<std::unique_ptr<logging::detail::Queue>> queues;
+        for(int i = 0; i < 8; ++i) {
+            queues.emplace_back(new logging::detail::Queue(16));
+            BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(queues.back().get()) % 64, 0u);
+        }
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
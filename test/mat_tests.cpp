@@ -0,0 +1,108 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include "quantity/transform.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(mat_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    namespace ops = quantity::dimensions::ops;
+    namespace pd = quantity::dimensions::predefined;
+
+    const double PI = 3.14159265358979323846;
+
+    using inertia_t  = qty_<ops::mul_t<pd::mass_t, pd::area_t>>;
+    using angular_t  = rate_t<scalar_t>;
+    using momentum_t = qty_<ops::mul_t<inertia_t::dimension_t, angular_t::dimension_t>>;
+
+    static_assert(std::is_same<decltype(Mat3<inertia_t>{} * Vec3<angular_t>{}), Vec3<momentum_t>>::value,
+                  "matrix-vector product has wrong dimension");
+    static_assert(std::is_same<decltype(Mat3<double>{} * Vec3<length_t>{}), length_vec>::value,
+                  "rotation changes dimension");
+    static_assert(std::is_same<decltype(determinant(Mat3<length_t>{})),
+                               qty_<ops::pow_t<pd::length_t, 3, 1>>>::value, "determinant has wrong dimension");
+
+    void check_close(const length_vec& a, const length_vec& b)
+    {
+        BOOST_CHECK_SMALL(length(a - b).value, 1e-9);
+    }
+
+    BOOST_AUTO_TEST_CASE(matrix_vector)
+    {
+        auto inertia = diagonal_matrix(inertia_t(2.0), inertia_t(3.0), inertia_t(4.0));
+        auto omega = make_vector(angular_t(1.0), angular_t(-1.0), angular_t(0.5));
+        auto L = inertia * omega;
+        BOOST_CHECK_EQUAL(L.x.value, 2.0);
+        BOOST_CHECK_EQUAL(L.y.value, -3.0);
+        BOOST_CHECK_EQUAL(L.z.value, 2.0);
+
+        Mat3<double> m(make_vector(1.0, 2.0, 3.0), make_vector(4.0, 5.0, 6.0), make_vector(7.0, 8.0, 10.0));
+        BOOST_CHECK(m * meters(1, 0, 0) == meters(1, 4, 7));
+        BOOST_CHECK(transpose(m) * meters(1, 0, 0) == meters(1, 2, 3));
+        BOOST_CHECK_CLOSE(determinant(m), -3.0, 1e-12);
+        BOOST_CHECK_EQUAL(trace(m), 16.0);
+    }
+
+    BOOST_AUTO_TEST_CASE(matrix_algebra)
+    {
+        Mat3<double> m(make_vector(1.0, 2.0, 3.0), make_vector(4.0, 5.0, 6.0), make_vector(7.0, 8.0, 10.0));
+        BOOST_CHECK(m * identity_matrix() == m);
+        BOOST_CHECK(identity_matrix() * m == m);
+        BOOST_CHECK(m + m == 2.0 * m);
+        BOOST_CHECK(m - m == Mat3<double>{});
+        BOOST_CHECK((2.0 * m) / 2.0 == m);
+
+        auto mm = m * m;
+        BOOST_CHECK_EQUAL(mm(0, 0), 1.0 * 1 + 2 * 4 + 3 * 7);
+        BOOST_CHECK_EQUAL(mm(2, 1), 7.0 * 2 + 8 * 5 + 10 * 8);
+    }
+
+    BOOST_AUTO_TEST_CASE(quaternion_rotation)
+    {
+        auto q = axis_angle(make_vector(0.0, 0.0, 1.0), PI / 2);
+        BOOST_CHECK_CLOSE(norm(q), 1.0, 1e-12);
+        check_close(rotate(q, meters(1, 0, 0)), meters(0, 1, 0));
+        check_close(to_matrix(q) * meters(1, 0, 0), meters(0, 1, 0));
+        check_close(rotate(conjugate(q), meters(0, 1, 0)), meters(1, 0, 0));
+
+        // composition of rotations
+        auto p = axis_angle(make_vector(1.0, 0.0, 0.0), PI / 3);
+        auto v = meters(0.3, -2, 5);
+        check_close(rotate(p * q, v), rotate(p, rotate(q, v)));
+        check_close(rotate(p * q, v), to_matrix(p) * (to_matrix(q) * v));
+
+        auto n = normalized(2.0 * q);
+        BOOST_CHECK_CLOSE(n.w, q.w, 1e-12);
+        BOOST_CHECK(identity_quaternion() * q == q);
+    }
+
+    BOOST_AUTO_TEST_CASE(batched_transform)
+    {
+        Vec3Array<length_t> positions;
+        for(int i = 0; i < 1000; ++i) {
+            positions.push_back(meters(i, 2.0 * i, -0.5 * i));
+        }
+
+        auto q = normalized(make_quaternion(1.0, 0.2, -0.3, 0.4));
+        Vec3Array<length_t> rotated;
+        rotate(q, positions, rotated, 4);
+        BOOST_REQUIRE_EQUAL(rotated.size(), positions.size());
+        for(std::size_t i = 0; i < positions.size(); ++i) {
+            check_close(rotated[i], rotate(q, positions[i]));
+        }
+
+        // unit carrying matrices change the dimension of the result
+        auto inertia = diagonal_matrix(inertia_t(2.0), inertia_t(3.0), inertia_t(4.0));
+        Vec3Array<angular_t> omega;
+        omega.push_back(make_vector(angular_t(1.0), angular_t(1.0), angular_t(1.0)));
+        Vec3Array<momentum_t> L;
+        transform(inertia, omega, L);
+        BOOST_CHECK_EQUAL(L.z[0].value, 4.0);
+
+        // in place
+        transform(identity_matrix(), positions, positions);
+        BOOST_CHECK(positions[10] == meters(10, 20, -5));
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,84 @@
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include "quantity/montecarlo.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(montecarlo_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    using namespace quantity::montecarlo;
+    using quantity::predefined::time_t;
+
+    BOOST_AUTO_TEST_CASE(philox_known_answers)
+    {
+        // test vectors of the Random123 reference implementation
+        Counter zero = philox(Counter{0, 0, 0, 0}, Key{0, 0});
+        BOOST_CHECK_EQUAL(zero[0], 0x6627e8d5u);
+        BOOST_CHECK_EQUAL(zero[1], 0xe169c58du);
+        BOOST_CHECK_EQUAL(zero[2], 0xbc57ac4cu);
+        BOOST_CHECK_EQUAL(zero[3], 0x9b00dbd8u);
+
+        Counter ones = philox(Counter{0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu},
+                              Key{0xffffffffu, 0xffffffffu});
+        BOOST_CHECK_EQUAL(ones[0], 0x408f276du);
+        BOOST_CHECK_EQUAL(ones[1], 0x41c83b0eu);
+        BOOST_CHECK_EQUAL(ones[2], 0xa20bc7c6u);
+        BOOST_CHECK_EQUAL(ones[3], 0x6d5451fdu);
+    }
+
+    BOOST_AUTO_TEST_CASE(kinetic_energy)
+    {
+        // E = m v^2 / 2 with normal v and uniform m: E[v^2] = mu^2 + sigma^2
+        auto energy = [](mass_t m, speed_t v) { return 0.5 * m * v * v; };
+        auto stats = propagate(200000, Options{1, 4}, energy,
+                               uniform(mass_t(1.0), mass_t(3.0)), normal(speed_t(10.0), speed_t(2.0)));
+
+        static_assert(std::is_same<decltype(stats.mean()), energy_t>::value, "statistics are dimension-typed");
+        BOOST_CHECK_EQUAL(stats.count(), 200000u);
+        BOOST_CHECK_CLOSE(stats.mean().value, 0.5 * 2.0 * (100.0 + 4.0), 1.0);
+        BOOST_CHECK_GE(stats.min().value, 0.0);
+
+        // identical for any thread count, different for another seed
+        auto single = propagate(200000, Options{1, 1}, energy,
+                                uniform(mass_t(1.0), mass_t(3.0)), normal(speed_t(10.0), speed_t(2.0)));
+        BOOST_CHECK_EQUAL(single.mean().value, stats.mean().value);
+        BOOST_CHECK_EQUAL(single.variance().value, stats.variance().value);
+        auto other = propagate(200000, Options{2, 4}, energy,
+                               uniform(mass_t(1.0), mass_t(3.0)), normal(speed_t(10.0), speed_t(2.0)));
+        BOOST_CHECK_NE(other.mean().value, stats.mean().value);
+    }
+
+    BOOST_AUTO_TEST_CASE(vector_inputs)
+    {
+        // displacement after a time with uncertain velocity vector
+        auto displacement = [](const velocity_vec& v, time_t t) { return v * t; };
+        auto samples = sample(50001, Options{7, 3}, displacement,
+                              normal(make_vector(1.0_kps, 0.0_kps, -2.0_kps), make_vector(0.1_kps, 0.2_kps, 0.0_kps)),
+                              normal(time_t(10.0), time_t(0.0)));
+        BOOST_REQUIRE_EQUAL(samples.size(), 50001u);
+
+        statistics::RunningStats<length_vec> stats;
+        stats.add(samples);
+        BOOST_CHECK_CLOSE(stats.mean().x.value, 1e4, 0.2);
+        BOOST_CHECK_SMALL(stats.mean().y.value, 50.0);
+        BOOST_CHECK_CLOSE(stats.stddev().x.value, 1e3, 2.0);
+        BOOST_CHECK_CLOSE(stats.stddev().y.value, 2e3, 2.0);
+        BOOST_CHECK_EQUAL(stats.stddev().z.value, 0.0);
+
+        // the components are independent streams
+        std::size_t equal = 0;
+        for(const auto& s : samples) equal += (s.x / 1.0e4 == s.y / 2.0e4);
+        BOOST_CHECK_EQUAL(equal, 0u);
+
+        auto direct = propagate(50001, Options{7, 1}, displacement,
+                                normal(make_vector(1.0_kps, 0.0_kps, -2.0_kps), make_vector(0.1_kps, 0.2_kps, 0.0_kps)),
+                                normal(time_t(10.0), time_t(0.0)));
+        BOOST_CHECK_CLOSE(direct.mean().x.value, stats.mean().x.value, 1e-9);
+
+        BOOST_CHECK_THROW(propagate(0, Options{}, displacement, normal(velocity_vec{}, velocity_vec{}),
+                                    normal(time_t(1.0), time_t(0.0))), std::invalid_argument);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,81 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include "quantity/quantized.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(quantized_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+
+    std::vector<length_t> sample(std::size_t n)
+    {
+        std::mt19937 rng(11);
+        std::normal_distribution<double> d(0.0, 1.0);
+        std::vector<length_t> data;
+        for(std::size_t i = 0; i < n; ++i) {
+            // slowly varying magnitude, so that blocks get different scales
+            data.emplace_back(7e6 + 1e4 * std::sin(i * 1e-3) + 50.0 * d(rng));
+        }
+        return data;
+    }
+
+    BOOST_AUTO_TEST_CASE(half_conversion)
+    {
+        for(float f : {0.0f, 1.0f, -2.5f, 0.333333f, 65504.0f, 6.1e-5f, 1e-7f}) {
+            float back = detail::half_to_float(detail::float_to_half(f));
+            BOOST_CHECK_CLOSE(back, f, 0.05 + (std::abs(f) < 6e-5f ? 50.0 : 0.0));
+        }
+        BOOST_CHECK_EQUAL(detail::float_to_half(1.0f), 0x3c00);
+        BOOST_CHECK_EQUAL(detail::float_to_half(-2.0f), 0xc000);
+        BOOST_CHECK(std::isinf(detail::half_to_float(detail::float_to_half(1e6f))));
+    }
+
+    BOOST_AUTO_TEST_CASE(error_bounds)
+    {
+        auto data = sample(10000);
+        for(auto encoding : {Encoding::INT16, Encoding::FLOAT16}) {
+            auto q = quantize(data, encoding);
+            BOOST_CHECK_EQUAL(q.size(), data.size());
+            BOOST_CHECK_LT(q.bytes() * 3.8, data.size() * sizeof(double));
+            BOOST_CHECK(q.dimension() == runtime::to_dynamic(dimensions::predefined::length_t{}));
+
+            std::vector<length_t> out(data.size());
+            q.dequantize(out, 4);
+            for(std::size_t i = 0; i < data.size(); ++i) {
+                BOOST_CHECK_LE(std::abs(out[i].value - data[i].value), q.error_bound(i).value);
+                BOOST_CHECK(q[i] == out[i]);
+            }
+            BOOST_CHECK_LE(q.max_error().value, encoding == Encoding::INT16 ? 1.0 : 5e6 * std::ldexp(1.0, -11));
+
+            std::vector<length_t> part(300);
+            q.dequantize(1000, part);
+            for(std::size_t i = 0; i < part.size(); ++i) BOOST_CHECK(part[i] == out[1000 + i]);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(special_values)
+    {
+        // constant blocks and zeros are exact
+        std::vector<force_t> constant(700, 3.25_N);
+        constant[600] = 0.0_N;
+        for(auto encoding : {Encoding::INT16, Encoding::FLOAT16}) {
+            auto q = quantize(constant, encoding);
+            BOOST_CHECK(q[0] == 3.25_N);
+            BOOST_CHECK(q[599] == 3.25_N);
+            BOOST_CHECK_LE(std::abs(q[600].value), q.error_bound(600).value);
+        }
+
+        std::vector<force_t> bad(10, 1.0_N);
+        bad[3] = force_t(std::numeric_limits<double>::quiet_NaN());
+        QuantizedArray<force_t> q;
+        BOOST_CHECK_THROW(q.assign(bad), std::domain_error);
+        BOOST_CHECK(q.empty());
+        std::vector<force_t> out(3);
+        BOOST_CHECK_THROW(q.dequantize(out), std::invalid_argument);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
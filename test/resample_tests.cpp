@@ -0,0 +1,110 @@
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include "quantity/predefined.hpp"
+#include "quantity/resample.hpp"
+
+BOOST_AUTO_TEST_SUITE(resample_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    using namespace quantity::resample;
+    using quantity::predefined::time_t;
+
+    std::vector<length_t> run(Interpolation interpolation, const std::vector<time_t>& times,
+                              const std::vector<length_t>& values, std::size_t& first)
+    {
+        Channel<length_t> channel(Grid{0.0_s, 0.5_s}, interpolation);
+        channel.push(times, values);
+        channel.finish();
+        first = channel.output_begin();
+        return channel.output();
+    }
+
+    BOOST_AUTO_TEST_CASE(policies)
+    {
+        std::vector<time_t> times = {0.2_s, 0.4_s, 1.5_s, 1.6_s, 3.0_s};
+        std::vector<length_t> values;
+        for(auto t : times) values.push_back(meters(2.0 * t.value));
+
+        std::size_t first;
+        auto linear = run(Interpolation::LINEAR, times, values, first);
+        // grid points 0.5 ... 3.0
+        BOOST_CHECK_EQUAL(first, 1u);
+        BOOST_REQUIRE_EQUAL(linear.size(), 6u);
+        for(std::size_t i = 0; i < linear.size(); ++i) {
+            BOOST_CHECK_CLOSE(linear[i].value, 2.0 * 0.5 * double(first + i), 1e-9);
+        }
+
+        auto hold = run(Interpolation::HOLD, times, values, first);
+        BOOST_REQUIRE_EQUAL(hold.size(), 6u);
+        BOOST_CHECK(hold[0] == 0.8_m);    // 0.5 s
+        BOOST_CHECK(hold[2] == 3.0_m);    // 1.5 s, on a sample
+        BOOST_CHECK(hold[3] == 3.2_m);    // 2.0 s
+        BOOST_CHECK(hold[5] == 6.0_m);    // 3.0 s
+
+        BOOST_CHECK_THROW(run(Interpolation::LINEAR, {1.0_s, 0.5_s}, {1.0_m, 2.0_m}, first), std::invalid_argument);
+    }
+
+    BOOST_AUTO_TEST_CASE(cubic)
+    {
+        // evenly spaced samples of a quadratic are reproduced exactly away from the ends
+        std::vector<time_t> times;
+        std::vector<length_t> values;
+        for(int i = 0; i < 10; ++i) {
+            double t = 0.3 * i;
+            times.push_back(time_t(t));
+            values.push_back(meters(t * t - t));
+        }
+        std::size_t first;
+        auto cubic = run(Interpolation::CUBIC, times, values, first);
+        BOOST_CHECK_EQUAL(first, 0u);
+        BOOST_REQUIRE_EQUAL(cubic.size(), 6u);
+        for(std::size_t k = 1; k < 5; ++k) {
+            double t = 0.5 * double(k);
+            BOOST_CHECK_SMALL(cubic[k].value - (t * t - t), 1e-12);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(aligned_chunks)
+    {
+        // a length channel sampled every 0.3 s and a velocity channel sampled every 0.7 s, fed in chunks
+        Aligner<length_t, velocity_vec> aligner(Grid{0.0_s, 0.25_s}, Interpolation::LINEAR, 2);
+        std::size_t rows = 0;
+        std::size_t next_row = 1;   // the velocity channel starts at 0.1 s
+        auto check = [&](const Block<length_t, velocity_vec>& block) {
+            BOOST_CHECK_EQUAL(block.first, next_row);
+            for(std::size_t i = 0; i < block.size(); ++i) {
+                const double t = block.times[i].value;
+                BOOST_CHECK_CLOSE(t, 0.25 * double(block.first + i), 1e-12);
+                BOOST_CHECK_CLOSE(block.column<0>()[i].value, 3.0 * t, 1e-9);
+                BOOST_CHECK_CLOSE(block.column<1>().y[i].value, -t, 1e-9);
+            }
+            next_row += block.size();
+            rows += block.size();
+        };
+
+        for(int chunk = 0; chunk < 20; ++chunk) {
+            std::vector<time_t> t1, t2;
+            std::vector<length_t> v1;
+            std::vector<velocity_vec> v2;
+            for(int i = 0; i < 10; ++i) {
+                double a = 0.3 * (chunk * 10 + i);
+                double b = 0.1 + 0.7 * (chunk * 10 + i);
+                t1.push_back(time_t(a));
+                v1.push_back(meters(3.0 * a));
+                t2.push_back(time_t(b));
+                v2.push_back(make_vector(speed_t(1.0), speed_t(-b), speed_t(0.0)));
+            }
+            aligner.feed(Input<length_t>{t1, v1}, Input<velocity_vec>{t2, v2});
+            aligner.drain(check);
+            // only rows waiting for the slower channel are kept
+            BOOST_CHECK_LE(aligner.channel<0>().output().size(), 120u);
+        }
+        aligner.finish();
+        aligner.drain(check);
+        // the length channel ends at 59.7 s
+        BOOST_CHECK_EQUAL(next_row, std::size_t(59.7 / 0.25) + 1);
+        BOOST_CHECK_EQUAL(rows, next_row - 1);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
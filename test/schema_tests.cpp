@@ -0,0 +1,161 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "quantity/predefined.hpp"
+#include "quantity/schema.hpp"
+
+BOOST_AUTO_TEST_SUITE(schema_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    using quantity::predefined::time_t;
+
+    struct Body
+    {
+        time_t t;
+        length_vec position;
+        velocity_vec velocity;
+        Quantity<float, mass_t::dimension_t> mass;
+        scalar_t charge;
+    };
+
+    constexpr auto body_schema = schema::make_schema(schema::field("t", &Body::t),
+                                                     schema::field("position", &Body::position, "km"),
+                                                     schema::field("velocity", &Body::velocity, "km/s"),
+                                                     schema::field("mass", &Body::mass, "t"),
+                                                     schema::field("charge", &Body::charge));
+    using body_schema_t = std::decay_t<decltype(body_schema)>;
+
+    static_assert(body_schema_t::size == 5, "fields");
+    static_assert(body_schema_t::components == 9, "components");
+    static_assert(body_schema_t::record_bytes == 8 * 8 + 4, "packed binary layout");
+    static_assert(body_schema_t::offset<2>() == 32 && body_schema_t::offset<4>() == 60, "offsets");
+
+    Body body(double i)
+    {
+        Body b;
+        b.t = time_t(i);
+        b.position = length_vec(meters(1.5 * i), meters(-2.0), meters(1e7 + i));
+        b.velocity = velocity_vec(speed_t(0.25 * i), speed_t(3.0), speed_t(-7.5));
+        b.mass = Quantity<float, mass_t::dimension_t>(1000.0f + float(i));
+        b.charge = 0.5 * i;
+        return b;
+    }
+
+    void check_equal(const Body& a, const Body& b)
+    {
+        BOOST_CHECK_EQUAL(a.t.value, b.t.value);
+        BOOST_CHECK_EQUAL(a.position.x.value, b.position.x.value);
+        BOOST_CHECK_EQUAL(a.position.z.value, b.position.z.value);
+        BOOST_CHECK_EQUAL(a.velocity.x.value, b.velocity.x.value);
+        BOOST_CHECK_EQUAL(a.velocity.z.value, b.velocity.z.value);
+        BOOST_CHECK_EQUAL(a.mass.value, b.mass.value);
+        BOOST_CHECK_EQUAL(a.charge.value, b.charge.value);
+    }
+
+    BOOST_AUTO_TEST_CASE(binary_round_trip)
+    {
+        char buffer[body_schema_t::record_bytes];
+        const Body original = body(3);
+        body_schema.encode(original, buffer);
+        double position_x;
+        std::memcpy(&position_x, buffer + body_schema_t::offset<1>(), sizeof(double));
+        BOOST_CHECK_EQUAL(position_x, 4.5);
+
+        Body decoded;
+        body_schema.decode(buffer, decoded);
+        check_equal(decoded, original);
+
+        std::vector<Body> bodies;
+        for(int i = 0; i < 10000; ++i) bodies.push_back(body(i));
+        std::stringstream stream;
+        schema::write_binary(stream, body_schema, bodies);
+        BOOST_CHECK_EQUAL(stream.str().size(), bodies.size() * body_schema_t::record_bytes);
+
+        std::vector<Body> read;
+        BOOST_CHECK_EQUAL(schema::read_binary(stream, body_schema, read, 6000), 6000u);
+        BOOST_CHECK_EQUAL(schema::read_binary(stream, body_schema, read, 6000), 4000u);
+        BOOST_REQUIRE_EQUAL(read.size(), bodies.size());
+        for(std::size_t i = 0; i < read.size(); i += 997) check_equal(read[i], bodies[i]);
+    }
+
+    BOOST_AUTO_TEST_CASE(text_round_trip)
+    {
+        BOOST_CHECK_EQUAL(body_schema.header(), "t[s],position.x[km],position.y[km],position.z[km],"
+                                                "velocity.x[km/s],velocity.y[km/s],velocity.z[km/s],mass[t],charge");
+        std::stringstream stream;
+        {
+            schema::TextWriter<body_schema_t> writer(stream, body_schema);
+            writer.write(body(2));
+            writer.write(body(3));
+        }
+        std::string header;
+        std::getline(stream, header);
+        std::string row;
+        std::getline(stream, row);
+        BOOST_CHECK_EQUAL(row, "2,0.003,-0.002,10000.002,0.0005,0.003,-0.0075,1.002,1");
+
+        stream.seekg(0);
+        schema::TextReader<body_schema_t> reader(stream, body_schema);
+        Body b;
+        for(double i : {2.0, 3.0}) {
+            BOOST_REQUIRE(reader.read(b));
+            const Body expected = body(i);
+            BOOST_CHECK_EQUAL(b.t.value, expected.t.value);
+            BOOST_CHECK_CLOSE(b.position.x.value, expected.position.x.value, 1e-12);
+            BOOST_CHECK_CLOSE(b.position.z.value, expected.position.z.value, 1e-12);
+            BOOST_CHECK_CLOSE(b.velocity.z.value, expected.velocity.z.value, 1e-12);
+            BOOST_CHECK_EQUAL(b.mass.value, expected.mass.value);
+            BOOST_CHECK_EQUAL(b.charge.value, expected.charge.value);
+        }
+        BOOST_CHECK(!reader.read(b));
+    }
+
+    BOOST_AUTO_TEST_CASE(text_columns)
+    {
+        // any order, other units and extra columns
+        std::istringstream input("charge, note, mass[kg], velocity.z[m/s], velocity.y[m/s], velocity.x[m/s],"
+                                 "position.z[m], position.y[m], position.x[mm], t[ms]\r\n"
+                                 "1, 17, 5, 3, 2, 1, 30, 20, 10, 2500\r\n"
+                                 "\n"
+                                 "2, x, 6, 3, 2, 1, 30, 20, 10, 0\n");
+        schema::TextReader<body_schema_t> reader(input, body_schema);
+        std::vector<Body> bodies;
+        BOOST_CHECK_EQUAL(reader.read(bodies, 10), 2u);
+        BOOST_REQUIRE_EQUAL(bodies.size(), 2u);
+        BOOST_CHECK_CLOSE(bodies[0].t.value, 2.5, 1e-12);
+        BOOST_CHECK_CLOSE(bodies[0].position.x.value, 0.01, 1e-12);
+        BOOST_CHECK_EQUAL(bodies[0].position.z.value, 30.0);
+        BOOST_CHECK_EQUAL(bodies[0].velocity.x.value, 1.0);
+        BOOST_CHECK_EQUAL(bodies[0].mass.value, 5.0f);
+        BOOST_CHECK_EQUAL(bodies[1].charge.value, 2.0);
+        BOOST_CHECK_EQUAL(reader.line(), 4u);
+    }
+
+    BOOST_AUTO_TEST_CASE(text_errors)
+    {
+        const std::string columns = "t[s],position.x[m],position.y[m],position.z[m],"
+                                    "velocity.x[m/s],velocity.y[m/s],velocity.z[m/s],mass[kg]";
+        std::istringstream missing(columns + "\n");
+        BOOST_CHECK_THROW(schema::TextReader<body_schema_t>(missing, body_schema), std::runtime_error);
+
+        std::istringstream wrong_unit(columns + ",charge[m]\n");
+        BOOST_CHECK_THROW(schema::TextReader<body_schema_t>(wrong_unit, body_schema), std::runtime_error);
+
+        std::istringstream repeated(columns + ",charge,t[s]\n");
+        BOOST_CHECK_THROW(schema::TextReader<body_schema_t>(repeated, body_schema), std::runtime_error);
+
+        std::istringstream rows(columns + ",charge\n1,2,3,4,5,6,7,8,9\n1,2,3,4,5,6,7,8\n1,2,3,4,5,6,7,8,9,10\n");
+        schema::TextReader<body_schema_t> reader(rows, body_schema);
+        Body b;
+        BOOST_CHECK(reader.read(b));
+        BOOST_CHECK_THROW(reader.read(b), std::runtime_error);
+        BOOST_CHECK_THROW(reader.read(b), std::runtime_error);
+
+        std::ostringstream out;
+        constexpr auto bad = schema::make_schema(schema::field("t", &Body::t, "m"));
+        BOOST_CHECK_THROW(schema::TextWriter<std::decay_t<decltype(bad)>>(out, bad), std::invalid_argument);
+    }
+BOOST_AUTO_TEST_SUITE_END()
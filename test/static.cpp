@@ -32,4 +32,12 @@ static_assert(!ops::dimensions_equal<dim_a, dim_b>(), "error in dimension equal"
 static_assert(ops::dimensions_equal< predefined::power_t, Dimension_t<r_<2, 1>, r_<-3, 1>, r_<1, 1>> >(), "error in "
         "dimension equal");
 
+// dimensions are canonical: unreduced ratios and different paths give the same type
+static_assert(std::is_same<Dimension_t<r_<2, 4>, r_<-3, -1>, r_<0, 7>>, Dimension_t<r_<1, 2>, r_<3, 1>, r_<0, 1>>>::value,
+              "dimensions are not canonical");
+static_assert(std::is_same<ops::pow_t<ops::pow_t<dim_a, 3, 1>, 1, 3>, dim_a>::value, "dimensions are not canonical");
+static_assert(std::is_same<ops::div_t<ops::mul_t<dim_a, dim_b>, dim_b>, dim_a>::value, "dimensions are not canonical");
+static_assert(std::ratio_equal<dim_a_2_3::mass, r_<4, 9>>::value && dim_a::time::num == -1 && dim_a::time::den == 2,
+              "exponents are not decoded");
+
 #endif //SPACEPHYS_TEST_STATIC_HPP
@@ -0,0 +1,106 @@
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "quantity/statistics.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(statistics_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    using statistics::RunningStats;
+    using statistics::QuantileSketch;
+    namespace ops = quantity::dimensions::ops;
+    namespace pd = quantity::dimensions::predefined;
+
+    static_assert(std::is_same<RunningStats<length_t>::variance_type, area_t>::value,
+                  "variance of a length is an area");
+
+    std::vector<length_t> sample(std::size_t n)
+    {
+        std::mt19937 rng(3);
+        std::normal_distribution<double> d(1e3, 25.0);
+        std::vector<length_t> data;
+        for(std::size_t i = 0; i < n; ++i) data.emplace_back(d(rng));
+        return data;
+    }
+
+    BOOST_AUTO_TEST_CASE(simple_values)
+    {
+        RunningStats<length_t> stats;
+        for(double v : {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0}) {
+            stats.add(meters(v));
+        }
+        BOOST_CHECK_EQUAL(stats.count(), 8u);
+        BOOST_CHECK_CLOSE(stats.mean().value, 5.0, 1e-12);
+        BOOST_CHECK_CLOSE(stats.variance().value, 4.0, 1e-12);
+        BOOST_CHECK_CLOSE(stats.sample_variance().value, 32.0 / 7, 1e-12);
+        BOOST_CHECK_CLOSE(stats.stddev().value, 2.0, 1e-12);
+        BOOST_CHECK(stats.min() == 2.0_m);
+        BOOST_CHECK(stats.max() == 9.0_m);
+    }
+
+    BOOST_AUTO_TEST_CASE(batch_and_merge)
+    {
+        auto data = sample(10000);
+
+        RunningStats<length_t> single;
+        for(const auto& v : data) single.add(v);
+
+        RunningStats<length_t> batch;
+        batch.add(data);
+
+        RunningStats<length_t> first, second;
+        first.add(Span<const length_t>(data).subspan(0, 3333));
+        second.add(Span<const length_t>(data).subspan(3333, data.size() - 3333));
+        first.merge(second);
+
+        auto parallel = statistics::parallel_stats(data, 4);
+
+        for(const auto* s : {&batch, &first, &parallel}) {
+            BOOST_CHECK_EQUAL(s->count(), single.count());
+            BOOST_CHECK_CLOSE(s->mean().value, single.mean().value, 1e-10);
+            BOOST_CHECK_CLOSE(s->variance().value, single.variance().value, 1e-8);
+            BOOST_CHECK(s->min() == single.min());
+            BOOST_CHECK(s->max() == single.max());
+        }
+        BOOST_CHECK_CLOSE(single.stddev().value, 25.0, 5.0);
+    }
+
+    BOOST_AUTO_TEST_CASE(vector_stats)
+    {
+        RunningStats<force_vec> stats;
+        std::vector<force_vec> data = {make_vector(1.0_N, 2.0_N, -1.0_N), make_vector(3.0_N, 2.0_N, 1.0_N)};
+        stats.add(data);
+        BOOST_CHECK(stats.mean() == make_vector(2.0_N, 2.0_N, 0.0_N));
+        BOOST_CHECK_CLOSE(stats.variance().x.value, 1.0, 1e-12);
+        BOOST_CHECK_EQUAL(stats.variance().y.value, 0.0);
+        BOOST_CHECK(stats.max() == make_vector(3.0_N, 2.0_N, 1.0_N));
+    }
+
+    BOOST_AUTO_TEST_CASE(quantiles)
+    {
+        auto data = sample(20000);
+        // include values of both signs and zero
+        data.emplace_back(-5.0);
+        data.emplace_back(0.0);
+
+        QuantileSketch<length_t> a(0.01), b(0.01);
+        a.add(Span<const length_t>(data).subspan(0, 5000));
+        b.add(Span<const length_t>(data).subspan(5000, data.size() - 5000));
+        a.merge(b);
+        BOOST_CHECK_EQUAL(a.count(), data.size());
+
+        auto sorted = data;
+        std::sort(sorted.begin(), sorted.end());
+        for(double q : {0.0, 0.01, 0.25, 0.5, 0.9, 0.99, 1.0}) {
+            double exact = sorted[std::size_t(q * (sorted.size() - 1))].value;
+            BOOST_CHECK_CLOSE(a.quantile(q).value, exact, 1.0 + 1e-9);
+        }
+
+        BOOST_CHECK_THROW(QuantileSketch<length_t>().quantile(0.5), std::domain_error);
+        BOOST_CHECK_THROW(a.merge(QuantileSketch<length_t>(0.05)), std::invalid_argument);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <vector>
+#include "quantity/table.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(table_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    using quantity::predefined::time_t;
+
+    static_assert(dimensions::ops::dimensions_equal<Table<time_t, force_t>::integral_type::dimension_t,
+                                                    impulse_t::dimension_t>(),
+                  "integral of force over time is an impulse");
+    static_assert(dimensions::ops::dimensions_equal<Table<time_t, length_t>::derivative_type::dimension_t,
+                                                    speed_t::dimension_t>(),
+                  "derivative of length over time is a speed");
+
+    BOOST_AUTO_TEST_CASE(linear)
+    {
+        std::vector<time_t> t = {0.0_s, 1.0_s, 3.0_s};
+        std::vector<force_t> f = {0.0_N, 10.0_N, 30.0_N};
+        auto table = make_table(t, f);
+        BOOST_CHECK(!table.is_uniform());
+
+        BOOST_CHECK_CLOSE(table(0.5_s).value, 5.0, 1e-12);
+        BOOST_CHECK_CLOSE(table(2.0_s).value, 20.0, 1e-12);
+        BOOST_CHECK(table(3.0_s) == 30.0_N);
+        // values are held outside of the table
+        BOOST_CHECK(table(-1.0_s) == 0.0_N);
+        BOOST_CHECK(table(5.0_s) == 30.0_N);
+
+        BOOST_CHECK_CLOSE(table.derivative(2.0_s).value, 10.0, 1e-12);
+        BOOST_CHECK_EQUAL(table.derivative(4.0_s).value, 0.0);
+        BOOST_CHECK_CLOSE(table.integral(0.0_s, 3.0_s).value, 45.0, 1e-12);
+        BOOST_CHECK_CLOSE(table.integral(2.0_s, 4.0_s).value, 25.0 + 30.0, 1e-12);
+        BOOST_CHECK_CLOSE(table.integral(3.0_s, 0.0_s).value, -45.0, 1e-12);
+    }
+
+    BOOST_AUTO_TEST_CASE(uniform_matches_general)
+    {
+        std::vector<length_t> h;
+        std::vector<Quantity<double, dimensions::ops::div_t<dimensions::predefined::mass_t,
+                                                            dimensions::ops::pow_t<dimensions::predefined::length_t, 3, 1>>>> rho;
+        for(int i = 0; i <= 100; ++i) {
+            h.push_back(kilometers(i));
+            rho.emplace_back(1.225 * std::exp(-i / 8.5));
+        }
+        auto uniform = Table<length_t, decltype(rho)::value_type>::uniform(0.0_km, 1.0_km, rho,
+                                                                           Interpolation::CUBIC);
+        BOOST_CHECK(uniform.is_uniform());
+
+        // break uniformity by a tiny amount
+        auto general_h = h;
+        general_h[50] = general_h[50] + 1e-3_m;
+        auto general = make_table(general_h, rho, Interpolation::CUBIC);
+        BOOST_CHECK(!general.is_uniform());
+
+        for(double x = -1.0; x < 102.0; x += 0.37) {
+            BOOST_CHECK_CLOSE(uniform(kilometers(x)).value, general(kilometers(x)).value, 1e-3);
+        }
+        // cubic interpolation of a smooth function is accurate
+        BOOST_CHECK_CLOSE(uniform(kilometers(10.5)).value, 1.225 * std::exp(-10.5 / 8.5), 0.05);
+    }
+
+    BOOST_AUTO_TEST_CASE(cubic_reproduces_quadratic)
+    {
+        std::vector<time_t> t;
+        std::vector<length_t> x;
+        for(int i = 0; i < 10; ++i) {
+            t.emplace_back(i * i * 0.1);
+            x.emplace_back(3.0 * t.back().value * t.back().value);
+        }
+        auto table = make_table(t, x, Interpolation::CUBIC);
+        // away from the first and last segment, where the end slopes are only first order
+        BOOST_CHECK_CLOSE(table(2.0_s).value, 12.0, 1e-9);
+        BOOST_CHECK_CLOSE(table.derivative(2.0_s).value, 12.0, 1e-9);
+        BOOST_CHECK_CLOSE(table.integral(1.0_s, 4.0_s).value, 63.0, 1e-9);
+    }
+
+    BOOST_AUTO_TEST_CASE(batch_evaluation)
+    {
+        std::vector<time_t> t = {0.0_s, 1.0_s, 2.5_s, 3.0_s, 7.0_s};
+        std::vector<force_t> f = {1.0_N, 3.0_N, -2.0_N, 0.0_N, 4.0_N};
+        for(auto method : {Interpolation::LINEAR, Interpolation::CUBIC}) {
+            auto table = make_table(t, f, method);
+            std::vector<time_t> in;
+            for(double x = -1; x < 8; x += 0.01) in.emplace_back(x);
+            std::vector<force_t> out(in.size());
+            table.evaluate(in, out);
+            for(std::size_t i = 0; i < in.size(); ++i) {
+                BOOST_CHECK(out[i] == table(in[i]));
+            }
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(invalid_tables)
+    {
+        std::vector<time_t> t = {0.0_s, 1.0_s, 1.0_s};
+        std::vector<force_t> f = {0.0_N, 1.0_N, 2.0_N};
+        BOOST_CHECK_THROW(make_table(t, f), std::invalid_argument);
+        BOOST_CHECK_THROW(make_table(std::vector<time_t>{0.0_s}, std::vector<force_t>{0.0_N}), std::invalid_argument);
+        BOOST_CHECK_THROW(make_table(std::vector<time_t>{0.0_s, 1.0_s}, f), std::invalid_argument);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
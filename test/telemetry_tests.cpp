@@ -0,0 +1,136 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include "quantity/telemetry.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(telemetry_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    using namespace quantity::telemetry;
+
+    std::string segment_name(const char* test)
+    {
+        return std::string("/quantity_test_") + test + "_" + std::to_string(getpid());
+    }
+
+    Schema make_schema()
+    {
+        Schema schema;
+        schema.add<length_t>("altitude")
+              .add<velocity_vec>("velocity")
+              .add<Quantity<float, dimensions::predefined::time_t>>("age");
+        return schema;
+    }
+
+    BOOST_AUTO_TEST_CASE(publish_and_read)
+    {
+        Producer producer(segment_name("publish"), make_schema(), 8);
+        BOOST_CHECK_EQUAL(producer.capacity(), 8u);
+        auto altitude = producer.channel<length_t>("altitude");
+        auto velocity = producer.channel<velocity_vec>("velocity");
+
+        Consumer consumer(segment_name("publish"));
+        BOOST_REQUIRE_EQUAL(consumer.channels().size(), 3u);
+        BOOST_CHECK_EQUAL(consumer.channels()[1].components, 3u);
+        auto c_altitude = consumer.channel<length_t>("altitude");
+        auto c_velocity = consumer.channel<velocity_vec>("velocity");
+        auto c_age = consumer.channel<Quantity<float, dimensions::predefined::time_t>>("age");
+
+        Sample sample;
+        BOOST_CHECK(!consumer.poll(sample));
+
+        for(int i = 0; i < 5; ++i) {
+            producer.publish([&](WriteSample& s) {
+                s[altitude] = kilometers(i);
+                s[velocity] = make_vector(1.0_m / 1.0_s, 2.0_m / 1.0_s, double(i) * 1.0_m / 1.0_s);
+            });
+        }
+        BOOST_CHECK_EQUAL(producer.published(), 5u);
+
+        for(int i = 0; i < 5; ++i) {
+            BOOST_REQUIRE(consumer.poll(sample));
+            BOOST_CHECK_EQUAL(sample.sequence(), std::uint64_t(i));
+            BOOST_CHECK(sample[c_altitude] == kilometers(i));
+            BOOST_CHECK_EQUAL(sample[c_velocity].z.value, double(i));
+            BOOST_CHECK_EQUAL(sample[c_age].value, 0.0f);
+            BOOST_CHECK(consumer.valid(sample));
+        }
+        BOOST_CHECK(!consumer.poll(sample));
+        BOOST_CHECK_EQUAL(consumer.lost(), 0u);
+    }
+
+    BOOST_AUTO_TEST_CASE(overrun)
+    {
+        Producer producer(segment_name("overrun"), make_schema(), 4);
+        auto altitude = producer.channel<length_t>("altitude");
+        Consumer consumer(segment_name("overrun"));
+        auto c_altitude = consumer.channel<length_t>("altitude");
+
+        Sample first;
+        producer.publish([&](WriteSample& s) { s[altitude] = 0.0_m; });
+        BOOST_REQUIRE(consumer.poll(first));
+        for(int i = 1; i < 10; ++i) {
+            producer.publish([&](WriteSample& s) { s[altitude] = meters(i); });
+        }
+        // the slot of the first record has been reused
+        BOOST_CHECK(!consumer.valid(first));
+
+        Sample sample;
+        BOOST_REQUIRE(consumer.poll(sample));
+        BOOST_CHECK_EQUAL(consumer.lost(), 5u);
+        BOOST_CHECK(sample[c_altitude] == 6.0_m);
+    }
+
+    BOOST_AUTO_TEST_CASE(concurrent_reader)
+    {
+        Producer producer(segment_name("concurrent"), make_schema(), 64);
+        auto altitude = producer.channel<length_t>("altitude");
+        auto velocity = producer.channel<velocity_vec>("velocity");
+        Consumer consumer(segment_name("concurrent"));
+
+        const int count = 100000;
+        int torn = 0;
+        std::thread reader([&] {
+            auto c_altitude = consumer.channel<length_t>("altitude");
+            auto c_velocity = consumer.channel<velocity_vec>("velocity");
+            Sample sample;
+            std::uint64_t seen = 0;
+            while(seen + consumer.lost() < std::uint64_t(count)) {
+                if(!consumer.poll(sample)) continue;
+                double h = sample[c_altitude].value;
+                double vx = sample[c_velocity].x.value;
+                if(consumer.valid(sample) && (h != double(sample.sequence()) || vx != -h)) {
+                    ++torn;
+                }
+                ++seen;
+            }
+        });
+        for(int i = 0; i < count; ++i) {
+            producer.publish([&](WriteSample& s) {
+                s[altitude] = meters(i);
+                s[velocity] = make_vector(-double(i) * 1.0_m / 1.0_s, 0.0_m / 1.0_s, 0.0_m / 1.0_s);
+            });
+        }
+        reader.join();
+        // Boost.Test assertions are not thread safe, so the reader only counts inconsistent records.
+        BOOST_CHECK_EQUAL(torn, 0);
+    }
+
+    BOOST_AUTO_TEST_CASE(errors)
+    {
+        Producer producer(segment_name("errors"), make_schema());
+        Consumer consumer(segment_name("errors"));
+        BOOST_CHECK_THROW(consumer.channel<length_vec>("velocity"), std::runtime_error);
+        BOOST_CHECK_THROW(consumer.channel<speed_t>("velocity"), std::runtime_error);
+        using float_length_t = Quantity<float, dimensions::predefined::length_t>;
+        BOOST_CHECK_THROW(consumer.channel<float_length_t>("altitude"), std::runtime_error);
+        BOOST_CHECK_THROW(consumer.channel<length_t>("height"), std::runtime_error);
+        BOOST_CHECK_THROW(Consumer(segment_name("missing")), std::system_error);
+        BOOST_CHECK_THROW(Schema().add<length_t>("a").add<speed_t>("a"), std::invalid_argument);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,81 @@
+#include <boost/test/unit_test.hpp>
+
+#include <tuple>
+#include <vector>
+#include "quantity/views.hpp"
+#include "quantity/predefined.hpp"
+
+BOOST_AUTO_TEST_SUITE(views_tests)
+    using namespace quantity;
+    using namespace quantity::predefined;
+    using quantity::predefined::time_t;
+
+    BOOST_AUTO_TEST_CASE(unit_conversion)
+    {
+        std::vector<double> raw = {1.0, 2.5, -3.0};
+        auto lengths = views::from_unit<length_t>(raw, "km");
+        std::vector<length_t> converted = views::to_vector(lengths);
+        BOOST_REQUIRE_EQUAL(converted.size(), 3u);
+        BOOST_CHECK_CLOSE(converted[1].value, 2500.0, 1e-10);
+        BOOST_CHECK_CLOSE(views::sum(lengths).value, 500.0, 1e-10);
+
+        // the view sees later changes of the underlying data
+        raw[0] = 4.0;
+        BOOST_CHECK_CLOSE(views::sum(lengths).value, 3500.0, 1e-10);
+
+        BOOST_CHECK_CLOSE(views::sum(views::from_unit<speed_t>(raw, "km/s") | views::scaled(2.0)).value, 7000.0, 1e-10);
+        BOOST_CHECK_THROW(views::from_unit<length_t>(raw, "s"), std::runtime_error);
+    }
+
+    BOOST_AUTO_TEST_CASE(filter_and_map)
+    {
+        std::vector<length_t> data = {1.0_m, 5.0_m, 2.0_m, 8.0_m, 3.0_m};
+        auto big = data | views::filter([](length_t l) { return l > 2.5_m; });
+        BOOST_CHECK_EQUAL(views::count(big), 3u);
+        BOOST_CHECK(views::sum(big) == 16.0_m);
+
+        // the map keeps the dimension of its result
+        auto areas = big | views::map([](length_t l) { return l * l; });
+        auto total = views::reduce(areas, area_t(0.0), [](area_t a, area_t b) { return a + b; });
+        BOOST_CHECK_CLOSE(total.value, 25.0 + 64.0 + 9.0, 1e-10);
+
+        auto none = data | views::filter([](length_t l) { return l > 100.0_m; });
+        BOOST_CHECK_EQUAL(views::count(none), 0u);
+        BOOST_CHECK(views::sum(none) == 0.0_m);
+    }
+
+    BOOST_AUTO_TEST_CASE(vector_components)
+    {
+        Vec3Array<length_t> positions(3);
+        for(std::size_t i = 0; i < 3; ++i) {
+            positions.x[i] = meters(double(i));
+            positions.y[i] = meters(10.0 * i);
+            positions.z[i] = meters(-1.0);
+        }
+
+        auto vectors = views::vectors(positions);
+        BOOST_CHECK_EQUAL(views::count(vectors), 3u);
+        BOOST_CHECK(views::to_vector(vectors)[2] == make_vector(2.0_m, 20.0_m, -1.0_m));
+        BOOST_CHECK(views::sum(vectors | views::y()) == 30.0_m);
+        BOOST_CHECK(views::sum(vectors | views::z()) == -3.0_m);
+
+        std::vector<length_vec> list = views::to_vector(vectors);
+        auto far = list | views::filter([](const length_vec& v) { return v.x > 0.5_m; }) | views::x();
+        BOOST_CHECK(views::sum(far) == 3.0_m);
+    }
+
+    BOOST_AUTO_TEST_CASE(zip_shortest)
+    {
+        std::vector<length_t> distance = {10.0_m, 20.0_m, 30.0_m};
+        std::vector<double> raw_time = {2.0, 4.0};
+        auto speeds = views::zip(distance, views::from_unit<time_t>(raw_time, "ms")) |
+                      views::map([](const std::tuple<length_t, time_t>& t) {
+                          return std::get<0>(t) / std::get<1>(t);
+                      });
+        std::vector<speed_t> result = views::to_vector(speeds);
+        BOOST_REQUIRE_EQUAL(result.size(), 2u);
+        BOOST_CHECK_CLOSE(result[0].value, 5000.0, 1e-10);
+        BOOST_CHECK_CLOSE(result[1].value, 5000.0, 1e-10);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()